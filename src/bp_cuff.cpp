@@ -0,0 +1,136 @@
+#include "bp_cuff.h"
+#include <string.h>
+
+BpCuff::BpCuff()
+    : sendFn(NULL), sendCtx(NULL), resultFn(NULL), resultCtx(NULL), current(BPC_IDLE),
+      failReason(NULL), startedAt(0), lastFrameAt(0), lastStop(0), stopSent(false), changed(false),
+      peakOsc(0), peakCuff(0), traceHead(0), traceCount(0) {
+    memset(&last, 0, sizeof(last));
+}
+
+void BpCuff::setLink(BpSendFn send, void* ctx) {
+    sendFn = send;
+    sendCtx = ctx;
+}
+
+void BpCuff::setHandler(BpResultFn handler, void* ctx) {
+    resultFn = handler;
+    resultCtx = ctx;
+}
+
+void BpCuff::sendStop(uint32_t now) {
+    uint8_t stop = CMD_STOP_STREAM;
+    if (sendFn) sendFn(&stop, 1, sendCtx);
+    lastStop = now;
+    stopSent = true;
+}
+
+void BpCuff::finish(const char* why) {
+    current = BPC_FAILED;
+    failReason = why;
+    changed = true;
+    if (resultFn) resultFn(last, why, resultCtx);
+}
+
+/* ==================== INPUTS ==================== */
+void BpCuff::start(uint32_t now) {
+    if (running()) return;
+    memset(&last, 0, sizeof(last));
+    failReason = NULL;
+    peakOsc = 0;
+    peakCuff = 0;
+    traceHead = 0;
+    traceCount = 0;
+    startedAt = now;
+    lastFrameAt = now;
+    current = BPC_WAITING;
+    changed = true;
+    uint8_t cmd = CMD_START_BP;
+    if (sendFn) sendFn(&cmd, 1, sendCtx);
+}
+
+void BpCuff::cancel(uint32_t now) {
+    if (running()) sendStop(now);
+    current = BPC_IDLE;
+    failReason = NULL;
+    changed = true;
+}
+
+void BpCuff::frame(const BpReading& r, uint32_t now) {
+    if (!running()) {
+        // Somebody else's run, or ours outliving a restart: let it down
+        bool active = r.phase == BP_INFLATING || r.phase == BP_DEFLATING;
+        if (active && (!stopSent || now - lastStop >= BP_STRAY_STOP_MS)) sendStop(now);
+        return;
+    }
+    lastFrameAt = now;
+    last = r;
+    changed = true;
+    if (r.cuffMmHg > BP_MAX_CUFF_MMHG) {
+        sendStop(now);
+        finish("Cuff over-pressure");
+        return;
+    }
+
+    switch (r.phase) {
+        case BP_INFLATING:
+            current = BPC_INFLATING;
+            break;
+        case BP_DEFLATING:
+            current = BPC_DEFLATING;
+            trace[traceHead] = r.oscMmHg;
+            traceHead = (traceHead + 1) % BP_TRACE_RING;
+            if (traceCount < BP_TRACE_RING) traceCount++;
+            if (r.oscMmHg > peakOsc) {
+                peakOsc = r.oscMmHg;
+                peakCuff = r.cuffMmHg;
+            }
+            break;
+        case BP_DONE:
+            if (r.sys == 0 || r.dia == 0 || r.dia >= r.sys) {
+                finish("No valid reading");
+                return;
+            }
+            current = BPC_DONE;
+            if (resultFn) resultFn(last, NULL, resultCtx);
+            break;
+        case BP_FAILED:
+            finish("Cuff could not measure");
+            break;
+        default: break;   // unknown phase byte
+    }
+}
+
+void BpCuff::tick(uint32_t now) {
+    if (!running()) return;
+    if (now - startedAt >= BP_MAX_RUN_MS) {
+        sendStop(now);
+        finish("Timed out");
+        return;
+    }
+    uint32_t quiet = current == BPC_WAITING ? BP_FIRST_FRAME_MS : BP_FRAME_GAP_MS;
+    if (now - lastFrameAt < quiet) return;
+    sendStop(now);
+    finish(current == BPC_WAITING ? "Cuff not responding" : "Cuff stopped reporting");
+}
+
+/* ==================== UI ==================== */
+float BpCuff::mapEstimate() const {
+    if (current != BPC_DEFLATING && current != BPC_DONE) return 0;
+    if (peakOsc <= 0 || last.oscMmHg * 100 > peakOsc * BP_PAST_PEAK_PCT) return 0;
+    return peakCuff;
+}
+
+bool BpCuff::takeChanged() {
+    bool c = changed;
+    changed = false;
+    return c;
+}
+
+size_t BpCuff::drain(float* out, size_t n) {
+    if (n > traceCount) n = traceCount;
+    uint8_t start = (traceHead + BP_TRACE_RING - traceCount) % BP_TRACE_RING;
+    for (size_t i = 0; i < n; i++) out[i] = trace[(start + i) % BP_TRACE_RING];
+    traceCount -= n;
+    return n;
+}
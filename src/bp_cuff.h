@@ -0,0 +1,88 @@
+#ifndef BP_CUFF_H
+#define BP_CUFF_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hub_protocol.h"
+
+// Automatic blood pressure: one CMD_START_BP run of the hub's cuff, followed
+// through its BP frames to the hub's result.
+//
+// The kiosk does not trust the hub to let the cuff down on its own. A run
+// that goes quiet, overruns BP_MAX_RUN_MS or reports more than
+// BP_MAX_CUFF_MMHG is vented with CMD_STOP_STREAM and failed, and so is one
+// the caller cancels. Cuff frames that arrive with no run going (the kiosk
+// restarted mid-run) are answered with another STOP.
+//
+// Oscillation amplitudes seen on the way down are kept for the BP screen's
+// chart. Once they are clearly past their peak, the cuff pressure at the
+// largest one is the MAP estimate shown while the hub is still measuring.
+//
+// Time is passed in by the caller and the hub link and result are
+// callbacks, so this has no Arduino or LVGL dependencies.
+
+#define BP_FIRST_FRAME_MS  3000     // START sent, cuff not answering
+#define BP_FRAME_GAP_MS    2000     // frames stopped mid-run
+#define BP_MAX_RUN_MS      120000   // vent whatever the hub says
+#define BP_MAX_CUFF_MMHG   300
+#define BP_STRAY_STOP_MS   1000     // repeat STOP for a run we didn't start
+#define BP_TRACE_RING      32
+#define BP_PAST_PEAK_PCT   80       // oscillations this far down from the largest: MAP found
+
+enum BpCuffState { BPC_IDLE, BPC_WAITING, BPC_INFLATING, BPC_DEFLATING, BPC_DONE, BPC_FAILED };
+
+typedef void (*BpSendFn)(const uint8_t* bytes, size_t len, void* ctx);
+
+// `failure` is NULL when `result` holds a reading
+typedef void (*BpResultFn)(const BpReading& result, const char* failure, void* ctx);
+
+class BpCuff {
+public:
+    BpCuff();
+
+    void setLink(BpSendFn send, void* ctx);
+    void setHandler(BpResultFn handler, void* ctx);
+
+    void start(uint32_t now);
+    void cancel(uint32_t now);   // vents a running cuff; forgets the last result
+    void frame(const BpReading& r, uint32_t now);
+    void tick(uint32_t now);     // timeouts
+
+    BpCuffState state() const { return current; }
+    bool running() const { return current == BPC_WAITING || current == BPC_INFLATING || current == BPC_DEFLATING; }
+    const BpReading& latest() const { return last; }   // newest frame, or the result once done
+    const char* failure() const { return failReason; }
+    float mapEstimate() const;   // 0 until the oscillations have peaked
+
+    // Set by every frame and state change; for batching UI updates
+    bool takeChanged();
+
+    // Oscillation amplitudes not taken yet, oldest first
+    size_t drain(float* out, size_t n);
+
+private:
+    void finish(const char* why);
+    void sendStop(uint32_t now);
+
+    BpSendFn sendFn;
+    void* sendCtx;
+    BpResultFn resultFn;
+    void* resultCtx;
+
+    BpCuffState current;
+    BpReading last;
+    const char* failReason;
+    uint32_t startedAt;
+    uint32_t lastFrameAt;
+    uint32_t lastStop;
+    bool stopSent;
+    bool changed;
+    float peakOsc;
+    float peakCuff;
+
+    float trace[BP_TRACE_RING];
+    uint8_t traceHead;
+    uint8_t traceCount;
+};
+
+#endif // BP_CUFF_H
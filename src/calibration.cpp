@@ -0,0 +1,171 @@
+#include "calibration.h"
+#include <Preferences.h>
+#include <rom/crc.h>
+#include <math.h>
+
+struct CalBlob {
+    uint16_t version;
+    uint16_t sensors;
+    CalCurve curves[HUB_SENSOR_COUNT];
+    uint32_t crc;   // over everything above
+};
+
+// Fixed-point form of a curve: input in Q8, result in Q16; c1 and c2 carry
+// extra fraction bits so small quadratic terms survive the conversion.
+struct CalFixed {
+    bool identity;
+    int64_t c0;   // Q16
+    int64_t c1;   // Q24
+    int64_t c2;   // Q40
+};
+
+static Preferences calPrefs;
+static CalCurve curves[HUB_SENSOR_COUNT];
+static CalFixed fixed[HUB_SENSOR_COUNT];
+static uint8_t bypassSensor = 0;
+
+static const CalCurve IDENTITY = {{0.0f, 1.0f, 0.0f}};
+
+static void precompute(uint8_t idx) {
+    const CalCurve& c = curves[idx];
+    CalFixed& f = fixed[idx];
+    f.identity = c.c[0] == 0.0f && c.c[1] == 1.0f && c.c[2] == 0.0f;
+    f.c0 = (int64_t)llround((double)c.c[0] * (1LL << 16));
+    f.c1 = (int64_t)llround((double)c.c[1] * (1LL << 24));
+    f.c2 = (int64_t)llround((double)c.c[2] * (1LL << 40));
+}
+
+static uint32_t blobCRC(const CalBlob& b) {
+    return crc32_le(0, (const uint8_t*)&b, offsetof(CalBlob, crc));
+}
+
+static bool save() {
+    CalBlob b;
+    memset(&b, 0, sizeof(b));
+    b.version = CAL_VERSION;
+    b.sensors = HUB_SENSOR_COUNT;
+    memcpy(b.curves, curves, sizeof(curves));
+    b.crc = blobCRC(b);
+    if (calPrefs.putBytes("curves", &b, sizeof(b)) != sizeof(b)) {
+        Serial.println("✗ Calibration: NVS write failed");
+        return false;
+    }
+    return true;
+}
+
+bool calBegin() {
+    for (uint8_t i = 0; i < HUB_SENSOR_COUNT; i++) curves[i] = IDENTITY;
+
+    bool ok = calPrefs.begin(CAL_NAMESPACE, false);
+    if (!ok) {
+        Serial.println("✗ Calibration: NVS unavailable, using identity");
+    } else {
+        CalBlob b;
+        size_t n = calPrefs.getBytes("curves", &b, sizeof(b));
+        if (n == 0) {
+            Serial.println("Calibration: none stored, using identity");
+        } else if (n != sizeof(b) || b.version != CAL_VERSION || b.sensors != HUB_SENSOR_COUNT ||
+                   b.crc != blobCRC(b)) {
+            Serial.println("✗ Calibration: stored curves invalid, using identity");
+            ok = false;
+        } else {
+            memcpy(curves, b.curves, sizeof(curves));
+            Serial.println("✓ Calibration loaded");
+        }
+    }
+    for (uint8_t i = 0; i < HUB_SENSOR_COUNT; i++) precompute(i);
+    return ok;
+}
+
+/* ==================== APPLY ==================== */
+float calPreview(uint8_t sensor, float raw) {
+    if (sensor < 1 || sensor > HUB_SENSOR_COUNT) return raw;
+    const CalFixed& f = fixed[sensor - 1];
+    if (f.identity) return raw;
+
+    int64_t x = (int64_t)(raw * 256.0f);                // Q8
+    int64_t y = f.c0;                                   // Q16
+    y += (f.c1 * x) >> 16;                              // Q24 * Q8 = Q32 -> Q16
+    y += (((f.c2 * x) >> 24) * x) >> 16;                // Q40 * Q8 -> Q24, * Q8 -> Q16
+    return (float)y * (1.0f / 65536.0f);
+}
+
+float calApply(uint8_t sensor, float raw) {
+    return sensor == bypassSensor ? raw : calPreview(sensor, raw);
+}
+
+void calApplyFrame(SensorData& d) {
+    if (d.sensor_status & HUB_STATUS_HEIGHT) d.height_cm = calApply(HUB_SENSOR_HEIGHT, d.height_cm);
+    if (d.sensor_status & HUB_STATUS_WEIGHT) d.weight_kg = calApply(HUB_SENSOR_WEIGHT, d.weight_kg);
+    if (d.sensor_status & HUB_STATUS_TEMP) d.temperature_c = calApply(HUB_SENSOR_TEMP, d.temperature_c);
+    if (d.sensor_status & HUB_STATUS_HR) {
+        float hr = calApply(HUB_SENSOR_PULSE, d.heart_rate);
+        d.heart_rate = hr > 0 ? (uint16_t)(hr + 0.5f) : 0;
+    }
+    if (d.height_cm > 0 && d.weight_kg > 0) {
+        float m = d.height_cm / 100.0f;
+        d.bmi = d.weight_kg / (m * m);
+    }
+}
+
+/* ==================== CURVES ==================== */
+const CalCurve& calCurve(uint8_t sensor) {
+    return curves[sensor >= 1 && sensor <= HUB_SENSOR_COUNT ? sensor - 1 : 0];
+}
+
+bool calSet(uint8_t sensor, const CalCurve& curve) {
+    if (sensor < 1 || sensor > HUB_SENSOR_COUNT) return false;
+    curves[sensor - 1] = curve;
+    precompute(sensor - 1);
+    return save();
+}
+
+bool calReset(uint8_t sensor) {
+    return calSet(sensor, IDENTITY);
+}
+
+void calSetBypass(uint8_t sensor) {
+    bypassSensor = sensor;
+}
+
+/* ==================== FIT ==================== */
+// Solves the normal equations of a polynomial least-squares fit by Gaussian
+// elimination; at most 3x3, in double for headroom.
+bool calFit(const float* raw, const float* ref, uint8_t n, CalCurve& out) {
+    if (n == 0 || n > CAL_MAX_POINTS) return false;
+    out = IDENTITY;
+    if (n == 1) {
+        out.c[0] = ref[0] - raw[0];
+        return true;
+    }
+    const int terms = n >= 3 ? 3 : 2;
+
+    double a[3][4] = {{0}};
+    for (uint8_t i = 0; i < n; i++) {
+        double p[3] = {1.0, raw[i], (double)raw[i] * raw[i]};
+        for (int r = 0; r < terms; r++) {
+            for (int c = 0; c < terms; c++) a[r][c] += p[r] * p[c];
+            a[r][terms] += p[r] * ref[i];
+        }
+    }
+    for (int col = 0; col < terms; col++) {
+        int pivot = col;
+        for (int r = col + 1; r < terms; r++) {
+            if (fabs(a[r][col]) > fabs(a[pivot][col])) pivot = r;
+        }
+        if (fabs(a[pivot][col]) < 1e-9) return false;   // points not distinct enough
+        for (int c = 0; c <= terms; c++) {
+            double t = a[col][c];
+            a[col][c] = a[pivot][c];
+            a[pivot][c] = t;
+        }
+        for (int r = 0; r < terms; r++) {
+            if (r == col) continue;
+            double k = a[r][col] / a[col][col];
+            for (int c = col; c <= terms; c++) a[r][c] -= k * a[col][c];
+        }
+    }
+    out.c[2] = 0.0f;
+    for (int t = 0; t < terms; t++) out.c[t] = (float)(a[t][terms] / a[t][t]);
+    return true;
+}
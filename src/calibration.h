@@ -0,0 +1,51 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <Arduino.h>
+#include "hub_protocol.h"
+
+// Per-sensor calibration of hub readings: calibrated = c0 + c1*raw + c2*raw²,
+// fitted on the calibration screen from readings against known references
+// (weights, a measuring rod, a reference thermometer).
+//
+// Curves are kept in NVS with a version and CRC; a missing or damaged blob
+// means identity for every sensor. On load each curve is converted to fixed
+// point once, so applying it in the ingest path is integer multiply-adds,
+// and identity curves are skipped outright.
+
+#define CAL_NAMESPACE  "calib"
+#define CAL_VERSION    1
+#define CAL_DEGREE_MAX 2
+#define CAL_MAX_POINTS 6
+
+struct CalCurve {
+    float c[CAL_DEGREE_MAX + 1];   // c0 + c1*x + c2*x²
+};
+
+// Load curves from NVS. Call once at boot.
+bool calBegin();
+
+// Calibrated value of one reading (HUB_SENSOR_* number)
+float calApply(uint8_t sensor, float raw);
+
+// Same, ignoring the bypass below
+float calPreview(uint8_t sensor, float raw);
+
+// Calibrate every field of a data frame, BMI recomputed from the results
+void calApplyFrame(SensorData& d);
+
+const CalCurve& calCurve(uint8_t sensor);
+
+// Replace one sensor's curve and persist all of them
+bool calSet(uint8_t sensor, const CalCurve& curve);
+bool calReset(uint8_t sensor);   // back to identity
+
+// Readings of this sensor pass through uncalibrated (0 = none), so the
+// calibration screen sees raw values
+void calSetBypass(uint8_t sensor);
+
+// Least-squares fit through n (raw, reference) points. The degree follows
+// the point count: 1 point = offset, 2 = linear, 3 or more = quadratic.
+bool calFit(const float* raw, const float* ref, uint8_t n, CalCurve& out);
+
+#endif // CALIBRATION_H
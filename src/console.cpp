@@ -0,0 +1,68 @@
+#include "console.h"
+
+struct ConsoleCommand {
+    const char* name;
+    ConsoleHandler handler;
+};
+
+static ConsoleCommand commands[CONSOLE_MAX_COMMANDS];
+static uint8_t commandCount = 0;
+
+static char line[CONSOLE_LINE_MAX];
+static uint8_t lineLen = 0;
+static bool lineOverflow = false;
+static unsigned long lastInput = 0;
+
+static void consoleHelp(const char*) {
+    Serial.println("Commands:");
+    for (uint8_t i = 0; i < commandCount; i++) {
+        Serial.printf("  %s\n", commands[i].name);
+    }
+}
+
+bool consoleRegister(const char* name, ConsoleHandler handler) {
+    if (commandCount == 0) {
+        commands[commandCount++] = {"HELP", consoleHelp};
+    }
+    if (commandCount >= CONSOLE_MAX_COMMANDS) return false;
+    commands[commandCount++] = {name, handler};
+    return true;
+}
+
+static void dispatch() {
+    char* args = line;
+    while (*args && *args != ' ') args++;
+    size_t nameLen = args - line;
+    while (*args == ' ') args++;
+
+    for (uint8_t i = 0; i < commandCount; i++) {
+        if (strlen(commands[i].name) == nameLen &&
+            strncasecmp(commands[i].name, line, nameLen) == 0) {
+            commands[i].handler(args);
+            return;
+        }
+    }
+    Serial.printf("Unknown command: %.*s\n", (int)nameLen, line);
+}
+
+void consolePoll() {
+    while (Serial.available()) {
+        lastInput = millis();
+        char c = Serial.read();
+        if (c == '\r') continue;
+        if (c != '\n') {
+            if (lineLen < CONSOLE_LINE_MAX - 1) line[lineLen++] = c;
+            else lineOverflow = true;
+            continue;
+        }
+        line[lineLen] = '\0';
+        if (lineOverflow) Serial.println("Command too long");
+        else if (lineLen > 0) dispatch();
+        lineLen = 0;
+        lineOverflow = false;
+    }
+}
+
+unsigned long consoleLastInput() {
+    return lastInput;
+}
@@ -0,0 +1,23 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <Arduino.h>
+
+// Line-based command console on the USB serial port, used by field tools
+// (export collector, diagnostics). Commands are one word followed by
+// optional arguments, terminated by '\n'.
+
+#define CONSOLE_MAX_COMMANDS 16
+#define CONSOLE_LINE_MAX     96
+
+typedef void (*ConsoleHandler)(const char* args);
+
+bool consoleRegister(const char* name, ConsoleHandler handler);
+
+// Call from loop(); never blocks
+void consolePoll();
+
+// millis() of the last byte received, 0 if none yet
+unsigned long consoleLastInput();
+
+#endif // CONSOLE_H
@@ -11,7 +11,7 @@
 // Configuration for Display and Touch
 #define TOUCH_GT911_SCL 20
 #define TOUCH_GT911_SDA 19
-#define TOUCH_GT911_INT -1
+#define TOUCH_GT911_INT -1   // wire the GT911 INT pad to a free GPIO to enable interrupt mode
 #define TOUCH_GT911_RST 38
 #define TOUCH_MAP_X1 800
 #define TOUCH_MAP_X2 0
@@ -29,13 +29,38 @@
 #define SD_MISO 13
 #define SD_SCK  12
 
+// Sensor hub UART
+#define UART_RX_PIN 18
+#define UART_TX_PIN 17
+#define UART_BAUD 115200
+
+// Local sensor drivers (sensor_driver.cpp), for kiosks with a sensor wired
+// straight to the board instead of the hub; -1 = not fitted. 17/18 are
+// the hub UART, so none of these may use them.
+#define ULTRASONIC_TRIG_PIN -1
+#define ULTRASONIC_ECHO_PIN -1
+#define HX711_DOUT_PIN      -1
+#define HX711_SCK_PIN       -1
+#define MLX90614_SDA_PIN    -1   // own bus (Wire1); Wire belongs to the touch task
+#define MLX90614_SCL_PIN    -1
+
+#define PIN_IS_UART(p) ((p) >= 0 && ((p) == UART_RX_PIN || (p) == UART_TX_PIN))
+#if PIN_IS_UART(ULTRASONIC_TRIG_PIN) || PIN_IS_UART(ULTRASONIC_ECHO_PIN) || \
+    PIN_IS_UART(HX711_DOUT_PIN) || PIN_IS_UART(HX711_SCK_PIN) || \
+    PIN_IS_UART(MLX90614_SDA_PIN) || PIN_IS_UART(MLX90614_SCL_PIN)
+#error "local sensor pin collides with the hub UART"
+#endif
 
-#define TRIG_PIN 17
-#define ECHO_PIN 18
 // CSV File settings
-#define DATA_FILENAME "/health_data.csv"
+#define DATA_FILENAME "/health_data.csv"   // legacy single file, migrated on mount
 #define MAX_RECORDS 1000
 
+// Segmented record store: DATA_DIR/segNNNNN.csv, SEGMENT_RECORDS per file,
+// oldest segments dropped to stay within MAX_RECORDS / RETENTION_DAYS
+#define DATA_DIR "/records"
+#define SEGMENT_RECORDS 100
+#define RETENTION_DAYS 0   // 0 = keep until MAX_RECORDS is reached
+
 // ==================== Display Objects ====================
 extern TAMC_GT911 ts;
 extern Arduino_ESP32RGBPanel rgbpanel;
@@ -51,14 +76,18 @@ bool initPrinter();
 void printHealthReport();
 
 // SD Card functions
+struct HealthData;
 bool initSDCard();
 bool saveHealthData(const String& data);
+bool saveHealthData(const HealthData& data, uint64_t* at = NULL);   // at: the RecordPos stored to
 String readHealthData();
 bool deleteHealthData();
 void updateReportPage();
 void updateDisplay();
 void update_welcome_printer_status();
+void update_welcome_sd_status();
 void show_report();
 void create_data_view_screen();
+void data_view_show(uint32_t first);
 void addLog(const char* message);
 #endif // DISPLAY_H
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "gesture.h"
+
+enum GestureState : uint8_t {
+    GS_IDLE,
+    GS_TRACKING,     // one finger down
+    GS_PINCH,        // two fingers down
+    GS_WAIT_LIFT     // pinch ended with a finger still down – ignore it
+};
+
+struct Sample {
+    int64_t t;
+    int16_t x, y;
+};
+
+static GestureHandler handler = NULL;
+static GestureState state = GS_IDLE;
+
+static Sample history[GESTURE_HISTORY];
+static uint8_t histHead = 0;     // next slot to write
+static uint8_t histCount = 0;
+static Sample start;
+
+static uint32_t pinchStartDist = 0;
+static uint16_t pinchReported = 100;
+
+static void emit(const Gesture& g) {
+    if (handler) handler(g);
+}
+
+static void addSample(const TouchEvent& ev) {
+    Sample& s = history[histHead];
+    s.t = ev.stamp_us;
+    s.x = ev.pts[0].x;
+    s.y = ev.pts[0].y;
+    histHead = (histHead + 1) % GESTURE_HISTORY;
+    if (histCount < GESTURE_HISTORY) histCount++;
+}
+
+static const Sample& sampleAgo(uint8_t n) {
+    return history[(histHead + GESTURE_HISTORY - 1 - n) % GESTURE_HISTORY];
+}
+
+// Velocity over the last GESTURE_VELOCITY_MS of movement, px/s
+static void releaseVelocity(int64_t releaseAt, int32_t& vx, int32_t& vy) {
+    vx = vy = 0;
+    if (histCount < 2) return;
+    const Sample& newest = sampleAgo(0);
+    if (releaseAt - newest.t > (int64_t)GESTURE_HOLD_MS * 1000) return;
+
+    const Sample* oldest = &newest;
+    for (uint8_t i = 1; i < histCount; i++) {
+        const Sample& s = sampleAgo(i);
+        if (newest.t - s.t > (int64_t)GESTURE_VELOCITY_MS * 1000) break;
+        oldest = &s;
+    }
+    int64_t dt = newest.t - oldest->t;
+    if (dt <= 0) return;
+    vx = (int32_t)((newest.x - oldest->x) * 1000000LL / dt);
+    vy = (int32_t)((newest.y - oldest->y) * 1000000LL / dt);
+}
+
+static uint32_t pinchDistance(const TouchEvent& ev) {
+    int32_t dx = ev.pts[1].x - ev.pts[0].x;
+    int32_t dy = ev.pts[1].y - ev.pts[0].y;
+    return (uint32_t)sqrtf((float)(dx * dx + dy * dy));
+}
+
+static void fillPinch(Gesture& g, const TouchEvent& ev, GestureType type) {
+    g.type = type;
+    g.x = (ev.pts[0].x + ev.pts[1].x) / 2;
+    g.y = (ev.pts[0].y + ev.pts[1].y) / 2;
+    g.dx = g.dy = 0;
+    g.vx = g.vy = 0;
+}
+
+static void beginPinch(const TouchEvent& ev) {
+    pinchStartDist = pinchDistance(ev);
+    if (pinchStartDist == 0) pinchStartDist = 1;
+    pinchReported = 100;
+    state = GS_PINCH;
+}
+
+static void endTracking(const TouchEvent& ev) {
+    Gesture g;
+    g.x = ev.pts[0].x;
+    g.y = ev.pts[0].y;
+    g.dx = g.x - start.x;
+    g.dy = g.y - start.y;
+    g.scale_pct = 100;
+    releaseVelocity(ev.stamp_us, g.vx, g.vy);
+
+    int32_t adx = abs(g.dx), ady = abs(g.dy);
+    int32_t speed = max(abs(g.vx), abs(g.vy));
+    if (speed >= GESTURE_FLING_MIN_PX_S) {
+        g.type = GESTURE_FLING;
+    } else if (max(adx, ady) >= GESTURE_SWIPE_MIN_PX) {
+        if (adx > ady) g.type = g.dx < 0 ? GESTURE_SWIPE_LEFT : GESTURE_SWIPE_RIGHT;
+        else g.type = g.dy < 0 ? GESTURE_SWIPE_UP : GESTURE_SWIPE_DOWN;
+    } else {
+        return;   // a tap – LVGL handles it
+    }
+    emit(g);
+}
+
+void gestureSetHandler(GestureHandler h) {
+    handler = h;
+    state = GS_IDLE;
+}
+
+void gestureFeed(const TouchEvent& ev) {
+    if (!handler) return;
+
+    switch (state) {
+        case GS_IDLE:
+            if (ev.count == 0) break;
+            histHead = histCount = 0;
+            addSample(ev);
+            start = sampleAgo(0);
+            {
+                Gesture g = {GESTURE_DOWN, start.x, start.y, 0, 0, 0, 0, 100};
+                emit(g);
+            }
+            if (ev.count >= 2) beginPinch(ev);
+            else state = GS_TRACKING;
+            break;
+
+        case GS_TRACKING:
+            if (ev.count == 0) {
+                endTracking(ev);
+                state = GS_IDLE;
+            } else if (ev.count >= 2) {
+                beginPinch(ev);
+            } else {
+                addSample(ev);
+            }
+            break;
+
+        case GS_PINCH:
+            if (ev.count >= 2) {
+                uint16_t scale = (uint16_t)min<uint32_t>(pinchDistance(ev) * 100 / pinchStartDist, 1000);
+                if (abs((int)scale - (int)pinchReported) >= GESTURE_ZOOM_STEP_PCT) {
+                    Gesture g;
+                    fillPinch(g, ev, GESTURE_ZOOM);
+                    g.scale_pct = scale;
+                    pinchReported = scale;
+                    emit(g);
+                }
+                break;
+            }
+            {
+                Gesture g = {GESTURE_ZOOM_END, ev.pts[0].x, ev.pts[0].y, 0, 0, 0, 0, pinchReported};
+                emit(g);
+            }
+            state = ev.count ? GS_WAIT_LIFT : GS_IDLE;
+            break;
+
+        case GS_WAIT_LIFT:
+            if (ev.count == 0) state = GS_IDLE;
+            else if (ev.count >= 2) beginPinch(ev);
+            break;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <Arduino.h>
+#include "touch.h"
+
+// Gesture recognizer on top of the timestamped multi-point touch reports.
+//
+// A small state machine with fixed storage (no allocation): one finger is
+// tracked for swipes and flings, two fingers for pinch zoom. Velocity is
+// estimated from the IRQ timestamps of the last GESTURE_VELOCITY_MS of
+// movement, so it doesn't depend on how often LVGL happens to poll.
+// Recognized gestures go to a single handler, normally the active screen.
+
+#define GESTURE_HISTORY          8
+#define GESTURE_VELOCITY_MS      100   // window used for release velocity
+#define GESTURE_HOLD_MS          80    // finger still this long before lift = no fling
+#define GESTURE_SWIPE_MIN_PX     60
+#define GESTURE_FLING_MIN_PX_S   700
+#define GESTURE_ZOOM_STEP_PCT    8     // report pinch changes of at least this much
+
+enum GestureType : uint8_t {
+    GESTURE_DOWN,          // first finger down (stop kinetic motion)
+    GESTURE_SWIPE_LEFT,
+    GESTURE_SWIPE_RIGHT,
+    GESTURE_SWIPE_UP,
+    GESTURE_SWIPE_DOWN,
+    GESTURE_FLING,         // vx/vy hold the release velocity
+    GESTURE_ZOOM,          // scale_pct relative to the pinch start
+    GESTURE_ZOOM_END
+};
+
+struct Gesture {
+    GestureType type;
+    int16_t x, y;          // position (pinch: midpoint)
+    int16_t dx, dy;        // travel since the gesture started
+    int32_t vx, vy;        // px/s
+    uint16_t scale_pct;    // 100 = fingers as far apart as when the pinch began
+};
+
+typedef void (*GestureHandler)(const Gesture& g);
+
+// NULL disables recognition
+void gestureSetHandler(GestureHandler handler);
+
+// Called by the touch layer for every report, on the UI thread
+void gestureFeed(const TouchEvent& ev);
+
+#endif // GESTURE_H
@@ -0,0 +1,155 @@
+#include "hub_protocol.h"
+#include <string.h>
+
+static_assert(WAVE_FRAME_LEN <= DATA_FRAME_LEN && STREAM_FRAME_LEN <= DATA_FRAME_LEN &&
+              BP_FRAME_LEN <= DATA_FRAME_LEN,
+              "FrameDecoder buffers DATA_FRAME_LEN bytes");
+
+static uint8_t xorBytes(const uint8_t* p, size_t n) {
+    uint8_t x = 0;
+    while (n--) x ^= *p++;
+    return x;
+}
+
+size_t encodeDataFrame(const SensorData& d, uint8_t* out) {
+    out[0] = FRAME_DATA_START;
+    memcpy(out + 1, &d, sizeof(SensorData));
+    out[sizeof(SensorData) + 1] = xorBytes(out + 1, sizeof(SensorData));
+    out[sizeof(SensorData) + 2] = FRAME_END;
+    return DATA_FRAME_LEN;
+}
+
+size_t encodeStreamFrame(const StreamSample& s, uint8_t* out) {
+    out[0] = FRAME_STREAM_START;
+    out[1] = s.sensor;
+    memcpy(out + 2, &s.value, 4);
+    memcpy(out + 6, &s.timestamp, 4);
+    out[10] = xorBytes(out + 1, 9);
+    out[11] = FRAME_END;
+    return STREAM_FRAME_LEN;
+}
+
+size_t encodeWaveFrame(const WaveBatch& w, uint8_t* out) {
+    out[0] = FRAME_WAVE_START;
+    out[1] = w.rateHz;
+    memcpy(out + 2, &w.timestamp, 4);
+    memcpy(out + 6, w.samples, 2 * HUB_WAVE_BATCH);
+    out[WAVE_FRAME_LEN - 2] = xorBytes(out + 1, WAVE_FRAME_LEN - 3);
+    out[WAVE_FRAME_LEN - 1] = FRAME_END;
+    return WAVE_FRAME_LEN;
+}
+
+// Pressures go out in fixed point, clamped to the uint16 range
+static void putScaled(uint8_t* out, float v, float scale) {
+    float x = v * scale + 0.5f;
+    uint16_t u = x <= 0 ? 0 : x >= 65535.0f ? 65535 : (uint16_t)x;
+    memcpy(out, &u, 2);
+}
+
+static float getScaled(const uint8_t* in, float scale) {
+    uint16_t u;
+    memcpy(&u, in, 2);
+    return u / scale;
+}
+
+size_t encodeBpFrame(const BpReading& r, uint8_t* out) {
+    out[0] = FRAME_BP_START;
+    out[1] = r.phase;
+    putScaled(out + 2, r.cuffMmHg, 10.0f);
+    putScaled(out + 4, r.oscMmHg, 100.0f);
+    memcpy(out + 6, &r.sys, 2);
+    memcpy(out + 8, &r.dia, 2);
+    memcpy(out + 10, &r.map, 2);
+    memcpy(out + 12, &r.timestamp, 4);
+    out[16] = xorBytes(out + 1, 15);
+    out[17] = FRAME_END;
+    return BP_FRAME_LEN;
+}
+
+size_t encodeSubscribe(uint8_t mask, const uint8_t rates[HUB_SENSOR_COUNT], uint8_t* out) {
+    out[0] = CMD_SUBSCRIBE;
+    out[1] = mask;
+    memcpy(out + 2, rates, HUB_SENSOR_COUNT);
+    return SUBSCRIBE_CMD_LEN;
+}
+
+FrameDecoder::FrameDecoder() {
+    reset();
+}
+
+void FrameDecoder::reset() {
+    len = 0;
+    need = 0;
+    replayLen = 0;
+    goodFrames = 0;
+    badFrames = 0;
+}
+
+bool FrameDecoder::complete(HubFrame& frame) const {
+    if (buf[len - 1] != FRAME_END) return false;
+    if (buf[len - 2] != xorBytes(buf + 1, len - 3)) return false;
+
+    if (buf[0] == FRAME_DATA_START) {
+        frame.type = FRAME_DATA;
+        memcpy(&frame.data, buf + 1, sizeof(SensorData));
+    } else if (buf[0] == FRAME_WAVE_START) {
+        frame.type = FRAME_WAVE;
+        frame.wave.rateHz = buf[1];
+        memcpy(&frame.wave.timestamp, buf + 2, 4);
+        memcpy(frame.wave.samples, buf + 6, 2 * HUB_WAVE_BATCH);
+    } else if (buf[0] == FRAME_BP_START) {
+        frame.type = FRAME_BP;
+        frame.bp.phase = buf[1];
+        frame.bp.cuffMmHg = getScaled(buf + 2, 10.0f);
+        frame.bp.oscMmHg = getScaled(buf + 4, 100.0f);
+        memcpy(&frame.bp.sys, buf + 6, 2);
+        memcpy(&frame.bp.dia, buf + 8, 2);
+        memcpy(&frame.bp.map, buf + 10, 2);
+        memcpy(&frame.bp.timestamp, buf + 12, 4);
+    } else {
+        frame.type = FRAME_STREAM;
+        frame.sample.sensor = buf[1];
+        memcpy(&frame.sample.value, buf + 2, 4);
+        memcpy(&frame.sample.timestamp, buf + 6, 4);
+    }
+    return true;
+}
+
+void FrameDecoder::process(uint8_t byte, HubFrameHandler handler, void* ctx) {
+    if (len == 0) {
+        if (byte == FRAME_DATA_START) need = DATA_FRAME_LEN;
+        else if (byte == FRAME_STREAM_START) need = STREAM_FRAME_LEN;
+        else if (byte == FRAME_WAVE_START) need = WAVE_FRAME_LEN;
+        else if (byte == FRAME_BP_START) need = BP_FRAME_LEN;
+        else return;   // noise between frames
+    }
+    buf[len++] = byte;
+    if (len < need) return;
+
+    HubFrame frame;
+    if (complete(frame)) {
+        len = 0;
+        goodFrames++;
+        handler(frame, ctx);
+        return;
+    }
+
+    // Bad frame: everything after its start byte may still hold a frame
+    badFrames++;
+    uint8_t n = len - 1;
+    if (replayLen + n > sizeof(replay)) n = sizeof(replay) - replayLen;
+    memmove(replay + n, replay, replayLen);
+    memcpy(replay, buf + 1, n);
+    replayLen += n;
+    len = 0;
+}
+
+void FrameDecoder::push(uint8_t byte, HubFrameHandler handler, void* ctx) {
+    process(byte, handler, ctx);
+    while (replayLen > 0) {
+        uint8_t b = replay[0];
+        replayLen--;
+        memmove(replay, replay + 1, replayLen);
+        process(b, handler, ctx);
+    }
+}
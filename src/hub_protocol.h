@@ -0,0 +1,163 @@
+#ifndef HUB_PROTOCOL_H
+#define HUB_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Kiosk <-> sensor hub UART protocol. Shared by the firmware, the sensor
+// simulator and the host tools, so it has no Arduino dependencies.
+//
+// Kiosk -> hub: single command bytes, CMD_START_STREAM followed by a sensor
+// type byte, CMD_SUBSCRIBE followed by a sensor mask and one rate byte per
+// sensor. Stream frames name their sensor, so several subscribed channels
+// share the link without further framing. CMD_START_WAVE adds the raw pulse
+// waveform, HUB_WAVE_BATCH samples per frame, until CMD_STOP_STREAM; hubs
+// without a PPG front end ignore it. CMD_START_BP inflates the cuff for one
+// oscillometric reading, reported by BP frames every few hundred ms and a
+// last one with the result; hubs without a cuff ignore it.
+//
+// Hub -> kiosk:
+//   data frame    0xAA | SensorData | XOR of SensorData bytes | 0x55
+//   stream frame  0xCC | type | float value | uint32 timestamp | XOR of bytes 1..9 | 0x55
+//   wave frame    0xDD | rate Hz | uint32 timestamp of the first sample |
+//                 HUB_WAVE_BATCH x int16 sample | XOR of bytes 1..25 | 0x55
+//   bp frame      0xEE | phase | uint16 cuff 0.1 mmHg | uint16 oscillation 0.01 mmHg |
+//                 uint16 sys | uint16 dia | uint16 MAP | uint32 timestamp |
+//                 XOR of bytes 1..15 | 0x55
+
+#define CMD_MEASURE      0x01
+#define CMD_START_STREAM 0x05
+#define CMD_STOP_STREAM  0x06   // ends every stream and the waveform, vents the cuff
+#define CMD_SUBSCRIBE    0x07
+#define CMD_START_WAVE   0x08
+#define CMD_START_BP     0x09
+
+// Sensor type byte of CMD_START_STREAM and stream frames
+#define HUB_SENSOR_HEIGHT 1
+#define HUB_SENSOR_WEIGHT 2
+#define HUB_SENSOR_TEMP   3
+#define HUB_SENSOR_PULSE  4
+#define HUB_SENSOR_COUNT  4
+
+// CMD_SUBSCRIBE: bit (sensor - 1) of the mask selects a sensor; rate bytes
+// are Hz per sensor in HUB_SENSOR_* order, 0 = hub default
+#define HUB_SENSOR_BIT(sensor) (1 << ((sensor) - 1))
+#define SUBSCRIBE_CMD_LEN (2 + HUB_SENSOR_COUNT)
+
+// SensorData.sensor_status bits
+#define HUB_STATUS_HEIGHT 0x01
+#define HUB_STATUS_TEMP   0x02
+#define HUB_STATUS_HR     0x04
+#define HUB_STATUS_WEIGHT 0x08
+
+#define FRAME_DATA_START   0xAA
+#define FRAME_STREAM_START 0xCC
+#define FRAME_WAVE_START   0xDD
+#define FRAME_BP_START     0xEE
+#define FRAME_END          0x55
+
+// Packed struct – MUST match sensor hub!
+#pragma pack(push, 1)
+struct SensorData {
+  float distance_cm;
+  float height_cm;
+  float temperature_c;
+  float ambient_temp_c;
+  uint16_t heart_rate;
+  float weight_kg;
+  float bmi;
+  uint8_t sensor_status;
+  uint32_t timestamp;
+};
+#pragma pack(pop)
+
+#define DATA_FRAME_LEN   (sizeof(SensorData) + 3)
+#define STREAM_FRAME_LEN 12
+
+// Pulse waveform: PPG samples, systole positive, in ADC counts
+#define HUB_WAVE_BATCH   10
+#define WAVE_FRAME_LEN   (8 + 2 * HUB_WAVE_BATCH)
+
+// Blood pressure: phase byte of BP frames. Result fields are only set in
+// the BP_DONE frame; the cuff has been vented by then.
+#define BP_FRAME_LEN     18
+
+enum BpPhase : uint8_t {
+    BP_INFLATING = 1,
+    BP_DEFLATING,        // oscillations measured on the way down
+    BP_DONE,
+    BP_FAILED            // no usable oscillations, cuff leak or over-pressure
+};
+
+struct StreamSample {
+    uint8_t sensor;
+    float value;
+    uint32_t timestamp;
+};
+
+struct WaveBatch {
+    uint8_t rateHz;
+    uint32_t timestamp;    // hub clock of samples[0], ms
+    int16_t samples[HUB_WAVE_BATCH];
+};
+
+struct BpReading {
+    uint8_t phase;         // BpPhase
+    float cuffMmHg;
+    float oscMmHg;         // amplitude of the last pulse seen in the cuff
+    uint16_t sys, dia, map;
+    uint32_t timestamp;
+};
+
+enum FrameType : uint8_t {
+    FRAME_DATA,
+    FRAME_STREAM,
+    FRAME_WAVE,
+    FRAME_BP
+};
+
+struct HubFrame {
+    FrameType type;
+    SensorData data;       // FRAME_DATA
+    StreamSample sample;   // FRAME_STREAM
+    WaveBatch wave;        // FRAME_WAVE
+    BpReading bp;          // FRAME_BP
+};
+
+// Encoders write exactly DATA_FRAME_LEN / STREAM_FRAME_LEN / WAVE_FRAME_LEN /
+// BP_FRAME_LEN bytes
+size_t encodeDataFrame(const SensorData& d, uint8_t* out);
+size_t encodeStreamFrame(const StreamSample& s, uint8_t* out);
+size_t encodeWaveFrame(const WaveBatch& w, uint8_t* out);
+size_t encodeBpFrame(const BpReading& r, uint8_t* out);
+
+// Writes SUBSCRIBE_CMD_LEN bytes
+size_t encodeSubscribe(uint8_t mask, const uint8_t rates[HUB_SENSOR_COUNT], uint8_t* out);
+
+typedef void (*HubFrameHandler)(const HubFrame& frame, void* ctx);
+
+// Byte-at-a-time frame decoder. Frames are recognised by length, checksum
+// and terminator; after a bad frame the buffered bytes are rescanned for the
+// next start byte, so a start byte inside a payload or a corrupted frame
+// costs at most that frame, never the ones behind it.
+class FrameDecoder {
+public:
+    FrameDecoder();
+    void push(uint8_t byte, HubFrameHandler handler, void* ctx);
+    void reset();
+
+    uint32_t goodFrames;
+    uint32_t badFrames;
+
+private:
+    void process(uint8_t byte, HubFrameHandler handler, void* ctx);
+    bool complete(HubFrame& frame) const;
+
+    uint8_t buf[DATA_FRAME_LEN];      // the longest frame
+    uint8_t len;
+    uint8_t need;
+    uint8_t replay[DATA_FRAME_LEN];   // bytes to rescan after a bad frame
+    uint8_t replayLen;
+};
+
+#endif // HUB_PROTOCOL_H
@@ -0,0 +1,132 @@
+#include "journal.h"
+#include "record_codec.h"
+#include <Preferences.h>
+#include <rom/crc.h>
+
+#define JOURNAL_FLAG_OPEN 0x01
+
+struct JournalHeader {
+    uint32_t seq;
+    uint32_t crc;       // over flags, done mask and payload
+    uint16_t len;       // payload bytes
+    uint8_t flags;
+    uint8_t done;       // bit i = measurements_done[i]
+};
+
+struct JournalEntry {
+    JournalHeader hdr;
+    uint8_t payload[RECORD_BIN_MAX];
+};
+
+static Preferences prefs;
+static QueueHandle_t journalQueue = NULL;
+static uint32_t journalSeq = 0;
+
+static bool journalPaused = false;
+
+static JournalEntry recovered;
+static bool recoveredValid = false;
+
+static uint32_t entryCRC(const JournalEntry& e) {
+    uint32_t crc = crc32_le(0, &e.hdr.flags, 1);
+    crc = crc32_le(crc, &e.hdr.done, 1);
+    return crc32_le(crc, e.payload, e.hdr.len);
+}
+
+static void slotKey(uint32_t seq, char* key) {
+    key[0] = 's';
+    key[1] = '0' + (seq % JOURNAL_SLOTS);
+    key[2] = '\0';
+}
+
+static void journalTask(void*) {
+    JournalEntry entry;
+    while (true) {
+        if (xQueueReceive(journalQueue, &entry, portMAX_DELAY) != pdTRUE) continue;
+        char key[3];
+        slotKey(entry.hdr.seq, key);
+        size_t n = sizeof(JournalHeader) + entry.hdr.len;
+        if (prefs.putBytes(key, &entry, n) != n) {
+            Serial.println("✗ Journal write failed");
+        }
+    }
+}
+
+bool journalBegin() {
+    if (!prefs.begin(JOURNAL_NAMESPACE, false)) {
+        Serial.println("✗ Journal: NVS unavailable");
+        return false;
+    }
+
+    // Newest entry with a good CRC wins; older slots are history
+    JournalEntry e;
+    for (uint8_t i = 0; i < JOURNAL_SLOTS; i++) {
+        char key[3] = {'s', (char)('0' + i), '\0'};
+        size_t n = prefs.getBytes(key, &e, sizeof(e));
+        if (n < sizeof(JournalHeader) || n != sizeof(JournalHeader) + e.hdr.len) continue;
+        if (e.hdr.crc != entryCRC(e)) continue;
+        if (!recoveredValid || e.hdr.seq > recovered.hdr.seq) {
+            recovered = e;
+            recoveredValid = true;
+        }
+    }
+    if (recoveredValid) {
+        journalSeq = recovered.hdr.seq + 1;
+        if (!(recovered.hdr.flags & JOURNAL_FLAG_OPEN)) recoveredValid = false;
+    }
+
+    journalQueue = xQueueCreate(1, sizeof(JournalEntry));
+    xTaskCreatePinnedToCore(journalTask, "journal", 3072, NULL, 1, NULL, 0);
+    Serial.printf("✓ Journal ready (%s)\n", recoveredValid ? "unfinished session found" : "clean");
+    return true;
+}
+
+static void journalPost(JournalEntry& e) {
+    if (!journalQueue) return;
+    e.hdr.seq = journalSeq++;
+    e.hdr.crc = entryCRC(e);
+    // Only the latest state matters, so an unwritten older snapshot is replaced
+    xQueueOverwrite(journalQueue, &e);
+}
+
+void journalRecord(const HealthData& data, const bool done[5]) {
+    if (journalPaused) return;
+    static JournalEntry e;
+    size_t n = encodeBinary(data, e.payload, sizeof(e.payload));
+    if (n == 0) return;
+    e.hdr.len = n;
+    e.hdr.flags = JOURNAL_FLAG_OPEN;
+    e.hdr.done = 0;
+    for (uint8_t i = 0; i < 5; i++) {
+        if (done[i]) e.hdr.done |= (1 << i);
+    }
+    recoveredValid = false;   // this session replaces the one found at boot
+    journalPost(e);
+}
+
+void journalClear() {
+    if (journalPaused) return;
+    static JournalEntry e;
+    e.hdr.len = 0;
+    e.hdr.flags = 0;
+    e.hdr.done = 0;
+    recoveredValid = false;
+    journalPost(e);
+}
+
+void journalPause(bool paused) {
+    journalPaused = paused;
+}
+
+bool journalHasSession() {
+    return recoveredValid;
+}
+
+bool journalRestore(HealthData& data, bool done[5]) {
+    if (!recoveredValid) return false;
+    if (!decodeBinary(recovered.payload, recovered.hdr.len, data)) return false;
+    for (uint8_t i = 0; i < 5; i++) {
+        done[i] = (recovered.hdr.done & (1 << i)) != 0;
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <Arduino.h>
+#include "sensors.h"
+
+// Write-ahead journal for the checkup in progress. Every completed step
+// stores a snapshot of the session in NVS so a brown-out mid-checkup can be
+// resumed on the next boot.
+//
+// Snapshots rotate over JOURNAL_SLOTS keys (NVS itself is log-structured and
+// wear-levels its pages) and are written by a background task; callers on
+// the UI thread only encode into a queue slot and never wait on flash.
+
+#define JOURNAL_NAMESPACE "journal"
+#define JOURNAL_SLOTS 4
+
+// Call once at boot. Loads the newest valid snapshot and starts the writer.
+bool journalBegin();
+
+// Record the current session state (non-blocking; newest snapshot wins)
+void journalRecord(const HealthData& data, const bool done[5]);
+
+// Mark the session finished or discarded
+void journalClear();
+
+// While paused, journalRecord and journalClear are dropped and the last
+// snapshot stays as it was (the soak benchmark runs fake checkups)
+void journalPause(bool paused);
+
+// True if the last boot left an unfinished session behind and nothing has
+// been recorded or cleared since (a newer snapshot supersedes it)
+bool journalHasSession();
+
+// Copy the unfinished session out of the journal; false once superseded
+bool journalRestore(HealthData& data, bool done[5]);
+
+#endif // JOURNAL_H
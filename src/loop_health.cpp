@@ -0,0 +1,135 @@
+#include "loop_health.h"
+#include "console.h"
+#include <esp_task_wdt.h>
+
+static const char *const SITE_NAMES[LS_COUNT] = {
+    "idle", "lvgl", "input", "uart", "measure", "parallel", "console", "boot", "patients", "printer", "power"};
+
+static bool wdtOn = false;
+
+// Current iteration
+static bool iterOpen = false;
+static uint8_t curSite = LS_IDLE;
+static uint32_t iterStartUs, iterStartMs, markUs;
+static uint32_t nestedUs;               // blamed on nested sites since the last mark
+static uint32_t siteUs[LS_COUNT];
+
+// Since boot (or LOOP RESET)
+static uint32_t iterations;
+static uint64_t iterSumUs;
+static uint32_t iterWorstUs;
+static uint32_t siteWorstUs[LS_COUNT];
+static LoopStall worst;
+static LoopStall stalls[LOOP_STALL_RING];
+static uint8_t stallHead, stallCount;
+static uint32_t stallTotal;
+
+static void charge(uint32_t now) {
+    uint32_t seg = now - markUs;
+    siteUs[curSite] += seg > nestedUs ? seg - nestedUs : 0;
+    nestedUs = 0;
+    markUs = now;
+}
+
+void loopMark(LoopSite site) {
+    uint32_t now = micros();
+    if (!iterOpen) {
+        iterOpen = true;
+        iterStartUs = markUs = now;
+        iterStartMs = millis();
+        nestedUs = 0;
+        memset(siteUs, 0, sizeof(siteUs));
+    } else {
+        charge(now);
+    }
+    curSite = site;
+}
+
+void loopBlame(LoopSite site, uint32_t us) {
+    if (!iterOpen) return;
+    siteUs[site] += us;
+    nestedUs += us;
+}
+
+void loopEnd() {
+    if (wdtOn) esp_task_wdt_reset();
+    if (!iterOpen) return;
+    uint32_t now = micros();
+    charge(now);
+    iterOpen = false;
+    curSite = LS_IDLE;
+
+    uint32_t total = now - iterStartUs;
+    iterations++;
+    iterSumUs += total;
+    if (total > iterWorstUs) iterWorstUs = total;
+    uint8_t top = LS_IDLE;
+    for (uint8_t s = 0; s < LS_COUNT; s++) {
+        if (siteUs[s] > siteWorstUs[s]) siteWorstUs[s] = siteUs[s];
+        if (siteUs[s] > siteUs[top]) top = s;
+    }
+    if (total <= LOOP_STALL_MS * 1000UL) return;
+
+    LoopStall &st = stalls[stallHead];
+    st.atMs = iterStartMs;
+    st.totalUs = total;
+    st.siteUs = siteUs[top];
+    st.site = top;
+    stallHead = (stallHead + 1) % LOOP_STALL_RING;
+    if (stallCount < LOOP_STALL_RING) stallCount++;
+    stallTotal++;
+    if (total > worst.totalUs) worst = st;
+    Serial.printf("✗ Loop stall: %lu ms, %lu ms of it in %s\n", (unsigned long)(total / 1000),
+                  (unsigned long)(st.siteUs / 1000), SITE_NAMES[top]);
+}
+
+void loopFeed() {
+    if (wdtOn) esp_task_wdt_reset();
+}
+
+/* ==================== CONSOLE ==================== */
+// LOOP prints iteration timing, the worst time per site and the stall ring
+// (newest first); LOOP RESET clears them.
+static void cmdLoop(const char *args) {
+    if (strncasecmp(args, "RESET", 5) == 0) {
+        iterations = 0;
+        iterSumUs = 0;
+        iterWorstUs = 0;
+        memset(siteWorstUs, 0, sizeof(siteWorstUs));
+        memset(&worst, 0, sizeof(worst));
+        stallHead = stallCount = 0;
+        stallTotal = 0;
+        Serial.println("✓ LOOP: cleared");
+        return;
+    }
+    Serial.printf("Loop: %lu iterations, mean %lu us, worst %lu us, watchdog %s (%d s)\n",
+                  (unsigned long)iterations,
+                  iterations ? (unsigned long)(iterSumUs / iterations) : 0UL,
+                  (unsigned long)iterWorstUs, wdtOn ? "on" : "off", LOOP_WDT_TIMEOUT_S);
+    Serial.print("  worst per site (us):");
+    for (uint8_t s = 1; s < LS_COUNT; s++) {
+        Serial.printf(" %s %lu", SITE_NAMES[s], (unsigned long)siteWorstUs[s]);
+    }
+    Serial.println();
+    Serial.printf("  %lu stalls over %d ms", (unsigned long)stallTotal, LOOP_STALL_MS);
+    if (stallTotal) {
+        Serial.printf(", worst %lu ms at %lu ms in %s", (unsigned long)(worst.totalUs / 1000),
+                      (unsigned long)worst.atMs, SITE_NAMES[worst.site]);
+    }
+    Serial.println();
+    for (uint8_t i = 1; i <= stallCount; i++) {
+        const LoopStall &st = stalls[(stallHead + LOOP_STALL_RING - i) % LOOP_STALL_RING];
+        Serial.printf("  at %9lu ms: %6lu ms, %s %lu ms\n", (unsigned long)st.atMs,
+                      (unsigned long)(st.totalUs / 1000), SITE_NAMES[st.site],
+                      (unsigned long)(st.siteUs / 1000));
+    }
+}
+
+void loopHealthBegin() {
+    // Reconfigures the watchdog the core already runs (idle tasks) and adds
+    // the loop task to it
+    esp_task_wdt_init(LOOP_WDT_TIMEOUT_S, true);
+    wdtOn = esp_task_wdt_add(NULL) == ESP_OK;
+    Serial.println(wdtOn ? "✓ Loop watchdog armed" : "✗ Loop watchdog unavailable");
+    consoleRegister("LOOP", cmdLoop);
+}
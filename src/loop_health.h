@@ -0,0 +1,62 @@
+#ifndef LOOP_HEALTH_H
+#define LOOP_HEALTH_H
+
+#include <Arduino.h>
+
+// Loop-health monitor for the UI task.
+//
+// loop() marks each piece of work it does with loopMark(); the time up to
+// the next mark is charged to that call site. loopEnd() closes the
+// iteration: it feeds the task watchdog, and if the iteration took longer
+// than LOOP_STALL_MS it records a stall – when, how long, and the site
+// that took most of it – in a ring buffer readable with the LOOP console
+// command. Work that runs nested inside a site (an LVGL event callback
+// inside the LVGL handler) can claim its share with loopBlame(), so the
+// stall names the callback rather than the handler around it.
+//
+// The watchdog resets the kiosk only if one iteration hangs for
+// LOOP_WDT_TIMEOUT_S; known long operations (the 10 s printer scan) stay
+// under it and show up as stalls instead.
+
+#define LOOP_STALL_MS       50
+#define LOOP_STALL_RING     16
+#define LOOP_WDT_TIMEOUT_S  15
+
+// Most a touch-driven event callback may take; the input read timer logs
+// overruns, and SOAK and tools/toast_check hold the toast path to it
+#define UI_CALLBACK_BUDGET_MS 50
+
+enum LoopSite {
+    LS_IDLE,        // before the first mark / after loopEnd()
+    LS_LVGL,
+    LS_INPUT,       // touch-driven event callbacks (nested in LS_LVGL)
+    LS_UART,
+    LS_MEASURE,
+    LS_PARALLEL,
+    LS_CONSOLE,
+    LS_BOOT,
+    LS_PATIENTS,    // patient index catch-up scan
+    LS_PRINTER,
+    LS_POWER,
+    LS_COUNT
+};
+
+struct LoopStall {
+    uint32_t atMs;      // millis() when the iteration started
+    uint32_t totalUs;   // whole iteration
+    uint32_t siteUs;    // share of the blamed site
+    uint8_t site;       // LoopSite
+};
+
+// Subscribe the calling task to the watchdog. Call once from setup().
+void loopHealthBegin();
+
+void loopMark(LoopSite site);
+void loopBlame(LoopSite site, uint32_t us);
+void loopEnd();
+
+// For long operations that run inside one iteration on purpose (SOAK):
+// keeps the watchdog quiet without closing the iteration
+void loopFeed();
+
+#endif // LOOP_HEALTH_H
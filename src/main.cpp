@@ -5,6 +5,29 @@
 #include "display.h"
 #include "sensors.h"
 #include "printer.h"
+#include "record_codec.h"
+#include "journal.h"
+#include "console.h"
+#include "sync_export.h"
+#include "touch.h"
+#include "gesture.h"
+#include "storage.h"
+#include "hub_protocol.h"
+#include "simulator.h"
+#include "soak.h"
+#include "measure_flow.h"
+#include "parallel_capture.h"
+#include "stream_store.h"
+#include "calibration.h"
+#include "toast.h"
+#include "loop_health.h"
+#include "scheduler.h"
+#include "power.h"
+#include "sensor_table.h"
+#include "sensor_driver.h"
+#include "ppg.h"
+#include "bp_cuff.h"
+#include "patients.h"
 
 /* ==================== HARDWARE ==================== */
 TAMC_GT911 ts(TOUCH_GT911_SDA, TOUCH_GT911_SCL, TOUCH_GT911_INT, TOUCH_GT911_RST, 
@@ -17,34 +40,19 @@ Arduino_ESP32RGBPanel rgbpanel(
 Arduino_RGB_Display gfx(800, 480, &rgbpanel, 0, true);
 
 /* ==================== UART ==================== */
-#define UART_RX_PIN 18
-#define UART_TX_PIN 17
-#define UART_BAUD 115200
 HardwareSerial SerialUART(1);
 
-// Packed struct – MUST match sensor hub!
-#pragma pack(push, 1)
-struct SensorData {
-  float distance_cm;
-  float height_cm;
-  float temperature_c;
-  float ambient_temp_c;
-  uint16_t heart_rate;
-  float weight_kg;
-  float bmi;
-  uint8_t sensor_status;
-  uint32_t timestamp;
-};
-#pragma pack(pop)
-
 SensorData sensorData;
 bool dataReceived = false;
 unsigned long lastDataTime = 0;
 uint32_t packetCount = 0;
 
-uint8_t uartBuffer[sizeof(SensorData) + 4];
-uint8_t bufferIndex = 0;
-bool receivingPacket = false;
+FrameDecoder hubDecoder;
+
+// Simulated hub (console: SIM ON [scenario] | SIM OFF)
+SimEngine simHub;
+bool simHubActive = false;
+unsigned long simHubLastAdvance = 0;
 
 /* ==================== PATIENT DATA ==================== */
 HealthData healthData;
@@ -54,34 +62,33 @@ bool printerInitialized = false;
 bool printerConnected = false;
 bool printingInProgress = false;
 
-// Printer status on welcome screen
+// SD / printer status on welcome screen
+lv_obj_t *sd_status_label = NULL;
 lv_obj_t *printer_status_label = NULL;
 lv_obj_t *printer_connect_btn = NULL;
 
-// Measurement flags (5 sensors: 0=BP,1=Height,2=Weight,3=Temp,4=Pulse)
-bool measurements_done[5] = {false, false, false, false, false};
-
-// Results screen labels
-lv_obj_t *results_name, *results_age, *results_gender, *results_addr;
-lv_obj_t *results_bp, *results_height, *results_weight, *results_temp, *results_hr, *results_bmi, *results_bmi_cat;
 lv_obj_t *scr_bp;
 lv_obj_t *bp_sys_ta, *bp_dia_ta;
-
-// Ultrasonic mounting height (for simulation fallback)
-const float SENSOR_MOUNTING_HEIGHT = 250.0;
-
-/* ==================== STREAMING ==================== */
-bool receivingStream = false;
-uint8_t streamBuffer[16];
-uint8_t streamIndex = 0;
-float latestStreamValue = 0;
-int currentStreamSensor = 0;
-
-// Live labels for each sensor screen
-lv_obj_t* live_label_height = NULL;
-lv_obj_t* live_label_weight = NULL;
-lv_obj_t* live_label_temp = NULL;
-lv_obj_t* live_label_pulse = NULL;
+lv_obj_t *bp_start_lbl, *bp_status_lbl, *bp_bar, *bp_chart;
+lv_chart_series_t *bp_series;
+
+/* ==================== MEASUREMENT ==================== */
+// Hub streams, timeouts and completed steps (BP, Height, Weight, Temp, Pulse)
+MeasureFlow measureFlow;
+// All hub sensors at once on the dashboard (BP screen: MEASURE ALL)
+ParallelCapture parallelCapture;
+// Latest value and recent samples of every stream channel
+StreamStore streamStore;
+#define LIVE_REFRESH_MS 100   // live readouts are redrawn in one pass at this period
+// Pulse waveform of the sensor being measured, if its hub streams one
+PpgProcessor ppg;
+uint32_t waveArrivedMs = 0;
+#define WAVE_CHART_POINTS   250   // 2.5 s at the hub's 100 Hz
+#define WAVE_CAPTURE_QUALITY 80   // PPG heart rate replaces the hub's from here
+// Cuff run on the BP screen
+BpCuff bpCuff;
+#define BP_CHART_POINTS 200   // a whole deflation at the hub's 5 frames/s
+#define BP_BAR_MMHG     250
 
 /* ==================== LVGL CALLBACKS ==================== */
 uint32_t millis_cb(void) { return millis(); }
@@ -90,18 +97,7 @@ void my_disp_flush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
     gfx.draw16bitRGBBitmap(area->x1, area->y1, (uint16_t *)px_map,
                            lv_area_get_width(area), lv_area_get_height(area));
     lv_disp_flush_ready(disp);
-}
-
-void my_touchpad_read(lv_indev_t *indev, lv_indev_data_t *data) {
-    ts.read();
-    if (ts.isTouched) {
-        data->state = LV_INDEV_STATE_PRESSED;
-        int32_t tx = ts.points[0].x, ty = ts.points[0].y;
-        if (DISPLAY_ROTATION == 1) { int32_t tmp = tx; tx = ty; ty = 800 - tmp; }
-        data->point.x = tx; data->point.y = ty;
-    } else {
-        data->state = LV_INDEV_STATE_RELEASED;
-    }
+    touchNoteFlush();
 }
 
 /* ==================== GLOBAL KEYBOARD ==================== */
@@ -124,12 +120,43 @@ static void ta_event_cb(lv_event_t * e) {
 /* ==================== SCREEN GLOBALS ==================== */
 lv_obj_t *scr_welcome;
 lv_obj_t *scr_info;
-lv_obj_t *scr_height;
-lv_obj_t *scr_weight;
-lv_obj_t *scr_temp;
-lv_obj_t *scr_pulse;
 lv_obj_t *scr_results;
-lv_obj_t *scr_data_view;
+lv_obj_t *scr_data_view = NULL;
+lv_obj_t *scr_dashboard = NULL;
+lv_obj_t *scr_calibration = NULL;
+
+// Screens other than welcome are built on first navigation (see get_screen)
+enum ScreenId {
+    SCR_WELCOME,
+    SCR_INFO,
+    SCR_BP,
+    SCR_HEIGHT,
+    SCR_WEIGHT,
+    SCR_TEMP,
+    SCR_PULSE,
+    SCR_RESULTS,
+    SCR_DASHBOARD,
+    SCR_CALIBRATION
+};
+lv_obj_t *get_screen(ScreenId id);
+void update_results_screen();
+
+// Widgets of each hub sensor screen, indexed by HUB_SENSOR_*. Screens are
+// built once, so callbacks can point into this table.
+struct SensorScreen {
+    const SensorDescriptor *sensor;
+    lv_obj_t *screen;
+    ScreenId nextScreen;
+    lv_obj_t *resultLabel;
+    lv_obj_t *liveLabel;
+    lv_obj_t *waveChart;             // sensors with a waveform only
+    lv_chart_series_t *waveSeries;
+    lv_obj_t *waveLabel;
+    char waveText[48];
+    lv_obj_t *startButton;
+    lv_obj_t *captureButton;
+};
+SensorScreen sensorScreens[MEASURE_STEPS];
 
 // Patient info widgets
 lv_obj_t *name_ta;
@@ -137,110 +164,202 @@ lv_obj_t *age_ta;
 lv_obj_t *gender_dd;
 lv_obj_t *address_ta;
 
-/* ==================== COMMAND DEFINITIONS ==================== */
-#define CMD_MEASURE   0x01
-#define CMD_START_STREAM 0x05
-#define CMD_STOP_STREAM  0x06
-
 /* ==================== UART FUNCTIONS ==================== */
-bool parseUARTPacket() {
-  if (uartBuffer[0] != 0xAA || uartBuffer[sizeof(SensorData) + 2] != 0x55) return false;
-  uint8_t checksum = 0;
-  for (uint16_t i = 1; i <= sizeof(SensorData); i++) checksum ^= uartBuffer[i];
-  if (checksum != uartBuffer[sizeof(SensorData) + 1]) return false;
-  memcpy(&sensorData, &uartBuffer[1], sizeof(SensorData));
-  Serial.printf("📥 Data: H=%.1f T=%.1f HR=%d W=%.1f BMI=%.1f ST=0x%02X\n",
-                sensorData.height_cm, sensorData.temperature_c, sensorData.heart_rate,
-                sensorData.weight_kg, sensorData.bmi, sensorData.sensor_status);
-  return true;
-}
-
 void updateLiveLabel(int sensorType, float value) {
-    lv_obj_t* target = NULL;
-    switch (sensorType) {
-        case 1: target = live_label_height; break;
-        case 2: target = live_label_weight; break;
-        case 3: target = live_label_temp; break;
-        case 4: target = live_label_pulse; break;
-    }
+    if (sensorType < HUB_SENSOR_HEIGHT || sensorType > HUB_SENSOR_PULSE) return;
+    lv_obj_t* target = sensorScreens[sensorType].liveLabel;
     if (target && lv_obj_is_valid(target)) {
         char buf[32];
-        if (sensorType == 4)
-            lv_label_set_text_fmt(target, "Live: %d BPM", (int)value);
-        else {
-            const char* unit = (sensorType==1?"cm":(sensorType==2?"kg":"°C"));
-            dtostrf(value, 5, 1, buf);
-            lv_label_set_text_fmt(target, "Live: %s %s", buf, unit);
-        }
+        sensorFormat(sensorDescriptor(sensorType), value, buf, sizeof(buf));
+        lv_label_set_text_fmt(target, "Live: %s", buf);
     }
 }
 
+// Sensor being calibrated; its raw stream only feeds streamStore
+uint8_t calStreamSensor = 0;
+
+void onHubFrame(const HubFrame &frame, void *ctx) {
+  if (frame.type == FRAME_DATA) {
+    sensorData = frame.data;
+    calApplyFrame(sensorData);
+    Serial.printf("📥 Data: H=%.1f T=%.1f HR=%d W=%.1f BMI=%.1f ST=0x%02X\n",
+                  sensorData.height_cm, sensorData.temperature_c, sensorData.heart_rate,
+                  sensorData.weight_kg, sensorData.bmi, sensorData.sensor_status);
+    dataReceived = true;
+    lastDataTime = millis();
+    packetCount++;
+    // The dashboard keeps its own readings until they are stable
+    if (parallelCapture.feed(sensorData, millis())) return;
+    healthData.height = sensorData.height_cm;
+    healthData.temperature = sensorData.temperature_c;
+    healthData.heart_rate = sensorData.heart_rate;
+    healthData.weight = sensorData.weight_kg;
+    healthData.bmi = sensorData.bmi;
+    healthData.height_measured = (sensorData.sensor_status & HUB_STATUS_HEIGHT) != 0;
+    healthData.temp_measured    = (sensorData.sensor_status & HUB_STATUS_TEMP) != 0;
+    healthData.hr_measured      = (sensorData.sensor_status & HUB_STATUS_HR) != 0;
+    healthData.weight_measured  = (sensorData.sensor_status & HUB_STATUS_WEIGHT) != 0;
+  } else if (frame.type == FRAME_WAVE) {
+    ppg.push(frame.wave);   // drawn by live_refresh_cb
+    waveArrivedMs = millis();
+  } else if (frame.type == FRAME_BP) {
+    bpCuff.frame(frame.bp, millis());   // drawn by live_refresh_cb
+  } else {
+    StreamSample sample = frame.sample;
+    sample.value = calApply(sample.sensor, sample.value);
+    streamStore.push(sample, millis());
+    if (calStreamSensor) return;
+    if (!parallelCapture.feedSample(sample.sensor, sample.value, millis())) {
+      measureFlow.sample(sample.sensor, sample.value, millis());
+    }
+  }
+}
+
+static void simHubSink(const uint8_t *bytes, size_t len, void *ctx) {
+  for (size_t i = 0; i < len; i++) hubDecoder.push(bytes[i], onHubFrame, NULL);
+}
+
 void processUART() {
   while (SerialUART.available()) {
-    uint8_t byte = SerialUART.read();
-    if (byte == 0xAA) {
-      receivingPacket = true;
-      bufferIndex = 0;
-      uartBuffer[bufferIndex++] = byte;
-    } else if (receivingPacket) {
-      uartBuffer[bufferIndex++] = byte;
-      if (bufferIndex >= sizeof(SensorData) + 3) {
-        receivingPacket = false;
-        if (parseUARTPacket()) {
-          dataReceived = true;
-          lastDataTime = millis();
-          packetCount++;
-          healthData.height = sensorData.height_cm;
-          healthData.temperature = sensorData.temperature_c;
-          healthData.heart_rate = sensorData.heart_rate;
-          healthData.weight = sensorData.weight_kg;
-          healthData.bmi = sensorData.bmi;
-          healthData.height_measured = (sensorData.sensor_status & 0x01) != 0;
-          healthData.temp_measured    = (sensorData.sensor_status & 0x02) != 0;
-          healthData.hr_measured      = (sensorData.sensor_status & 0x04) != 0;
-          healthData.weight_measured  = (sensorData.sensor_status & 0x08) != 0;
-        }
-      }
-    } else if (byte == 0xCC) {
-      // Start of stream packet
-      receivingStream = true;
-      streamIndex = 0;
-      streamBuffer[streamIndex++] = byte;
-    } else if (receivingStream) {
-      streamBuffer[streamIndex++] = byte;
-      if (streamIndex >= 12) { // 1+1+4+4+1+1 = 12 bytes
-        receivingStream = false;
-        uint8_t checksum = 0;
-        for (int i = 1; i < 10; i++) checksum ^= streamBuffer[i];
-        if (checksum == streamBuffer[10] && streamBuffer[11] == 0x55) {
-          uint8_t sensorType = streamBuffer[1];
-          float val;
-          memcpy(&val, &streamBuffer[2], 4);
-          latestStreamValue = val;
-          currentStreamSensor = sensorType;
-          updateLiveLabel(sensorType, val);
-        }
-      }
-    }
+    hubDecoder.push(SerialUART.read(), onHubFrame, NULL);
+  }
+  if (simHubActive) {
+    unsigned long now = millis();
+    simHub.advance(now - simHubLastAdvance, simHubSink, NULL);
+    simHubLastAdvance = now;
   }
+  driversPoll(millis(), onHubFrame, NULL);
+}
+
+// Sensors on other drivers are taken out of the command first; the rest
+// goes to the simulator instead of the UART while it is active
+void hubWrite(const uint8_t *bytes, size_t len) {
+  uint8_t cmd[DRIVER_ROUTE_MAX];
+  len = driversRoute(bytes, len, cmd);
+  if (len == 0) return;
+  if (simHubActive) simHub.command(cmd, len);
+  else SerialUART.write(cmd, len);
 }
 
 void sendMeasureCommand() {
   uint8_t cmd = CMD_MEASURE;
-  SerialUART.write(cmd);
+  hubWrite(&cmd, 1);
   Serial.println("📤 Sent CMD_MEASURE");
 }
 
-void sendStartStreamCommand(int sensorType) {
-  uint8_t cmd[2] = {CMD_START_STREAM, (uint8_t)sensorType};
-  SerialUART.write(cmd, 2);
-  Serial.printf("📤 Sent START_STREAM for sensor %d\n", sensorType);
+// Stream commands come from measureFlow; a sensor with a waveform gets it
+// streamed along for its screen's chart
+void wave_reset();
+
+static void measureSend(const uint8_t *bytes, size_t len, void *ctx) {
+  hubWrite(bytes, len);
+  if (bytes[0] == CMD_START_STREAM) {
+    Serial.printf("📤 Sent START_STREAM for sensor %d\n", bytes[1]);
+    const SensorDescriptor &s = sensorDescriptor(bytes[1]);
+    if (s.id == bytes[1] && s.waveform) {
+      uint8_t wave = CMD_START_WAVE;
+      hubWrite(&wave, 1);
+      wave_reset();
+    }
+  } else if (bytes[0] == CMD_STOP_STREAM) {
+    Serial.println("📤 Sent STOP_STREAM");
+  }
+}
+
+// SIM ON [name] loads /scenarios/<name>.sim from SD (built-in default
+// otherwise); SIM OFF returns to the real hub; SIM prints counters.
+static void cmdSim(const char *args) {
+  if (strncasecmp(args, "ON", 2) == 0) {
+    SimScenario scenario;
+    const char *name = args + 2;
+    while (*name == ' ') name++;
+    if (*name == '\0') {
+      simDefaultScenario(scenario);
+    } else {
+      char path[48];
+      snprintf(path, sizeof(path), "/scenarios/%s.sim", name);
+      File f = sdCardInitialized ? SD.open(path, FILE_READ) : File();
+      if (!f) {
+        Serial.printf("✗ SIM: cannot open %s\n", path);
+        return;
+      }
+      static char text[SIM_SCENARIO_TEXT_MAX];
+      size_t n = f.read((uint8_t *)text, sizeof(text) - 1);
+      f.close();
+      text[n] = '\0';
+      int errLine = 0;
+      if (!simParseScenario(text, scenario, &errLine)) {
+        Serial.printf("✗ SIM: %s line %d not understood\n", path, errLine);
+        return;
+      }
+    }
+    measureFlow.cancel(millis());   // STOP goes out on the link that is streaming
+    simHub.begin(scenario);
+    simHubLastAdvance = millis();
+    hubDecoder.reset();
+    simHubActive = true;
+    Serial.printf("✓ SIM: hub simulated, scenario '%s' seed %lu\n",
+                  scenario.name, (unsigned long)scenario.seed);
+    return;
+  }
+  if (strcasecmp(args, "OFF") == 0) {
+    measureFlow.cancel(millis());
+    simHubActive = false;
+    hubDecoder.reset();
+    Serial.println("✓ SIM: real hub");
+    return;
+  }
+  Serial.printf("SIM: %s, t=%lu ms, sent %lu, dropped %lu, decoded %lu, bad %lu\n",
+                simHubActive ? "on" : "off", (unsigned long)simHub.now(),
+                (unsigned long)simHub.framesSent, (unsigned long)simHub.framesDropped,
+                (unsigned long)hubDecoder.goodFrames, (unsigned long)hubDecoder.badFrames);
+}
+
+// STREAMS: per-channel sample counts, measured rate and latest value
+static void cmdStreams(const char *args) {
+  for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+    const StreamChannel &c = streamStore.channel(sensorDescriptor(s).streamId);
+    Serial.printf("  %-7s %8lu samples, %5.1f Hz, latest %.2f, %lu ms ago\n", sensorDescriptor(s).key,
+                  (unsigned long)c.total, streamStore.rateHz(sensorDescriptor(s).streamId), c.latest,
+                  c.total ? (unsigned long)(millis() - c.arrivedMs) : 0UL);
+  }
+  Serial.printf("  parallel: %s, %s, %lu samples, %lu polls\n",
+                parallelCapture.active() ? "running" : "idle",
+                parallelCapture.mode() == PM_STREAM ? "stream" : "poll",
+                (unsigned long)parallelCapture.samples, (unsigned long)parallelCapture.polls);
+}
+
+static void printConfigLine(const char *line, void *ctx) {
+  Serial.printf("  %s\n", line);
 }
 
-void sendStopStreamCommand() {
-  uint8_t cmd = CMD_STOP_STREAM;
-  SerialUART.write(&cmd, 1);
-  Serial.println("📤 Sent STOP_STREAM");
+// CONFIG prints the running sensor configuration; CONFIG RELOAD re-reads
+// the SD file (else the NVS copy) without a reboot; CONFIG RESET returns to
+// the compiled-in defaults.
+static void cmdConfig(const char *args) {
+  if (strncasecmp(args, "RELOAD", 6) == 0) {
+    if (!(sdCardInitialized && configLoadSD())) configBegin();
+  } else if (strncasecmp(args, "RESET", 5) == 0) {
+    configReset();
+    Serial.println("✓ CONFIG: defaults");
+  }
+  const ConfigSnapshot &snap = configSnapshot();
+  Serial.printf("  # from %s, generation %lu\n", configSourceName(snap.source),
+                (unsigned long)snap.generation);
+  configFormat(snap.cfg, printConfigLine, NULL);
+}
+
+// CAL lists the stored curves; CAL RESET <1-4> returns one sensor to identity
+static void cmdCal(const char *args) {
+  if (strncasecmp(args, "RESET", 5) == 0) {
+    int sensor = atoi(args + 5);
+    Serial.println(calReset(sensor) ? "✓ CAL: reset" : "✗ CAL: sensor 1-4");
+    return;
+  }
+  for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+    const CalCurve &c = calCurve(s);
+    Serial.printf("  sensor %u: %.4g + %.6g x + %.3g x²\n", s, c.c[0], c.c[1], c.c[2]);
+  }
 }
 
 /* ==================== NAVIGATION ==================== */
@@ -248,6 +367,10 @@ void switch_scr(lv_obj_t *new_scr) {
     lv_screen_load_anim(new_scr, LV_SCR_LOAD_ANIM_MOVE_LEFT, 300, 0, false);
 }
 
+void switch_scr(ScreenId id) {
+    switch_scr(get_screen(id));
+}
+
 /* ==================== BMI UTILITIES ==================== */
 String getBMICategory(float bmi) {
   if (bmi < 18.5) return "Underweight";
@@ -264,21 +387,20 @@ lv_color_t getBMIColor(float bmi) {
 }
 
 /* ==================== CREATE SENSOR SCREEN (generic) ==================== */
-lv_obj_t* create_sensor_scr(const char* title, const char* icon, const char* instr,
-                            lv_obj_t* next_scr, int sensorType) {
+lv_obj_t* create_sensor_scr(const SensorDescriptor &sensor, ScreenId next_scr) {
     lv_obj_t* scr = lv_obj_create(NULL);
     lv_obj_set_style_bg_color(scr, lv_color_hex(0x0F172A), 0);
 
     // Title
     lv_obj_t* h = lv_label_create(scr);
-    lv_label_set_text(h, title);
+    lv_label_set_text(h, sensor.title);
     lv_obj_set_style_text_font(h, &lv_font_montserrat_24, 0);
     lv_obj_set_style_text_color(h, lv_color_hex(0x3B82F6), 0);
     lv_obj_align(h, LV_ALIGN_TOP_MID, 0, 40);
 
     // Icon
     lv_obj_t* icon_label = lv_label_create(scr);
-    lv_label_set_text(icon_label, icon);
+    lv_label_set_text(icon_label, sensor.icon);
     lv_obj_set_style_text_font(icon_label, &lv_font_montserrat_14, 0);
     lv_obj_align(icon_label, LV_ALIGN_CENTER, 0, -50);
 
@@ -288,7 +410,7 @@ lv_obj_t* create_sensor_scr(const char* title, const char* icon, const char* ins
     lv_obj_align(box, LV_ALIGN_CENTER, 0, 30);
     lv_obj_set_style_bg_color(box, lv_color_hex(0xFFFFFF), 0);
     lv_obj_t* i = lv_label_create(box);
-    lv_label_set_text(i, instr);
+    lv_label_set_text(i, sensor.instruction);
     lv_obj_set_style_text_font(i, &lv_font_montserrat_24, 0);
     lv_obj_set_style_text_align(i, LV_TEXT_ALIGN_CENTER, 0);
     lv_obj_center(i);
@@ -320,6 +442,34 @@ lv_obj_t* create_sensor_scr(const char* title, const char* icon, const char* ins
     lv_obj_align_to(progress_text, pb, LV_ALIGN_OUT_TOP_MID, 0, -10);
     lv_obj_add_flag(progress_text, LV_OBJ_FLAG_HIDDEN);
 
+    // Pulse waveform, for sensors whose hub streams one
+    lv_obj_t* wave_chart = NULL;
+    lv_chart_series_t* wave_series = NULL;
+    lv_obj_t* wave_label = NULL;
+    if (sensor.waveform) {
+        wave_chart = lv_chart_create(scr);
+        lv_obj_set_size(wave_chart, 440, 90);
+        lv_obj_align(wave_chart, LV_ALIGN_CENTER, 0, 150);
+        lv_chart_set_type(wave_chart, LV_CHART_TYPE_LINE);
+        lv_chart_set_point_count(wave_chart, WAVE_CHART_POINTS);
+        // Circular: a new point overwrites the oldest and invalidates only its column
+        lv_chart_set_update_mode(wave_chart, LV_CHART_UPDATE_MODE_CIRCULAR);
+        lv_chart_set_range(wave_chart, LV_CHART_AXIS_PRIMARY_Y, 0, PPG_DISPLAY_RANGE);
+        lv_chart_set_div_line_count(wave_chart, 0, 0);
+        lv_obj_set_style_bg_color(wave_chart, lv_color_hex(0x1E293B), 0);
+        lv_obj_set_style_border_width(wave_chart, 0, 0);
+        lv_obj_set_style_size(wave_chart, 0, 0, LV_PART_INDICATOR);   // no point markers
+        lv_obj_set_style_line_width(wave_chart, 2, LV_PART_ITEMS);
+        wave_series = lv_chart_add_series(wave_chart, lv_color_hex(0xEF4444), LV_CHART_AXIS_PRIMARY_Y);
+        lv_chart_set_all_value(wave_chart, wave_series, LV_CHART_POINT_NONE);
+
+        wave_label = lv_label_create(scr);
+        lv_label_set_text(wave_label, "PPG: --");
+        lv_obj_set_style_text_font(wave_label, &lv_font_montserrat_16, 0);
+        lv_obj_set_style_text_color(wave_label, lv_color_hex(0x94A3B8), 0);
+        lv_obj_align_to(wave_label, wave_chart, LV_ALIGN_OUT_BOTTOM_MID, 0, 4);
+    }
+
     // Start button
     lv_obj_t* start_btn = lv_btn_create(scr);
     lv_obj_set_size(start_btn, 250, 60);
@@ -341,97 +491,153 @@ lv_obj_t* create_sensor_scr(const char* title, const char* icon, const char* ins
     lv_obj_center(capture_lbl);
     lv_obj_add_flag(capture_btn, LV_OBJ_FLAG_HIDDEN);
 
-    // Store live label globally
-    if (sensorType == 1) live_label_height = live_label;
-    else if (sensorType == 2) live_label_weight = live_label;
-    else if (sensorType == 3) live_label_temp = live_label;
-    else if (sensorType == 4) live_label_pulse = live_label;
-
-    struct SensorScreenData {
-        int sensorType;
-        lv_obj_t* resultLabel;
-        lv_obj_t* liveLabel;
-        lv_obj_t* progressBar;
-        lv_obj_t* progressText;
-        lv_obj_t* nextScreen;
-        lv_obj_t* startButton;
-        lv_obj_t* captureButton;
-        bool* measurementFlag;
-    };
-
-    SensorScreenData* data = new SensorScreenData{
-        sensorType,
-        result_label,
-        live_label,
-        pb,
-        progress_text,
-        next_scr,
-        start_btn,
-        capture_btn,
-        &measurements_done[sensorType]
-    };
+    SensorScreen* data = &sensorScreens[sensor.id];
+    data->sensor = &sensor;
+    data->screen = scr;
+    data->nextScreen = next_scr;
+    data->resultLabel = result_label;
+    data->liveLabel = live_label;
+    data->startButton = start_btn;
+    data->captureButton = capture_btn;
+    data->waveChart = wave_chart;
+    data->waveSeries = wave_series;
+    data->waveLabel = wave_label;
+    data->waveText[0] = '\0';
 
     // Start button event
     lv_obj_add_event_cb(start_btn, [](lv_event_t* e) {
-        auto* d = (SensorScreenData*)lv_event_get_user_data(e);
-if (*(d->measurementFlag)) {
-    // Already measured: go to next screen
-    if (d->nextScreen == scr_results) {
-        show_report();   // updates and loads results
-    } else {
-        switch_scr(d->nextScreen);
-    }
-    return;
-}
+        auto* d = (SensorScreen*)lv_event_get_user_data(e);
+        if (measureFlow.isDone(d->sensor->id)) {
+            // Already measured: go to next screen
+            if (d->nextScreen == SCR_RESULTS) {
+                show_report();   // updates and loads results
+            } else {
+                switch_scr(d->nextScreen);
+            }
+            return;
+        }
         // Disable start button, show capture
         lv_obj_add_state(d->startButton, LV_STATE_DISABLED);
         lv_obj_clear_flag(d->captureButton, LV_OBJ_FLAG_HIDDEN);
         lv_label_set_text(d->resultLabel, "Position yourself...");
         lv_obj_set_style_text_color(d->resultLabel, lv_color_hex(0xF59E0B), 0);
-        // Send start stream command
-        sendStartStreamCommand(d->sensorType);
+        measureFlow.start(d->sensor->id, millis());
     }, LV_EVENT_CLICKED, data);
 
-    // Capture button event
-    lv_obj_add_event_cb(capture_btn, [](lv_event_t* e) {
-        auto* d = (SensorScreenData*)lv_event_get_user_data(e);
-        // Send stop stream command
-        sendStopStreamCommand();
-        // Store the latest value
-        float captured = latestStreamValue;
-        if (captured <= 0) captured = 0; // fallback
-        switch (d->sensorType) {
-            case 1: healthData.height = captured; healthData.height_measured = true; break;
-            case 2: healthData.weight = captured; healthData.weight_measured = true; if (healthData.height > 0) {
+    // Capture button event; the result arrives in onMeasureUpdate
+    lv_obj_add_event_cb(capture_btn, [](lv_event_t*) {
+        measureFlow.capture(millis());
+    }, LV_EVENT_CLICKED, NULL);
+
+    // However the screen is left, its stream stops
+    lv_obj_add_event_cb(scr, [](lv_event_t*) {
+        measureFlow.cancel(millis());
+    }, LV_EVENT_SCREEN_UNLOAD_START, NULL);
+
+    return scr;
+}
+
+// A new waveform stream: forget the last one's beats and trace
+void wave_reset() {
+    ppg.reset();
+    for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+        SensorScreen &d = sensorScreens[s];
+        if (!d.waveChart) continue;
+        lv_chart_set_all_value(d.waveChart, d.waveSeries, LV_CHART_POINT_NONE);
+        lv_label_set_text(d.waveLabel, "PPG: --");
+        d.waveText[0] = '\0';
+    }
+}
+
+// New waveform points and estimates onto the screen showing them (from
+// live_refresh_cb)
+static void wave_refresh() {
+    lv_obj_t *active = lv_scr_act();
+    for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+        SensorScreen &d = sensorScreens[s];
+        if (!d.waveChart || d.screen != active) continue;
+        int16_t points[PPG_DISPLAY_RING];
+        size_t n = ppg.drain(points, PPG_DISPLAY_RING);
+        for (size_t i = 0; i < n; i++) lv_chart_set_next_value(d.waveChart, d.waveSeries, points[i]);
+
+        char text[sizeof(d.waveText)];
+        PpgStats p = ppg.stats();
+        if (p.bpm) snprintf(text, sizeof(text), "PPG: %u BPM, HRV %u ms, signal %u%%", p.bpm, p.rmssdMs, p.quality);
+        else snprintf(text, sizeof(text), "PPG: --");
+        if (strcmp(text, d.waveText) == 0) continue;
+        memcpy(d.waveText, text, sizeof(text));
+        lv_label_set_text(d.waveLabel, text);
+    }
+}
+
+// The on-device estimate wins over the hub's figure while the waveform is
+// live and clean
+static float wave_capture_value(uint8_t sensor, float hubValue) {
+    if (!sensorDescriptor(sensor).waveform || millis() - waveArrivedMs > PPG_LOST_MS) return hubValue;
+    PpgStats p = ppg.stats();
+    if (!p.bpm || p.quality < WAVE_CAPTURE_QUALITY) return hubValue;
+    Serial.printf("PPG: %u BPM (hub %.0f), signal %u%%\n", p.bpm, hubValue, p.quality);
+    return p.bpm;
+}
+
+// Store a captured value in the checkup
+static void apply_capture(uint8_t sensorType, float captured) {
+    const SensorDescriptor &s = sensorDescriptor(sensorType);
+    if (!sensorPlausible(s, captured)) captured = 0; // fallback
+    s.store(healthData, captured);
+    healthData.*s.measured = true;
+    if (s.cls == SC_BODY && healthData.height > 0 && healthData.weight > 0)
         healthData.bmi = calculateBMI(healthData.weight, healthData.height);
-    } break;
-            case 3: healthData.temperature = captured; healthData.temp_measured = true; break;
-            case 4: healthData.heart_rate = (int)captured; healthData.hr_measured = true; break;
-        }
-        // Update result label
-        char buf[32];
-        if (captured > 0) {
-            if (d->sensorType == 4)
-                lv_label_set_text_fmt(d->resultLabel, "Heart Rate: %d BPM", (int)captured);
-            else {
-                const char* unit = (d->sensorType==1?"cm":(d->sensorType==2?"kg":"°C"));
-                dtostrf(captured, 5, 1, buf);
-                lv_label_set_text_fmt(d->resultLabel, "%s: %s %s",
-                    (d->sensorType==1?"Height":(d->sensorType==2?"Weight":"Temp")), buf, unit);
+    journalRecord(healthData, measureFlow.doneFlags());
+    update_results_screen();
+}
+
+static void show_sensor_message(SensorScreen &s, const char *text, uint32_t color) {
+    lv_label_set_text(s.resultLabel, text);
+    lv_obj_set_style_text_color(s.resultLabel, lv_color_hex(color), 0);
+}
+
+void onMeasureUpdate(const MeasureUpdate &u, void *ctx) {
+    if (u.sensor < HUB_SENSOR_HEIGHT || u.sensor > HUB_SENSOR_PULSE) return;
+    float value = u.value;
+    if (u.kind == MU_CAPTURED) {
+        value = wave_capture_value(u.sensor, value);
+        apply_capture(u.sensor, value);
+    }
+    SensorScreen &d = sensorScreens[u.sensor];
+    if (!d.resultLabel) return;   // screen not built yet
+
+    switch (u.kind) {
+        case MU_LIVE:
+            return;   // drawn by live_refresh_cb
+        case MU_RETRY:
+            show_sensor_message(d, "Waiting for sensor...", 0xF59E0B);
+            return;
+        case MU_CAPTURED: {
+            // Update result label
+            char buf[32];
+            if (sensorPlausible(*d.sensor, value)) {
+                sensorFormat(*d.sensor, value, buf, sizeof(buf));
+                lv_label_set_text_fmt(d.resultLabel, "%s: %s", d.sensor->label, buf);
+                lv_obj_set_style_text_color(d.resultLabel, lv_color_hex(0x10B981), 0);
+            } else {
+                show_sensor_message(d, "No reading, try again", 0xEF4444);
             }
-            lv_obj_set_style_text_color(d->resultLabel, lv_color_hex(0x10B981), 0);
-        } else {
-            lv_label_set_text(d->resultLabel, "No reading, try again");
-            lv_obj_set_style_text_color(d->resultLabel, lv_color_hex(0xEF4444), 0);
+            break;
         }
-        // Hide capture, show continue on start button
-        lv_obj_add_flag(d->captureButton, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_clear_state(d->startButton, LV_STATE_DISABLED);
-        lv_label_set_text(lv_obj_get_child(d->startButton, 0), "CONTINUE");
-        *(d->measurementFlag) = true;
-    }, LV_EVENT_CLICKED, data);
-
-    return scr;
+        case MU_NO_READING: show_sensor_message(d, "No reading, try again", 0xEF4444); break;
+        case MU_NO_DATA:    show_sensor_message(d, "Sensor not responding", 0xEF4444); break;
+        case MU_EXPIRED:    show_sensor_message(d, "Timed out, press START", 0xEF4444); break;
+        case MU_STOPPED:
+            show_sensor_message(d, "Ready for measurement", 0x94A3B8);
+            lv_label_set_text(d.liveLabel, "Live: --");
+            break;
+    }
+    // Stream is over: hide capture, START again (CONTINUE once measured)
+    lv_obj_add_flag(d.captureButton, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_clear_state(d.startButton, LV_STATE_DISABLED);
+    lv_label_set_text(lv_obj_get_child(d.startButton, 0),
+                      measureFlow.isDone(d.sensor->id) ? "CONTINUE" : "START");
 }
 
 /* ==================== WELCOME SCREEN ==================== */
@@ -446,17 +652,12 @@ void create_welcome_screen() {
     lv_obj_set_style_text_color(t, lv_color_hex(0xFFFFFF), 0);
     lv_obj_align(t, LV_ALIGN_CENTER, 0, -120);
 
-    // SD Card status
-    lv_obj_t *sd_status = lv_label_create(scr_welcome);
-    if (sdCardInitialized) {
-        lv_label_set_text(sd_status, "SD Card: Ready");
-        lv_obj_set_style_text_color(sd_status, lv_color_hex(0x10B981), 0);
-    } else {
-        lv_label_set_text(sd_status, "SD Card: Not Found");
-        lv_obj_set_style_text_color(sd_status, lv_color_hex(0xEF4444), 0);
-    }
-    lv_obj_set_style_text_font(sd_status, &lv_font_montserrat_18, 0);
-    lv_obj_align(sd_status, LV_ALIGN_CENTER, 0, -60);
+    // SD Card status (filled in once the boot worker has probed the card)
+    sd_status_label = lv_label_create(scr_welcome);
+    lv_label_set_text(sd_status_label, "SD Card: Checking...");
+    lv_obj_set_style_text_color(sd_status_label, lv_color_hex(0x94A3B8), 0);
+    lv_obj_set_style_text_font(sd_status_label, &lv_font_montserrat_18, 0);
+    lv_obj_align(sd_status_label, LV_ALIGN_CENTER, 0, -60);
 
     // Printer status + connect button
     lv_obj_t *printer_row = lv_obj_create(scr_welcome);
@@ -505,8 +706,8 @@ void create_welcome_screen() {
     lv_obj_set_style_text_font(btn_label, &lv_font_montserrat_18, 0);
     lv_obj_center(btn_label);
     lv_obj_add_event_cb(b, [](lv_event_t*) {
-        for (int i = 0; i < 5; i++) measurements_done[i] = false;
-        switch_scr(scr_info);
+        measureFlow.reset(millis());
+        switch_scr(SCR_INFO);
     }, LV_EVENT_CLICKED, NULL);
 
     // View saved data button
@@ -519,91 +720,157 @@ void create_welcome_screen() {
     lv_obj_set_style_text_font(data_label, &lv_font_montserrat_18, 0);
     lv_obj_center(data_label);
     lv_obj_add_event_cb(data_btn, [](lv_event_t*) {
-        create_data_view_screen();
+        if (!scr_data_view) create_data_view_screen();
+        data_view_show(0);
         switch_scr(scr_data_view);
     }, LV_EVENT_CLICKED, NULL);
 
+    // Calibration (service staff)
+    lv_obj_t *cal_btn = lv_btn_create(scr_welcome);
+    lv_obj_set_size(cal_btn, 140, 40);
+    lv_obj_align(cal_btn, LV_ALIGN_BOTTOM_RIGHT, -10, -10);
+    lv_obj_set_style_bg_color(cal_btn, lv_color_hex(0x475569), 0);
+    lv_obj_t *cal_lbl = lv_label_create(cal_btn);
+    lv_label_set_text(cal_lbl, "CALIBRATE");
+    lv_obj_set_style_text_font(cal_lbl, &lv_font_montserrat_14, 0);
+    lv_obj_center(cal_lbl);
+    lv_obj_add_event_cb(cal_btn, [](lv_event_t*) { switch_scr(SCR_CALIBRATION); }, LV_EVENT_CLICKED, NULL);
+
     // Initial update
     update_welcome_printer_status();
 }
 
-void update_results_screen() {
-    if (!scr_results) return;
+// Results screen fields. Each label remembers the text it shows and is only
+// touched when its formatted text changes, so a new capture updates one
+// label (plus BMI) instead of relabelling and restyling the whole report.
+#define RESULT_TEXT_MAX 64
 
-    // --- SET FONT SIZE TO 20 FOR ALL LABELS ---
-    const lv_font_t * font20 = &lv_font_montserrat_20;
-    lv_obj_set_style_text_font(results_name, font20, 0);
-    lv_obj_set_style_text_font(results_age, font20, 0);
-    lv_obj_set_style_text_font(results_gender, font20, 0);
-    lv_obj_set_style_text_font(results_addr, font20, 0);
-    lv_obj_set_style_text_font(results_bp, font20, 0);
-    lv_obj_set_style_text_font(results_height, font20, 0);
-    lv_obj_set_style_text_font(results_weight, font20, 0);
-    lv_obj_set_style_text_font(results_temp, font20, 0);
-    lv_obj_set_style_text_font(results_hr, font20, 0);
-    lv_obj_set_style_text_font(results_bmi, font20, 0);
-    lv_obj_set_style_text_font(results_bmi_cat, font20, 0);
-    // ------------------------------------------
-
-    // Patient info
-    lv_label_set_text_fmt(results_name, "Name: %s", healthData.name.c_str());
-    lv_label_set_text_fmt(results_age, "Age: %s", healthData.age.c_str());
-    lv_label_set_text_fmt(results_gender, "Gender: %s", healthData.gender.c_str());
-    lv_label_set_text_fmt(results_addr, "Address: %s", healthData.address.c_str());
+typedef void (*ResultFormat)(const HealthData &d, char *buf, size_t n);
 
-    char buf[32];
+struct ResultField {
+    ResultFormat format;
+    int16_t gapAfter;    // layout: pixels to the next label
+    lv_obj_t *label;
+    char shown[RESULT_TEXT_MAX];
+};
 
-    // BP
-    if (healthData.bp_measured)
-        lv_label_set_text_fmt(results_bp, "BP: %d/%d mmHg", healthData.bp_sys, healthData.bp_dia);
-    else
-        lv_label_set_text(results_bp, "BP: Not measured");
+static void fmt_name(const HealthData &d, char *buf, size_t n) { snprintf(buf, n, "Name: %s", d.name.c_str()); }
+static void fmt_age(const HealthData &d, char *buf, size_t n) { snprintf(buf, n, "Age: %s", d.age.c_str()); }
+static void fmt_gender(const HealthData &d, char *buf, size_t n) { snprintf(buf, n, "Gender: %s", d.gender.c_str()); }
+static void fmt_address(const HealthData &d, char *buf, size_t n) { snprintf(buf, n, "Address: %s", d.address.c_str()); }
 
-    // Height
-    if (healthData.height_measured) {
-        dtostrf(healthData.height, 5, 1, buf);
-        lv_label_set_text_fmt(results_height, "Height: %s cm", buf);
-    } else {
-        lv_label_set_text(results_height, "Height: Not measured");
+static void fmt_bp(const HealthData &d, char *buf, size_t n) {
+    if (d.bp_measured) snprintf(buf, n, "BP: %d/%d mmHg", d.bp_sys, d.bp_dia);
+    else snprintf(buf, n, "BP: Not measured");
+}
+// One formatter per hub sensor, instantiated from its descriptor
+template <uint8_t ID> void fmt_sensor(const HealthData &d, char *buf, size_t n) {
+    const SensorDescriptor &s = SENSOR_TABLE[ID - 1];
+    if (!(d.*s.measured)) {
+        snprintf(buf, n, "%s: Not measured", s.label);
+        return;
     }
+    int len = snprintf(buf, n, "%s: ", s.label);
+    sensorFormat(s, s.load(d), buf + len, n - len);
+}
+static void fmt_bmi(const HealthData &d, char *buf, size_t n) {
+    if (d.bmi > 0) snprintf(buf, n, "BMI: %4.1f", d.bmi);
+    else snprintf(buf, n, "BMI: --");
+}
+static void fmt_bmi_category(const HealthData &d, char *buf, size_t n) {
+    if (d.bmi > 0) snprintf(buf, n, "Category: %s", getBMICategory(d.bmi).c_str());
+    else snprintf(buf, n, "Category: --");
+}
 
-    // Weight
-    if (healthData.weight_measured) {
-        dtostrf(healthData.weight, 5, 1, buf);
-        lv_label_set_text_fmt(results_weight, "Weight: %s kg", buf);
-    } else {
-        lv_label_set_text(results_weight, "Weight: Not measured");
-    }
+enum ResultFieldId { RF_NAME, RF_AGE, RF_GENDER, RF_ADDRESS, RF_BP, RF_HEIGHT, RF_WEIGHT,
+                     RF_TEMP, RF_HR, RF_BMI, RF_BMI_CATEGORY, RF_COUNT };
+
+static ResultField resultFields[RF_COUNT] = {
+    {fmt_name,         25, NULL, ""},
+    {fmt_age,          25, NULL, ""},
+    {fmt_gender,       25, NULL, ""},
+    {fmt_address,      70, NULL, ""},
+    {fmt_bp,           25, NULL, ""},
+    {fmt_sensor<HUB_SENSOR_HEIGHT>, 25, NULL, ""},
+    {fmt_sensor<HUB_SENSOR_WEIGHT>, 25, NULL, ""},
+    {fmt_sensor<HUB_SENSOR_TEMP>,   25, NULL, ""},
+    {fmt_sensor<HUB_SENSOR_PULSE>,  25, NULL, ""},
+    {fmt_bmi,          25, NULL, ""},
+    {fmt_bmi_category, 0,  NULL, ""},
+};
 
-    // Temperature
-    if (healthData.temp_measured) {
-        dtostrf(healthData.temperature, 4, 1, buf);
-        lv_label_set_text_fmt(results_temp, "Temp: %s °C", buf);
-    } else {
-        lv_label_set_text(results_temp, "Temp: Not measured");
+// Bring the results screen up to date with healthData; cheap when little
+// changed, so captures call it as they land
+void update_results_screen() {
+    if (!scr_results) return;
+    char text[RESULT_TEXT_MAX];
+    for (uint8_t i = 0; i < RF_COUNT; i++) {
+        ResultField &f = resultFields[i];
+        f.format(healthData, text, sizeof(text));
+        if (strcmp(text, f.shown) == 0) continue;
+        memcpy(f.shown, text, sizeof(text));
+        lv_label_set_text(f.label, text);
+        if (i == RF_BMI_CATEGORY) {
+            if (healthData.bmi > 0) lv_obj_set_style_text_color(f.label, getBMIColor(healthData.bmi), 0);
+            else lv_obj_remove_local_style_prop(f.label, LV_STYLE_TEXT_COLOR, 0);
+        }
     }
+}
 
-    // Heart rate
-    if (healthData.hr_measured) {
-        lv_label_set_text_fmt(results_hr, "HR: %d BPM", healthData.heart_rate);
-    } else {
-        lv_label_set_text(results_hr, "HR: Not measured");
+/* ==================== PATIENT INFO SCREEN ==================== */
+// Typing a name offers returning patients from the patient index; picking
+// one fills in the rest of the form from their latest record.
+static lv_obj_t *suggest_box = NULL;
+static lv_obj_t *suggest_btns[PATIENT_SUGGEST_MAX];
+static RecordPos suggest_pos[PATIENT_SUGGEST_MAX];
+static bool suggest_filling = false;   // our own set_text, not the user typing
+
+static void suggest_hide() {
+    if (suggest_box) lv_obj_add_flag(suggest_box, LV_OBJ_FLAG_HIDDEN);
+}
+
+static void name_changed_cb(lv_event_t *) {
+    if (suggest_filling) return;
+    const char *typed = lv_textarea_get_text(name_ta);
+    PatientMatch found[PATIENT_SUGGEST_MAX];
+    size_t n = strlen(typed) >= 2 ? patientsSuggest(typed, found, PATIENT_SUGGEST_MAX) : 0;
+    if (n == 0) {
+        suggest_hide();
+        return;
+    }
+    for (size_t i = 0; i < PATIENT_SUGGEST_MAX; i++) {
+        if (i < n) {
+            lv_label_set_text(lv_obj_get_child(suggest_btns[i], 0), found[i].name);
+            suggest_pos[i] = found[i].pos;
+            lv_obj_clear_flag(suggest_btns[i], LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_add_flag(suggest_btns[i], LV_OBJ_FLAG_HIDDEN);
+        }
     }
+    lv_obj_update_layout(name_ta);
+    lv_obj_align_to(suggest_box, name_ta, LV_ALIGN_OUT_BOTTOM_MID, 0, 4);
+    lv_obj_clear_flag(suggest_box, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_move_foreground(suggest_box);
+}
 
-    // BMI
-    if (healthData.bmi > 0) {
-        dtostrf(healthData.bmi, 4, 1, buf);
-        lv_label_set_text_fmt(results_bmi, "BMI: %s", buf);
-        String cat = getBMICategory(healthData.bmi);
-        lv_label_set_text_fmt(results_bmi_cat, "Category: %s", cat.c_str());
-        lv_obj_set_style_text_color(results_bmi_cat, getBMIColor(healthData.bmi), 0);
-    } else {
-        lv_label_set_text(results_bmi, "BMI: --");
-        lv_label_set_text(results_bmi_cat, "Category: --");
+static void suggest_pick_cb(lv_event_t *e) {
+    size_t i = (size_t)lv_event_get_user_data(e);
+    suggest_hide();
+    HealthData prev;
+    if (!patientsFetch(suggest_pos[i], prev)) {
+        toastShow("✗ Could not read that record", TOAST_ERROR);
+        return;
     }
+    suggest_filling = true;
+    lv_textarea_set_text(name_ta, prev.name.c_str());
+    suggest_filling = false;
+    lv_textarea_set_text(age_ta, prev.age.c_str());
+    lv_textarea_set_text(address_ta, prev.address.c_str());
+    int32_t g = lv_dropdown_get_option_index(gender_dd, prev.gender.c_str());
+    if (g >= 0) lv_dropdown_set_selected(gender_dd, g);
+    lv_obj_add_flag(kb, LV_OBJ_FLAG_HIDDEN);
 }
 
-/* ==================== PATIENT INFO SCREEN ==================== */
 void create_info_screen() {
     scr_info = lv_obj_create(NULL);
     lv_obj_set_style_bg_color(scr_info, lv_color_hex(0x0F172A), 0);
@@ -629,8 +896,10 @@ void create_info_screen() {
     lv_obj_set_width(name_ta, LV_PCT(100));
     lv_obj_set_height(name_ta, 50);
     lv_textarea_set_placeholder_text(name_ta, "Enter full name");
+    lv_textarea_set_max_length(name_ta, RECORD_NAME_MAX);
     lv_obj_set_style_text_font(name_ta, &lv_font_montserrat_18, 0);
     lv_obj_add_event_cb(name_ta, ta_event_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(name_ta, name_changed_cb, LV_EVENT_VALUE_CHANGED, NULL);
 
     // Age
     lv_obj_t *age_label = lv_label_create(form);
@@ -640,6 +909,8 @@ void create_info_screen() {
     lv_obj_set_width(age_ta, LV_PCT(100));
     lv_obj_set_height(age_ta, 50);
     lv_textarea_set_placeholder_text(age_ta, "Enter age");
+    lv_textarea_set_max_length(age_ta, RECORD_AGE_MAX);
+    lv_textarea_set_accepted_chars(age_ta, "0123456789");
     lv_obj_set_style_text_font(age_ta, &lv_font_montserrat_18, 0);
     lv_obj_add_event_cb(age_ta, ta_event_cb, LV_EVENT_CLICKED, NULL);
 
@@ -661,9 +932,32 @@ void create_info_screen() {
     lv_obj_set_width(address_ta, LV_PCT(100));
     lv_obj_set_height(address_ta, 80);
     lv_textarea_set_placeholder_text(address_ta, "Enter address");
+    lv_textarea_set_max_length(address_ta, RECORD_ADDRESS_MAX);
     lv_obj_set_style_text_font(address_ta, &lv_font_montserrat_18, 0);
     lv_obj_add_event_cb(address_ta, ta_event_cb, LV_EVENT_CLICKED, NULL);
 
+    // Returning-patient suggestions, floating over the form under the name
+    suggest_box = lv_obj_create(scr_info);
+    lv_obj_set_size(suggest_box, 430, LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(suggest_box, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_style_pad_all(suggest_box, 4, 0);
+    lv_obj_set_style_pad_gap(suggest_box, 4, 0);
+    lv_obj_set_style_bg_color(suggest_box, lv_color_hex(0x1E293B), 0);
+    lv_obj_set_style_border_color(suggest_box, lv_color_hex(0x3B82F6), 0);
+    lv_obj_clear_flag(suggest_box, LV_OBJ_FLAG_SCROLLABLE);
+    for (size_t i = 0; i < PATIENT_SUGGEST_MAX; i++) {
+        suggest_btns[i] = lv_btn_create(suggest_box);
+        lv_obj_set_size(suggest_btns[i], LV_PCT(100), 40);
+        lv_obj_set_style_bg_color(suggest_btns[i], lv_color_hex(0x334155), 0);
+        lv_obj_t *lbl = lv_label_create(suggest_btns[i]);
+        lv_label_set_long_mode(lbl, LV_LABEL_LONG_DOT);
+        lv_obj_set_width(lbl, LV_PCT(100));
+        lv_obj_set_style_text_font(lbl, &lv_font_montserrat_18, 0);
+        lv_obj_align(lbl, LV_ALIGN_LEFT_MID, 0, 0);
+        lv_obj_add_event_cb(suggest_btns[i], suggest_pick_cb, LV_EVENT_CLICKED, (void *)i);
+    }
+    suggest_hide();
+
     // Next button
     lv_obj_t *n = lv_btn_create(scr_info);
     lv_obj_set_size(n, 150, 60);
@@ -675,6 +969,7 @@ void create_info_screen() {
     lv_obj_center(btn_lbl);
 
     lv_obj_add_event_cb(n, [](lv_event_t*) {
+        suggest_hide();
         // Save patient info
         healthData.name = lv_textarea_get_text(name_ta);
         healthData.age = lv_textarea_get_text(age_ta);
@@ -684,12 +979,105 @@ void create_info_screen() {
         healthData.address = lv_textarea_get_text(address_ta);
         // Reset all sensor data
         healthData.resetMeasurements();
-        for (int i = 0; i < 5; i++) measurements_done[i] = false;
-        switch_scr(scr_bp);
+        measureFlow.reset(millis());
+        journalRecord(healthData, measureFlow.doneFlags());
+        switch_scr(SCR_BP);
     }, LV_EVENT_CLICKED, NULL);
 }
 
 /* ==================== BLOOD PRESSURE SCREEN ==================== */
+// START runs the hub's cuff and fills the fields in with its reading. The
+// fields stay editable as the fallback for kiosks without a cuff, and
+// whatever they hold when the screen is left is range-checked against the
+// configuration before it is taken; both empty skips the step.
+static void bpSend(const uint8_t *bytes, size_t len, void *ctx) {
+    hubWrite(bytes, len);
+    if (bytes[0] == CMD_START_BP) Serial.println("📤 Sent START_BP");
+    else if (bytes[0] == CMD_STOP_STREAM) Serial.println("📤 Sent STOP_STREAM (cuff vented)");
+}
+
+static void onBpResult(const BpReading &r, const char *failure, void *ctx) {
+    if (failure) {
+        Serial.printf("✗ BP: %s\n", failure);
+        return;   // shown by bp_refresh
+    }
+    Serial.printf("✓ BP: %u/%u mmHg (MAP %u)\n", r.sys, r.dia, r.map);
+    if (!bp_sys_ta) return;
+    char buf[8];
+    snprintf(buf, sizeof(buf), "%u", r.sys);
+    lv_textarea_set_text(bp_sys_ta, buf);
+    snprintf(buf, sizeof(buf), "%u", r.dia);
+    lv_textarea_set_text(bp_dia_ta, buf);
+}
+
+// Cuff progress onto the BP screen (from live_refresh_cb)
+static void bp_refresh() {
+    if (!scr_bp || lv_scr_act() != scr_bp || !bpCuff.takeChanged()) return;
+    float osc[BP_TRACE_RING];
+    size_t n = bpCuff.drain(osc, BP_TRACE_RING);
+    for (size_t i = 0; i < n; i++) lv_chart_set_next_value(bp_chart, bp_series, (int32_t)(osc[i] * 100));
+
+    const BpReading &r = bpCuff.latest();
+    lv_bar_set_value(bp_bar, bpCuff.running() ? (int32_t)r.cuffMmHg : 0, LV_ANIM_OFF);
+    lv_label_set_text(bp_start_lbl, bpCuff.running() ? "STOP" : "START CUFF");
+
+    char text[64];
+    uint32_t color = 0x94A3B8;
+    switch (bpCuff.state()) {
+        case BPC_IDLE:      snprintf(text, sizeof(text), "Sit still, arm at heart level"); break;
+        case BPC_WAITING:   snprintf(text, sizeof(text), "Starting cuff..."); break;
+        case BPC_INFLATING: snprintf(text, sizeof(text), "Inflating: %.0f mmHg", r.cuffMmHg); break;
+        case BPC_DEFLATING:
+            if (bpCuff.mapEstimate() > 0)
+                snprintf(text, sizeof(text), "Measuring: %.0f mmHg, MAP ~%.0f", r.cuffMmHg, bpCuff.mapEstimate());
+            else
+                snprintf(text, sizeof(text), "Measuring: %.0f mmHg", r.cuffMmHg);
+            color = 0xF59E0B;
+            break;
+        case BPC_DONE:
+            snprintf(text, sizeof(text), "%u/%u mmHg (MAP %u)", r.sys, r.dia, r.map);
+            color = 0x10B981;
+            break;
+        case BPC_FAILED:
+            snprintf(text, sizeof(text), "%s, enter manually", bpCuff.failure());
+            color = 0xEF4444;
+            break;
+    }
+    lv_label_set_text(bp_status_lbl, text);
+    lv_obj_set_style_text_color(bp_status_lbl, lv_color_hex(color), 0);
+}
+
+// Whole number of mmHg, nothing else in the field
+static bool parse_mmhg(lv_obj_t *ta, int &out) {
+    const char *text = lv_textarea_get_text(ta);
+    char *end;
+    long v = strtol(text, &end, 10);
+    while (*end == ' ') end++;
+    if (end == text || *end || v < 0 || v > 999) return false;
+    out = (int)v;
+    return true;
+}
+
+// False, with a toast, while the fields hold no plausible reading
+static bool save_bp() {
+    if (!*lv_textarea_get_text(bp_sys_ta) && !*lv_textarea_get_text(bp_dia_ta)) return true;
+    int sys = 0, dia = 0;
+    const char *err = "Enter both values in mmHg";
+    if (parse_mmhg(bp_sys_ta, sys) && parse_mmhg(bp_dia_ta, dia)) err = bpValidate(sensorConfig, sys, dia);
+    if (err) {
+        char msg[TOAST_TEXT_MAX];
+        snprintf(msg, sizeof(msg), "✗ %s", err);   // the ranges are the placeholders
+        toastShow(msg, TOAST_ERROR);
+        return false;
+    }
+    healthData.bp_sys = sys;
+    healthData.bp_dia = dia;
+    healthData.bp_measured = true;
+    measureFlow.markDone(MEASURE_STEP_BP);
+    journalRecord(healthData, measureFlow.doneFlags());
+    return true;
+}
+
 void create_bp_screen() {
     scr_bp = lv_obj_create(NULL);
     lv_obj_set_style_bg_color(scr_bp, lv_color_hex(0x0F172A), 0);
@@ -703,15 +1091,70 @@ void create_bp_screen() {
 
     // Instruction
     lv_obj_t *instr = lv_label_create(scr_bp);
-    lv_label_set_text(instr, "Enter your blood pressure manually");
+    lv_label_set_text(instr, "Use the cuff, or enter your readings");
     lv_obj_set_style_text_font(instr, &lv_font_montserrat_18, 0);
     lv_obj_set_style_text_color(instr, lv_color_hex(0x94A3B8), 0);
     lv_obj_align(instr, LV_ALIGN_TOP_MID, 0, 80);
 
-    // Container
+    // Cuff: start/stop, live pressure and the oscillations picked up on the
+    // way down
+    lv_obj_t *cuff = lv_obj_create(scr_bp);
+    lv_obj_set_size(cuff, 440, 250);
+    lv_obj_align(cuff, LV_ALIGN_TOP_MID, 0, 120);
+    lv_obj_set_style_bg_color(cuff, lv_color_hex(0x1E293B), 0);
+    lv_obj_set_style_border_width(cuff, 0, 0);
+    lv_obj_set_style_pad_all(cuff, 10, 0);
+
+    lv_obj_t *btn_cuff = lv_btn_create(cuff);
+    lv_obj_set_size(btn_cuff, 150, 45);
+    lv_obj_set_pos(btn_cuff, 0, 0);
+    lv_obj_set_style_bg_color(btn_cuff, lv_color_hex(0x3B82F6), 0);
+    bp_start_lbl = lv_label_create(btn_cuff);
+    lv_label_set_text(bp_start_lbl, "START CUFF");
+    lv_obj_set_style_text_font(bp_start_lbl, &lv_font_montserrat_16, 0);
+    lv_obj_center(bp_start_lbl);
+    lv_obj_add_event_cb(btn_cuff, [](lv_event_t*) {
+        if (bpCuff.running()) {
+            bpCuff.cancel(millis());
+            return;
+        }
+        lv_chart_set_all_value(bp_chart, bp_series, LV_CHART_POINT_NONE);
+        bpCuff.start(millis());
+    }, LV_EVENT_CLICKED, NULL);
+
+    bp_status_lbl = lv_label_create(cuff);
+    lv_obj_set_width(bp_status_lbl, 420);
+    lv_label_set_long_mode(bp_status_lbl, LV_LABEL_LONG_DOT);
+    lv_label_set_text(bp_status_lbl, "Sit still, arm at heart level");
+    lv_obj_set_style_text_font(bp_status_lbl, &lv_font_montserrat_16, 0);
+    lv_obj_set_style_text_color(bp_status_lbl, lv_color_hex(0x94A3B8), 0);
+    lv_obj_set_pos(bp_status_lbl, 0, 60);
+
+    bp_bar = lv_bar_create(cuff);
+    lv_obj_set_size(bp_bar, 420, 14);
+    lv_obj_set_pos(bp_bar, 0, 90);
+    lv_bar_set_range(bp_bar, 0, BP_BAR_MMHG);
+    lv_bar_set_value(bp_bar, 0, LV_ANIM_OFF);
+
+    bp_chart = lv_chart_create(cuff);
+    lv_obj_set_size(bp_chart, 420, 110);
+    lv_obj_set_pos(bp_chart, 0, 115);
+    lv_chart_set_type(bp_chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_point_count(bp_chart, BP_CHART_POINTS);
+    lv_chart_set_update_mode(bp_chart, LV_CHART_UPDATE_MODE_CIRCULAR);
+    lv_chart_set_range(bp_chart, LV_CHART_AXIS_PRIMARY_Y, 0, 400);   // 0..4 mmHg
+    lv_chart_set_div_line_count(bp_chart, 0, 0);
+    lv_obj_set_style_bg_color(bp_chart, lv_color_hex(0x0F172A), 0);
+    lv_obj_set_style_border_width(bp_chart, 0, 0);
+    lv_obj_set_style_size(bp_chart, 0, 0, LV_PART_INDICATOR);
+    lv_obj_set_style_line_width(bp_chart, 2, LV_PART_ITEMS);
+    bp_series = lv_chart_add_series(bp_chart, lv_color_hex(0xF59E0B), LV_CHART_AXIS_PRIMARY_Y);
+    lv_chart_set_all_value(bp_chart, bp_series, LV_CHART_POINT_NONE);
+
+    // Manual entry, also filled in by the cuff
     lv_obj_t *box = lv_obj_create(scr_bp);
-    lv_obj_set_size(box, 400, 200);
-    lv_obj_align(box, LV_ALIGN_CENTER, 0, 0);
+    lv_obj_set_size(box, 440, 170);
+    lv_obj_align(box, LV_ALIGN_TOP_MID, 0, 390);
     lv_obj_set_style_bg_color(box, lv_color_hex(0x1E293B), 0);
     lv_obj_set_style_border_width(box, 0, 0);
 
@@ -720,13 +1163,14 @@ void create_bp_screen() {
     lv_label_set_text(sys_lbl, "Systolic (mmHg):");
     lv_obj_set_style_text_font(sys_lbl, &lv_font_montserrat_18, 0);
     lv_obj_set_style_text_color(sys_lbl, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_pos(sys_lbl, 20, 30);
+    lv_obj_set_pos(sys_lbl, 20, 20);
 
     bp_sys_ta = lv_textarea_create(box);
     lv_obj_set_size(bp_sys_ta, 150, 40);
-    lv_obj_set_pos(bp_sys_ta, 200, 25);
+    lv_obj_set_pos(bp_sys_ta, 220, 15);
     lv_textarea_set_one_line(bp_sys_ta, true);
-    lv_textarea_set_placeholder_text(bp_sys_ta, "e.g. 120");
+    lv_textarea_set_accepted_chars(bp_sys_ta, "0123456789");
+    lv_textarea_set_max_length(bp_sys_ta, 3);
     lv_obj_add_event_cb(bp_sys_ta, ta_event_cb, LV_EVENT_CLICKED, NULL);
 
     // Diastolic
@@ -734,19 +1178,20 @@ void create_bp_screen() {
     lv_label_set_text(dia_lbl, "Diastolic (mmHg):");
     lv_obj_set_style_text_font(dia_lbl, &lv_font_montserrat_18, 0);
     lv_obj_set_style_text_color(dia_lbl, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_pos(dia_lbl, 20, 90);
+    lv_obj_set_pos(dia_lbl, 20, 80);
 
     bp_dia_ta = lv_textarea_create(box);
     lv_obj_set_size(bp_dia_ta, 150, 40);
-    lv_obj_set_pos(bp_dia_ta, 200, 85);
+    lv_obj_set_pos(bp_dia_ta, 220, 75);
     lv_textarea_set_one_line(bp_dia_ta, true);
-    lv_textarea_set_placeholder_text(bp_dia_ta, "e.g. 80");
+    lv_textarea_set_accepted_chars(bp_dia_ta, "0123456789");
+    lv_textarea_set_max_length(bp_dia_ta, 3);
     lv_obj_add_event_cb(bp_dia_ta, ta_event_cb, LV_EVENT_CLICKED, NULL);
 
-    // Save & Continue button
+    // Save & Continue button: one screen per sensor
     lv_obj_t *btn_save = lv_btn_create(scr_bp);
     lv_obj_set_size(btn_save, 200, 60);
-    lv_obj_align(btn_save, LV_ALIGN_BOTTOM_MID, 0, -50);
+    lv_obj_align(btn_save, LV_ALIGN_BOTTOM_MID, -110, -50);
     lv_obj_set_style_bg_color(btn_save, lv_color_hex(0x10B981), 0);
     lv_obj_t *btn_lbl = lv_label_create(btn_save);
     lv_label_set_text(btn_lbl, "SAVE & CONTINUE");
@@ -754,19 +1199,390 @@ void create_bp_screen() {
     lv_obj_center(btn_lbl);
 
     lv_obj_add_event_cb(btn_save, [](lv_event_t*) {
-        String sys_str = lv_textarea_get_text(bp_sys_ta);
-        String dia_str = lv_textarea_get_text(bp_dia_ta);
-        healthData.bp_sys = sys_str.toInt();
-        healthData.bp_dia = dia_str.toInt();
-        healthData.bp_measured = true;
-        measurements_done[0] = true;
-        switch_scr(scr_height);
+        if (save_bp()) switch_scr(SCR_HEIGHT);
     }, LV_EVENT_CLICKED, NULL);
+
+    // Measure all button: every hub sensor at once on the dashboard
+    lv_obj_t *btn_all = lv_btn_create(scr_bp);
+    lv_obj_set_size(btn_all, 200, 60);
+    lv_obj_align(btn_all, LV_ALIGN_BOTTOM_MID, 110, -50);
+    lv_obj_set_style_bg_color(btn_all, lv_color_hex(0x8B5CF6), 0);
+    lv_obj_t *all_lbl = lv_label_create(btn_all);
+    lv_label_set_text(all_lbl, "MEASURE ALL");
+    lv_obj_set_style_text_font(all_lbl, &lv_font_montserrat_16, 0);
+    lv_obj_center(all_lbl);
+
+    lv_obj_add_event_cb(btn_all, [](lv_event_t*) {
+        if (save_bp()) switch_scr(SCR_DASHBOARD);
+    }, LV_EVENT_CLICKED, NULL);
+
+    // Placeholders show the accepted ranges, which a CONFIG reload may change
+    lv_obj_add_event_cb(scr_bp, [](lv_event_t*) {
+        char range[16];
+        snprintf(range, sizeof(range), "%d-%d", sensorConfig.bp_sys_min, sensorConfig.bp_sys_max);
+        lv_textarea_set_placeholder_text(bp_sys_ta, range);
+        snprintf(range, sizeof(range), "%d-%d", sensorConfig.bp_dia_min, sensorConfig.bp_dia_max);
+        lv_textarea_set_placeholder_text(bp_dia_ta, range);
+    }, LV_EVENT_SCREEN_LOAD_START, NULL);
+
+    // However the screen is left, the cuff is let down
+    lv_obj_add_event_cb(scr_bp, [](lv_event_t*) {
+        bpCuff.cancel(millis());
+    }, LV_EVENT_SCREEN_UNLOAD_START, NULL);
+}
+
+/* ==================== PARALLEL CAPTURE DASHBOARD ==================== */
+// One tile per hub sensor, polled together with CMD_MEASURE. Sensors are
+// taken once stable; CAPTURE takes the stable ones early and the rest are
+// measured one by one.
+struct DashboardTile {
+    lv_obj_t *value;
+    lv_obj_t *state;
+    lv_obj_t *bar;
+};
+static DashboardTile dashTiles[MEASURE_STEPS];
+static lv_obj_t *dash_capture_lbl;
+
+void resume_session();
+
+static void dashboard_accept() {
+    parallelCapture.stop();
+    for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+        const ParallelChannel &c = parallelCapture.channel(s);
+        if (c.state != PC_STABLE) continue;
+        measureFlow.markDone(s);
+        apply_capture(s, c.value);
+    }
+    resume_session();   // report, or the first sensor still missing
+}
+
+static void dashboard_reset_tiles() {
+    for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+        lv_label_set_text(dashTiles[s].value, "--");
+        lv_label_set_text(dashTiles[s].state, "Waiting...");
+        lv_obj_set_style_text_color(dashTiles[s].state, lv_color_hex(0x94A3B8), 0);
+        lv_bar_set_value(dashTiles[s].bar, 0, LV_ANIM_OFF);
+    }
+    lv_label_set_text(dash_capture_lbl, "CAPTURE (0)");
+}
+
+// All tiles in one pass (from live_refresh_cb)
+static void dashboard_refresh() {
+    if (!scr_dashboard) return;
+    const ParallelCapture &pc = parallelCapture;
+    char buf[32];
+    for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+        const ParallelChannel &c = pc.channel(s);
+        DashboardTile &t = dashTiles[s];
+        if (c.state == PC_ABSENT) {
+            lv_label_set_text(t.value, "--");
+            lv_label_set_text(t.state, "Not ready");
+            lv_obj_set_style_text_color(t.state, lv_color_hex(0x94A3B8), 0);
+            lv_bar_set_value(t.bar, 0, LV_ANIM_OFF);
+            continue;
+        }
+        sensorFormat(sensorDescriptor(s), c.value, buf, sizeof(buf));
+        lv_label_set_text(t.value, buf);
+        bool stable = c.state == PC_STABLE;
+        lv_label_set_text(t.state, stable ? "Stable" : "Settling...");
+        lv_obj_set_style_text_color(t.state, lv_color_hex(stable ? 0x10B981 : 0xF59E0B), 0);
+        lv_bar_set_value(t.bar, stable ? 100 : c.count * 90 / PARALLEL_WINDOW, LV_ANIM_ON);
+    }
+    lv_label_set_text_fmt(dash_capture_lbl, "CAPTURE (%d)", pc.stableCount());
+    if (pc.allStable()) dashboard_accept();
+}
+
+void create_dashboard_screen() {
+    scr_dashboard = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr_dashboard, lv_color_hex(0x0F172A), 0);
+
+    lv_obj_t *title = lv_label_create(scr_dashboard);
+    lv_label_set_text(title, "ALL MEASUREMENTS");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_color(title, lv_color_hex(0x3B82F6), 0);
+    lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 30);
+
+    lv_obj_t *instr = lv_label_create(scr_dashboard);
+    lv_label_set_text(instr, "Stand on the scale under the sensor,\nfinger on the pulse sensor");
+    lv_obj_set_style_text_font(instr, &lv_font_montserrat_16, 0);
+    lv_obj_set_style_text_color(instr, lv_color_hex(0x94A3B8), 0);
+    lv_obj_set_style_text_align(instr, LV_TEXT_ALIGN_CENTER, 0);
+    lv_obj_align(instr, LV_ALIGN_TOP_MID, 0, 70);
+
+    lv_obj_t *grid = lv_obj_create(scr_dashboard);
+    lv_obj_set_size(grid, 460, 360);
+    lv_obj_align(grid, LV_ALIGN_CENTER, 0, 0);
+    lv_obj_set_flex_flow(grid, LV_FLEX_FLOW_ROW_WRAP);
+    lv_obj_set_flex_align(grid, LV_FLEX_ALIGN_SPACE_EVENLY, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_SPACE_EVENLY);
+    lv_obj_set_style_bg_opa(grid, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(grid, 0, 0);
+
+    for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+        lv_obj_t *tile = lv_obj_create(grid);
+        lv_obj_set_size(tile, 210, 160);
+        lv_obj_set_style_bg_color(tile, lv_color_hex(0x1E293B), 0);
+        lv_obj_set_style_border_width(tile, 0, 0);
+        lv_obj_clear_flag(tile, LV_OBJ_FLAG_SCROLLABLE);
+
+        lv_obj_t *name = lv_label_create(tile);
+        lv_label_set_text(name, sensorDescriptor(s).caption);
+        lv_obj_set_style_text_font(name, &lv_font_montserrat_14, 0);
+        lv_obj_set_style_text_color(name, lv_color_hex(0x94A3B8), 0);
+        lv_obj_align(name, LV_ALIGN_TOP_MID, 0, 0);
+
+        DashboardTile &t = dashTiles[s];
+        t.value = lv_label_create(tile);
+        lv_obj_set_style_text_font(t.value, &lv_font_montserrat_28, 0);
+        lv_obj_set_style_text_color(t.value, lv_color_hex(0xFFFFFF), 0);
+        lv_obj_align(t.value, LV_ALIGN_CENTER, 0, -10);
+
+        t.state = lv_label_create(tile);
+        lv_obj_set_style_text_font(t.state, &lv_font_montserrat_14, 0);
+        lv_obj_align(t.state, LV_ALIGN_BOTTOM_MID, 0, -20);
+
+        t.bar = lv_bar_create(tile);
+        lv_obj_set_size(t.bar, 170, 8);
+        lv_obj_align(t.bar, LV_ALIGN_BOTTOM_MID, 0, 0);
+    }
+
+    // One by one: leave the dashboard for the per-sensor screens
+    lv_obj_t *single = lv_btn_create(scr_dashboard);
+    lv_obj_set_size(single, 200, 60);
+    lv_obj_align(single, LV_ALIGN_BOTTOM_MID, -110, -40);
+    lv_obj_set_style_bg_color(single, lv_color_hex(0x3B82F6), 0);
+    lv_obj_t *single_lbl = lv_label_create(single);
+    lv_label_set_text(single_lbl, "ONE BY ONE");
+    lv_obj_set_style_text_font(single_lbl, &lv_font_montserrat_16, 0);
+    lv_obj_center(single_lbl);
+    lv_obj_add_event_cb(single, [](lv_event_t*) { resume_session(); }, LV_EVENT_CLICKED, NULL);
+
+    // Capture: take what is stable now
+    lv_obj_t *capture = lv_btn_create(scr_dashboard);
+    lv_obj_set_size(capture, 200, 60);
+    lv_obj_align(capture, LV_ALIGN_BOTTOM_MID, 110, -40);
+    lv_obj_set_style_bg_color(capture, lv_color_hex(0x8B5CF6), 0);
+    dash_capture_lbl = lv_label_create(capture);
+    lv_obj_set_style_text_font(dash_capture_lbl, &lv_font_montserrat_16, 0);
+    lv_obj_center(dash_capture_lbl);
+    lv_obj_add_event_cb(capture, [](lv_event_t*) { dashboard_accept(); }, LV_EVENT_CLICKED, NULL);
+
+    // Polling runs only while the dashboard is shown
+    lv_obj_add_event_cb(scr_dashboard, [](lv_event_t*) {
+        dashboard_reset_tiles();
+        measureFlow.cancel(millis());
+        parallelCapture.begin(millis());
+    }, LV_EVENT_SCREEN_LOAD_START, NULL);
+    lv_obj_add_event_cb(scr_dashboard, [](lv_event_t*) {
+        parallelCapture.stop();
+    }, LV_EVENT_SCREEN_UNLOAD_START, NULL);
+
+    dashboard_reset_tiles();
+}
+
+/* ==================== CALIBRATION SCREEN ==================== */
+// Guided calibration: stream one sensor raw, put a known reference on it
+// (weight, measuring rod, reference thermometer), enter the reference value
+// and ADD POINT; the raw reading is the mean of the last second. FIT & SAVE
+// fits a curve through the points and stores it in NVS.
+#define CAL_POINT_SAMPLES 10   // raw samples averaged per point
+#define CAL_POINT_MAX_AGE 1000 // ms; older samples mean the sensor isn't streaming
+
+static lv_obj_t *cal_sensor_dd, *cal_ref_ta, *cal_live_lbl, *cal_points_lbl, *cal_status_lbl;
+static float calRaw[CAL_MAX_POINTS], calRef[CAL_MAX_POINTS];
+static uint8_t calPoints = 0;
+
+static void cal_status(const char *text, uint32_t color) {
+    lv_label_set_text(cal_status_lbl, text);
+    lv_obj_set_style_text_color(cal_status_lbl, lv_color_hex(color), 0);
+}
+
+static void cal_show_points() {
+    char text[CAL_MAX_POINTS * 40 + 1];
+    size_t n = 0;
+    text[0] = '\0';
+    for (uint8_t i = 0; i < calPoints; i++) {
+        n += snprintf(text + n, sizeof(text) - n, "%u: raw %.2f -> %.2f\n", i + 1, calRaw[i], calRef[i]);
+    }
+    const CalCurve &c = calCurve(calStreamSensor);
+    snprintf(text + n, sizeof(text) - n, "Current: %.4g + %.6g x + %.3g x²", c.c[0], c.c[1], c.c[2]);
+    lv_label_set_text(cal_points_lbl, text);
+}
+
+// Subscribe to the selected sensor alone, uncalibrated
+static void cal_select(uint8_t sensor) {
+    calStreamSensor = sensor;
+    calSetBypass(sensor);
+    calPoints = 0;
+    uint8_t rates[HUB_SENSOR_COUNT] = {0, 0, 0, 0};
+    uint8_t cmd[SUBSCRIBE_CMD_LEN];
+    measureSend(cmd, encodeSubscribe(HUB_SENSOR_BIT(sensor), rates, cmd), NULL);
+    lv_label_set_text(cal_live_lbl, "Raw: --");
+    cal_show_points();
+    cal_status("Place the reference and enter its value", 0x94A3B8);
+}
+
+static void cal_add_point() {
+    if (calPoints >= CAL_MAX_POINTS) {
+        cal_status("Point limit reached: FIT & SAVE or RESET", 0xF59E0B);
+        return;
+    }
+    const char *text = lv_textarea_get_text(cal_ref_ta);
+    char *end;
+    float ref = strtof(text, &end);
+    if (end == text) {
+        cal_status("Enter the reference value first", 0xEF4444);
+        return;
+    }
+    StreamPoint pts[CAL_POINT_SAMPLES];
+    size_t n = streamStore.recent(calStreamSensor, pts, CAL_POINT_SAMPLES);
+    const StreamChannel &ch = streamStore.channel(calStreamSensor);
+    if (n < 3 || millis() - ch.arrivedMs > CAL_POINT_MAX_AGE) {
+        cal_status("No readings - is the sensor streaming?", 0xEF4444);
+        return;
+    }
+    float sum = 0;
+    for (size_t i = 0; i < n; i++) sum += pts[i].value;
+    calRaw[calPoints] = sum / n;
+    calRef[calPoints] = ref;
+    calPoints++;
+    lv_textarea_set_text(cal_ref_ta, "");
+    cal_show_points();
+    cal_status("Point added", 0x10B981);
+}
+
+static void cal_fit_save() {
+    CalCurve curve;
+    if (!calFit(calRaw, calRef, calPoints, curve)) {
+        cal_status(calPoints ? "Points too close together" : "Add at least one point", 0xEF4444);
+        return;
+    }
+    if (!calSet(calStreamSensor, curve)) {
+        cal_status("Saving failed", 0xEF4444);
+        return;
+    }
+    Serial.printf("✓ Calibration sensor %u: %.4g + %.6g x + %.3g x²\n", calStreamSensor,
+                  curve.c[0], curve.c[1], curve.c[2]);
+    calPoints = 0;
+    cal_show_points();
+    cal_status("Saved", 0x10B981);
+}
+
+// Live raw reading and what the stored curve makes of it
+static void calibration_refresh(uint8_t dirty) {
+    if (!calStreamSensor || !(dirty & HUB_SENSOR_BIT(calStreamSensor))) return;
+    float raw = streamStore.channel(calStreamSensor).latest;
+    lv_label_set_text_fmt(cal_live_lbl, "Raw: %.2f   Calibrated: %.2f", raw,
+                          calPreview(calStreamSensor, raw));
+}
+
+static lv_obj_t *cal_button(lv_obj_t *parent, const char *text, uint32_t color, lv_event_cb_t cb) {
+    lv_obj_t *b = lv_btn_create(parent);
+    lv_obj_set_size(b, 140, 50);
+    lv_obj_set_style_bg_color(b, lv_color_hex(color), 0);
+    lv_obj_t *l = lv_label_create(b);
+    lv_label_set_text(l, text);
+    lv_obj_set_style_text_font(l, &lv_font_montserrat_14, 0);
+    lv_obj_center(l);
+    lv_obj_add_event_cb(b, cb, LV_EVENT_CLICKED, NULL);
+    return b;
+}
+
+void create_calibration_screen() {
+    scr_calibration = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr_calibration, lv_color_hex(0x0F172A), 0);
+
+    lv_obj_t *title = lv_label_create(scr_calibration);
+    lv_label_set_text(title, "CALIBRATION");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_color(title, lv_color_hex(0x3B82F6), 0);
+    lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 30);
+
+    lv_obj_t *form = lv_obj_create(scr_calibration);
+    lv_obj_set_size(form, 460, 520);
+    lv_obj_align(form, LV_ALIGN_TOP_MID, 0, 80);
+    lv_obj_set_flex_flow(form, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_style_pad_all(form, 15, 0);
+    lv_obj_set_style_pad_gap(form, 12, 0);
+
+    cal_sensor_dd = lv_dropdown_create(form);
+    lv_obj_set_width(cal_sensor_dd, LV_PCT(100));
+    lv_dropdown_clear_options(cal_sensor_dd);
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        char opt[40];
+        snprintf(opt, sizeof(opt), "%s (%s)", SENSOR_TABLE[i].label, SENSOR_TABLE[i].unit);
+        lv_dropdown_add_option(cal_sensor_dd, opt, i);
+    }
+    lv_obj_set_style_text_font(cal_sensor_dd, &lv_font_montserrat_18, 0);
+    lv_obj_add_event_cb(cal_sensor_dd, [](lv_event_t *) {
+        cal_select(lv_dropdown_get_selected(cal_sensor_dd) + HUB_SENSOR_HEIGHT);
+    }, LV_EVENT_VALUE_CHANGED, NULL);
+
+    cal_live_lbl = lv_label_create(form);
+    lv_obj_set_style_text_font(cal_live_lbl, &lv_font_montserrat_20, 0);
+
+    cal_ref_ta = lv_textarea_create(form);
+    lv_obj_set_width(cal_ref_ta, LV_PCT(100));
+    lv_textarea_set_one_line(cal_ref_ta, true);
+    lv_textarea_set_accepted_chars(cal_ref_ta, "0123456789.-");
+    lv_textarea_set_placeholder_text(cal_ref_ta, "Reference value");
+    lv_obj_set_style_text_font(cal_ref_ta, &lv_font_montserrat_18, 0);
+    lv_obj_add_event_cb(cal_ref_ta, ta_event_cb, LV_EVENT_CLICKED, NULL);
+
+    lv_obj_t *row = lv_obj_create(form);
+    lv_obj_set_size(row, LV_PCT(100), 70);
+    lv_obj_set_flex_flow(row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(row, LV_FLEX_ALIGN_SPACE_EVENLY, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_bg_opa(row, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(row, 0, 0);
+    cal_button(row, "ADD POINT", 0x10B981, [](lv_event_t *) { cal_add_point(); });
+    cal_button(row, "FIT & SAVE", 0x8B5CF6, [](lv_event_t *) { cal_fit_save(); });
+
+    cal_points_lbl = lv_label_create(form);
+    lv_obj_set_style_text_font(cal_points_lbl, &lv_font_montserrat_16, 0);
+
+    cal_status_lbl = lv_label_create(form);
+    lv_obj_set_style_text_font(cal_status_lbl, &lv_font_montserrat_16, 0);
+
+    lv_obj_t *reset = cal_button(scr_calibration, "RESET", 0xEF4444, [](lv_event_t *) {
+        calPoints = 0;
+        calReset(calStreamSensor);
+        cal_show_points();
+        cal_status("Back to uncalibrated", 0xF59E0B);
+    });
+    lv_obj_align(reset, LV_ALIGN_BOTTOM_LEFT, 20, -20);
+    lv_obj_t *back = cal_button(scr_calibration, "BACK", 0x3B82F6, [](lv_event_t *) {
+        switch_scr(scr_welcome);
+    });
+    lv_obj_align(back, LV_ALIGN_BOTTOM_RIGHT, -20, -20);
+
+    // Stream only while shown; leaving stops it and restores calibration
+    lv_obj_add_event_cb(scr_calibration, [](lv_event_t *) {
+        measureFlow.cancel(millis());
+        cal_select(lv_dropdown_get_selected(cal_sensor_dd) + HUB_SENSOR_HEIGHT);
+    }, LV_EVENT_SCREEN_LOAD_START, NULL);
+    lv_obj_add_event_cb(scr_calibration, [](lv_event_t *) {
+        uint8_t stop = CMD_STOP_STREAM;
+        measureSend(&stop, 1, NULL);
+        calStreamSensor = 0;
+        calSetBypass(0);
+    }, LV_EVENT_SCREEN_UNLOAD_START, NULL);
+}
+
+// Batched UI pass for everything streamed since the last one: sensor
+// screen live labels and waveform, dashboard tiles. Frames only touch the stores.
+static void live_refresh_cb(lv_timer_t *) {
+    uint8_t dirty = streamStore.takeDirty();
+    for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+        if (dirty & HUB_SENSOR_BIT(s)) updateLiveLabel(s, streamStore.channel(s).latest);
+    }
+    if (parallelCapture.takeChanged()) dashboard_refresh();
+    wave_refresh();
+    bp_refresh();
+    calibration_refresh(dirty);
 }
 
 /* ==================== RESULTS SCREEN ==================== */
 void create_results_screen() {
-    if (scr_results != NULL) lv_obj_del(scr_results);
     scr_results = lv_obj_create(NULL);
     lv_obj_set_style_bg_color(scr_results, lv_color_hex(0x0F172A), 0);
 
@@ -787,50 +1603,16 @@ void create_results_screen() {
 
     int y = 0;
 
-    // Create all result labels inside the container and store them globally
-    results_name = lv_label_create(measurements);
-    lv_label_set_text(results_name, "Name: --");
-    lv_obj_set_pos(results_name, 0, y); y += 25;
-
-    results_age = lv_label_create(measurements);
-    lv_label_set_text(results_age, "Age: --");
-    lv_obj_set_pos(results_age, 0, y); y += 25;
-
-    results_gender = lv_label_create(measurements);
-    lv_label_set_text(results_gender, "Gender: --");
-    lv_obj_set_pos(results_gender, 0, y); y += 25;
-
-    results_addr = lv_label_create(measurements);
-    lv_label_set_text(results_addr, "Address: --");
-    lv_obj_set_pos(results_addr, 0, y); y += 70;
-
-    results_bp = lv_label_create(measurements);
-    lv_label_set_text(results_bp, "BP: --");
-    lv_obj_set_pos(results_bp, 0, y); y += 25;
-
-    results_height = lv_label_create(measurements);
-    lv_label_set_text(results_height, "Height: --");
-    lv_obj_set_pos(results_height, 0, y); y += 25;
-
-    results_weight = lv_label_create(measurements);
-    lv_label_set_text(results_weight, "Weight: --");
-    lv_obj_set_pos(results_weight, 0, y); y += 25;
-
-    results_temp = lv_label_create(measurements);
-    lv_label_set_text(results_temp, "Temp: --");
-    lv_obj_set_pos(results_temp, 0, y); y += 25;
-
-    results_hr = lv_label_create(measurements);
-    lv_label_set_text(results_hr, "HR: --");
-    lv_obj_set_pos(results_hr, 0, y); y += 25;
-
-    results_bmi = lv_label_create(measurements);
-    lv_label_set_text(results_bmi, "BMI: --");
-    lv_obj_set_pos(results_bmi, 0, y); y += 25;
-
-    results_bmi_cat = lv_label_create(measurements);
-    lv_label_set_text(results_bmi_cat, "Category: --");
-    lv_obj_set_pos(results_bmi_cat, 0, y);
+    // Result labels; their text comes from update_results_screen()
+    for (uint8_t i = 0; i < RF_COUNT; i++) {
+        ResultField &f = resultFields[i];
+        f.label = lv_label_create(measurements);
+        lv_obj_set_style_text_font(f.label, &lv_font_montserrat_20, 0);
+        lv_obj_set_pos(f.label, 0, y);
+        y += f.gapAfter;
+        f.shown[0] = '\0';
+    }
+    update_results_screen();
 
     // Button row at bottom
     lv_obj_t *btn_row = lv_obj_create(scr_results);
@@ -851,31 +1633,11 @@ void create_results_screen() {
     lv_obj_center(print_lbl);
     lv_obj_add_event_cb(btn_print, [](lv_event_t*) {
         if (!printerConnected) {
-            lv_obj_t *msg = lv_obj_create(lv_layer_top());
-            lv_obj_set_size(msg, 300, 80);
-            lv_obj_center(msg);
-            lv_obj_set_style_bg_color(msg, lv_color_hex(0xEF4444), 0);
-            lv_obj_set_style_radius(msg, 10, 0);
-            lv_obj_t *txt = lv_label_create(msg);
-            lv_label_set_text(txt, "Printer not connected!");
-            lv_obj_set_style_text_font(txt, &lv_font_montserrat_14, 0);
-            lv_obj_center(txt);
-            delay(2000);
-            lv_obj_del(msg);
+            toastShow("Printer not connected!", TOAST_ERROR);
             return;
         }
         thermalPrinter.printHealthReport(healthData);
-        lv_obj_t *msg = lv_obj_create(lv_layer_top());
-        lv_obj_set_size(msg, 300, 80);
-        lv_obj_center(msg);
-        lv_obj_set_style_bg_color(msg, lv_color_hex(0x10B981), 0);
-        lv_obj_set_style_radius(msg, 10, 0);
-        lv_obj_t *txt = lv_label_create(msg);
-        lv_label_set_text(txt, "✓ Report sent");
-        lv_obj_set_style_text_font(txt, &lv_font_montserrat_14, 0);
-        lv_obj_center(txt);
-        delay(1500);
-        lv_obj_del(msg);
+        toastShow("✓ Report sent", TOAST_SUCCESS, 1500);
     }, LV_EVENT_CLICKED, NULL);
 
     // Done button (saves and exits)
@@ -886,36 +1648,187 @@ void create_results_screen() {
     lv_label_set_text(done_lbl, "DONE");
     lv_obj_set_style_text_font(done_lbl, &lv_font_montserrat_18, 0);
     lv_obj_center(done_lbl);
+    // The checkup and its journal are only let go once the record is on the
+    // card; otherwise the results stay up so DONE can be tapped again (the
+    // card may still be mounting just after boot).
     lv_obj_add_event_cb(btn_done, [](lv_event_t*) {
-        if (sdCardInitialized) {
-            struct tm timeinfo;
-            if (getLocalTime(&timeinfo)) {
-                char ts[64];
-                strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", &timeinfo);
-                healthData.timestamp = String(ts);
-            } else {
-                healthData.timestamp = String(millis()/1000);
-            }
-            if (saveHealthData(healthData.toCSV())) {
-                lv_obj_t *msg = lv_obj_create(lv_layer_top());
-                lv_obj_set_size(msg, 250, 60);
-                lv_obj_center(msg);
-                lv_obj_set_style_bg_color(msg, lv_color_hex(0x10B981), 0);
-                lv_obj_set_style_radius(msg, 10, 0);
-                lv_obj_t *txt = lv_label_create(msg);
-                lv_label_set_text(txt, "Data saved");
-                lv_obj_set_style_text_font(txt, &lv_font_montserrat_14, 0);
-                lv_obj_center(txt);
-                delay(1000);
-                lv_obj_del(msg);
-            }
+        if (!sdCardInitialized) {
+            toastShow("✗ SD card not ready - try again", TOAST_ERROR);
+            return;
+        }
+        struct tm timeinfo;
+        if (getLocalTime(&timeinfo)) {
+            char ts[64];
+            strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", &timeinfo);
+            healthData.timestamp = String(ts);
+        } else {
+            healthData.timestamp = String(millis()/1000);
+        }
+        RecordPos at;
+        if (!saveHealthData(healthData, &at)) {
+            toastShow("✗ Save failed - try again", TOAST_ERROR);
+            return;
         }
+        patientsNoteSaved(healthData.name.c_str(), at);
+        toastShow("Data saved", TOAST_SUCCESS, 1000);   // stays up over the welcome screen
+        journalClear();
         healthData = HealthData();
         switch_scr(scr_welcome);
     }, LV_EVENT_CLICKED, NULL);
 }
 
 /* ==================== DATA VIEW SCREEN ==================== */
+// Paged record viewer. Rows are a fixed pool of label objects created once;
+// browsing only rewrites their text from the record store, so thousands of
+// records page as fast as one. Swipe pages, fling scrolls kinetically and a
+// two-finger pinch changes how many rows fit on a page.
+#define DATA_VIEW_COLS     12
+#define DATA_VIEW_ROWS_MAX 10
+#define DATA_VIEW_FLING_MS 40
+
+struct DataViewZoom {
+    uint8_t rows;
+    uint8_t rowHeight;
+    const lv_font_t *font;
+};
+
+static const DataViewZoom DATA_VIEW_ZOOM[] = {
+    {10, 26, &lv_font_montserrat_12},
+    {7,  35, &lv_font_montserrat_14},
+    {5,  50, &lv_font_montserrat_18},
+};
+#define DATA_VIEW_ZOOM_LEVELS (sizeof(DATA_VIEW_ZOOM) / sizeof(DATA_VIEW_ZOOM[0]))
+
+static const int DATA_VIEW_COL_WIDTHS[DATA_VIEW_COLS] = {120, 100, 50, 70, 150, 70, 70, 70, 70, 60, 80, 80};
+
+static lv_obj_t *dv_rows[DATA_VIEW_ROWS_MAX];
+static lv_obj_t *dv_cells[DATA_VIEW_ROWS_MAX][DATA_VIEW_COLS];
+static lv_obj_t *dv_page_label = NULL;
+static uint8_t dv_zoom = 1;
+static int8_t dv_zoom_base = -1;     // zoom level when the current pinch began
+static uint32_t dv_first = 0;        // index of the top row, 0 = newest record
+static uint8_t dv_filled = 0;
+static lv_timer_t *dv_fling_timer = NULL;
+static float dv_fling_pos = 0;       // fractional row position while flinging
+static float dv_fling_velocity = 0;  // rows per second
+
+static void data_view_fill_row(const char *line, uint32_t index, void *ctx) {
+    if (dv_filled >= DATA_VIEW_ZOOM[dv_zoom].rows) return;
+    // Quoted fields may contain commas – split with the CSV codec
+    char buf[RECORD_CSV_MAX];
+    strlcpy(buf, line, sizeof(buf));
+    char *fields[DATA_VIEW_COLS];
+    int fieldCount = splitCSV(buf, fields, DATA_VIEW_COLS);
+    for (int f = fieldCount; f < DATA_VIEW_COLS; f++) fields[f] = (char *)"";
+
+    lv_obj_t *row = dv_rows[dv_filled++];
+    lv_obj_set_style_bg_color(row, index % 2 ? lv_color_hex(0x1E293B) : lv_color_hex(0x0F172A), 0);
+    lv_obj_clear_flag(row, LV_OBJ_FLAG_HIDDEN);
+    for (int col = 0; col < DATA_VIEW_COLS; col++) {
+        lv_label_set_text(dv_cells[dv_filled - 1][col], fields[col]);
+    }
+}
+
+void data_view_show(uint32_t first) {
+    if (!scr_data_view) return;
+    uint32_t total = storageRecordCount();
+    uint8_t rows = DATA_VIEW_ZOOM[dv_zoom].rows;
+    uint32_t last = total > rows ? total - rows : 0;
+    dv_first = min(first, last);
+
+    dv_filled = 0;
+    storageReadNewest(dv_first, rows, data_view_fill_row, NULL);
+    for (uint8_t r = dv_filled; r < DATA_VIEW_ROWS_MAX; r++) {
+        lv_obj_add_flag(dv_rows[r], LV_OBJ_FLAG_HIDDEN);
+    }
+
+    if (total == 0) {
+        lv_label_set_text(dv_page_label, "No records");
+    } else {
+        lv_label_set_text_fmt(dv_page_label, "Records %lu-%lu of %lu  (page %lu/%lu)",
+                              (unsigned long)dv_first + 1, (unsigned long)(dv_first + dv_filled),
+                              (unsigned long)total, (unsigned long)(dv_first / rows + 1),
+                              (unsigned long)((total + rows - 1) / rows));
+    }
+}
+
+static void data_view_apply_zoom() {
+    const DataViewZoom &z = DATA_VIEW_ZOOM[dv_zoom];
+    int yPos = 45;
+    for (uint8_t r = 0; r < DATA_VIEW_ROWS_MAX; r++) {
+        lv_obj_set_size(dv_rows[r], 730, z.rowHeight);
+        lv_obj_set_pos(dv_rows[r], 10, yPos);
+        for (int col = 0; col < DATA_VIEW_COLS; col++) {
+            lv_obj_set_style_text_font(dv_cells[r][col], z.font, 0);
+            lv_obj_set_height(dv_cells[r][col], z.rowHeight);
+        }
+        yPos += z.rowHeight + 5;
+    }
+}
+
+static void data_view_fling_cb(lv_timer_t *t) {
+    dv_fling_pos += dv_fling_velocity * DATA_VIEW_FLING_MS / 1000.0f;
+    dv_fling_velocity *= 0.9f;
+    if (dv_fling_pos < 0) { dv_fling_pos = 0; dv_fling_velocity = 0; }
+
+    uint32_t row = (uint32_t)(dv_fling_pos + 0.5f);
+    if (row != dv_first) {
+        data_view_show(row);
+        if (row != dv_first) dv_fling_velocity = 0;   // hit the oldest record
+    }
+
+    if (fabsf(dv_fling_velocity) < 2.0f || lv_scr_act() != scr_data_view) {
+        dv_fling_velocity = 0;
+        lv_timer_pause(t);
+    }
+}
+
+static void data_view_gesture(const Gesture &g) {
+    if (lv_scr_act() != scr_data_view) return;
+    uint8_t rows = DATA_VIEW_ZOOM[dv_zoom].rows;
+
+    switch (g.type) {
+        case GESTURE_DOWN:
+            dv_fling_velocity = 0;
+            lv_timer_pause(dv_fling_timer);
+            break;
+        case GESTURE_SWIPE_UP:
+        case GESTURE_SWIPE_LEFT:
+            data_view_show(dv_first + rows);
+            break;
+        case GESTURE_SWIPE_DOWN:
+        case GESTURE_SWIPE_RIGHT:
+            data_view_show(dv_first > rows ? dv_first - rows : 0);
+            break;
+        case GESTURE_FLING:
+            if (abs(g.vx) > abs(g.vy)) {
+                data_view_show(g.vx < 0 ? dv_first + rows : (dv_first > rows ? dv_first - rows : 0));
+                break;
+            }
+            // Finger up = towards older records
+            dv_fling_pos = dv_first;
+            dv_fling_velocity = -(float)g.vy / (DATA_VIEW_ZOOM[dv_zoom].rowHeight + 5);
+            lv_timer_resume(dv_fling_timer);
+            break;
+        case GESTURE_ZOOM: {
+            // One zoom level per pinch, relative to where the pinch started
+            if (dv_zoom_base < 0) dv_zoom_base = dv_zoom;
+            int zoom = dv_zoom_base;
+            if (g.scale_pct >= 125) zoom++;
+            else if (g.scale_pct <= 80) zoom--;
+            zoom = constrain(zoom, 0, (int)DATA_VIEW_ZOOM_LEVELS - 1);
+            if (zoom == dv_zoom) break;
+            dv_zoom = zoom;
+            data_view_apply_zoom();
+            data_view_show(dv_first);
+            break;
+        }
+        case GESTURE_ZOOM_END:
+            dv_zoom_base = -1;
+            break;
+    }
+}
+
 void create_data_view_screen() {
     scr_data_view = lv_obj_create(NULL);
     lv_obj_set_style_bg_color(scr_data_view, lv_color_hex(0x0F172A), 0);
@@ -927,82 +1840,64 @@ void create_data_view_screen() {
     lv_obj_set_style_text_color(title, lv_color_hex(0x3B82F6), 0);
     lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 30);
 
+    dv_page_label = lv_label_create(scr_data_view);
+    lv_obj_set_style_text_font(dv_page_label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(dv_page_label, lv_color_hex(0x94A3B8), 0);
+    lv_obj_align(dv_page_label, LV_ALIGN_TOP_MID, 0, 65);
+
     lv_obj_t *table_container = lv_obj_create(scr_data_view);
     lv_obj_set_size(table_container, 750, 350);
     lv_obj_align(table_container, LV_ALIGN_CENTER, 0, 0);
     lv_obj_set_style_border_width(table_container, 0, 0);
     lv_obj_set_style_bg_opa(table_container, LV_OPA_TRANSP, 0);
-
-    String data = readHealthData();
-    String lines[50];
-    int lineCount = 0;
-    int startIdx = 0;
-    for (int i = 0; i < data.length(); i++) {
-        if (data.charAt(i) == '\n') {
-            lines[lineCount++] = data.substring(startIdx, i);
-            startIdx = i + 1;
-            if (lineCount >= 49) break;
-        }
-    }
+    // Paging is done by the gesture handler, not by scrolling
+    lv_obj_clear_flag(table_container, LV_OBJ_FLAG_SCROLLABLE);
 
     const char* headers[] = {"Timestamp", "Name", "Age", "Gender", "Address", "Weight", "Height", "Temp", "BMI", "HR", "BP Sys", "BP Dia"};
-    const int colWidths[] = {120, 100, 50, 70, 150, 70, 70, 70, 70, 60, 80, 80};
-
-    int yPos = 0;
 
     // Header row
     lv_obj_t *header_row = lv_obj_create(table_container);
     lv_obj_set_size(header_row, 730, 40);
-    lv_obj_set_pos(header_row, 10, yPos);
+    lv_obj_set_pos(header_row, 10, 0);
     lv_obj_set_style_bg_color(header_row, lv_color_hex(0x1E293B), 0);
     lv_obj_set_style_border_width(header_row, 0, 0);
 
     int xPos = 0;
-    for (int col = 0; col < 12; col++) {
+    for (int col = 0; col < DATA_VIEW_COLS; col++) {
         lv_obj_t *h = lv_label_create(header_row);
         lv_label_set_text(h, headers[col]);
         lv_obj_set_style_text_font(h, &lv_font_montserrat_14, 0);
         lv_obj_set_style_text_color(h, lv_color_hex(0x3B82F6), 0);
-        lv_obj_set_size(h, colWidths[col], 40);
+        lv_obj_set_size(h, DATA_VIEW_COL_WIDTHS[col], 40);
         lv_obj_set_pos(h, xPos, 0);
-        xPos += colWidths[col];
+        xPos += DATA_VIEW_COL_WIDTHS[col];
     }
 
-    yPos += 45;
-
-    // Data rows (max 8)
-    for (int row = 1; row < lineCount && row < 8; row++) {
-        String fields[12];
-        int fieldIdx = 0;
-        int start = 0;
-        String line = lines[row];
-        for (int i = 0; i < line.length(); i++) {
-            if (line.charAt(i) == ',') {
-                fields[fieldIdx++] = line.substring(start, i);
-                start = i + 1;
-                if (fieldIdx >= 11) break;
-            }
-        }
-        fields[fieldIdx] = line.substring(start);
-
+    // Row pool, filled by data_view_show()
+    for (uint8_t r = 0; r < DATA_VIEW_ROWS_MAX; r++) {
         lv_obj_t *data_row = lv_obj_create(table_container);
-        lv_obj_set_size(data_row, 730, 35);
-        lv_obj_set_pos(data_row, 10, yPos);
-        lv_obj_set_style_bg_color(data_row, row % 2 == 0 ? lv_color_hex(0x1E293B) : lv_color_hex(0x0F172A), 0);
         lv_obj_set_style_border_width(data_row, 0, 0);
+        lv_obj_clear_flag(data_row, LV_OBJ_FLAG_SCROLLABLE);
+        dv_rows[r] = data_row;
 
         xPos = 0;
-        for (int col = 0; col < 12; col++) {
+        for (int col = 0; col < DATA_VIEW_COLS; col++) {
             lv_obj_t *cell = lv_label_create(data_row);
-            lv_label_set_text(cell, fields[col].c_str());
-            lv_obj_set_style_text_font(cell, &lv_font_montserrat_14, 0);
+            lv_label_set_text(cell, "");
             lv_obj_set_style_text_color(cell, lv_color_hex(0xE2E8F0), 0);
-            lv_obj_set_size(cell, colWidths[col], 35);
+            lv_obj_set_width(cell, DATA_VIEW_COL_WIDTHS[col]);
             lv_obj_set_pos(cell, xPos, 0);
-            xPos += colWidths[col];
+            xPos += DATA_VIEW_COL_WIDTHS[col];
+            dv_cells[r][col] = cell;
         }
-        yPos += 40;
     }
+    data_view_apply_zoom();
+
+    if (!dv_fling_timer) {
+        dv_fling_timer = lv_timer_create(data_view_fling_cb, DATA_VIEW_FLING_MS, NULL);
+        lv_timer_pause(dv_fling_timer);
+    }
+    gestureSetHandler(data_view_gesture);
 
     // Button container
     lv_obj_t *btn_container = lv_obj_create(scr_data_view);
@@ -1023,9 +1918,7 @@ void create_data_view_screen() {
     lv_obj_set_style_text_font(load_lbl, &lv_font_montserrat_14, 0);
     lv_obj_center(load_lbl);
     lv_obj_add_event_cb(btn_load, [](lv_event_t*) {
-        lv_obj_del(scr_data_view);
-        create_data_view_screen();
-        lv_scr_load(scr_data_view);
+        data_view_show(0);
     }, LV_EVENT_CLICKED, NULL);
 
     // Clear all
@@ -1039,20 +1932,8 @@ void create_data_view_screen() {
     lv_obj_center(clear_lbl);
     lv_obj_add_event_cb(btn_clear, [](lv_event_t*) {
         if (deleteHealthData()) {
-            lv_obj_t *msg = lv_obj_create(lv_layer_top());
-            lv_obj_set_size(msg, 300, 80);
-            lv_obj_center(msg);
-            lv_obj_set_style_bg_color(msg, lv_color_hex(0x10B981), 0);
-            lv_obj_set_style_radius(msg, 10, 0);
-            lv_obj_t *txt = lv_label_create(msg);
-            lv_label_set_text(txt, "✓ All data cleared!");
-            lv_obj_set_style_text_font(txt, &lv_font_montserrat_14, 0);
-            lv_obj_center(txt);
-            delay(2000);
-            lv_obj_del(msg);
-            lv_obj_del(scr_data_view);
-            create_data_view_screen();
-            lv_scr_load(scr_data_view);
+            toastShow("✓ All data cleared!", TOAST_SUCCESS);
+            data_view_show(0);
         }
     }, LV_EVENT_CLICKED, NULL);
 
@@ -1067,6 +1948,17 @@ void create_data_view_screen() {
     lv_obj_add_event_cb(btn_back, [](lv_event_t*) { switch_scr(scr_welcome); }, LV_EVENT_CLICKED, NULL);
 }
 
+void update_welcome_sd_status() {
+    if (!sd_status_label) return;
+    if (sdCardInitialized) {
+        lv_label_set_text(sd_status_label, "SD Card: Ready");
+        lv_obj_set_style_text_color(sd_status_label, lv_color_hex(0x10B981), 0);
+    } else {
+        lv_label_set_text(sd_status_label, "SD Card: Not Found");
+        lv_obj_set_style_text_color(sd_status_label, lv_color_hex(0xEF4444), 0);
+    }
+}
+
 void update_welcome_printer_status() {
     if (!printer_status_label) return;
     if (printerConnected) {
@@ -1081,14 +1973,367 @@ void update_welcome_printer_status() {
 }
 
 void show_report() {
+    get_screen(SCR_RESULTS);
     update_results_screen();
     lv_scr_load(scr_results);
 }
 
+lv_obj_t *get_screen(ScreenId id) {
+    switch (id) {
+        case SCR_WELCOME:
+            if (!scr_welcome) create_welcome_screen();
+            return scr_welcome;
+        case SCR_INFO:
+            if (!scr_info) create_info_screen();
+            return scr_info;
+        case SCR_BP:
+            if (!scr_bp) create_bp_screen();
+            return scr_bp;
+        case SCR_HEIGHT:
+        case SCR_WEIGHT:
+        case SCR_TEMP:
+        case SCR_PULSE: {
+            // Sensor screens follow each other in table order, then results
+            uint8_t s = id - SCR_HEIGHT + HUB_SENSOR_HEIGHT;
+            if (!sensorScreens[s].screen)
+                create_sensor_scr(sensorDescriptor(s), s < SENSOR_COUNT ? (ScreenId)(id + 1) : SCR_RESULTS);
+            return sensorScreens[s].screen;
+        }
+        case SCR_RESULTS:
+            if (!scr_results) create_results_screen();
+            return scr_results;
+        case SCR_DASHBOARD:
+            if (!scr_dashboard) create_dashboard_screen();
+            return scr_dashboard;
+        case SCR_CALIBRATION:
+            if (!scr_calibration) create_calibration_screen();
+            return scr_calibration;
+    }
+    return scr_welcome;
+}
+
+/* ==================== SESSION RECOVERY ==================== */
+// Continue at the first step that wasn't completed before the reset
+void resume_session() {
+    static const ScreenId stepScreens[MEASURE_STEPS] = {SCR_BP, SCR_HEIGHT, SCR_WEIGHT, SCR_TEMP, SCR_PULSE};
+    for (int i = 0; i < MEASURE_STEPS; i++) {
+        if (!measureFlow.isDone(i)) {
+            switch_scr(stepScreens[i]);
+            return;
+        }
+    }
+    show_report();
+}
+
+// Modal: the backdrop takes every tap outside the panel, so no checkup can
+// be started behind the prompt. Both buttons still check that the journal
+// holds the session offered before acting on it.
+void show_resume_prompt() {
+    HealthData saved;
+    bool done[5];
+    if (!journalRestore(saved, done)) return;
+
+    lv_obj_t *backdrop = lv_obj_create(lv_layer_top());
+    lv_obj_set_size(backdrop, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_style_bg_color(backdrop, lv_color_hex(0x000000), 0);
+    lv_obj_set_style_bg_opa(backdrop, LV_OPA_70, 0);
+    lv_obj_set_style_border_width(backdrop, 0, 0);
+    lv_obj_set_style_radius(backdrop, 0, 0);
+    lv_obj_clear_flag(backdrop, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_t *panel = lv_obj_create(backdrop);
+    lv_obj_set_size(panel, 420, 220);
+    lv_obj_center(panel);
+    lv_obj_set_style_bg_color(panel, lv_color_hex(0x1E293B), 0);
+    lv_obj_set_style_border_width(panel, 0, 0);
+    lv_obj_set_style_radius(panel, 10, 0);
+
+    lv_obj_t *txt = lv_label_create(panel);
+    lv_label_set_text_fmt(txt, "Unfinished checkup for\n%s\n\nResume where you left off?",
+                          saved.name.length() ? saved.name.c_str() : "(no name)");
+    lv_obj_set_style_text_font(txt, &lv_font_montserrat_18, 0);
+    lv_obj_set_style_text_color(txt, lv_color_hex(0xFFFFFF), 0);
+    lv_obj_set_style_text_align(txt, LV_TEXT_ALIGN_CENTER, 0);
+    lv_obj_align(txt, LV_ALIGN_TOP_MID, 0, 0);
+
+    lv_obj_t *resume = lv_btn_create(panel);
+    lv_obj_set_size(resume, 150, 50);
+    lv_obj_align(resume, LV_ALIGN_BOTTOM_LEFT, 10, 0);
+    lv_obj_set_style_bg_color(resume, lv_color_hex(0x10B981), 0);
+    lv_obj_t *resume_lbl = lv_label_create(resume);
+    lv_label_set_text(resume_lbl, "RESUME");
+    lv_obj_set_style_text_font(resume_lbl, &lv_font_montserrat_18, 0);
+    lv_obj_center(resume_lbl);
+    lv_obj_add_event_cb(resume, [](lv_event_t *e) {
+        lv_obj_del((lv_obj_t *)lv_event_get_user_data(e));
+        bool done[MEASURE_STEPS];
+        if (!journalRestore(healthData, done)) {
+            toastShow("Session no longer available", TOAST_INFO);
+            return;
+        }
+        measureFlow.restore(done);
+        resume_session();
+    }, LV_EVENT_CLICKED, backdrop);
+
+    lv_obj_t *discard = lv_btn_create(panel);
+    lv_obj_set_size(discard, 150, 50);
+    lv_obj_align(discard, LV_ALIGN_BOTTOM_RIGHT, -10, 0);
+    lv_obj_set_style_bg_color(discard, lv_color_hex(0xEF4444), 0);
+    lv_obj_t *discard_lbl = lv_label_create(discard);
+    lv_label_set_text(discard_lbl, "DISCARD");
+    lv_obj_set_style_text_font(discard_lbl, &lv_font_montserrat_18, 0);
+    lv_obj_center(discard_lbl);
+    lv_obj_add_event_cb(discard, [](lv_event_t *e) {
+        lv_obj_del((lv_obj_t *)lv_event_get_user_data(e));
+        // Only the offered session; a newer one has its own journal entries
+        if (journalHasSession()) journalClear();
+    }, LV_EVENT_CLICKED, backdrop);
+}
+
+/* ==================== BOOT ==================== */
+// Phase timestamps are buffered and printed once boot completes, so logging
+// never sits on the path to the first frame.
+struct BootMark {
+    const char *phase;
+    uint32_t ms;
+};
+static BootMark bootMarks[12];
+static uint8_t bootMarkCount = 0;
+static portMUX_TYPE bootMarkMux = portMUX_INITIALIZER_UNLOCKED;
+
+static volatile bool sdInitDone = false;
+static volatile bool bleInitDone = false;
+
+void boot_mark(const char *phase) {
+    portENTER_CRITICAL(&bootMarkMux);
+    if (bootMarkCount < sizeof(bootMarks) / sizeof(bootMarks[0])) {
+        bootMarks[bootMarkCount].phase = phase;
+        bootMarks[bootMarkCount].ms = millis();
+        bootMarkCount++;
+    }
+    portEXIT_CRITICAL(&bootMarkMux);
+}
+
+void boot_report() {
+    Serial.println("=== Boot timeline ===");
+    for (uint8_t i = 0; i < bootMarkCount; i++) {
+        Serial.printf("[boot] %-12s %5lu ms\n", bootMarks[i].phase, (unsigned long)bootMarks[i].ms);
+    }
+}
+
+// SD probe and BLE stack bring-up are slow and independent of the panel, so
+// each runs on its own task on core 0 while the UI is already interactive.
+// Mounting the SD card runs the record store's index rebuild and segment
+// scans (a few KB of locals) on top of the FATFS call chain; each task logs
+// the stack it never touched, to size these against.
+#define SD_INIT_STACK  8192
+#define BLE_INIT_STACK 6144
+
+static void log_stack_left(const char *task) {
+    Serial.printf("[boot] %s stack: %u bytes never used\n", task,
+                  (unsigned)uxTaskGetStackHighWaterMark(NULL));
+}
+
+static void sd_init_task(void *) {
+    sdCardInitialized = initSDCard();
+    boot_mark("sd");
+    log_stack_left("sd_init");
+    sdInitDone = true;
+    vTaskDelete(NULL);
+}
+
+static void ble_init_task(void *) {
+    printerInitialized = thermalPrinter.begin();
+    if (printerInitialized) {
+        Serial.println("✓ Printer BLE initialized");
+    } else {
+        Serial.println("✗ Printer BLE init failed");
+    }
+    boot_mark("ble");
+    log_stack_left("ble_init");
+    bleInitDone = true;
+    vTaskDelete(NULL);
+}
+
+/* ==================== UI CALLBACK BUDGET ==================== */
+// Touch-driven event callbacks run inside LVGL's input read timer, so timing
+// that timer catches any callback that blocks the UI and hub ingest. Over
+// UI_CALLBACK_BUDGET_MS is logged as it happens.
+
+static uint32_t uiCallbackOverruns = 0;
+static uint32_t uiCallbackWorstUs = 0;
+
+static void timed_indev_read_cb(lv_timer_t *t) {
+    uint32_t t0 = micros();
+    lv_indev_read_timer_cb(t);
+    uint32_t us = micros() - t0;
+    loopBlame(LS_INPUT, us);
+    if (us > uiCallbackWorstUs) uiCallbackWorstUs = us;
+    if (us > UI_CALLBACK_BUDGET_MS * 1000UL) {
+        uiCallbackOverruns++;
+        Serial.printf("✗ UI: input callback took %lu ms (budget %d ms)\n",
+                      (unsigned long)(us / 1000), UI_CALLBACK_BUDGET_MS);
+    }
+}
+
+/* ==================== SOAK BENCHMARK ==================== */
+// SOAK <n> runs n complete checkups through the real capture, results,
+// storage and print code. Readings come from the hub simulator, records go
+// to a scratch store (/soak, wiped afterwards) and the printer runs dry with
+// its usual pacing. Each checkup ends the way DONE does, with a toast, and
+// one LVGL cycle to show it. Reports p50/p99 per stage and fails if free
+// heap keeps shrinking after warm-up or the toast stage misses the UI
+// callback budget.
+#define SOAK_MAX_CHECKUPS    100000
+#define SOAK_HEAP_TOLERANCE  4096   // bytes of system heap loss allowed
+#define SOAK_LVGL_TOLERANCE  1024   // bytes of LVGL pool loss allowed
+
+enum SoakStage { SOAK_CAPTURE, SOAK_RESULTS, SOAK_SAVE, SOAK_PRINT, SOAK_TOAST, SOAK_TOTAL, SOAK_STAGES };
+static const char *const SOAK_STAGE_NAMES[SOAK_STAGES] = {"capture", "results", "save", "print", "toast", "total"};
+
+static LatencyHistogram soakLatency[SOAK_STAGES];
+static HeapTrend soakHeap, soakLvgl;
+
+static void soakSink(const uint8_t *bytes, size_t len, void *ctx) {
+    FrameDecoder *decoder = (FrameDecoder *)ctx;
+    for (size_t i = 0; i < len; i++) decoder->push(bytes[i], onHubFrame, NULL);
+}
+
+static void soakSend(const uint8_t *bytes, size_t len, void *ctx) {
+    ((SimEngine *)ctx)->command(bytes, len);
+}
+
+// One checkup's worth of hub traffic through measureFlow and the real frame
+// handler; measureFlow is linked to the benchmark's own simulator
+static void soak_capture(SimEngine &engine, FrameDecoder &decoder, uint32_t i) {
+    measureFlow.reset(engine.now());
+    healthData = HealthData();
+    healthData.name = "Soak " + String(i);
+    healthData.age = String(20 + i % 60);
+    healthData.gender = (i & 1) ? "Female" : "Male";
+    healthData.address = "Benchmark Street " + String(i % 100);
+    healthData.timestamp = "2024-01-01 00:00:00";
+    healthData.bp_sys = 110 + i % 30;
+    healthData.bp_dia = 70 + i % 20;
+    healthData.bp_measured = true;
+    measureFlow.markDone(MEASURE_STEP_BP);
+
+    for (uint8_t sensor = HUB_SENSOR_HEIGHT; sensor <= HUB_SENSOR_PULSE; sensor++) {
+        measureFlow.start(sensor, engine.now());
+        engine.advance(2000, soakSink, &decoder);
+        measureFlow.capture(engine.now());
+    }
+    uint8_t measure = CMD_MEASURE;
+    engine.command(&measure, 1);
+    engine.advance(engine.scenario().measure_ms, soakSink, &decoder);
+}
+
+static uint32_t lvgl_free_bytes() {
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.free_size;
+}
+
+static void cmdSoak(const char *args) {
+    long n = atol(args);
+    if (n <= 0) n = 100;
+    if (n > SOAK_MAX_CHECKUPS) n = SOAK_MAX_CHECKUPS;
+    if (!sdCardInitialized) {
+        Serial.println("✗ SOAK: SD card not ready");
+        return;
+    }
+
+    // A checkup may be in progress; the benchmark borrows its state and link
+    measureFlow.cancel(millis());
+    HealthData saved = healthData;
+    bool savedDone[MEASURE_STEPS];
+    memcpy(savedDone, measureFlow.doneFlags(), sizeof(savedDone));
+    get_screen(SCR_RESULTS);
+    journalPause(true);   // the soak records are not a session to resume
+    storageSelect("/soak");
+    thermalPrinter.setDryRun(true);
+
+    SimScenario scenario;
+    simDefaultScenario(scenario);
+    SimEngine engine;
+    engine.begin(scenario);
+    FrameDecoder decoder;
+    measureFlow.setLink(soakSend, &engine);
+
+    for (int s = 0; s < SOAK_STAGES; s++) soakLatency[s].reset();
+    soakHeap.reset(n);
+    soakLvgl.reset(n);
+    uint32_t saveFailures = 0;
+    unsigned long started = millis();
+    Serial.printf("SOAK: %ld checkups\n", n);
+
+    for (long i = 0; i < n; i++) {
+        uint32_t t0 = micros();
+        soak_capture(engine, decoder, i);
+        uint32_t t1 = micros();
+        update_results_screen();
+        uint32_t t2 = micros();
+        if (!saveHealthData(healthData)) saveFailures++;
+        uint32_t t3 = micros();
+        thermalPrinter.printHealthReport(healthData);
+        uint32_t t4 = micros();
+        toastShow("Data saved", TOAST_SUCCESS, 1000);
+        lv_timer_handler();   // draws the toast, retires old ones, housekeeping
+        uint32_t t5 = micros();
+        loopFeed();
+
+        soakLatency[SOAK_CAPTURE].add(t1 - t0);
+        soakLatency[SOAK_RESULTS].add(t2 - t1);
+        soakLatency[SOAK_SAVE].add(t3 - t2);
+        soakLatency[SOAK_PRINT].add(t4 - t3);
+        soakLatency[SOAK_TOAST].add(t5 - t4);
+        soakLatency[SOAK_TOTAL].add(t5 - t0);
+
+        soakHeap.add(i, ESP.getFreeHeap());
+        soakLvgl.add(i, lvgl_free_bytes());
+
+        if ((i + 1) % 100 == 0) {
+            Serial.printf("SOAK: %ld/%ld, free heap %lu, largest block %lu\n", i + 1, n,
+                          (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMaxAllocHeap());
+        }
+    }
+
+    unsigned long elapsed = millis() - started;
+    toastClear();
+    thermalPrinter.setDryRun(false);
+    storageClear();
+    storageSelect(DATA_DIR);
+    measureFlow.setLink(measureSend, NULL);
+    measureFlow.restore(savedDone);
+    healthData = saved;
+    journalPause(false);
+
+    Serial.println("SOAK results (us)       p50       p99       max      mean");
+    for (int s = 0; s < SOAK_STAGES; s++) {
+        const LatencyHistogram &h = soakLatency[s];
+        Serial.printf("  %-10s %14lu %9lu %9lu %9lu\n", SOAK_STAGE_NAMES[s],
+                      (unsigned long)h.percentile(50), (unsigned long)h.percentile(99),
+                      (unsigned long)h.maxUs, (unsigned long)h.meanUs());
+    }
+    uint32_t mean = soakLatency[SOAK_TOTAL].meanUs();
+    Serial.printf("  %ld checkups in %lu ms, ceiling %lu checkups/hour, %lu save failures\n",
+                  n, elapsed, mean ? (unsigned long)(3600000000ULL / mean) : 0UL,
+                  (unsigned long)saveFailures);
+    soakHeap.print("heap");
+    soakLvgl.print("lvgl pool");
+
+    bool leak = soakHeap.growth() > SOAK_HEAP_TOLERANCE || soakLvgl.growth() > SOAK_LVGL_TOLERANCE;
+    bool slow = soakLatency[SOAK_TOAST].percentile(99) > UI_CALLBACK_BUDGET_MS * 1000UL;
+    if (slow) Serial.printf("  toast p99 over the %d ms UI callback budget\n", UI_CALLBACK_BUDGET_MS);
+    Serial.printf("  input callbacks since boot: worst %lu us, %lu over budget\n",
+                  (unsigned long)uiCallbackWorstUs, (unsigned long)uiCallbackOverruns);
+    Serial.println(leak || slow || saveFailures ? "SOAK: FAIL" : "SOAK: PASS");
+}
+
 /* ==================== SETUP ==================== */
 void setup() {
     Serial.begin(115200);
-    delay(1000);
+    boot_mark("start");
     Serial.println("==================================");
     Serial.println("   SMART HEALTH KIOSK (STREAMING)");
     Serial.println("==================================");
@@ -1101,18 +2346,17 @@ void setup() {
 
     ts.begin();
     ts.setRotation(DISPLAY_ROTATION);
-
+    touchBegin();
+    boot_mark("panel");
+
+    measureFlow.setLink(measureSend, NULL);
+    measureFlow.setHandler(onMeasureUpdate, NULL);
+    parallelCapture.setLink(measureSend, NULL);
+    bpCuff.setLink(bpSend, NULL);
+    bpCuff.setHandler(onBpResult, NULL);
     SerialUART.begin(UART_BAUD, SERIAL_8N1, UART_RX_PIN, UART_TX_PIN);
-    Serial.println("✓ UART ready (RX=18, TX=17)");
-
-    sdCardInitialized = initSDCard();
-
-    printerInitialized = thermalPrinter.begin();
-    if (printerInitialized) {
-        Serial.println("✓ Printer BLE initialized");
-    } else {
-        Serial.println("✗ Printer BLE init failed");
-    }
+    Serial.printf("✓ UART ready (RX=%d, TX=%d)\n", UART_RX_PIN, UART_TX_PIN);
+    driversBegin();
 
     lv_init();
     lv_tick_set_cb(millis_cb);
@@ -1124,35 +2368,89 @@ void setup() {
 
     lv_indev_t *indev = lv_indev_create();
     lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
-    lv_indev_set_read_cb(indev, my_touchpad_read);
+    lv_indev_set_read_cb(indev, touchRead);
+    lv_timer_set_cb(lv_indev_get_read_timer(indev), timed_indev_read_cb);
+    schedBegin(lv_indev_get_read_timer(indev), SerialUART);
+    powerBegin(disp, indev);
 
     kb = lv_keyboard_create(lv_layer_sys());
     lv_obj_set_size(kb, 480, 240);
     lv_obj_set_style_text_font(kb, &lv_font_montserrat_14, 0);
     lv_obj_add_event_cb(kb, kb_event_cb, LV_EVENT_ALL, NULL);
     lv_obj_add_flag(kb, LV_OBJ_FLAG_HIDDEN);
-
-    // Create screens in correct order
-    create_welcome_screen();
-    create_info_screen();
-    create_results_screen();
-    create_bp_screen();
-
-    scr_pulse  = create_sensor_scr("PULSE RATE", "❤️", "Place finger on sensor", scr_results, 4);
-    scr_temp   = create_sensor_scr("TEMPERATURE", "🌡️", "Look at thermal sensor from 5cm away", scr_pulse, 3);
-    scr_weight = create_sensor_scr("WEIGHT SCALE", "⚖️", "Step onto scale platform", scr_temp, 2);
-    scr_height = create_sensor_scr("HEIGHT SENSOR", "📏", "Stand straight under sensor", scr_weight, 1);
-
-    create_results_screen();
-    lv_scr_load(scr_welcome);
+    lv_timer_create(live_refresh_cb, LIVE_REFRESH_MS, NULL);
+    boot_mark("lvgl");
+
+    // Only the welcome screen is built up front; the rest on first use
+    lv_scr_load(get_screen(SCR_WELCOME));
+    lv_timer_handler();
+    boot_mark("interactive");
+
+    configBegin();
+    journalBegin();
+    calBegin();
+    if (journalHasSession()) show_resume_prompt();
+    exportBegin();
+    patientsBegin();
+    consoleRegister("SIM", cmdSim);
+    consoleRegister("SOAK", cmdSoak);
+    consoleRegister("STREAMS", cmdStreams);
+    consoleRegister("CAL", cmdCal);
+    consoleRegister("CONFIG", cmdConfig);
+    loopHealthBegin();
+
+    xTaskCreatePinnedToCore(sd_init_task, "sd_init", SD_INIT_STACK, NULL, 1, NULL, 0);
+    xTaskCreatePinnedToCore(ble_init_task, "ble_init", BLE_INIT_STACK, NULL, 1, NULL, 0);
     Serial.println("System ready.");
 }
 
 /* ==================== LOOP ==================== */
+// A checkup, print or calibration in progress keeps the screen on
+static bool kiosk_busy() {
+    return measureFlow.state() != MS_IDLE || parallelCapture.active() || printingInProgress ||
+           calStreamSensor != 0 || bpCuff.running();
+}
+
 void loop() {
-    lv_task_handler();
+    static uint32_t woke = 0;
+    loopMark(LS_POWER);
+    powerTick(woke, kiosk_busy());
+    loopMark(LS_LVGL);
+    uint32_t lvglDue = lv_timer_handler();
+    loopMark(LS_UART);
     processUART();
+    loopMark(LS_MEASURE);
+    measureFlow.tick(millis());
+    bpCuff.tick(millis());
+    loopMark(LS_PARALLEL);
+    parallelCapture.tick(millis());
+    loopMark(LS_CONSOLE);
+    consolePoll();
+
+    // Pick up results of the boot workers on the UI thread
+    loopMark(LS_BOOT);
+    static bool sdStatusShown = false, bleStatusShown = false;
+    if (sdInitDone && !sdStatusShown) {
+        if (sdCardInitialized) configLoadSD();
+        update_welcome_sd_status();
+        sdStatusShown = true;
+    }
+    if (bleInitDone && !bleStatusShown) {
+        update_welcome_printer_status();
+        bleStatusShown = true;
+    }
+    static bool bootReported = false;
+    if (sdStatusShown && bleStatusShown && !bootReported) {
+        boot_mark("complete");
+        boot_report();
+        bootReported = true;
+        get_screen(SCR_RESULTS);   // built while idle, so the report opens instantly
+    }
+
+    loopMark(LS_PATIENTS);
+    if (sdStatusShown && !kiosk_busy()) patientsPoll();
 
+    loopMark(LS_PRINTER);
     static unsigned long lastPrinterCheck = 0;
     if (millis() - lastPrinterCheck > 2000) {
         if (printerInitialized) {
@@ -1165,5 +2463,8 @@ void loop() {
         lastPrinterCheck = millis();
     }
 
-    delay(5);
+    loopEnd();
+    unsigned long console = consoleLastInput();
+    bool mayLightSleep = !printerConnected && (console == 0 || millis() - console > POWER_OFF_MS);
+    woke = powerIdle(lvglDue, mayLightSleep);
 }
\ No newline at end of file
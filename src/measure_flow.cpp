@@ -0,0 +1,186 @@
+#include "measure_flow.h"
+#include <string.h>
+
+/* ==================== TRANSITIONS ==================== */
+// Pairs not listed are ignored. onFail is taken when the action returns false.
+const MeasureFlow::Transition MeasureFlow::TABLE[] = {
+    //  from          event        action                     onOk          onFail
+    {MS_IDLE,      ME_START,    &MeasureFlow::actStart,    MS_WAITING,   MS_IDLE},
+    {MS_WAITING,   ME_START,    &MeasureFlow::actRestart,  MS_WAITING,   MS_IDLE},
+    {MS_STREAMING, ME_START,    &MeasureFlow::actRestart,  MS_WAITING,   MS_IDLE},
+    {MS_IDLE,      ME_SAMPLE,   &MeasureFlow::actStray,    MS_IDLE,      MS_IDLE},
+    {MS_WAITING,   ME_SAMPLE,   &MeasureFlow::actSample,   MS_STREAMING, MS_WAITING},
+    {MS_STREAMING, ME_SAMPLE,   &MeasureFlow::actSample,   MS_STREAMING, MS_STREAMING},
+    {MS_WAITING,   ME_CAPTURE,  &MeasureFlow::actCapture,  MS_IDLE,      MS_IDLE},
+    {MS_STREAMING, ME_CAPTURE,  &MeasureFlow::actCapture,  MS_IDLE,      MS_IDLE},
+    {MS_WAITING,   ME_CANCEL,   &MeasureFlow::actCancel,   MS_IDLE,      MS_IDLE},
+    {MS_STREAMING, ME_CANCEL,   &MeasureFlow::actCancel,   MS_IDLE,      MS_IDLE},
+    {MS_WAITING,   ME_NO_DATA,  &MeasureFlow::actRetry,    MS_WAITING,   MS_IDLE},
+    {MS_STREAMING, ME_NO_DATA,  &MeasureFlow::actRetry,    MS_WAITING,   MS_IDLE},
+    {MS_WAITING,   ME_EXPIRED,  &MeasureFlow::actExpire,   MS_IDLE,      MS_IDLE},
+    {MS_STREAMING, ME_EXPIRED,  &MeasureFlow::actExpire,   MS_IDLE,      MS_IDLE},
+};
+
+MeasureFlow::MeasureFlow()
+    : stopsSent(0), retriesSent(0), sendFn(NULL), sendCtx(NULL), updateFn(NULL), updateCtx(NULL),
+      current(MS_IDLE), active(0), attempts(0), haveSample(false), latestValue(0),
+      startedAt(0), lastActivity(0), lastStop(0), stopSent(false) {
+    memset(done, 0, sizeof(done));
+}
+
+void MeasureFlow::setLink(MeasureSendFn send, void* ctx) {
+    sendFn = send;
+    sendCtx = ctx;
+}
+
+void MeasureFlow::setHandler(MeasureUpdateFn handler, void* ctx) {
+    updateFn = handler;
+    updateCtx = ctx;
+}
+
+void MeasureFlow::dispatch(const Input& in) {
+    for (size_t i = 0; i < sizeof(TABLE) / sizeof(TABLE[0]); i++) {
+        const Transition& t = TABLE[i];
+        if (t.from != current || t.event != in.event) continue;
+        current = (this->*t.action)(in) ? t.onOk : t.onFail;
+        return;
+    }
+}
+
+/* ==================== INPUTS ==================== */
+void MeasureFlow::start(uint8_t sensor, uint32_t now) {
+    Input in = {ME_START, sensor, 0, now};
+    dispatch(in);
+}
+
+void MeasureFlow::sample(uint8_t sensor, float value, uint32_t now) {
+    Input in = {ME_SAMPLE, sensor, value, now};
+    dispatch(in);
+}
+
+void MeasureFlow::capture(uint32_t now) {
+    Input in = {ME_CAPTURE, active, 0, now};
+    dispatch(in);
+}
+
+void MeasureFlow::cancel(uint32_t now) {
+    Input in = {ME_CANCEL, active, 0, now};
+    dispatch(in);
+}
+
+void MeasureFlow::tick(uint32_t now) {
+    if (current == MS_IDLE) return;
+    Input in = {ME_NO_DATA, active, 0, now};
+    uint32_t quiet = current == MS_WAITING ? MEASURE_FIRST_SAMPLE_MS : MEASURE_SAMPLE_GAP_MS;
+    if (now - startedAt >= MEASURE_MAX_STREAM_MS) in.event = ME_EXPIRED;
+    else if (now - lastActivity < quiet) return;
+    dispatch(in);
+}
+
+/* ==================== STEPS ==================== */
+void MeasureFlow::reset(uint32_t now) {
+    cancel(now);
+    memset(done, 0, sizeof(done));
+}
+
+void MeasureFlow::markDone(uint8_t step) {
+    if (step < MEASURE_STEPS) done[step] = true;
+}
+
+void MeasureFlow::restore(const bool flags[MEASURE_STEPS]) {
+    memcpy(done, flags, sizeof(done));
+}
+
+/* ==================== ACTIONS ==================== */
+void MeasureFlow::notify(MeasureUpdateKind kind, float value) {
+    if (!updateFn) return;
+    MeasureUpdate u = {kind, active, value};
+    updateFn(u, updateCtx);
+}
+
+void MeasureFlow::sendStart() {
+    uint8_t cmd[2] = {CMD_START_STREAM, active};
+    if (sendFn) sendFn(cmd, 2, sendCtx);
+}
+
+void MeasureFlow::sendStop(uint32_t now) {
+    uint8_t cmd = CMD_STOP_STREAM;
+    if (sendFn) sendFn(&cmd, 1, sendCtx);
+    stopsSent++;
+    stopSent = true;
+    lastStop = now;
+}
+
+bool MeasureFlow::actStart(const Input& in) {
+    if (in.sensor < HUB_SENSOR_HEIGHT || in.sensor > HUB_SENSOR_PULSE) return false;
+    active = in.sensor;
+    attempts = 0;
+    haveSample = false;
+    latestValue = 0;
+    startedAt = in.now;
+    lastActivity = in.now;
+    sendStart();
+    return true;
+}
+
+// Only one stream at a time: stop the old sensor before starting the next
+bool MeasureFlow::actRestart(const Input& in) {
+    actCancel(in);
+    return actStart(in);
+}
+
+bool MeasureFlow::actSample(const Input& in) {
+    if (in.sensor != active) return false;   // late frame from a previous stream
+    latestValue = in.value;
+    haveSample = true;
+    attempts = 0;
+    lastActivity = in.now;
+    notify(MU_LIVE, in.value);
+    return true;
+}
+
+// Nobody asked for this stream (a lost STOP, or a hub that restarted
+// streaming on its own). Frames still in flight right after a STOP are
+// expected, so repeat it at most every MEASURE_STRAY_STOP_MS.
+bool MeasureFlow::actStray(const Input& in) {
+    if (stopSent && in.now - lastStop < MEASURE_STRAY_STOP_MS) return true;
+    sendStop(in.now);
+    return true;
+}
+
+bool MeasureFlow::actCapture(const Input& in) {
+    sendStop(in.now);
+    if (!haveSample) {
+        notify(MU_NO_READING, 0);
+        return false;
+    }
+    done[active] = true;
+    notify(MU_CAPTURED, latestValue);
+    return true;
+}
+
+bool MeasureFlow::actCancel(const Input& in) {
+    sendStop(in.now);
+    notify(MU_STOPPED, latestValue);
+    return true;
+}
+
+bool MeasureFlow::actRetry(const Input& in) {
+    if (attempts >= MEASURE_RETRIES) {
+        sendStop(in.now);
+        notify(MU_NO_DATA, 0);
+        return false;
+    }
+    attempts++;
+    retriesSent++;
+    lastActivity = in.now;
+    sendStart();
+    notify(MU_RETRY, attempts);
+    return true;
+}
+
+bool MeasureFlow::actExpire(const Input& in) {
+    sendStop(in.now);
+    notify(MU_EXPIRED, latestValue);
+    return true;
+}
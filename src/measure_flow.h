@@ -0,0 +1,137 @@
+#ifndef MEASURE_FLOW_H
+#define MEASURE_FLOW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hub_protocol.h"
+
+// Checkup measurement state machine. Owns the hub stream for the sensor
+// being measured: starting it, retrying when it goes quiet, capturing the
+// latest value and stopping it again. Every way out of a stream – capture,
+// cancel, switching sensors, timeout – goes through an action that sends
+// CMD_STOP_STREAM, and samples that keep arriving while idle get another
+// STOP.
+//
+// Time is passed in by the caller and the hub link and UI are callbacks, so
+// the machine has no Arduino or LVGL dependencies and runs on the host.
+
+// Checkup steps: BP comes from the cuff (bp_cuff.h) or is entered by hand,
+// the rest are hub sensors and share their HUB_SENSOR_* number.
+#define MEASURE_STEP_BP 0
+#define MEASURE_STEPS   5
+
+#define MEASURE_FIRST_SAMPLE_MS 3000     // START sent, no sample yet
+#define MEASURE_SAMPLE_GAP_MS   2000     // stream went quiet
+#define MEASURE_RETRIES         2        // START re-sent this often before giving up
+#define MEASURE_MAX_STREAM_MS   120000   // nobody captured; stop streaming
+#define MEASURE_STRAY_STOP_MS   1000     // repeat STOP for a stream we didn't ask for
+
+enum MeasureState { MS_IDLE, MS_WAITING, MS_STREAMING, MS_STATES };
+
+enum MeasureEvent {
+    ME_START,     // user started a sensor
+    ME_SAMPLE,    // stream frame arrived
+    ME_CAPTURE,   // user took the current value
+    ME_CANCEL,    // user left the screen or the checkup was reset
+    ME_NO_DATA,   // no sample within the first-sample / gap timeout
+    ME_EXPIRED,   // streamed for MEASURE_MAX_STREAM_MS without a capture
+    ME_EVENTS
+};
+
+enum MeasureUpdateKind {
+    MU_LIVE,        // new sample for the live label
+    MU_RETRY,       // stream went quiet, START re-sent
+    MU_CAPTURED,    // value taken, step done
+    MU_NO_READING,  // capture pressed before any sample arrived
+    MU_NO_DATA,     // retries exhausted
+    MU_EXPIRED,     // stream stopped after MEASURE_MAX_STREAM_MS
+    MU_STOPPED      // stream cancelled
+};
+
+struct MeasureUpdate {
+    MeasureUpdateKind kind;
+    uint8_t sensor;
+    float value;
+};
+
+typedef void (*MeasureSendFn)(const uint8_t* bytes, size_t len, void* ctx);
+typedef void (*MeasureUpdateFn)(const MeasureUpdate& update, void* ctx);
+
+class MeasureFlow {
+public:
+    MeasureFlow();
+
+    void setLink(MeasureSendFn send, void* ctx);
+    void setHandler(MeasureUpdateFn handler, void* ctx);
+
+    // Inputs; each runs the transition table once
+    void start(uint8_t sensor, uint32_t now);
+    void sample(uint8_t sensor, float value, uint32_t now);
+    void capture(uint32_t now);
+    void cancel(uint32_t now);
+    void tick(uint32_t now);   // turns expired timers into ME_NO_DATA / ME_EXPIRED
+
+    // Completed checkup steps (MEASURE_STEP_BP, HUB_SENSOR_*)
+    void reset(uint32_t now);   // cancels any stream and clears every step
+    void markDone(uint8_t step);
+    bool isDone(uint8_t step) const { return step < MEASURE_STEPS && done[step]; }
+    const bool* doneFlags() const { return done; }
+    void restore(const bool flags[MEASURE_STEPS]);
+
+    MeasureState state() const { return current; }
+    uint8_t sensor() const { return active; }
+    float latest() const { return latestValue; }
+    bool streaming() const { return current != MS_IDLE; }
+
+    uint32_t stopsSent;
+    uint32_t retriesSent;
+
+private:
+    struct Input {
+        MeasureEvent event;
+        uint8_t sensor;
+        float value;
+        uint32_t now;
+    };
+    typedef bool (MeasureFlow::*Action)(const Input& in);
+    struct Transition {
+        MeasureState from;
+        MeasureEvent event;
+        Action action;
+        MeasureState onOk;
+        MeasureState onFail;
+    };
+    static const Transition TABLE[];
+
+    void dispatch(const Input& in);
+    void notify(MeasureUpdateKind kind, float value);
+    void sendStart();
+    void sendStop(uint32_t now);
+
+    bool actStart(const Input& in);
+    bool actRestart(const Input& in);
+    bool actSample(const Input& in);
+    bool actStray(const Input& in);
+    bool actCapture(const Input& in);
+    bool actCancel(const Input& in);
+    bool actRetry(const Input& in);
+    bool actExpire(const Input& in);
+
+    MeasureSendFn sendFn;
+    void* sendCtx;
+    MeasureUpdateFn updateFn;
+    void* updateCtx;
+
+    MeasureState current;
+    uint8_t active;
+    uint8_t attempts;
+    bool haveSample;
+    float latestValue;
+    uint32_t startedAt;
+    uint32_t lastActivity;   // START sent or last sample
+    uint32_t lastStop;
+    bool stopSent;
+    bool done[MEASURE_STEPS];
+};
+
+#endif // MEASURE_FLOW_H
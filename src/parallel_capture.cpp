@@ -0,0 +1,178 @@
+#include "parallel_capture.h"
+#include <string.h>
+
+struct ParallelChannelDef {
+    uint8_t sensor;
+    uint8_t statusBit;
+    float tolerance;
+    uint8_t rateHz;   // subscription rate
+};
+
+static const ParallelChannelDef CHANNEL_DEFS[] = {
+    {HUB_SENSOR_HEIGHT, HUB_STATUS_HEIGHT, 2.0f, 10},   // cm
+    {HUB_SENSOR_WEIGHT, HUB_STATUS_WEIGHT, 0.3f, 10},   // kg
+    {HUB_SENSOR_TEMP,   HUB_STATUS_TEMP,   0.2f, 2},    // °C, slow to move anyway
+    {HUB_SENSOR_PULSE,  HUB_STATUS_HR,     5.0f, 5},    // BPM
+};
+#define CHANNEL_DEF_COUNT (sizeof(CHANNEL_DEFS) / sizeof(CHANNEL_DEFS[0]))
+
+static float channelReading(const SensorData& d, uint8_t sensor) {
+    switch (sensor) {
+        case HUB_SENSOR_HEIGHT: return d.height_cm;
+        case HUB_SENSOR_WEIGHT: return d.weight_kg;
+        case HUB_SENSOR_TEMP:   return d.temperature_c;
+        case HUB_SENSOR_PULSE:  return d.heart_rate;
+    }
+    return 0;
+}
+
+ParallelCapture::ParallelCapture()
+    : polls(0), replies(0), samples(0), sendFn(NULL), sendCtx(NULL), running(false),
+      currentMode(PM_STREAM), changed(false), streamSeen(false), subscribedAt(0),
+      awaitingReply(false), polledAt(0), nextPollAt(0) {
+    memset(ch, 0, sizeof(ch));
+}
+
+void ParallelCapture::setLink(MeasureSendFn send, void* ctx) {
+    sendFn = send;
+    sendCtx = ctx;
+}
+
+void ParallelCapture::send(const uint8_t* bytes, size_t len) {
+    if (sendFn) sendFn(bytes, len, sendCtx);
+}
+
+void ParallelCapture::begin(uint32_t now) {
+    memset(ch, 0, sizeof(ch));
+    uint8_t mask = 0;
+    uint8_t rates[HUB_SENSOR_COUNT];
+    for (size_t i = 0; i < CHANNEL_DEF_COUNT; i++) {
+        const ParallelChannelDef& d = CHANNEL_DEFS[i];
+        ParallelChannel& c = ch[d.sensor];
+        c.tolerance = d.tolerance;
+        // About a second of samples, within the window's bounds
+        c.need = d.rateHz < PARALLEL_WINDOW ? PARALLEL_WINDOW
+               : d.rateHz > PARALLEL_WINDOW_MAX ? PARALLEL_WINDOW_MAX : d.rateHz;
+        mask |= HUB_SENSOR_BIT(d.sensor);
+        rates[d.sensor - 1] = d.rateHz;
+    }
+    running = true;
+    currentMode = PM_STREAM;
+    changed = true;
+    streamSeen = false;
+    subscribedAt = now;
+    awaitingReply = false;
+
+    uint8_t cmd[SUBSCRIBE_CMD_LEN];
+    send(cmd, encodeSubscribe(mask, rates, cmd));
+}
+
+void ParallelCapture::stop() {
+    if (running && currentMode == PM_STREAM) {
+        uint8_t cmd = CMD_STOP_STREAM;
+        send(&cmd, 1);
+    }
+    running = false;
+}
+
+void ParallelCapture::poll(uint32_t now) {
+    uint8_t cmd = CMD_MEASURE;
+    send(&cmd, 1);
+    polls++;
+    awaitingReply = true;
+    polledAt = now;
+}
+
+void ParallelCapture::clear(ParallelChannel& c) {
+    if (c.state != PC_ABSENT) changed = true;
+    c.state = PC_ABSENT;
+    c.count = 0;
+    c.head = 0;
+}
+
+void ParallelCapture::push(ParallelChannel& c, float v, uint32_t now) {
+    c.window[c.head] = v;
+    c.head = (c.head + 1) % c.need;
+    if (c.count < c.need) c.count++;
+    c.lastMs = now;
+    changed = true;
+
+    float lo = c.window[0], hi = c.window[0], sum = 0;
+    for (uint8_t i = 0; i < c.count; i++) {
+        if (c.window[i] < lo) lo = c.window[i];
+        if (c.window[i] > hi) hi = c.window[i];
+        sum += c.window[i];
+    }
+    c.spread = hi - lo;
+    if (c.count == c.need && c.spread <= c.tolerance) {
+        c.state = PC_STABLE;
+        c.value = sum / c.count;
+    } else {
+        c.state = PC_SETTLING;
+        c.value = v;
+    }
+}
+
+bool ParallelCapture::feedSample(uint8_t sensor, float value, uint32_t now) {
+    if (!running) return false;
+    if (currentMode != PM_STREAM || sensor < 1 || sensor > HUB_SENSOR_COUNT) return true;
+    streamSeen = true;
+    samples++;
+    // A zero reading is the hub's "nobody there" (empty scale, no finger)
+    if (value <= 0) clear(ch[sensor]);
+    else push(ch[sensor], value, now);
+    return true;
+}
+
+bool ParallelCapture::feed(const SensorData& data, uint32_t now) {
+    if (!running) return false;
+    if (currentMode != PM_POLL) return true;
+    replies++;
+    for (size_t i = 0; i < CHANNEL_DEF_COUNT; i++) {
+        ParallelChannel& c = ch[CHANNEL_DEFS[i].sensor];
+        // Subject stepped off: the window starts over
+        if (data.sensor_status & CHANNEL_DEFS[i].statusBit) push(c, channelReading(data, CHANNEL_DEFS[i].sensor), now);
+        else clear(c);
+    }
+    awaitingReply = false;
+    nextPollAt = now + PARALLEL_POLL_MS;
+    return true;
+}
+
+void ParallelCapture::tick(uint32_t now) {
+    if (!running) return;
+    if (currentMode == PM_STREAM) {
+        if (!streamSeen && now - subscribedAt >= PARALLEL_REPLY_MS) {
+            // Hub without CMD_SUBSCRIBE: make sure nothing streams, then poll
+            uint8_t cmd = CMD_STOP_STREAM;
+            send(&cmd, 1);
+            currentMode = PM_POLL;
+            for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) ch[s].need = PARALLEL_WINDOW;
+            poll(now);
+            return;
+        }
+        for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+            if (ch[s].state != PC_ABSENT && now - ch[s].lastMs >= PARALLEL_QUIET_MS) clear(ch[s]);
+        }
+        return;
+    }
+    if (awaitingReply) {
+        if (now - polledAt >= PARALLEL_REPLY_MS) poll(now);
+    } else if ((int32_t)(now - nextPollAt) >= 0) {
+        poll(now);
+    }
+}
+
+bool ParallelCapture::takeChanged() {
+    bool c = changed;
+    changed = false;
+    return c;
+}
+
+uint8_t ParallelCapture::stableCount() const {
+    uint8_t n = 0;
+    for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+        if (ch[s].state == PC_STABLE) n++;
+    }
+    return n;
+}
@@ -0,0 +1,97 @@
+#ifndef PARALLEL_CAPTURE_H
+#define PARALLEL_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hub_protocol.h"
+#include "measure_flow.h"
+
+// Parallel capture: measures every hub sensor at once and tracks each
+// channel until its recent readings agree within the channel's tolerance.
+// The dashboard screen shows all four settling side by side instead of
+// walking through one screen per sensor.
+//
+// Readings come from a CMD_SUBSCRIBE stream of all four sensors, each at its
+// own rate; a channel is stable once about a second of samples agree. A hub
+// that doesn't answer the subscription is polled with CMD_MEASURE instead,
+// whose data frame also carries every sensor, and the last PARALLEL_WINDOW
+// replies must agree.
+//
+// Like MeasureFlow it takes time from the caller and talks to the hub
+// through a callback, so it runs on the host.
+
+#define PARALLEL_WINDOW      4      // readings that must agree when polling
+#define PARALLEL_WINDOW_MAX  16     // stream samples that must agree, at most
+#define PARALLEL_POLL_MS     200    // pause between a reply and the next poll
+#define PARALLEL_REPLY_MS    3000   // no reply / no stream: poll (again)
+#define PARALLEL_QUIET_MS    1500   // channel stopped streaming: not ready
+
+enum ParallelMode { PM_STREAM, PM_POLL };
+
+enum ParallelChannelState {
+    PC_ABSENT,     // hub reports the sensor not ready, or it went quiet
+    PC_SETTLING,   // readings still moving
+    PC_STABLE      // the last `need` readings within tolerance
+};
+
+struct ParallelChannel {
+    ParallelChannelState state;
+    float window[PARALLEL_WINDOW_MAX];
+    uint8_t need;      // readings that must agree
+    uint8_t count;     // readings in the window
+    uint8_t head;
+    float value;       // window mean once stable, latest reading before
+    float spread;      // max - min over the window
+    float tolerance;
+    uint32_t lastMs;   // kiosk clock of the latest reading
+};
+
+class ParallelCapture {
+public:
+    ParallelCapture();
+
+    void setLink(MeasureSendFn send, void* ctx);
+
+    void begin(uint32_t now);   // clears every channel and subscribes
+    void stop();                // ends the subscription
+    bool active() const { return running; }
+    ParallelMode mode() const { return currentMode; }
+
+    // Hub input while running; false (not consumed) otherwise
+    bool feedSample(uint8_t sensor, float value, uint32_t now);
+    bool feed(const SensorData& data, uint32_t now);
+    void tick(uint32_t now);
+
+    // True once after any channel changed, for a batched redraw
+    bool takeChanged();
+
+    // Channels by HUB_SENSOR_* number
+    const ParallelChannel& channel(uint8_t sensor) const { return ch[sensor < MEASURE_STEPS ? sensor : 0]; }
+    uint8_t stableCount() const;
+    bool allStable() const { return stableCount() == HUB_SENSOR_COUNT; }
+
+    uint32_t polls;
+    uint32_t replies;
+    uint32_t samples;
+
+private:
+    void send(const uint8_t* bytes, size_t len);
+    void poll(uint32_t now);
+    void push(ParallelChannel& c, float v, uint32_t now);
+    void clear(ParallelChannel& c);
+
+    MeasureSendFn sendFn;
+    void* sendCtx;
+
+    bool running;
+    ParallelMode currentMode;
+    bool changed;
+    bool streamSeen;
+    uint32_t subscribedAt;
+    bool awaitingReply;
+    uint32_t polledAt;
+    uint32_t nextPollAt;
+    ParallelChannel ch[MEASURE_STEPS];   // [0] unused (BP)
+};
+
+#endif // PARALLEL_CAPTURE_H
@@ -0,0 +1,299 @@
+#include "patient_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TRIE_NONE 0   // node 0 is the root, never anyone's child or sibling
+
+static uint32_t fnv1a(const char* s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) h = (h ^ (uint8_t)s[i]) * 16777619u;
+    return h;
+}
+
+static size_t commonPrefix(const char* a, size_t an, const char* b, size_t bn) {
+    size_t n = an < bn ? an : bn;
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) i++;
+    return i;
+}
+
+PatientIndex::PatientIndex()
+    : dropped(0), entries(NULL), table(NULL), tableMask(0), trie(NULL), pool(NULL), capacity(0),
+      nodeCapacity(0), poolCapacity(0), patients(0), nodes(0), poolLen(0) {}
+
+PatientIndex::~PatientIndex() {
+    free(entries);
+    free(table);
+    free(trie);
+    free(pool);
+}
+
+bool PatientIndex::begin(uint16_t maxPatients, uint32_t poolBytes) {
+    if (entries) return true;
+    if (maxPatients > 32767) maxPatients = 32767;   // node indices are 16 bit
+    uint32_t tableSize = 1;
+    while (tableSize < 2u * maxPatients) tableSize <<= 1;   // at most half full
+
+    capacity = maxPatients;
+    nodeCapacity = 2u * maxPatients + 1;   // a leaf and a split per name, plus the root
+    poolCapacity = poolBytes;
+    tableMask = tableSize - 1;
+    entries = (Entry*)malloc(capacity * sizeof(Entry));
+    table = (uint16_t*)malloc(tableSize * sizeof(uint16_t));
+    trie = (Node*)malloc(nodeCapacity * sizeof(Node));
+    pool = (char*)malloc(poolCapacity);
+    if (!entries || !table || !trie || !pool) {
+        free(entries);
+        free(table);
+        free(trie);
+        free(pool);
+        entries = NULL;
+        table = NULL;
+        trie = NULL;
+        pool = NULL;
+        capacity = 0;
+        return false;
+    }
+    clear();
+    return true;
+}
+
+void PatientIndex::clear() {
+    patients = 0;
+    poolLen = 0;
+    dropped = 0;
+    if (!entries) return;
+    memset(table, 0, (tableMask + 1) * sizeof(uint16_t));
+    memset(&trie[0], 0, sizeof(Node));
+    nodes = 1;
+}
+
+size_t PatientIndex::bytes() const {
+    if (!entries) return 0;
+    return capacity * sizeof(Entry) + (tableMask + 1) * sizeof(uint16_t) + nodeCapacity * sizeof(Node) +
+           poolCapacity;
+}
+
+/* ==================== NAMES ==================== */
+size_t PatientIndex::normalize(const char* in, char* out, bool prefix) {
+    size_t n = 0;
+    bool space = false;
+    for (; *in && n < PATIENT_NAME_MAX; in++) {
+        char c = *in;
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            space = n > 0;
+            continue;
+        }
+        if (space) {
+            out[n++] = ' ';
+            space = false;
+            if (n == PATIENT_NAME_MAX) break;
+        }
+        out[n++] = c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+    }
+    if (prefix && space && n < PATIENT_NAME_MAX) out[n++] = ' ';
+    out[n] = '\0';
+    return n;
+}
+
+uint32_t PatientIndex::store(const char* s, size_t len) {
+    if (poolLen + len + 1 > poolCapacity) return UINT32_MAX;
+    uint32_t at = poolLen;
+    memcpy(pool + at, s, len);
+    pool[at + len] = '\0';
+    poolLen += len + 1;
+    return at;
+}
+
+uint16_t PatientIndex::lookup(const char* key, size_t len, uint32_t hash) const {
+    for (uint32_t i = hash & tableMask;; i = (i + 1) & tableMask) {
+        uint16_t e = table[i];
+        if (e == 0) return 0;
+        const Entry& en = entries[e - 1];
+        if (en.hash == hash && en.keyLen == len && memcmp(pool + en.key, key, len) == 0) return e;
+    }
+}
+
+/* ==================== TRIE ==================== */
+uint16_t PatientIndex::newNode(uint32_t label, uint8_t len, uint16_t patient) {
+    if (nodes >= nodeCapacity) return TRIE_NONE;
+    Node& n = trie[nodes];
+    n.label = label;
+    n.labelLen = len;
+    n.child = TRIE_NONE;
+    n.sibling = TRIE_NONE;
+    n.patient = patient;
+    return (uint16_t)nodes++;
+}
+
+// `key` is the pool copy of the name; new labels point into it
+bool PatientIndex::insertTrie(uint32_t key, uint8_t len, uint16_t patient) {
+    const char* k = pool + key;
+    uint16_t at = 0;
+    size_t i = 0;
+    for (;;) {
+        if (i == len) {
+            trie[at].patient = patient;
+            return true;
+        }
+        // Children are kept sorted by their first byte
+        uint16_t prev = TRIE_NONE;
+        uint16_t c = trie[at].child;
+        while (c != TRIE_NONE && (uint8_t)pool[trie[c].label] < (uint8_t)k[i]) {
+            prev = c;
+            c = trie[c].sibling;
+        }
+        if (c == TRIE_NONE || pool[trie[c].label] != k[i]) {
+            uint16_t leaf = newNode(key + i, len - i, patient);
+            if (leaf == TRIE_NONE) return false;
+            trie[leaf].sibling = c;
+            if (prev == TRIE_NONE) trie[at].child = leaf;
+            else trie[prev].sibling = leaf;
+            return true;
+        }
+
+        size_t m = commonPrefix(pool + trie[c].label, trie[c].labelLen, k + i, len - i);
+        if (m < trie[c].labelLen) {
+            // Split the edge where the names part
+            uint16_t mid = newNode(trie[c].label, (uint8_t)m, 0);
+            if (mid == TRIE_NONE) return false;
+            trie[mid].child = c;
+            trie[mid].sibling = trie[c].sibling;
+            trie[c].sibling = TRIE_NONE;
+            trie[c].label += m;
+            trie[c].labelLen -= m;
+            if (prev == TRIE_NONE) trie[at].child = mid;
+            else trie[prev].sibling = mid;
+            c = mid;
+        }
+        i += m;
+        at = c;
+    }
+}
+
+/* ==================== QUERIES ==================== */
+bool PatientIndex::add(const char* name, uint64_t pos) {
+    if (!entries) return false;
+    char key[PATIENT_NAME_MAX + 1];
+    size_t len = normalize(name, key);
+    if (len == 0) return false;
+    uint32_t hash = fnv1a(key, len);
+
+    uint16_t e = lookup(key, len, hash);
+    if (e) {
+        Entry& en = entries[e - 1];
+        if (pos <= en.pos) return true;
+        en.pos = pos;
+        // Keep the newest spelling when it changed and still fits
+        const char* shown = name;
+        while (*shown == ' ') shown++;
+        size_t shownLen = strnlen(shown, PATIENT_NAME_MAX);
+        while (shownLen > 0 && shown[shownLen - 1] == ' ') shownLen--;
+        if (strncmp(pool + en.display, shown, shownLen) != 0 || pool[en.display + shownLen] != '\0') {
+            uint32_t at = store(shown, shownLen);
+            if (at != UINT32_MAX) en.display = at;
+        }
+        return true;
+    }
+
+    // Room for the entry, both strings and up to two trie nodes
+    if (patients >= capacity || nodes + 2 > nodeCapacity) {
+        dropped++;
+        return false;
+    }
+    uint32_t poolMark = poolLen;
+    uint32_t keyAt = store(key, len);
+    const char* shown = name;
+    while (*shown == ' ') shown++;
+    size_t shownLen = strnlen(shown, PATIENT_NAME_MAX);
+    while (shownLen > 0 && shown[shownLen - 1] == ' ') shownLen--;
+    uint32_t shownAt = keyAt;   // shared when saved already normalized
+    if (keyAt != UINT32_MAX && (shownLen != len || memcmp(shown, key, len) != 0)) shownAt = store(shown, shownLen);
+    if (shownAt == UINT32_MAX) {
+        poolLen = poolMark;
+        dropped++;
+        return false;
+    }
+
+    Entry& en = entries[patients];
+    en.pos = pos;
+    en.hash = hash;
+    en.key = keyAt;
+    en.display = shownAt;
+    en.keyLen = (uint8_t)len;
+    patients++;
+    insertTrie(keyAt, (uint8_t)len, patients);
+
+    uint32_t i = hash & tableMask;
+    while (table[i]) i = (i + 1) & tableMask;
+    table[i] = patients;
+    return true;
+}
+
+bool PatientIndex::find(const char* name, uint64_t& pos) const {
+    if (!entries) return false;
+    char key[PATIENT_NAME_MAX + 1];
+    size_t len = normalize(name, key);
+    if (len == 0) return false;
+    uint16_t e = lookup(key, len, fnv1a(key, len));
+    if (!e) return false;
+    pos = entries[e - 1].pos;
+    return true;
+}
+
+uint16_t PatientIndex::countBefore(uint64_t minPos) const {
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < patients; i++) {
+        if (entries[i].pos < minPos) n++;
+    }
+    return n;
+}
+
+size_t PatientIndex::suggest(const char* prefix, uint64_t minPos, PatientMatch* out, size_t n) const {
+    if (!entries || n == 0) return 0;
+    char key[PATIENT_NAME_MAX + 1];
+    size_t len = normalize(prefix, key, true);
+    if (len == 0) return 0;
+
+    // Down to the node whose subtree holds every name with the prefix
+    uint16_t at = 0;
+    size_t i = 0;
+    while (i < len) {
+        uint16_t c = trie[at].child;
+        while (c != TRIE_NONE && pool[trie[c].label] != key[i]) c = trie[c].sibling;
+        if (c == TRIE_NONE) return 0;
+        size_t m = commonPrefix(pool + trie[c].label, trie[c].labelLen, key + i, len - i);
+        if (i + m < len && m < trie[c].labelLen) return 0;   // names part inside the label
+        i += m;
+        at = c;
+    }
+
+    // Preorder walk of that subtree: a name before the longer ones under it,
+    // children in byte order
+    uint16_t stack[PATIENT_NAME_MAX + 2];
+    size_t depth = 0;
+    size_t found = 0;
+    uint32_t visits = 0;
+    uint16_t node = at;
+    while (found < n && visits++ < PATIENT_VISIT_MAX) {
+        const Node& nd = trie[node];
+        if (nd.patient) {
+            const Entry& en = entries[nd.patient - 1];
+            if (en.pos >= minPos) {
+                out[found].name = pool + en.display;
+                out[found].pos = en.pos;
+                found++;
+            }
+        }
+        // Next in preorder: first child, else the nearest sibling up the path
+        if (nd.child != TRIE_NONE && depth < sizeof(stack) / sizeof(stack[0])) {
+            stack[depth++] = node;
+            node = nd.child;
+            continue;
+        }
+        while (node != at && trie[node].sibling == TRIE_NONE && depth > 0) node = stack[--depth];
+        if (node == at) break;
+        node = trie[node].sibling;
+    }
+    return found;
+}
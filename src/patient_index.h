@@ -0,0 +1,120 @@
+#ifndef PATIENT_INDEX_H
+#define PATIENT_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Returning-patient index: every name in the record store, mapped to the
+// position of that patient's newest record, with prefix search for the
+// info screen's typeahead.
+//
+//   names      compared normalized: ASCII lower case, runs of whitespace
+//              as one space, no leading or trailing space, at most
+//              PATIENT_NAME_MAX bytes
+//   lookup     FNV-1a hash of the normalized name into an open-addressed
+//              table, confirmed against the stored key
+//   prefix     radix trie over the normalized names; edge labels point
+//              into the name pool, so a node is 11 bytes whatever its
+//              label's length
+//
+// A suggestion walks at most the prefix's length down the trie and then
+// visits at most PATIENT_VISIT_MAX nodes, so its cost does not grow with
+// the number of records stored.
+//
+// All memory is taken once by begin() – about 200 KB for the default
+// capacity, which lands in PSRAM on the kiosk. Names past capacity are not
+// indexed and counted in `dropped`. Nothing is removed one by one: entries
+// whose record retention has deleted are skipped by passing the oldest live
+// position to suggest(), and once the index is full and countBefore() finds
+// such entries, patients.cpp rebuilds it from the records that are left.
+//
+// Record positions are storage.h RecordPos values, kept as uint64_t so the
+// index has no Arduino dependencies and runs on a host.
+
+// The store keeps at most MAX_RECORDS (display.h) records, so at most that
+// many live patients; twice that leaves room for the patients retention
+// has deleted, so the rebuild comes once per ~1000 new names, not per save
+#define PATIENT_INDEX_MAX   2048      // patients
+#define PATIENT_POOL_BYTES  (PATIENT_INDEX_MAX * 48)   // normalized and saved name
+#define PATIENT_NAME_MAX    48
+#define PATIENT_VISIT_MAX   256       // trie nodes visited per suggestion
+
+struct PatientMatch {
+    const char* name;      // as last saved; valid until the next add()
+    uint64_t pos;          // newest record
+};
+
+class PatientIndex {
+public:
+    PatientIndex();
+    ~PatientIndex();
+
+    // False if the memory is not available; the index then stays empty
+    bool begin(uint16_t maxPatients = PATIENT_INDEX_MAX, uint32_t poolBytes = PATIENT_POOL_BYTES);
+    void clear();
+
+    // A record of `name` at `pos`. Positions only move forward, so an older
+    // one (the catch-up scan meeting a record already added) is ignored.
+    // False if the name is empty or did not fit.
+    bool add(const char* name, uint64_t pos);
+
+    bool find(const char* name, uint64_t& pos) const;
+
+    // Patients whose newest record is before `minPos` (deleted by retention)
+    uint16_t countBefore(uint64_t minPos) const;
+
+    // Up to `n` patients whose name starts with `prefix`, in the byte order
+    // of their normalized names (so a name comes before the longer ones it
+    // begins), skipping records before `minPos`
+    size_t suggest(const char* prefix, uint64_t minPos, PatientMatch* out, size_t n) const;
+
+    // Normalized form of `in` into `out` (PATIENT_NAME_MAX + 1 bytes); a
+    // prefix keeps one trailing space, as the user is still typing.
+    // Returns the length.
+    static size_t normalize(const char* in, char* out, bool prefix = false);
+
+    uint16_t count() const { return patients; }
+    uint32_t nodeCount() const { return nodes; }
+    uint32_t poolUsed() const { return poolLen; }
+    size_t bytes() const;
+
+    uint32_t dropped;
+
+private:
+#pragma pack(push, 1)
+    struct Node {
+        uint32_t label;        // pool offset
+        uint8_t labelLen;
+        uint16_t child;        // first child, children sorted by first byte
+        uint16_t sibling;
+        uint16_t patient;      // entries index + 1, 0 = none
+    };
+#pragma pack(pop)
+    struct Entry {
+        uint64_t pos;
+        uint32_t hash;
+        uint32_t key;          // pool offset of the normalized name
+        uint32_t display;      // pool offset of the name as saved
+        uint8_t keyLen;
+    };
+
+    uint16_t lookup(const char* key, size_t len, uint32_t hash) const;
+    uint32_t store(const char* s, size_t len);
+    bool insertTrie(uint32_t key, uint8_t len, uint16_t patient);
+    uint16_t newNode(uint32_t label, uint8_t len, uint16_t patient);
+
+    Entry* entries;
+    uint16_t* table;           // entry index + 1, 0 = empty
+    uint32_t tableMask;
+    Node* trie;                // trie[0] is the root
+    char* pool;
+
+    uint16_t capacity;
+    uint32_t nodeCapacity;
+    uint32_t poolCapacity;
+    uint16_t patients;
+    uint32_t nodes;
+    uint32_t poolLen;
+};
+
+#endif // PATIENT_INDEX_H
@@ -0,0 +1,157 @@
+#include "patients.h"
+#include "sensors.h"
+#include "record_codec.h"
+#include "console.h"
+
+extern bool sdCardInitialized;
+
+static_assert(PATIENT_INDEX_MAX >= MAX_RECORDS, "the index must hold every patient the store can keep");
+
+static PatientIndex patientIndex;
+static bool indexReady = false;
+
+// Catch-up scan
+static RecordPos scanCursor = 0;
+static bool scanDone = false;
+static uint32_t scanned = 0;
+static uint32_t scanStartMs = 0;
+static uint32_t scanMs = 0;
+static RecordPos scanOldest = 0;   // storageOldestPos() when the scan started
+static uint32_t rebuilds = 0;
+
+static uint32_t lastSuggestUs = 0;
+static uint32_t worstSuggestUs = 0;
+
+static int nameColumn() {
+    for (size_t i = 0; i < HEALTH_FIELD_COUNT; i++) {
+        if (strcmp(HEALTH_FIELDS[i].key, "name") == 0) return i;
+    }
+    return -1;
+}
+
+/* ==================== CATCH-UP SCAN ==================== */
+// A full index keeps the slots of patients whose records retention has
+// deleted. Each time the oldest segment goes, check for such entries and,
+// if there are any, scan the store again so only live patients fill it.
+static bool reclaimDead() {
+    if (!patientIndex.dropped) return false;
+    RecordPos oldest = storageOldestPos();
+    if (oldest == scanOldest) return false;
+    scanOldest = oldest;
+    uint16_t dead = patientIndex.countBefore(oldest);
+    if (!dead) return false;
+    Serial.printf("Patient index: full, rebuilding without %u patients whose records were deleted\n", dead);
+    patientsReset();
+    rebuilds++;
+    return true;
+}
+
+void patientsPoll() {
+    if (!indexReady || !sdCardInitialized) return;
+    if (scanDone && !reclaimDead()) return;
+    uint32_t t0 = micros();
+    if (scanned == 0) {
+        scanStartMs = millis();
+        scanOldest = storageOldestPos();
+    }
+
+    RecordReader reader;
+    bool resynced = false;
+    if (!reader.open(scanCursor, resynced)) {
+        scanDone = true;   // empty store
+        return;
+    }
+
+    static const int column = nameColumn();
+    char line[RECORD_CSV_MAX];
+    char* fields[HEALTH_FIELD_COUNT];
+    bool truncated;
+    RecordPos at;
+    while (micros() - t0 < PATIENT_SCAN_BUDGET_US && reader.next(line, sizeof(line), at, truncated)) {
+        scanned++;
+        if (truncated || column < 0) continue;
+        if (splitCSV(line, fields, HEALTH_FIELD_COUNT) > column) patientIndex.add(fields[column], at);
+    }
+    scanCursor = reader.position();
+    if (reader.atEnd()) {
+        scanDone = true;
+        scanMs = millis() - scanStartMs;
+        Serial.printf("✓ Patient index: %u patients from %lu records in %lu ms\n", patientIndex.count(),
+                      (unsigned long)scanned, (unsigned long)scanMs);
+        if (patientIndex.dropped) {
+            Serial.printf("✗ Patient index full, %lu names not indexed\n", (unsigned long)patientIndex.dropped);
+        }
+    }
+    reader.close();
+}
+
+void patientsNoteSaved(const char* name, RecordPos pos) {
+    if (indexReady) patientIndex.add(name, pos);
+}
+
+void patientsReset() {
+    patientIndex.clear();
+    scanCursor = 0;
+    scanDone = false;
+    scanned = 0;
+}
+
+/* ==================== LOOKUP ==================== */
+size_t patientsSuggest(const char* prefix, PatientMatch* out, size_t n) {
+    uint32_t t0 = micros();
+    size_t found = patientIndex.suggest(prefix, storageOldestPos(), out, n);
+    lastSuggestUs = micros() - t0;
+    if (lastSuggestUs > worstSuggestUs) worstSuggestUs = lastSuggestUs;
+    return found;
+}
+
+bool patientsFetch(RecordPos pos, HealthData& data) {
+    if (!sdCardInitialized) return false;
+    RecordReader reader;
+    bool resynced = false;
+    char line[RECORD_CSV_MAX];
+    bool truncated = false;
+    RecordPos at = 0;
+    bool ok = reader.open(pos, resynced) && !resynced && reader.next(line, sizeof(line), at, truncated) &&
+              at == pos && !truncated && decodeCSV(line, data);
+    reader.close();
+    return ok;
+}
+
+/* ==================== CONSOLE ==================== */
+static void cmdPatients(const char* args) {
+    if (*args == '\0') {
+        Serial.printf("Patients: %u indexed, %lu not indexed, %lu trie nodes, %lu/%u pool bytes\n",
+                      patientIndex.count(), (unsigned long)patientIndex.dropped,
+                      (unsigned long)patientIndex.nodeCount(), (unsigned long)patientIndex.poolUsed(),
+                      PATIENT_POOL_BYTES);
+        if (scanDone) {
+            Serial.printf("  scan: done, %lu records in %lu ms, %lu rebuilds\n", (unsigned long)scanned,
+                          (unsigned long)scanMs, (unsigned long)rebuilds);
+        } else {
+            Serial.printf("  scan: %lu records so far, at segment %lu offset %lu\n", (unsigned long)scanned,
+                          (unsigned long)RECORD_POS_SEQ(scanCursor), (unsigned long)RECORD_POS_OFF(scanCursor));
+        }
+        Serial.printf("  suggest: last %lu us, worst %lu us\n", (unsigned long)lastSuggestUs,
+                      (unsigned long)worstSuggestUs);
+        return;
+    }
+    PatientMatch found[PATIENT_SUGGEST_MAX];
+    size_t n = patientsSuggest(args, found, PATIENT_SUGGEST_MAX);
+    Serial.printf("%u match(es) in %lu us\n", (unsigned)n, (unsigned long)lastSuggestUs);
+    for (size_t i = 0; i < n; i++) {
+        Serial.printf("  %-32s segment %lu offset %lu\n", found[i].name, (unsigned long)RECORD_POS_SEQ(found[i].pos),
+                      (unsigned long)RECORD_POS_OFF(found[i].pos));
+    }
+}
+
+void patientsBegin() {
+    indexReady = patientIndex.begin();
+    consoleRegister("PATIENTS", cmdPatients);
+    if (!indexReady) {
+        Serial.println("✗ Patient index: out of memory, typeahead off");
+        return;
+    }
+    Serial.printf("✓ Patient index: room for %u patients (%u KB)\n", PATIENT_INDEX_MAX,
+                  (unsigned)(patientIndex.bytes() / 1024));
+}
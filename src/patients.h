@@ -0,0 +1,40 @@
+#ifndef PATIENTS_H
+#define PATIENTS_H
+
+#include <Arduino.h>
+#include "patient_index.h"
+#include "storage.h"
+
+// Returning patients: the PatientIndex over the record store, for the info
+// screen's name typeahead (console: PATIENTS [prefix]).
+//
+// The index lives in RAM only. After boot it is caught up by scanning the
+// store oldest first, PATIENT_SCAN_BUDGET_US per loop pass, and from then
+// on every checkup saved is added as it is written. Suggestions work
+// during the scan; they just don't know the patients not reached yet.
+// A full index is scanned again once retention has deleted records of
+// patients it holds, so they stop taking room from new ones.
+
+#define PATIENT_SCAN_BUDGET_US 4000
+#define PATIENT_SUGGEST_MAX    4
+
+// Reserve the index and register the console command
+void patientsBegin();
+
+// Catch-up scan and rebuilds; call from loop() once the SD card is up
+void patientsPoll();
+
+// A checkup saved at `pos` (saveHealthData's `at`)
+void patientsNoteSaved(const char* name, RecordPos pos);
+
+// Data file was cleared: forget everyone
+void patientsReset();
+
+// Patients whose name starts with `prefix`, for the typeahead. Names stay
+// valid until the next save.
+size_t patientsSuggest(const char* prefix, PatientMatch* out, size_t n);
+
+// Reads back the record a suggestion points at
+bool patientsFetch(RecordPos pos, HealthData& data);
+
+#endif // PATIENTS_H
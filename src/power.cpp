@@ -0,0 +1,149 @@
+#include "power.h"
+#include "display.h"
+#include "console.h"
+#include "scheduler.h"
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+
+#define POWER_HUB_UART UART_NUM_1   // SerialUART
+
+static const char *const STATE_NAMES[PWR_STATES] = {"active", "dim", "off"};
+static const uint16_t STATE_MHZ[PWR_STATES] = {POWER_ACTIVE_MHZ, POWER_DIM_MHZ, POWER_OFF_MHZ};
+static const uint8_t STATE_BACKLIGHT[PWR_STATES] = {POWER_BL_FULL, POWER_BL_DIM, 0};
+
+static lv_display_t *display = NULL;
+static lv_indev_t *input = NULL;
+static PowerState state = PWR_ACTIVE;
+
+static uint8_t backlight = POWER_BL_FULL;
+static uint8_t backlightTarget = POWER_BL_FULL;
+static unsigned long lastFade = 0;
+
+// Time per state since boot (or POWER RESET)
+static int64_t statsSinceUs;
+static int64_t stateSinceUs;
+static uint64_t stateUs[PWR_STATES];
+static uint64_t lightSleepUs;
+static uint32_t lightSleeps;
+static uint32_t offWakes;
+
+static void enter(PowerState next) {
+    int64_t now = esp_timer_get_time();
+    stateUs[state] += now - stateSinceUs;
+    stateSinceUs = now;
+
+    lv_timer_t *refresh = lv_display_get_refr_timer(display);
+    if (state == PWR_OFF) {
+        lv_timer_resume(refresh);
+        lv_obj_invalidate(lv_scr_act());   // whatever changed while dark
+    }
+    if (next == PWR_OFF) lv_timer_pause(refresh);
+
+    setCpuFrequencyMhz(STATE_MHZ[next]);
+    backlightTarget = STATE_BACKLIGHT[next];
+    state = next;
+    Serial.printf("Power: %s, CPU %u MHz\n", STATE_NAMES[next], STATE_MHZ[next]);
+}
+
+static void fade() {
+    unsigned long now = millis();
+    uint32_t step = (now - lastFade) * 255 / POWER_BL_FADE_MS;
+    lastFade = now;
+    if (backlight == backlightTarget) return;
+    if (step == 0) step = 1;
+    if (backlight < backlightTarget) backlight = min<uint32_t>(backlightTarget, backlight + step);
+    else backlight = backlight > backlightTarget + step ? backlight - step : backlightTarget;
+    ledcWrite(POWER_BL_CHANNEL, backlight);
+}
+
+void powerTick(uint32_t woke, bool busy) {
+    if (busy) lv_display_trigger_activity(display);
+    if (state == PWR_OFF && (woke & SCHED_WAKE_TOUCH)) {
+        // Before LVGL reads the report: this press only turns the screen on
+        lv_indev_wait_release(input);
+        lv_display_trigger_activity(display);
+        offWakes++;
+    }
+
+    uint32_t idle = lv_display_get_inactive_time(display);
+    PowerState want = idle >= POWER_OFF_MS ? PWR_OFF : idle >= POWER_DIM_MS ? PWR_DIM : PWR_ACTIVE;
+    if (want != state) enter(want);
+    fade();
+}
+
+static uint32_t lightSleep() {
+    Serial.flush();
+    esp_sleep_enable_timer_wakeup(POWER_SLEEP_MS * 1000ULL);
+    int64_t t0 = esp_timer_get_time();
+    esp_light_sleep_start();
+    lightSleepUs += esp_timer_get_time() - t0;
+    lightSleeps++;
+
+    switch (esp_sleep_get_wakeup_cause()) {
+        case ESP_SLEEP_WAKEUP_GPIO: return SCHED_WAKE_TOUCH;
+        case ESP_SLEEP_WAKEUP_UART: return SCHED_WAKE_UART;
+        default:                    return 0;
+    }
+}
+
+uint32_t powerIdle(uint32_t lvglDueMs, bool mayLightSleep) {
+#if TOUCH_GT911_INT >= 0
+    if (state == PWR_OFF && backlight == 0 && mayLightSleep) return lightSleep();
+#endif
+    if (backlight != backlightTarget && lvglDueMs > 20) lvglDueMs = 20;   // smooth fade
+    return schedIdle(lvglDueMs);
+}
+
+PowerState powerState() {
+    return state;
+}
+
+/* ==================== CONSOLE ==================== */
+// POWER prints the time spent in each state since boot; POWER RESET
+// starts over.
+static void cmdPower(const char *args) {
+    int64_t now = esp_timer_get_time();
+    if (strncasecmp(args, "RESET", 5) == 0) {
+        memset(stateUs, 0, sizeof(stateUs));
+        lightSleepUs = 0;
+        lightSleeps = offWakes = 0;
+        statsSinceUs = stateSinceUs = now;
+        Serial.println("✓ POWER: cleared");
+        return;
+    }
+    uint64_t total = now - statsSinceUs;
+    Serial.printf("Power: %s, backlight %u, CPU %lu MHz, inactive %lu s\n", STATE_NAMES[state],
+                  backlight, (unsigned long)getCpuFrequencyMhz(),
+                  (unsigned long)(lv_display_get_inactive_time(display) / 1000));
+    for (uint8_t s = 0; s < PWR_STATES; s++) {
+        uint64_t us = stateUs[s] + (s == state ? now - stateSinceUs : 0);
+        Serial.printf("  %-7s %9lu s %5.1f%%\n", STATE_NAMES[s], (unsigned long)(us / 1000000),
+                      total ? 100.0f * us / total : 0.0f);
+    }
+    Serial.printf("  light sleep %lu s in %lu sleeps, %lu wakes by touch\n",
+                  (unsigned long)(lightSleepUs / 1000000), (unsigned long)lightSleeps,
+                  (unsigned long)offWakes);
+}
+
+void powerBegin(lv_display_t *disp, lv_indev_t *indev) {
+    display = disp;
+    input = indev;
+    ledcSetup(POWER_BL_CHANNEL, POWER_BL_FREQ, 8);
+    ledcAttachPin(GFX_BL, POWER_BL_CHANNEL);
+    ledcWrite(POWER_BL_CHANNEL, backlight);
+    setCpuFrequencyMhz(POWER_ACTIVE_MHZ);
+
+#if TOUCH_GT911_INT >= 0
+    // Wake sources for light sleep; they stay armed, the timer is set per sleep
+    gpio_wakeup_enable((gpio_num_t)TOUCH_GT911_INT, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    uart_set_wakeup_threshold(POWER_HUB_UART, 3);
+    esp_sleep_enable_uart_wakeup(POWER_HUB_UART);
+#endif
+
+    statsSinceUs = stateSinceUs = esp_timer_get_time();
+    lastFade = millis();
+    consoleRegister("POWER", cmdPower);
+}
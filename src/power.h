@@ -0,0 +1,60 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+// Idle power management.
+//
+// The kiosk steps down as the screen goes untouched: after POWER_DIM_MS the
+// backlight fades to POWER_BL_DIM and the CPU drops to POWER_DIM_MHZ; after
+// POWER_OFF_MS the backlight goes out, LVGL stops rendering (its refresh
+// timer is paused, so nothing is drawn into the panel nobody sees) and the
+// CPU runs at POWER_OFF_MHZ. Idle time is LVGL's own input inactivity;
+// a checkup, print or calibration in progress counts as activity.
+//
+// With the screen off and the GT911 INT line wired, the loop light-sleeps
+// between events: woken by the touch controller, hub bytes on the UART, or
+// after POWER_SLEEP_MS for housekeeping. The hub frame that wakes the chip
+// loses its first bytes; the decoder resyncs on the next one. Without INT
+// there is no way to notice a touch during light sleep, so the loop keeps
+// its normal idle sleep at the lower clock. The caller also holds off light
+// sleep while the printer link is up and for POWER_OFF_MS after console
+// input, since neither BLE nor the USB console can wake the chip.
+//
+// A touch on a dark screen only wakes it; LVGL is told to ignore that
+// press until it is released, so nothing underneath gets clicked.
+//
+// The POWER console command reports the time spent in each state.
+
+#define POWER_DIM_MS      60000
+#define POWER_OFF_MS      300000
+#define POWER_SLEEP_MS    1000    // longest light sleep while off
+
+#define POWER_BL_FULL     255
+#define POWER_BL_DIM      40
+#define POWER_BL_FADE_MS  400     // full range
+#define POWER_BL_CHANNEL  0       // LEDC
+#define POWER_BL_FREQ     5000
+
+#define POWER_ACTIVE_MHZ  240
+#define POWER_DIM_MHZ     160
+#define POWER_OFF_MHZ     80
+
+enum PowerState { PWR_ACTIVE, PWR_DIM, PWR_OFF, PWR_STATES };
+
+// Call once from setup() after LVGL is up; takes over the backlight pin
+void powerBegin(lv_display_t *disp, lv_indev_t *indev);
+
+// Call at the top of loop(), before LVGL runs, with the wake reasons of
+// the last sleep (SCHED_WAKE_*) and whether a task in progress must keep
+// the screen on
+void powerTick(uint32_t woke, bool busy);
+
+// End-of-loop sleep: light sleep while off (when possible), the
+// scheduler's idle sleep otherwise. Returns SCHED_WAKE_* reasons.
+uint32_t powerIdle(uint32_t lvglDueMs, bool mayLightSleep);
+
+PowerState powerState();
+
+#endif // POWER_H
@@ -0,0 +1,153 @@
+#include "ppg.h"
+#include <string.h>
+
+#define PPG_HP_SHIFT   6   // baseline follows with 1/64 per sample
+#define PPG_LP_SHIFT   2   // smoothing 1/4 per sample
+#define PPG_ENV_SHIFT  7   // envelope decays 1/128 per sample (~1.3 s)
+
+PpgProcessor::PpgProcessor() {
+    reset();
+}
+
+void PpgProcessor::reset() {
+    samples = 0;
+    baseline = 0;
+    smooth = 0;
+    envelope = 0;
+    primed = false;
+    inPulse = false;
+    pulseMax = 0;
+    pulseMaxAt = 0;
+    haveBeat = false;
+    lastBeatAt = 0;
+    lastSampleAt = 0;
+    rrHead = 0;
+    rrCount = 0;
+    beats = 0;
+    displayHead = 0;
+    displayCount = 0;
+}
+
+void PpgProcessor::push(const WaveBatch& batch) {
+    uint32_t stepMs = 1000 / (batch.rateHz ? batch.rateHz : PPG_RATE_HZ);
+    for (uint8_t i = 0; i < HUB_WAVE_BATCH; i++) pushSample(batch.samples[i], batch.timestamp + i * stepMs);
+}
+
+void PpgProcessor::pushSample(int16_t x, uint32_t tMs) {
+    int32_t q = (int32_t)x * 256;
+    if (!primed) {
+        baseline = q;   // start on the signal, not a step from 0
+        primed = true;
+    }
+    baseline += (q - baseline) >> PPG_HP_SHIFT;
+    smooth += ((q - baseline) - smooth) >> PPG_LP_SHIFT;
+    if (samples > 0 && tMs - lastSampleAt > PPG_GAP_MS) {
+        // Lost frames: the next interval would span the hole, and after
+        // PPG_LOST_MS the intervals before it no longer describe the pulse
+        haveBeat = false;
+        inPulse = false;
+        if (tMs - lastSampleAt > PPG_LOST_MS) rrCount = 0;
+    }
+    samples++;
+    lastSampleAt = tMs;
+
+    envelope -= envelope >> PPG_ENV_SHIFT;
+    if (smooth > envelope) envelope = smooth;
+
+    // A beat is the top of each excursion over half the envelope
+    int32_t threshold = envelope >> 1;
+    if (smooth > threshold && envelope >= (PPG_MIN_AMPLITUDE << 8)) {
+        if (!inPulse || smooth > pulseMax) {
+            pulseMax = smooth;
+            pulseMaxAt = tMs;
+        }
+        inPulse = true;
+    } else if (inPulse) {
+        inPulse = false;
+        if (!haveBeat || pulseMaxAt - lastBeatAt >= PPG_REFRACTORY_MS) beat(pulseMaxAt);
+    }
+
+    int32_t v = PPG_DISPLAY_RANGE / 2;
+    if (envelope > 0) v += (int32_t)((int64_t)smooth * (PPG_DISPLAY_RANGE * 2 / 5) / envelope);
+    if (v < 0) v = 0;
+    if (v > PPG_DISPLAY_RANGE) v = PPG_DISPLAY_RANGE;
+    display[displayHead] = (int16_t)v;
+    displayHead = (displayHead + 1) % PPG_DISPLAY_RING;
+    if (displayCount < PPG_DISPLAY_RING) displayCount++;
+}
+
+void PpgProcessor::beat(uint32_t tMs) {
+    beats++;
+    if (haveBeat) {
+        uint32_t interval = tMs - lastBeatAt;
+        if (interval <= PPG_RR_MAX_MS) {
+            rr[rrHead] = (uint16_t)interval;
+            rrHead = (rrHead + 1) % PPG_RR_MAX;
+            if (rrCount < PPG_RR_MAX) rrCount++;
+        } else {
+            rrCount = 0;   // a gap, not a slow heart; start over
+        }
+    }
+    haveBeat = true;
+    lastBeatAt = tMs;
+}
+
+static uint32_t isqrt(uint32_t v) {
+    uint32_t r = 0;
+    for (uint32_t bit = 1UL << 30; bit; bit >>= 2) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+    }
+    return r;
+}
+
+PpgStats PpgProcessor::stats() const {
+    PpgStats s;
+    memset(&s, 0, sizeof(s));
+    s.beats = beats;
+    if (rrCount < 3 || lastSampleAt - lastBeatAt > PPG_LOST_MS) return s;
+    if (envelope < (PPG_MIN_AMPLITUDE << 8)) return s;
+
+    // Intervals oldest first
+    uint16_t seq[PPG_RR_MAX];
+    uint8_t start = (rrHead + PPG_RR_MAX - rrCount) % PPG_RR_MAX;
+    for (uint8_t i = 0; i < rrCount; i++) seq[i] = rr[(start + i) % PPG_RR_MAX];
+
+    uint16_t sorted[PPG_RR_MAX];
+    memcpy(sorted, seq, rrCount * sizeof(uint16_t));
+    for (uint8_t i = 1; i < rrCount; i++) {
+        uint16_t v = sorted[i];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+    }
+    uint32_t median = sorted[rrCount / 2];
+    s.bpm = (uint16_t)((60000 + median / 2) / median);
+
+    uint32_t sumSq = 0;
+    for (uint8_t i = 1; i < rrCount; i++) {
+        int32_t d = (int32_t)seq[i] - seq[i - 1];
+        sumSq += d * d;
+    }
+    s.rmssdMs = (uint16_t)isqrt(sumSq / (rrCount - 1));
+
+    uint8_t regular = 0;
+    for (uint8_t i = 0; i < rrCount; i++) {
+        uint32_t diff = seq[i] > median ? seq[i] - median : median - seq[i];
+        if (diff * 100 <= median * PPG_RR_TOLERANCE) regular++;
+    }
+    s.quality = (uint8_t)(regular * 100 / rrCount);
+    return s;
+}
+
+size_t PpgProcessor::drain(int16_t* out, size_t n) {
+    if (n > displayCount) n = displayCount;
+    uint8_t start = (displayHead + PPG_DISPLAY_RING - displayCount) % PPG_DISPLAY_RING;
+    for (size_t i = 0; i < n; i++) out[i] = display[(start + i) % PPG_DISPLAY_RING];
+    displayCount -= n;
+    return n;
+}
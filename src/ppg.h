@@ -0,0 +1,92 @@
+#ifndef PPG_H
+#define PPG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hub_protocol.h"
+
+// Streaming pulse-waveform (PPG) processing: heart rate, heart-rate
+// variability and a signal-quality index from the raw samples the hub
+// sends after CMD_START_WAVE, one sample at a time as batches arrive.
+//
+// Everything is integer arithmetic in Q8:
+//   band-pass  first-order high-pass (baseline, ~0.25 Hz) followed by a
+//              first-order low-pass (~4.6 Hz), both as shift-and-add IIRs;
+//              the corners assume PPG_RATE_HZ and scale with the real rate
+//   beats      the maximum of each excursion above half the decaying peak
+//              envelope, at least PPG_REFRACTORY_MS apart
+//   HR         median of the last PPG_RR_MAX beat-to-beat intervals, none
+//              measured across a gap left by lost frames
+//   HRV        RMSSD of the same intervals
+//   quality    share of intervals within PPG_RR_TOLERANCE of the median,
+//              0 without a beat for PPG_LOST_MS, after a gap in the samples
+//              that long until new intervals are measured, or with an
+//              envelope below PPG_MIN_AMPLITUDE (no finger)
+//
+// The filtered signal is also scaled by the envelope into
+// 0..PPG_DISPLAY_RANGE and queued for the pulse screen's chart.
+//
+// Kept free of Arduino dependencies so tools/simrun can run it on a host.
+
+#define PPG_RATE_HZ        100
+#define PPG_RR_MAX         16
+#define PPG_RR_MIN_MS      300     // 200 BPM
+#define PPG_RR_MAX_MS      2000    // 30 BPM
+#define PPG_REFRACTORY_MS  PPG_RR_MIN_MS
+#define PPG_LOST_MS        2500
+#define PPG_GAP_MS         50      // missing samples: no interval across them
+#define PPG_RR_TOLERANCE   15      // percent
+#define PPG_MIN_AMPLITUDE  20      // ADC counts of the filtered pulse
+#define PPG_DISPLAY_RANGE  100
+#define PPG_DISPLAY_RING   64
+
+struct PpgStats {
+    uint16_t bpm;        // 0 = no estimate
+    uint16_t rmssdMs;
+    uint8_t quality;     // 0..100
+    uint32_t beats;
+};
+
+class PpgProcessor {
+public:
+    PpgProcessor();
+    void reset();
+
+    void push(const WaveBatch& batch);
+    void pushSample(int16_t x, uint32_t tMs);
+
+    // Estimates as of the newest sample
+    PpgStats stats() const;
+
+    // Chart values not taken yet, oldest first; older ones are dropped
+    // once PPG_DISPLAY_RING are waiting
+    size_t drain(int16_t* out, size_t n);
+
+    uint32_t samples;
+
+private:
+    void beat(uint32_t tMs);
+
+    int32_t baseline;    // Q8
+    int32_t smooth;      // Q8, band-passed signal
+    int32_t envelope;    // Q8
+    bool primed;
+
+    bool inPulse;
+    int32_t pulseMax;
+    uint32_t pulseMaxAt;
+    bool haveBeat;
+    uint32_t lastBeatAt;
+    uint32_t lastSampleAt;
+
+    uint16_t rr[PPG_RR_MAX];
+    uint8_t rrHead;
+    uint8_t rrCount;
+    uint32_t beats;
+
+    int16_t display[PPG_DISPLAY_RING];
+    uint8_t displayHead;
+    uint8_t displayCount;
+};
+
+#endif // PPG_H
@@ -4,7 +4,7 @@
 ThermalPrinterBLE thermalPrinter;
 
 ThermalPrinterBLE::ThermalPrinterBLE() 
-    : connected(false), pClient(nullptr), pWriteCharacteristic(nullptr) {
+    : connected(false), dryRun(false), dryBytes(0), pClient(nullptr), pWriteCharacteristic(nullptr) {
 }
 
 bool ThermalPrinterBLE::begin() {
@@ -105,7 +105,17 @@ void ThermalPrinterBLE::disconnect() {
     pWriteCharacteristic = nullptr;
 }
 
+void ThermalPrinterBLE::setDryRun(bool enable) {
+    dryRun = enable;
+    dryBytes = 0;
+}
+
 void ThermalPrinterBLE::writeString(const String &str) {
+    if(dryRun) {
+        dryBytes += str.length();
+        delay(10); // Same pacing as a real write
+        return;
+    }
     if(isConnected() && pWriteCharacteristic) {
         pWriteCharacteristic->writeValue(str.c_str(), str.length());
         delay(10); // Small delay
@@ -113,6 +123,11 @@ void ThermalPrinterBLE::writeString(const String &str) {
 }
 
 void ThermalPrinterBLE::writeRaw(const uint8_t *data, size_t length) {
+    if(dryRun) {
+        dryBytes += length;
+        delay(10);
+        return;
+    }
     if(isConnected() && pWriteCharacteristic) {
         pWriteCharacteristic->writeValue(data, length, false);
         delay(10);
@@ -175,7 +190,7 @@ void ThermalPrinterBLE::cutPaper() {
 
 // CHANGED FROM bool TO void (to match old working code)
 void ThermalPrinterBLE::printHealthReport(const HealthData &data) {
-    if (!isConnected()) {
+    if (!dryRun && !isConnected()) {
         Serial.println("Cannot print: Printer not connected");
         return;
     }
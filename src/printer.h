@@ -37,8 +37,15 @@ public:
     // Report printing - CHANGE THIS TO void (like in old working code)
     void printHealthReport(const HealthData &data);  // CHANGED FROM bool to void
     
+    // Dry run: reports are formatted and paced as usual but nothing goes
+    // over BLE (soak benchmark stand-in)
+    void setDryRun(bool enable);
+    uint32_t dryRunBytes() const { return dryBytes; }
+    
 private:
     bool connected;
+    bool dryRun;
+    uint32_t dryBytes;
     String deviceName;
     NimBLEClient* pClient;
     NimBLERemoteCharacteristic* pWriteCharacteristic;
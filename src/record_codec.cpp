@@ -0,0 +1,295 @@
+#include "record_codec.h"
+
+/* ==================== RecordWriter ==================== */
+RecordWriter::RecordWriter(char* out, size_t capacity)
+    : buf(out), cap(capacity), len(0), overflow(capacity == 0) {
+    if (cap > 0) buf[0] = '\0';
+}
+
+void RecordWriter::put(char c) {
+    if (overflow) return;
+    if (len + 1 >= cap) { overflow = true; return; }
+    buf[len++] = c;
+}
+
+void RecordWriter::put(const char* s, size_t n) {
+    if (overflow) return;
+    if (len + n >= cap) { overflow = true; return; }
+    memcpy(buf + len, s, n);
+    len += n;
+}
+
+void RecordWriter::put(const char* s) {
+    put(s, strlen(s));
+}
+
+void RecordWriter::putInt(long v) {
+    char tmp[12];
+    int n = 0;
+    unsigned long u = v < 0 ? 0UL - (unsigned long)v : (unsigned long)v;
+    do { tmp[n++] = '0' + (u % 10); u /= 10; } while (u);
+    if (v < 0) put('-');
+    while (n) put(tmp[--n]);
+}
+
+// Same output as String(float, decimals) for the values we store, without
+// going through printf/dtoa (which allocate on newlib).
+void RecordWriter::putFixed(float v, uint8_t decimals) {
+    if (isnan(v)) { put("nan"); return; }
+    if (isinf(v)) { put(v < 0 ? "-inf" : "inf"); return; }
+    if (v > 4294967040.0f || v < -4294967040.0f) { put("ovf"); return; }
+
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+    bool neg = v < 0;
+    uint64_t scaled = (uint64_t)((neg ? -v : v) * scale + 0.5f);
+    if (neg && scaled != 0) put('-');
+    putInt((long)(scaled / scale));
+    if (decimals == 0) return;
+    put('.');
+    uint32_t frac = scaled % scale;
+    for (uint32_t div = scale / 10; div > 0; div /= 10) {
+        put('0' + (frac / div) % 10);
+    }
+}
+
+size_t RecordWriter::finish() {
+    if (cap > 0) buf[len < cap ? len : cap - 1] = '\0';
+    return overflow ? 0 : len;
+}
+
+/* ==================== CSV ==================== */
+struct CsvVisitor {
+    RecordWriter& w;
+    bool first;
+
+    void sep() { if (!first) w.put(','); first = false; }
+
+    void text(const RecordField&, const String& s) {
+        sep();
+        const char* p = s.c_str();
+        if (strpbrk(p, ",\"\r\n") == nullptr) { w.put(p, s.length()); return; }
+        // The store is line-oriented, so embedded line breaks become spaces
+        w.put('"');
+        for (; *p; p++) {
+            if (*p == '"') w.put('"');
+            w.put((*p == '\r' || *p == '\n') ? ' ' : *p);
+        }
+        w.put('"');
+    }
+    void real(const RecordField& f, const float& v) { sep(); w.putFixed(v, f.decimals); }
+    void integer(const RecordField&, const int& v) { sep(); w.putInt(v); }
+};
+
+size_t encodeCSV(const HealthData& d, char* out, size_t cap) {
+    RecordWriter w(out, cap);
+    CsvVisitor v = {w, true};
+    visitHealthFields(d, v);
+    return w.finish();
+}
+
+size_t encodeCSVHeader(char* out, size_t cap) {
+    RecordWriter w(out, cap);
+    for (size_t i = 0; i < HEALTH_FIELD_COUNT; i++) {
+        if (i) w.put(',');
+        w.put(HEALTH_FIELDS[i].header);
+    }
+    return w.finish();
+}
+
+int splitCSV(char* line, char** fields, int maxFields) {
+    int count = 0;
+    char* r = line;
+    while (count < maxFields) {
+        char* w = r;
+        fields[count++] = w;
+        if (*r == '"') {
+            r++;
+            while (*r) {
+                if (*r == '"') {
+                    if (r[1] == '"') { *w++ = '"'; r += 2; continue; }
+                    r++;
+                    break;
+                }
+                *w++ = *r++;
+            }
+        }
+        while (*r && *r != ',' && *r != '\r' && *r != '\n') *w++ = *r++;
+        bool more = (*r == ',');
+        *w = '\0';
+        if (!more) break;
+        r++;
+    }
+    return count;
+}
+
+struct CsvDecoder {
+    char** fields;
+    size_t idx;
+
+    void text(const RecordField&, String& s) { s = fields[idx++]; }
+    void real(const RecordField&, float& v) { v = strtof(fields[idx++], nullptr); }
+    void integer(const RecordField&, int& v) { v = atoi(fields[idx++]); }
+};
+
+bool decodeCSV(char* line, HealthData& d) {
+    char* fields[HEALTH_FIELD_COUNT];
+    if (splitCSV(line, fields, HEALTH_FIELD_COUNT) != (int)HEALTH_FIELD_COUNT) return false;
+    CsvDecoder dec = {fields, 0};
+    visitHealthFields(d, dec);
+    return true;
+}
+
+/* ==================== JSON ==================== */
+struct JsonVisitor {
+    RecordWriter& w;
+    bool first;
+
+    void key(const RecordField& f) {
+        w.put(first ? '{' : ',');
+        first = false;
+        w.put('"');
+        w.put(f.key);
+        w.put("\":", 2);
+    }
+
+    void text(const RecordField& f, const String& s) {
+        key(f);
+        w.put('"');
+        static const char hex[] = "0123456789abcdef";
+        for (const char* p = s.c_str(); *p; p++) {
+            uint8_t c = (uint8_t)*p;
+            switch (c) {
+                case '"':  w.put("\\\"", 2); break;
+                case '\\': w.put("\\\\", 2); break;
+                case '\n': w.put("\\n", 2); break;
+                case '\r': w.put("\\r", 2); break;
+                case '\t': w.put("\\t", 2); break;
+                default:
+                    if (c < 0x20) {
+                        w.put("\\u00", 4);
+                        w.put(hex[c >> 4]);
+                        w.put(hex[c & 0x0F]);
+                    } else {
+                        w.put((char)c);
+                    }
+            }
+        }
+        w.put('"');
+    }
+    void real(const RecordField& f, const float& v) {
+        key(f);
+        if (isnan(v) || isinf(v)) w.put("null");
+        else w.putFixed(v, f.decimals);
+    }
+    void integer(const RecordField& f, const int& v) { key(f); w.putInt(v); }
+};
+
+size_t encodeJSON(const HealthData& d, char* out, size_t cap) {
+    RecordWriter w(out, cap);
+    JsonVisitor v = {w, true};
+    visitHealthFields(d, v);
+    w.put('}');
+    return w.finish();
+}
+
+/* ==================== BINARY ==================== */
+// Layout: version, measured-flags, then per field in table order:
+//   text  -> u8 length + bytes (longer than 255 does not fit)
+//   float -> 4 bytes IEEE-754 little endian
+//   int   -> 2 bytes little endian, clamped to int16
+struct BinaryEncoder {
+    uint8_t* out;
+    size_t cap;
+    size_t len;
+    bool overflow;
+
+    void put(const void* p, size_t n) {
+        if (overflow) return;
+        if (len + n > cap) { overflow = true; return; }
+        memcpy(out + len, p, n);
+        len += n;
+    }
+    void text(const RecordField&, const String& s) {
+        if (s.length() > 255) { overflow = true; return; }
+        uint8_t n = (uint8_t)s.length();
+        put(&n, 1);
+        put(s.c_str(), n);
+    }
+    void real(const RecordField&, const float& v) { put(&v, sizeof(float)); }
+    void integer(const RecordField&, const int& v) {
+        int16_t s = (int16_t)constrain(v, -32768, 32767);
+        put(&s, sizeof(s));
+    }
+};
+
+struct BinaryDecoder {
+    const uint8_t* in;
+    size_t len;
+    size_t pos;
+    bool error;
+
+    bool get(void* p, size_t n) {
+        if (pos + n > len) { error = true; return false; }
+        memcpy(p, in + pos, n);
+        pos += n;
+        return true;
+    }
+    void text(const RecordField&, String& s) {
+        uint8_t n;
+        if (!get(&n, 1) || pos + n > len) { error = true; return; }
+        char tmp[256];
+        memcpy(tmp, in + pos, n);
+        tmp[n] = '\0';
+        pos += n;
+        s = tmp;
+    }
+    void real(const RecordField&, float& v) { get(&v, sizeof(float)); }
+    void integer(const RecordField&, int& v) {
+        int16_t s;
+        if (get(&s, sizeof(s))) v = s;
+    }
+};
+
+size_t encodeBinary(const HealthData& d, uint8_t* out, size_t cap) {
+    uint8_t hdr[2] = {RECORD_BIN_VERSION, 0};
+    if (d.height_measured) hdr[1] |= RECORD_MEASURED_HEIGHT;
+    if (d.weight_measured) hdr[1] |= RECORD_MEASURED_WEIGHT;
+    if (d.temp_measured)   hdr[1] |= RECORD_MEASURED_TEMP;
+    if (d.hr_measured)     hdr[1] |= RECORD_MEASURED_HR;
+    if (d.bp_measured)     hdr[1] |= RECORD_MEASURED_BP;
+
+    BinaryEncoder e = {out, cap, 0, false};
+    e.put(hdr, sizeof(hdr));
+    visitHealthFields(d, e);
+    return e.overflow ? 0 : e.len;
+}
+
+bool decodeBinary(const uint8_t* in, size_t len, HealthData& d) {
+    if (len < 2 || in[0] != RECORD_BIN_VERSION) return false;
+    BinaryDecoder dec = {in, len, 2, false};
+    visitHealthFields(d, dec);
+    if (dec.error) return false;
+
+    uint8_t m = in[1];
+    d.height_measured = (m & RECORD_MEASURED_HEIGHT) != 0;
+    d.weight_measured = (m & RECORD_MEASURED_WEIGHT) != 0;
+    d.temp_measured   = (m & RECORD_MEASURED_TEMP) != 0;
+    d.hr_measured     = (m & RECORD_MEASURED_HR) != 0;
+    d.bp_measured     = (m & RECORD_MEASURED_BP) != 0;
+    return true;
+}
+
+/* ==================== HealthData convenience ==================== */
+// Empty if the record does not fit
+String HealthData::toCSV() const {
+    char buf[RECORD_CSV_MAX];
+    if (encodeCSV(*this, buf, sizeof(buf)) == 0) return String();
+    return String(buf);
+}
+
+String HealthData::toJSON() const {
+    char buf[RECORD_JSON_MAX];
+    if (encodeJSON(*this, buf, sizeof(buf)) == 0) return String();
+    return String(buf);
+}
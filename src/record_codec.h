@@ -0,0 +1,127 @@
+#ifndef RECORD_CODEC_H
+#define RECORD_CODEC_H
+
+#include <Arduino.h>
+#include "sensors.h"
+
+// Buffer sizes large enough for a typical record (name/address of a few
+// dozen characters). Encoders never grow past the caller's buffer; they
+// return 0 when the record does not fit.
+#define RECORD_CSV_MAX   512
+#define RECORD_JSON_MAX  768
+#define RECORD_BIN_MAX   320
+
+#define RECORD_BIN_VERSION 1
+
+// Longest text the info screen accepts (characters; the on-screen keyboard
+// types ASCII). At these caps a record fits every format even with each
+// character of the free text escaped to two bytes, so a checkup can always
+// be saved.
+#define RECORD_NAME_MAX     48
+#define RECORD_AGE_MAX      3
+#define RECORD_ADDRESS_MAX  100
+#define RECORD_GENDER_MAX   17                  // "Prefer not to say"
+#define RECORD_TEXT_WORST   (19 + RECORD_NAME_MAX + RECORD_AGE_MAX + RECORD_GENDER_MAX + RECORD_ADDRESS_MAX)
+#define RECORD_NUMBER_WORST (4 * 13 + 3 * 11)   // floats up to "4294967295.00", ints
+static_assert(2 * RECORD_TEXT_WORST + 10 + RECORD_NUMBER_WORST + 11 <= RECORD_CSV_MAX - 1,
+              "capped record may not fit RECORD_CSV_MAX");
+static_assert(2 * RECORD_TEXT_WORST + 10 + RECORD_NUMBER_WORST + 135 <= RECORD_JSON_MAX - 1,
+              "capped record may not fit RECORD_JSON_MAX");
+static_assert(2 + 5 + RECORD_TEXT_WORST + 4 * 4 + 3 * 2 <= RECORD_BIN_MAX,
+              "capped record may not fit RECORD_BIN_MAX");
+
+// Bits of the "measured" byte in the binary encoding
+#define RECORD_MEASURED_HEIGHT 0x01
+#define RECORD_MEASURED_WEIGHT 0x02
+#define RECORD_MEASURED_TEMP   0x04
+#define RECORD_MEASURED_HR     0x08
+#define RECORD_MEASURED_BP     0x10
+
+enum RecordFieldType : uint8_t {
+    FIELD_TEXT,
+    FIELD_FLOAT,
+    FIELD_INT
+};
+
+// One column of a stored record. Exactly one of the member pointers is set,
+// matching `type`.
+struct RecordField {
+    const char* key;        // JSON key
+    const char* header;     // CSV column header
+    RecordFieldType type;
+    uint8_t decimals;       // FIELD_FLOAT only
+    String HealthData::* text;
+    float HealthData::* real;
+    int HealthData::* integer;
+};
+
+// Field table – the single place that defines column order, JSON keys and
+// CSV headers for every serializer below.
+static constexpr RecordField HEALTH_FIELDS[] = {
+    {"timestamp",   "Timestamp",      FIELD_TEXT,  0, &HealthData::timestamp, nullptr, nullptr},
+    {"name",        "Name",           FIELD_TEXT,  0, &HealthData::name,      nullptr, nullptr},
+    {"age",         "Age",            FIELD_TEXT,  0, &HealthData::age,       nullptr, nullptr},
+    {"gender",      "Gender",         FIELD_TEXT,  0, &HealthData::gender,    nullptr, nullptr},
+    {"address",     "Address",        FIELD_TEXT,  0, &HealthData::address,   nullptr, nullptr},
+    {"weight",      "Weight(kg)",     FIELD_FLOAT, 2, nullptr, &HealthData::weight,      nullptr},
+    {"height",      "Height(cm)",     FIELD_FLOAT, 2, nullptr, &HealthData::height,      nullptr},
+    {"temperature", "Temperature(C)", FIELD_FLOAT, 2, nullptr, &HealthData::temperature, nullptr},
+    {"bmi",         "BMI",            FIELD_FLOAT, 2, nullptr, &HealthData::bmi,         nullptr},
+    {"heart_rate",  "HeartRate(BPM)", FIELD_INT,   0, nullptr, nullptr, &HealthData::heart_rate},
+    {"bp_sys",      "BP_Sys",         FIELD_INT,   0, nullptr, nullptr, &HealthData::bp_sys},
+    {"bp_dia",      "BP_Dia",         FIELD_INT,   0, nullptr, nullptr, &HealthData::bp_dia},
+};
+#define HEALTH_FIELD_COUNT (sizeof(HEALTH_FIELDS) / sizeof(HEALTH_FIELDS[0]))
+
+// Walks the field table and hands each member to the visitor.
+// Visitor must provide:
+//   void text(const RecordField&, [const] String&)
+//   void real(const RecordField&, [const] float&)
+//   void integer(const RecordField&, [const] int&)
+// Data may be `HealthData` (decoders) or `const HealthData` (encoders).
+template <class Data, class Visitor>
+void visitHealthFields(Data& d, Visitor& v) {
+    for (size_t i = 0; i < HEALTH_FIELD_COUNT; i++) {
+        const RecordField& f = HEALTH_FIELDS[i];
+        switch (f.type) {
+            case FIELD_TEXT:  v.text(f, d.*(f.text)); break;
+            case FIELD_FLOAT: v.real(f, d.*(f.real)); break;
+            case FIELD_INT:   v.integer(f, d.*(f.integer)); break;
+        }
+    }
+}
+
+// Fixed-capacity text sink. Never allocates; sets `overflow` instead of
+// growing, ignores every put after that, and keeps the buffer NUL-terminated.
+struct RecordWriter {
+    char* buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+
+    RecordWriter(char* out, size_t capacity);
+    void put(char c);
+    void put(const char* s, size_t n);
+    void put(const char* s);
+    void putInt(long v);
+    void putFixed(float v, uint8_t decimals);
+    size_t finish();   // length written, or 0 on overflow
+};
+
+// Serializers – all write into caller-provided buffers and return the number
+// of bytes written (excluding the NUL for text formats), or 0 if it didn't fit.
+size_t encodeCSV(const HealthData& d, char* out, size_t cap);
+size_t encodeCSVHeader(char* out, size_t cap);
+size_t encodeJSON(const HealthData& d, char* out, size_t cap);
+size_t encodeBinary(const HealthData& d, uint8_t* out, size_t cap);
+bool decodeBinary(const uint8_t* in, size_t len, HealthData& d);
+
+// Splits one CSV line in place (RFC 4180 quoting). `fields` point into
+// `line`. Returns the number of fields found, at most maxFields.
+int splitCSV(char* line, char** fields, int maxFields);
+
+// Parses a stored CSV line (modified in place) back into a record.
+// Returns false if the column count doesn't match the field table.
+bool decodeCSV(char* line, HealthData& d);
+
+#endif // RECORD_CODEC_H
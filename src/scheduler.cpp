@@ -0,0 +1,99 @@
+#include "scheduler.h"
+#include "console.h"
+#include "soak.h"
+#include <esp_timer.h>
+
+static TaskHandle_t loopTaskHandle = NULL;
+static lv_timer_t *inputReadTimer = NULL;
+static bool fixedDelay = false;
+
+// Time of the first wake request since the loop last looked
+static portMUX_TYPE wakeMux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t wakeRequestedUs = 0;
+
+static LatencyHistogram wakeLatency;
+static int64_t windowStartUs;
+static uint64_t idleUs;
+static uint32_t sleeps, wakesUart, wakesTouch;
+
+static void resetStats() {
+    wakeLatency.reset();
+    windowStartUs = esp_timer_get_time();
+    idleUs = 0;
+    sleeps = wakesUart = wakesTouch = 0;
+}
+
+void schedWake(uint32_t reason) {
+    if (!loopTaskHandle) return;
+    portENTER_CRITICAL(&wakeMux);
+    if (wakeRequestedUs == 0) wakeRequestedUs = esp_timer_get_time();
+    portEXIT_CRITICAL(&wakeMux);
+    xTaskNotify(loopTaskHandle, reason, eSetBits);
+}
+
+uint32_t schedIdle(uint32_t lvglDueMs) {
+    int64_t start = esp_timer_get_time();
+    uint32_t reasons = 0;
+    if (fixedDelay) {
+        delay(SCHED_FIXED_MS);
+        xTaskNotifyWait(0, 0xFFFFFFFF, &reasons, 0);   // collect, for the statistics
+    } else {
+        uint32_t ms = lvglDueMs < SCHED_MAX_SLEEP_MS ? lvglDueMs : SCHED_MAX_SLEEP_MS;
+        xTaskNotifyWait(0, 0xFFFFFFFF, &reasons, pdMS_TO_TICKS(ms));
+    }
+    int64_t now = esp_timer_get_time();
+    idleUs += now - start;
+    sleeps++;
+
+    if (reasons) {
+        portENTER_CRITICAL(&wakeMux);
+        int64_t requested = wakeRequestedUs;
+        wakeRequestedUs = 0;
+        portEXIT_CRITICAL(&wakeMux);
+        if (requested) wakeLatency.add((uint32_t)(now - requested));
+    }
+    if (reasons & SCHED_WAKE_UART) wakesUart++;
+    if (reasons & SCHED_WAKE_TOUCH) {
+        wakesTouch++;
+        if (inputReadTimer) lv_timer_ready(inputReadTimer);
+    }
+    return reasons;
+}
+
+/* ==================== CONSOLE ==================== */
+// SCHED prints idle CPU and wake statistics since the last reset; SCHED
+// FIXED | ADAPTIVE picks the loop mode and starts a new measurement.
+static void cmdSched(const char *args) {
+    if (strncasecmp(args, "FIXED", 5) == 0 || strncasecmp(args, "ADAPTIVE", 8) == 0) {
+        fixedDelay = strncasecmp(args, "FIXED", 5) == 0;
+        resetStats();
+        Serial.printf("✓ SCHED: %s loop, statistics reset\n", fixedDelay ? "fixed delay(5)" : "adaptive");
+        return;
+    }
+    if (strncasecmp(args, "RESET", 5) == 0) {
+        resetStats();
+        return;
+    }
+    int64_t span = esp_timer_get_time() - windowStartUs;
+    float secs = span / 1e6f;
+    Serial.printf("Sched: %s loop, %.1f s measured, loop task idle %.1f%%\n",
+                  fixedDelay ? "fixed delay(5)" : "adaptive", secs,
+                  span ? 100.0f * idleUs / span : 0.0f);
+    Serial.printf("  %.1f passes/s; wakes/s: uart %.1f, touch %.1f\n", sleeps / secs,
+                  wakesUart / secs, wakesTouch / secs);
+    Serial.printf("  wake latency over %lu wakes: p50 %lu us, p99 %lu us, max %lu us\n",
+                  (unsigned long)wakeLatency.count, (unsigned long)wakeLatency.percentile(50),
+                  (unsigned long)wakeLatency.percentile(99), (unsigned long)wakeLatency.maxUs);
+}
+
+static void uartReceived() {
+    schedWake(SCHED_WAKE_UART);
+}
+
+void schedBegin(lv_timer_t *inputTimer, HardwareSerial &hub) {
+    loopTaskHandle = xTaskGetCurrentTaskHandle();
+    inputReadTimer = inputTimer;
+    hub.onReceive(uartReceived, false);
+    resetStats();
+    consoleRegister("SCHED", cmdSched);
+}
@@ -0,0 +1,39 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+// Idle scheduling for the UI task.
+//
+// Instead of a fixed delay(5) after every pass, loop() sleeps until the
+// next LVGL timer is due (lv_timer_handler()'s return value), capped at
+// SCHED_MAX_SLEEP_MS so polled work – console, measure timeouts, printer
+// check – still runs often enough. Hub bytes on the UART and reports from
+// the touch task wake it early through a task notification; a touch wake
+// also makes LVGL read input on the very next pass instead of at its next
+// read period.
+//
+// The SCHED console command reports idle CPU, wakes per second by cause and
+// the wake-up latency (wake request to loop running), and SCHED FIXED
+// switches back to the old delay(5) loop to compare the two on the same
+// kiosk.
+
+#define SCHED_MAX_SLEEP_MS  50
+#define SCHED_FIXED_MS      5      // the old loop's delay
+
+#define SCHED_WAKE_UART     0x01
+#define SCHED_WAKE_TOUCH    0x02
+
+// Call once from setup() (the loop task) with LVGL's input read timer and
+// the hub's UART
+void schedBegin(lv_timer_t *inputTimer, HardwareSerial &hub);
+
+// Wake the loop early; any task
+void schedWake(uint32_t reason);
+
+// Sleep at the end of loop(). `lvglDueMs` is lv_timer_handler()'s return.
+// Returns the wake reasons (0 = timed out).
+uint32_t schedIdle(uint32_t lvglDueMs);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,157 @@
+#include "sensor_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+struct ConfigKey {
+    const char* key;
+    float SensorConfig::* real;
+    int SensorConfig::* whole;
+    float lo, hi;   // accepted range of the value itself
+};
+
+static const ConfigKey CONFIG_KEYS[] = {
+    {"temp_min",               &SensorConfig::temp_min,               nullptr, 25.0f, 45.0f},
+    {"temp_max",               &SensorConfig::temp_max,               nullptr, 25.0f, 45.0f},
+    {"temp_variance",          &SensorConfig::temp_variance,          nullptr, 0.0f,  5.0f},
+    {"hr_min",                 nullptr, &SensorConfig::hr_min,                 20.0f, 250.0f},
+    {"hr_max",                 nullptr, &SensorConfig::hr_max,                 20.0f, 250.0f},
+    {"hr_variance",            nullptr, &SensorConfig::hr_variance,            0.0f,  50.0f},
+    {"weight_min",             &SensorConfig::weight_min,             nullptr, 0.0f,  300.0f},
+    {"weight_max",             &SensorConfig::weight_max,             nullptr, 0.0f,  300.0f},
+    {"weight_variance",        &SensorConfig::weight_variance,        nullptr, 0.0f,  10.0f},
+    {"height_min",             &SensorConfig::height_min,             nullptr, 30.0f, 250.0f},
+    {"height_max",             &SensorConfig::height_max,             nullptr, 30.0f, 250.0f},
+    {"height_variance",        &SensorConfig::height_variance,        nullptr, 0.0f,  10.0f},
+    {"bp_sys_min",             nullptr, &SensorConfig::bp_sys_min,             50.0f, 260.0f},
+    {"bp_sys_max",             nullptr, &SensorConfig::bp_sys_max,             50.0f, 260.0f},
+    {"bp_dia_min",             nullptr, &SensorConfig::bp_dia_min,             30.0f, 160.0f},
+    {"bp_dia_max",             nullptr, &SensorConfig::bp_dia_max,             30.0f, 160.0f},
+    {"bp_variance",            nullptr, &SensorConfig::bp_variance,            0.0f,  30.0f},
+    {"sensor_mounting_height", &SensorConfig::sensor_mounting_height, nullptr, 100.0f, 400.0f},
+};
+
+#define CONFIG_KEY_COUNT (sizeof(CONFIG_KEYS) / sizeof(CONFIG_KEYS[0]))
+
+static bool parseNumber(const char* text, double& out) {
+    char* end;
+    out = strtod(text, &end);
+    return end != text && *end == '\0';
+}
+
+static bool applyKey(SensorConfig& c, const char* key, double v) {
+    for (size_t i = 0; i < CONFIG_KEY_COUNT; i++) {
+        const ConfigKey& k = CONFIG_KEYS[i];
+        if (strcasecmp(key, k.key) != 0) continue;
+        if (v < k.lo || v > k.hi) return false;
+        if (k.real) {
+            c.*(k.real) = (float)v;
+        } else {
+            if (v != (int)v) return false;
+            c.*(k.whole) = (int)v;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool configParse(const char* text, SensorConfig& out, int* errLine) {
+    SensorConfig c;
+    bool versionSeen = false;
+    int lineNo = 0;
+
+    while (*text) {
+        lineNo++;
+        const char* eol = strchr(text, '\n');
+        size_t n = eol ? (size_t)(eol - text) : strlen(text);
+        char line[96];
+        if (n >= sizeof(line)) {
+            if (errLine) *errLine = lineNo;
+            return false;
+        }
+        memcpy(line, text, n);
+        line[n] = '\0';
+        text += eol ? n + 1 : n;
+
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        char* end = p + strlen(p);
+        while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) *--end = '\0';
+        if (*p == '\0') continue;
+
+        bool ok = false;
+        char* value = p;
+        while (*value && *value != ' ' && *value != '\t') value++;
+        if (*value) {
+            *value++ = '\0';
+            while (*value == ' ' || *value == '\t') value++;
+            double v;
+            if (!parseNumber(value, v)) {
+                ok = false;
+            } else if (strcasecmp(p, "version") == 0) {
+                // Must come first, so an old kiosk never half-applies a newer file
+                ok = !versionSeen && v == CONFIG_VERSION;
+                versionSeen = true;
+            } else {
+                ok = versionSeen && applyKey(c, p, v);
+            }
+        }
+        if (!ok) {
+            if (errLine) *errLine = lineNo;
+            return false;
+        }
+    }
+    if (!versionSeen) {
+        if (errLine) *errLine = 0;
+        return false;
+    }
+    out = c;
+    return true;
+}
+
+const char* configValidate(const SensorConfig& c) {
+    for (size_t i = 0; i < CONFIG_KEY_COUNT; i++) {
+        const ConfigKey& k = CONFIG_KEYS[i];
+        float v = k.real ? c.*(k.real) : (float)(c.*(k.whole));
+        if (!(v >= k.lo && v <= k.hi)) return k.key;   // also catches NaN
+    }
+    if (c.temp_min >= c.temp_max) return "temp_min not below temp_max";
+    if (c.hr_min >= c.hr_max) return "hr_min not below hr_max";
+    if (c.weight_min >= c.weight_max) return "weight_min not below weight_max";
+    if (c.height_min >= c.height_max) return "height_min not below height_max";
+    if (c.bp_sys_min >= c.bp_sys_max) return "bp_sys_min not below bp_sys_max";
+    if (c.bp_dia_min >= c.bp_dia_max) return "bp_dia_min not below bp_dia_max";
+    if (c.bp_dia_max >= c.bp_sys_max) return "bp_dia_max not below bp_sys_max";
+    if (c.sensor_mounting_height <= c.height_max) return "sensor_mounting_height not above height_max";
+    return NULL;
+}
+
+const char* bpValidate(const SensorConfig& c, int sys, int dia) {
+    if (sys < c.bp_sys_min || sys > c.bp_sys_max) return "Systolic out of range";
+    if (dia < c.bp_dia_min || dia > c.bp_dia_max) return "Diastolic out of range";
+    if (dia >= sys) return "Diastolic must be below systolic";
+    return NULL;
+}
+
+void configFormat(const SensorConfig& c, void (*fn)(const char* line, void* ctx), void* ctx) {
+    char line[48];
+    snprintf(line, sizeof(line), "version %d", CONFIG_VERSION);
+    fn(line, ctx);
+    for (size_t i = 0; i < CONFIG_KEY_COUNT; i++) {
+        const ConfigKey& k = CONFIG_KEYS[i];
+        if (k.real) snprintf(line, sizeof(line), "%s %.2f", k.key, c.*(k.real));
+        else snprintf(line, sizeof(line), "%s %d", k.key, c.*(k.whole));
+        fn(line, ctx);
+    }
+}
+
+const char* configSourceName(uint8_t source) {
+    switch (source) {
+        case CFG_SD:  return "SD";
+        case CFG_NVS: return "NVS";
+        default:      return "defaults";
+    }
+}
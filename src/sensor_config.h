@@ -0,0 +1,93 @@
+#ifndef SENSOR_CONFIG_H
+#define SENSOR_CONFIG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Runtime sensor configuration: plausible ranges for every reading and the
+// ultrasonic mounting height. The compiled-in values below are only the
+// last fallback; at boot the kiosk takes /config/sensors.cfg from the SD
+// card, else the copy last accepted into NVS, else these defaults, so a
+// fleet is retuned by copying one file instead of reflashing.
+//
+// The file is "key value" lines with '#' comments, the same format as
+// simulator scenarios, and must start with "version 1". Unset keys keep
+// the defaults. Every value is range-checked and the result cross-checked
+// (min below max, sensor mounted above the tallest patient) before it
+// replaces the running configuration.
+//
+// Parsing and validation are kept free of Arduino dependencies so they run
+// on a host; loading from SD and NVS lives in sensors.cpp.
+
+#define CONFIG_FILE      "/config/sensors.cfg"
+#define CONFIG_NAMESPACE "sensorcfg"
+#define CONFIG_VERSION   1
+#define CONFIG_TEXT_MAX  2048
+
+struct SensorConfig {
+    // Temperature range (Celsius)
+    float temp_min = 35.0;
+    float temp_max = 42.0;
+    float temp_variance = 0.5;
+
+    // Heart rate range (BPM)
+    int hr_min = 50;
+    int hr_max = 120;
+    int hr_variance = 10;
+
+    // Weight range (kg)
+    float weight_min = 40.0;
+    float weight_max = 120.0;
+    float weight_variance = 0.5;
+
+    // Height range (cm) - Updated based on sensor
+    float height_min = 140.0;
+    float height_max = 200.0;
+    float height_variance = 0.5;
+
+    // Blood pressure ranges
+    int bp_sys_min = 90;
+    int bp_sys_max = 180;
+    int bp_dia_min = 60;
+    int bp_dia_max = 120;
+    int bp_variance = 5;
+
+    // Ultrasonic sensor mounting height (cm from ground)
+    float sensor_mounting_height = 250.0; // Default 2.5m
+};
+
+enum ConfigSource { CFG_DEFAULTS, CFG_NVS, CFG_SD };
+
+// Binary form of a configuration, as stored in NVS and handed to readers:
+// the flat struct plus what is needed to trust it. Readers use `cfg`
+// directly; `generation` changes on every accepted reload so anything
+// derived from the ranges knows to recompute.
+struct ConfigSnapshot {
+    uint16_t version;
+    uint8_t source;         // ConfigSource
+    uint8_t reserved;
+    uint32_t generation;
+    SensorConfig cfg;
+    uint32_t crc;           // over everything above
+};
+
+// Parse configuration text over the defaults. Returns false and the
+// offending line (0 for a missing version line) on error; `out` is only
+// written on success.
+bool configParse(const char* text, SensorConfig& out, int* errLine);
+
+// NULL if the configuration is usable, otherwise the out-of-range key or
+// the failed cross-check
+const char* configValidate(const SensorConfig& c);
+
+// NULL if a blood pressure reading is inside the bp_* ranges with
+// diastolic below systolic, otherwise what is wrong with it
+const char* bpValidate(const SensorConfig& c, int sys, int dia);
+
+// Print every key with its value in the file format (fn gets one line at
+// a time, without the newline)
+void configFormat(const SensorConfig& c, void (*fn)(const char* line, void* ctx), void* ctx);
+
+const char* configSourceName(uint8_t source);
+
+#endif // SENSOR_CONFIG_H
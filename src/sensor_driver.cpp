@@ -0,0 +1,435 @@
+#include "sensor_driver.h"
+#include "sensor_table.h"
+#include "simulator.h"
+#include "console.h"
+#include <Preferences.h>
+#include <Wire.h>
+#include <driver/rmt.h>
+
+/* ==================== ULTRASONIC (RMT) ==================== */
+// The echo pulse is timed by an RMT receive channel at 1 µs per tick
+// instead of pulseIn() spinning for up to 30 ms. poll() fires the 10 µs
+// trigger and picks up the capture the channel finished on its own.
+#define ULTRASONIC_RMT_CHANNEL  RMT_CHANNEL_4   // ESP32-S3: RX channels are 4-7
+#define ULTRASONIC_PERIOD_MS    60              // let echoes die out between pings
+#define ULTRASONIC_TIMEOUT_US   30000           // no edge for this long ends a capture
+#define ULTRASONIC_US_PER_CM    58.0f           // round trip
+
+class UltrasonicDriver : public SensorDriver {
+public:
+    UltrasonicDriver() : ring(NULL), running(false), periodMs(ULTRASONIC_PERIOD_MS), nextPing(0) {}
+    const char* name() const { return "ultrasonic"; }
+
+    bool begin() {
+#if ULTRASONIC_TRIG_PIN >= 0 && ULTRASONIC_ECHO_PIN >= 0
+        pinMode(ULTRASONIC_TRIG_PIN, OUTPUT);
+        digitalWrite(ULTRASONIC_TRIG_PIN, LOW);
+        rmt_config_t cfg = RMT_DEFAULT_CONFIG_RX((gpio_num_t)ULTRASONIC_ECHO_PIN, ULTRASONIC_RMT_CHANNEL);
+        cfg.clk_div = 80;                              // 1 µs ticks
+        cfg.rx_config.idle_threshold = ULTRASONIC_TIMEOUT_US;
+        cfg.rx_config.filter_en = true;
+        cfg.rx_config.filter_ticks_thresh = 100;       // APB cycles: glitches under 1.25 µs
+        if (rmt_config(&cfg) != ESP_OK || rmt_driver_install(ULTRASONIC_RMT_CHANNEL, 256, 0) != ESP_OK) {
+            return false;
+        }
+        rmt_get_ringbuf_handle(ULTRASONIC_RMT_CHANNEL, &ring);
+        return ring != NULL;
+#else
+        return false;
+#endif
+    }
+
+    void start(uint8_t rateHz) {
+        periodMs = rateHz ? max<uint32_t>(1000 / rateHz, ULTRASONIC_PERIOD_MS) : ULTRASONIC_PERIOD_MS;
+        rmt_rx_start(ULTRASONIC_RMT_CHANNEL, true);
+        nextPing = millis();
+        running = true;
+    }
+
+    void stop() {
+        rmt_rx_stop(ULTRASONIC_RMT_CHANNEL);
+        running = false;
+    }
+
+    bool poll(uint32_t now, float& value) {
+        if (!running) return false;
+        bool got = false;
+        size_t size = 0;
+        rmt_item32_t* items = (rmt_item32_t*)xRingbufferReceive(ring, &size, 0);
+        if (items) {
+            // The capture starts at the echo's rising edge
+            if (size >= sizeof(rmt_item32_t) && items[0].level0 == 1 && items[0].duration0 > 0) {
+                value = sensorConfig.sensor_mounting_height - items[0].duration0 / ULTRASONIC_US_PER_CM;
+                got = true;
+            }
+            vRingbufferReturnItem(ring, items);
+        }
+#if ULTRASONIC_TRIG_PIN >= 0
+        if ((int32_t)(now - nextPing) >= 0) {
+            digitalWrite(ULTRASONIC_TRIG_PIN, HIGH);
+            delayMicroseconds(10);
+            digitalWrite(ULTRASONIC_TRIG_PIN, LOW);
+            nextPing = now + periodMs;
+        }
+#endif
+        return got;
+    }
+
+private:
+    RingbufHandle_t ring;
+    bool running;
+    uint32_t periodMs;
+    uint32_t nextPing;
+};
+
+/* ==================== LOAD CELL (HX711) ==================== */
+// The HX711 converts continuously (10 Hz) and pulls DOUT low when a reading
+// is ready, so poll() only clocks out a conversion that is already there –
+// 25 clock pulses, about 50 µs. The first readings after boot set the tare,
+// which is why it samples even while no stream runs; the kiosk's CAL
+// calibration takes care of the gain.
+#define HX711_COUNTS_PER_KG  21000.0f   // typical 4-cell platform
+#define HX711_TARE_READINGS  8
+
+class Hx711Driver : public SensorDriver {
+public:
+    Hx711Driver() : running(false), tare(0), tareSum(0), tareCount(0) {}
+    const char* name() const { return "hx711"; }
+
+    bool begin() {
+#if HX711_DOUT_PIN >= 0 && HX711_SCK_PIN >= 0
+        pinMode(HX711_DOUT_PIN, INPUT);
+        pinMode(HX711_SCK_PIN, OUTPUT);
+        digitalWrite(HX711_SCK_PIN, LOW);   // SCK low = powered up
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void start(uint8_t) { running = true; }
+    void stop() { running = false; }
+
+    bool poll(uint32_t, float& value) {
+#if HX711_DOUT_PIN >= 0 && HX711_SCK_PIN >= 0
+        if (digitalRead(HX711_DOUT_PIN) == HIGH) return false;   // converting
+        int32_t raw = read();
+        if (tareCount < HX711_TARE_READINGS) {
+            tareSum += raw;
+            if (++tareCount == HX711_TARE_READINGS) tare = tareSum / HX711_TARE_READINGS;
+            return false;
+        }
+        if (!running) return false;
+        value = (raw - tare) / HX711_COUNTS_PER_KG;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    int32_t read() {
+        uint32_t bits = 0;
+#if HX711_DOUT_PIN >= 0 && HX711_SCK_PIN >= 0
+        // 24 data bits MSB first, then a 25th pulse: channel A, gain 128
+        for (uint8_t i = 0; i < 25; i++) {
+            digitalWrite(HX711_SCK_PIN, HIGH);
+            delayMicroseconds(1);
+            if (i < 24) bits = (bits << 1) | digitalRead(HX711_DOUT_PIN);
+            digitalWrite(HX711_SCK_PIN, LOW);
+            delayMicroseconds(1);
+        }
+#endif
+        return (int32_t)(bits << 8) >> 8;   // sign-extend
+    }
+
+    bool running;
+    int32_t tare;
+    int64_t tareSum;
+    uint8_t tareCount;
+};
+
+/* ==================== IR THERMOMETER (MLX90614) ==================== */
+// SMBus read of the object temperature register on its own I2C bus; the
+// sensor updates it continuously, so there is nothing to wait for.
+#define MLX90614_ADDR       0x5A
+#define MLX90614_TOBJ1      0x07
+#define MLX90614_PERIOD_MS  100
+
+class Mlx90614Driver : public SensorDriver {
+public:
+    Mlx90614Driver() : running(false), periodMs(MLX90614_PERIOD_MS), nextRead(0) {}
+    const char* name() const { return "mlx90614"; }
+
+    bool begin() {
+#if MLX90614_SDA_PIN >= 0 && MLX90614_SCL_PIN >= 0
+        if (!Wire1.begin(MLX90614_SDA_PIN, MLX90614_SCL_PIN, 100000)) return false;
+        Wire1.beginTransmission(MLX90614_ADDR);
+        return Wire1.endTransmission() == 0;
+#else
+        return false;
+#endif
+    }
+
+    void start(uint8_t rateHz) {
+        periodMs = rateHz ? max<uint32_t>(1000 / rateHz, MLX90614_PERIOD_MS) : MLX90614_PERIOD_MS;
+        nextRead = millis();
+        running = true;
+    }
+
+    void stop() { running = false; }
+
+    bool poll(uint32_t now, float& value) {
+        if (!running || (int32_t)(now - nextRead) < 0) return false;
+        nextRead = now + periodMs;
+        Wire1.beginTransmission(MLX90614_ADDR);
+        Wire1.write(MLX90614_TOBJ1);
+        if (Wire1.endTransmission(false) != 0) return false;
+        if (Wire1.requestFrom(MLX90614_ADDR, 3) != 3) return false;
+        uint16_t raw = Wire1.read();
+        raw |= Wire1.read() << 8;
+        Wire1.read();                         // PEC
+        if (raw & 0x8000) return false;       // error flag
+        value = raw * 0.02f - 273.15f;        // 0.02 K per count
+        return true;
+    }
+
+private:
+    bool running;
+    uint32_t periodMs;
+    uint32_t nextRead;
+};
+
+/* ==================== SIMULATED CHANNEL ==================== */
+// A private SimEngine streaming just this sensor, for trying a kiosk with
+// one sensor missing or exercising a local driver's slot without hardware.
+class SimDriver : public SensorDriver {
+public:
+    explicit SimDriver(uint8_t s) : sensor(s), running(false), fresh(false), latest(0), lastMs(0) {}
+    const char* name() const { return "sim"; }
+
+    bool begin() {
+        SimScenario scenario;
+        simDefaultScenario(scenario);
+        scenario.seed = random(1, 0x7FFFFFFF);
+        engine.begin(scenario);
+        return true;
+    }
+
+    void start(uint8_t rateHz) {
+        uint8_t rates[HUB_SENSOR_COUNT] = {0};
+        rates[sensor - 1] = rateHz;
+        uint8_t cmd[SUBSCRIBE_CMD_LEN];
+        engine.command(cmd, encodeSubscribe(HUB_SENSOR_BIT(sensor), rates, cmd));
+        lastMs = millis();
+        running = true;
+    }
+
+    void stop() {
+        uint8_t cmd = CMD_STOP_STREAM;
+        engine.command(&cmd, 1);
+        running = false;
+    }
+
+    bool poll(uint32_t now, float& value) {
+        if (!running) return false;
+        engine.advance(now - lastMs, sink, this);
+        lastMs = now;
+        if (!fresh) return false;
+        fresh = false;
+        value = latest;
+        return true;
+    }
+
+private:
+    static void sink(const uint8_t* bytes, size_t len, void* ctx) {
+        SimDriver* d = (SimDriver*)ctx;
+        for (size_t i = 0; i < len; i++) d->decoder.push(bytes[i], onFrame, d);
+    }
+    static void onFrame(const HubFrame& frame, void* ctx) {
+        SimDriver* d = (SimDriver*)ctx;
+        if (frame.type != FRAME_STREAM || frame.sample.sensor != d->sensor) return;
+        d->latest = frame.sample.value;
+        d->fresh = true;
+    }
+
+    uint8_t sensor;
+    bool running;
+    bool fresh;
+    float latest;
+    uint32_t lastMs;
+    SimEngine engine;
+    FrameDecoder decoder;
+};
+
+/* ==================== SELECTION ==================== */
+static const char* const KIND_NAMES[DRV_KINDS] = {"hub", "local", "sim"};
+
+static UltrasonicDriver ultrasonic;
+static Hx711Driver hx711;
+static Mlx90614Driver mlx90614;
+static SimDriver simDrivers[HUB_SENSOR_COUNT] = {
+    SimDriver(HUB_SENSOR_HEIGHT), SimDriver(HUB_SENSOR_WEIGHT), SimDriver(HUB_SENSOR_TEMP), SimDriver(HUB_SENSOR_PULSE)
+};
+
+// Local driver of each sensor in HUB_SENSOR_* order; NULL = hub only
+static SensorDriver* const LOCAL_DRIVERS[HUB_SENSOR_COUNT] = {&ultrasonic, &hx711, &mlx90614, NULL};
+
+static DriverKind kinds[HUB_SENSOR_COUNT];
+static bool begun[HUB_SENSOR_COUNT][DRV_KINDS];
+static bool running[HUB_SENSOR_COUNT];
+static uint32_t readings[HUB_SENSOR_COUNT];
+static Preferences driverPrefs;
+static bool driverPrefsOpen = false;
+
+static SensorDriver* driverFor(uint8_t idx, DriverKind kind) {
+    if (kind == DRV_LOCAL) return LOCAL_DRIVERS[idx];
+    if (kind == DRV_SIM) return &simDrivers[idx];
+    return NULL;
+}
+
+static void startDriver(uint8_t idx, uint8_t rateHz) {
+    driverFor(idx, kinds[idx])->start(rateHz);
+    running[idx] = true;
+}
+
+static void stopDriver(uint8_t idx) {
+    if (!running[idx]) return;
+    driverFor(idx, kinds[idx])->stop();
+    running[idx] = false;
+}
+
+static void stopAll() {
+    for (uint8_t i = 0; i < HUB_SENSOR_COUNT; i++) stopDriver(i);
+}
+
+// A stream running on the old driver just ends; MeasureFlow reports the
+// sensor as not responding and START picks up the new one
+bool driverSelect(uint8_t sensor, DriverKind kind) {
+    if (sensor < HUB_SENSOR_HEIGHT || sensor > HUB_SENSOR_PULSE || kind >= DRV_KINDS) return false;
+    uint8_t idx = sensor - 1;
+    SensorDriver* drv = driverFor(idx, kind);
+    if (kind != DRV_HUB && !drv) return false;
+    if (drv && !begun[idx][kind]) {
+        if (!drv->begin()) return false;
+        begun[idx][kind] = true;
+    }
+    stopDriver(idx);
+    kinds[idx] = kind;
+    return true;
+}
+
+DriverKind driverKind(uint8_t sensor) {
+    if (sensor < HUB_SENSOR_HEIGHT || sensor > HUB_SENSOR_PULSE) return DRV_HUB;
+    return kinds[sensor - 1];
+}
+
+/* ==================== ROUTING ==================== */
+size_t driversRoute(const uint8_t* cmd, size_t len, uint8_t* out) {
+    if (len == 0) return 0;
+    if (len > DRIVER_ROUTE_MAX) len = DRIVER_ROUTE_MAX;
+    memcpy(out, cmd, len);
+
+    switch (cmd[0]) {
+        case CMD_STOP_STREAM:
+            stopAll();
+            break;
+        case CMD_START_STREAM: {
+            // START replaces whatever streamed, on either side
+            stopAll();
+            uint8_t sensor = len > 1 ? cmd[1] : 0;
+            if (driverKind(sensor) != DRV_HUB) {
+                startDriver(sensor - 1, 0);
+                out[0] = CMD_STOP_STREAM;
+                return 1;
+            }
+            break;
+        }
+        case CMD_START_WAVE:
+            if (kinds[HUB_SENSOR_PULSE - 1] != DRV_HUB) return 0;   // no waveform off the hub
+            break;
+        case CMD_SUBSCRIBE: {
+            if (len < SUBSCRIBE_CMD_LEN) break;
+            for (uint8_t i = 0; i < HUB_SENSOR_COUNT; i++) {
+                if (kinds[i] == DRV_HUB) continue;
+                uint8_t bit = HUB_SENSOR_BIT(i + 1);
+                stopDriver(i);
+                if (cmd[1] & bit) startDriver(i, cmd[2 + i]);
+                out[1] &= ~bit;
+            }
+            break;
+        }
+    }
+    return len;
+}
+
+void driversPoll(uint32_t now, HubFrameHandler handler, void* ctx) {
+    for (uint8_t i = 0; i < HUB_SENSOR_COUNT; i++) {
+        if (kinds[i] == DRV_HUB) continue;
+        float value;
+        if (!driverFor(i, kinds[i])->poll(now, value) || !running[i]) continue;
+        readings[i]++;
+        HubFrame frame;
+        frame.type = FRAME_STREAM;
+        frame.sample.sensor = i + 1;
+        frame.sample.value = value;
+        frame.sample.timestamp = now;
+        handler(frame, ctx);
+    }
+}
+
+/* ==================== CONSOLE ==================== */
+// DRIVER lists what backs each sensor; DRIVER <sensor> HUB|LOCAL|SIM
+// switches one and remembers the choice.
+static void cmdDriver(const char* args) {
+    if (*args == '\0') {
+        for (uint8_t i = 0; i < HUB_SENSOR_COUNT; i++) {
+            SensorDriver* drv = driverFor(i, kinds[i]);
+            Serial.printf("  %-7s %-5s %-10s %s, %lu readings\n", SENSOR_TABLE[i].key, KIND_NAMES[kinds[i]],
+                          drv ? drv->name() : "uart", running[i] ? "running" : "idle",
+                          (unsigned long)readings[i]);
+        }
+        return;
+    }
+    const char* kindArg = strchr(args, ' ');
+    size_t keyLen = kindArg ? kindArg - args : strlen(args);
+    while (kindArg && *kindArg == ' ') kindArg++;
+
+    uint8_t sensor = 0;
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        if (strlen(SENSOR_TABLE[i].key) == keyLen && strncasecmp(args, SENSOR_TABLE[i].key, keyLen) == 0) {
+            sensor = SENSOR_TABLE[i].id;
+        }
+    }
+    uint8_t kind = DRV_KINDS;
+    for (uint8_t k = 0; kindArg && k < DRV_KINDS; k++) {
+        if (strcasecmp(kindArg, KIND_NAMES[k]) == 0) kind = k;
+    }
+    if (!sensor || kind == DRV_KINDS) {
+        Serial.println("✗ DRIVER: usage DRIVER [height|weight|temp|pulse HUB|LOCAL|SIM]");
+        return;
+    }
+    const char* key = sensorDescriptor(sensor).key;
+    if (!driverSelect(sensor, (DriverKind)kind)) {
+        Serial.printf("✗ DRIVER: no %s driver for %s fitted\n", KIND_NAMES[kind], key);
+        return;
+    }
+    if (driverPrefsOpen) driverPrefs.putUChar(key, kind);
+    Serial.printf("✓ DRIVER: %s from %s\n", key, KIND_NAMES[kind]);
+}
+
+void driversBegin() {
+    driverPrefsOpen = driverPrefs.begin(DRIVER_NAMESPACE, false);
+    for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+        const char* key = sensorDescriptor(s).key;
+        uint8_t kind = driverPrefsOpen ? driverPrefs.getUChar(key, DRV_HUB) : DRV_HUB;
+        if (kind == DRV_HUB) continue;
+        if (driverSelect(s, (DriverKind)kind)) {
+            Serial.printf("✓ Driver: %s from %s (%s)\n", key, KIND_NAMES[kind], driverFor(s - 1, kinds[s - 1])->name());
+        } else {
+            Serial.printf("✗ Driver: %s %s driver not answering, using the hub\n", key,
+                          kind < DRV_KINDS ? KIND_NAMES[kind] : "unknown");
+        }
+    }
+    consoleRegister("DRIVER", cmdDriver);
+}
@@ -0,0 +1,72 @@
+#ifndef SENSOR_DRIVER_H
+#define SENSOR_DRIVER_H
+
+#include <Arduino.h>
+#include "hub_protocol.h"
+
+// Sensor drivers: where each hub sensor's readings come from.
+//
+// By default every sensor is read through the UART hub (or the SIM console
+// command's simulated hub). A kiosk can instead back a sensor with a local
+// driver – an ultrasonic ranger captured by the RMT peripheral, an HX711
+// load cell or an MLX90614 thermometer wired to the board – or with its
+// own simulator channel. The choice is made per sensor with the DRIVER
+// console command and kept in NVS, so it survives a reboot.
+//
+// The rest of the firmware keeps talking hub protocol: hub commands pass
+// through driversRoute(), which starts and stops the drivers behind the
+// sensors they name and returns what is left for the hub, and
+// driversPoll() hands driver readings on as stream frames, so MeasureFlow,
+// ParallelCapture, calibration and the stream store cannot tell a local
+// sensor from a hub channel. Local sensors answer stream commands only;
+// CMD_MEASURE data frames still come from the hub alone.
+//
+// poll() never waits: it starts a conversion, or collects one the hardware
+// finished on its own, and returns. The longest it takes is one MLX90614
+// bus transaction (about 0.5 ms at 100 kHz).
+
+#define DRIVER_NAMESPACE  "drivers"
+#define DRIVER_ROUTE_MAX  SUBSCRIBE_CMD_LEN   // largest hub command
+
+enum DriverKind : uint8_t {
+    DRV_HUB,      // the hub (or SIM ON)
+    DRV_LOCAL,    // sensor wired to the kiosk
+    DRV_SIM,      // simulated channel of its own
+    DRV_KINDS
+};
+
+class SensorDriver {
+public:
+    virtual ~SensorDriver() {}
+    virtual const char* name() const = 0;
+
+    // Claim pins and peripherals; false if the sensor is not fitted.
+    // Called once, when the driver is first selected.
+    virtual bool begin() = 0;
+
+    // Sample at `rateHz` (0 = the driver's own rate) until stop()
+    virtual void start(uint8_t rateHz) = 0;
+    virtual void stop() = 0;
+
+    // A new reading in the sensor's units, if one is ready
+    virtual bool poll(uint32_t now, float& value) = 0;
+};
+
+// Loads the per-sensor selection from NVS and registers DRIVER. A stored
+// local driver that fails begin() falls back to the hub.
+void driversBegin();
+
+// Back `sensor` (HUB_SENSOR_*) with another driver; false if that kind is
+// not available for the sensor or the hardware does not answer
+bool driverSelect(uint8_t sensor, DriverKind kind);
+DriverKind driverKind(uint8_t sensor);
+
+// Starts / stops drivers for the sensors a hub command names. Writes the
+// part of the command still meant for the hub to `out` (at least
+// DRIVER_ROUTE_MAX bytes) and returns its length, 0 for nothing.
+size_t driversRoute(const uint8_t* cmd, size_t len, uint8_t* out);
+
+// Hands every ready driver reading to `handler` as a FRAME_STREAM frame
+void driversPoll(uint32_t now, HubFrameHandler handler, void* ctx);
+
+#endif // SENSOR_DRIVER_H
@@ -0,0 +1,100 @@
+#ifndef SENSOR_TABLE_H
+#define SENSOR_TABLE_H
+
+#include <Arduino.h>
+#include "sensors.h"
+#include "hub_protocol.h"
+#include "record_codec.h"
+
+// Sensor descriptor table – the single place that names each hub sensor and
+// says how its readings are shown and where they are kept. Sensor screens,
+// live readouts, the dashboard, the results report and the calibration
+// picker are all generated from it, and captures are stored through it.
+//
+// Values reach HealthData through accessors instantiated per member by the
+// templates below, so the per-sample path is an indirect call and a printf
+// with the entry's width and precision, never a switch on the sensor.
+//
+// A sensor also needs its HealthData member and a HEALTH_FIELDS column (the
+// stored record format is shared with the export tools); the checks at the
+// bottom fail the build if the table and the record format disagree.
+
+enum SensorClass : uint8_t {
+    SC_BODY,    // body measurement; feeds BMI
+    SC_VITAL    // vital sign
+};
+
+typedef void (*SensorStore)(HealthData &d, float v);
+typedef float (*SensorLoad)(const HealthData &d);
+
+template <float HealthData::* M> void storeReal(HealthData &d, float v) { d.*M = v; }
+template <float HealthData::* M> float loadReal(const HealthData &d) { return d.*M; }
+template <int HealthData::* M> void storeWhole(HealthData &d, float v) { d.*M = (int)v; }
+template <int HealthData::* M> float loadWhole(const HealthData &d) { return (float)(d.*M); }
+
+struct SensorDescriptor {
+    uint8_t id;               // HUB_SENSOR_* (also the MeasureFlow step)
+    const char *key;          // console and log name
+    const char *label;        // "Height: 170.5 cm"
+    const char *caption;      // dashboard tile
+    const char *title;        // sensor screen
+    const char *icon;
+    const char *instruction;
+    const char *unit;
+    uint8_t width;            // printf field width of the value
+    uint8_t decimals;
+    float lo, hi;             // plausible readings; anything else is no reading
+    uint8_t streamId;         // hub stream channel
+    SensorClass cls;
+    bool waveform;            // hub can stream its raw waveform (CMD_START_WAVE)
+    const char *recordKey;    // HEALTH_FIELDS column
+    SensorStore store;
+    SensorLoad load;
+    bool HealthData::* measured;
+};
+
+static constexpr SensorDescriptor SENSOR_TABLE[] = {
+    {HUB_SENSOR_HEIGHT, "height", "Height", "HEIGHT", "HEIGHT SENSOR", "📏",
+     "Stand straight under sensor", "cm", 5, 1, 30.0f, 250.0f, HUB_SENSOR_HEIGHT, SC_BODY, false,
+     "height", storeReal<&HealthData::height>, loadReal<&HealthData::height>, &HealthData::height_measured},
+    {HUB_SENSOR_WEIGHT, "weight", "Weight", "WEIGHT", "WEIGHT SCALE", "⚖️",
+     "Step onto scale platform", "kg", 5, 1, 1.0f, 300.0f, HUB_SENSOR_WEIGHT, SC_BODY, false,
+     "weight", storeReal<&HealthData::weight>, loadReal<&HealthData::weight>, &HealthData::weight_measured},
+    {HUB_SENSOR_TEMP, "temp", "Temp", "TEMPERATURE", "TEMPERATURE", "🌡️",
+     "Look at thermal sensor from 5cm away", "°C", 4, 1, 25.0f, 45.0f, HUB_SENSOR_TEMP, SC_VITAL, false,
+     "temperature", storeReal<&HealthData::temperature>, loadReal<&HealthData::temperature>, &HealthData::temp_measured},
+    {HUB_SENSOR_PULSE, "pulse", "Heart Rate", "HEART RATE", "PULSE RATE", "❤️",
+     "Place finger on sensor", "BPM", 0, 0, 20.0f, 250.0f, HUB_SENSOR_PULSE, SC_VITAL, true,
+     "heart_rate", storeWhole<&HealthData::heart_rate>, loadWhole<&HealthData::heart_rate>, &HealthData::hr_measured},
+};
+#define SENSOR_COUNT (sizeof(SENSOR_TABLE) / sizeof(SENSOR_TABLE[0]))
+
+// Entry of a HUB_SENSOR_* number (1-based, like the hub protocol)
+inline const SensorDescriptor &sensorDescriptor(uint8_t id) {
+    return SENSOR_TABLE[id >= 1 && id <= SENSOR_COUNT ? id - 1 : 0];
+}
+
+inline bool sensorPlausible(const SensorDescriptor &s, float v) {
+    return v >= s.lo && v <= s.hi;
+}
+
+// "<value> <unit>" at the entry's width and precision
+inline int sensorFormat(const SensorDescriptor &s, float v, char *buf, size_t n) {
+    return snprintf(buf, n, "%*.*f %s", s.width, s.decimals, v, s.unit);
+}
+
+/* ==================== CONSISTENCY CHECKS ==================== */
+constexpr bool sensorStrEq(const char *a, const char *b) {
+    return *a == *b && (*a == '\0' || sensorStrEq(a + 1, b + 1));
+}
+constexpr bool sensorHasColumn(const char *key, size_t i = 0) {
+    return i < HEALTH_FIELD_COUNT && (sensorStrEq(HEALTH_FIELDS[i].key, key) || sensorHasColumn(key, i + 1));
+}
+constexpr bool sensorTableValid(size_t i = 0) {
+    return i >= SENSOR_COUNT ||
+           (SENSOR_TABLE[i].id == i + 1 && sensorHasColumn(SENSOR_TABLE[i].recordKey) && sensorTableValid(i + 1));
+}
+static_assert(SENSOR_COUNT == HUB_SENSOR_COUNT, "one descriptor per hub sensor");
+static_assert(sensorTableValid(), "descriptors must be in HUB_SENSOR_* order and have a HEALTH_FIELDS column");
+
+#endif // SENSOR_TABLE_H
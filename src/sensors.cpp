@@ -1,61 +1,148 @@
 #include "sensors.h"
+#include "simulator.h"
+#include "sensor_table.h"
+#include "stream_store.h"
+#include "bp_cuff.h"
+#include <Preferences.h>
+#include <rom/crc.h>
 
-SensorConfig sensorConfig;
+static ConfigSnapshot activeConfig;
+const SensorConfig& sensorConfig = activeConfig.cfg;
 HealthData currentHealthData;
 
-// Simulate realistic sensor readings
-float simulateTemperature() {
-    // Normal range with some variance
-    float baseTemp = 36.5;
-    float variance = random(-100, 100) / 100.0 * sensorConfig.temp_variance;
-    return constrain(baseTemp + variance, sensorConfig.temp_min, sensorConfig.temp_max);
+/* ==================== CONFIGURATION ==================== */
+static Preferences configPrefs;
+static bool configPrefsOpen = false;
+
+static uint32_t snapshotCRC(const ConfigSnapshot& s) {
+    return crc32_le(0, (const uint8_t*)&s, offsetof(ConfigSnapshot, crc));
+}
+
+static void install(const SensorConfig& c, uint8_t source) {
+    activeConfig.version = CONFIG_VERSION;
+    activeConfig.source = source;
+    activeConfig.reserved = 0;
+    activeConfig.generation++;
+    activeConfig.cfg = c;
+    activeConfig.crc = snapshotCRC(activeConfig);
 }
 
-int simulateHeartRate() {
-    int baseHR = 72;
-    int variance = random(-sensorConfig.hr_variance, sensorConfig.hr_variance);
-    return constrain(baseHR + variance, sensorConfig.hr_min, sensorConfig.hr_max);
+static void persist() {
+    if (!configPrefsOpen) return;
+    ConfigSnapshot stored;
+    if (configPrefs.getBytes("snapshot", &stored, sizeof(stored)) == sizeof(stored) &&
+        memcmp(&stored.cfg, &activeConfig.cfg, sizeof(SensorConfig)) == 0) {
+        return;   // unchanged; spare the flash
+    }
+    if (configPrefs.putBytes("snapshot", &activeConfig, sizeof(activeConfig)) != sizeof(activeConfig)) {
+        Serial.println("✗ Config: NVS write failed");
+    }
 }
 
-float simulateWeight() {
-    // Simulate weight with small daily variations
-    float baseWeight = 70.0;
-    float variance = random(-100, 100) / 100.0 * sensorConfig.weight_variance;
-    return constrain(baseWeight + variance, sensorConfig.weight_min, sensorConfig.weight_max);
+bool configBegin() {
+    SensorConfig defaults;
+    install(defaults, CFG_DEFAULTS);
+
+    if (!configPrefsOpen) configPrefsOpen = configPrefs.begin(CONFIG_NAMESPACE, false);
+    if (!configPrefsOpen) {
+        Serial.println("✗ Config: NVS unavailable, using defaults");
+        return false;
+    }
+    ConfigSnapshot stored;
+    size_t n = configPrefs.getBytes("snapshot", &stored, sizeof(stored));
+    if (n == 0) {
+        Serial.println("Config: none stored, using defaults");
+        return true;
+    }
+    const char* problem = NULL;
+    if (n != sizeof(stored) || stored.version != CONFIG_VERSION || stored.crc != snapshotCRC(stored)) {
+        problem = "damaged";
+    } else {
+        problem = configValidate(stored.cfg);
+    }
+    if (problem) {
+        Serial.printf("✗ Config: stored copy rejected (%s), using defaults\n", problem);
+        return false;
+    }
+    install(stored.cfg, CFG_NVS);
+    Serial.println("✓ Config loaded from NVS");
+    return true;
 }
 
-float simulateHeight() {
-    // Height is usually stable for adults
-    float baseHeight = 170.0;
-    float variance = random(-100, 100) / 100.0 * sensorConfig.height_variance;
-    return constrain(baseHeight + variance, sensorConfig.height_min, sensorConfig.height_max);
+bool configLoadSD() {
+    File f = SD.open(CONFIG_FILE, FILE_READ);
+    if (!f) {
+        Serial.printf("Config: no %s, keeping %s\n", CONFIG_FILE, configSourceName(activeConfig.source));
+        return false;
+    }
+    static char text[CONFIG_TEXT_MAX];
+    size_t n = f.read((uint8_t*)text, sizeof(text) - 1);
+    bool truncated = f.available() > 0;
+    f.close();
+    text[n] = '\0';
+    if (truncated) {
+        Serial.printf("✗ Config: %s larger than %d bytes\n", CONFIG_FILE, CONFIG_TEXT_MAX - 1);
+        return false;
+    }
+
+    SensorConfig c;
+    int errLine = 0;
+    if (!configParse(text, c, &errLine)) {
+        if (errLine == 0) Serial.printf("✗ Config: %s has no \"version %d\" line\n", CONFIG_FILE, CONFIG_VERSION);
+        else Serial.printf("✗ Config: %s line %d not understood\n", CONFIG_FILE, errLine);
+        return false;
+    }
+    const char* problem = configValidate(c);
+    if (problem) {
+        Serial.printf("✗ Config: %s rejected (%s)\n", CONFIG_FILE, problem);
+        return false;
+    }
+    install(c, CFG_SD);
+    persist();
+    Serial.printf("✓ Config loaded from %s (generation %lu)\n", CONFIG_FILE,
+                  (unsigned long)activeConfig.generation);
+    return true;
 }
 
-int simulateBPSystolic() {
-    int baseBP = 120;
-    int variance = random(-sensorConfig.bp_variance, sensorConfig.bp_variance);
-    return constrain(baseBP + variance, sensorConfig.bp_sys_min, sensorConfig.bp_sys_max);
+void configReset() {
+    SensorConfig defaults;
+    install(defaults, CFG_DEFAULTS);
+    if (configPrefsOpen) configPrefs.remove("snapshot");
 }
 
-int simulateBPDiastolic() {
-    int baseBP = 80;
-    int variance = random(-sensorConfig.bp_variance, sensorConfig.bp_variance);
-    return constrain(baseBP + variance, sensorConfig.bp_dia_min, sensorConfig.bp_dia_max);
+const ConfigSnapshot& configSnapshot() {
+    return activeConfig;
 }
 
+/* ==================== SIMULATION ==================== */
+
 float calculateBMI(float weight, float height) {
     // Height in meters
     float heightM = height / 100.0;
     return weight / (heightM * heightM);
 }
 
+// One settled reading from the hub simulator (default scenario, fresh seed)
 void simulateSensors(HealthData& data) {
-    data.weight = simulateWeight();
-    data.height = simulateHeight();
-    data.temperature = simulateTemperature();
-    data.heart_rate = simulateHeartRate();
-    data.bp_sys = simulateBPSystolic();
-    data.bp_dia = simulateBPDiastolic();
+    SimScenario scenario;
+    simDefaultScenario(scenario);
+    scenario.seed = random(1, 0x7FFFFFFF);
+    SimEngine engine;
+    engine.begin(scenario);
+    engine.advance(10000, NULL, NULL);   // let the channels settle; nothing is streaming
+    SensorData reading;
+    engine.measure(reading);
+
+    data.weight = constrain(reading.weight_kg, sensorConfig.weight_min, sensorConfig.weight_max);
+    data.height = constrain(reading.height_cm, sensorConfig.height_min, sensorConfig.height_max);
+    data.temperature = constrain(reading.temperature_c, sensorConfig.temp_min, sensorConfig.temp_max);
+    data.heart_rate = constrain((int)reading.heart_rate, sensorConfig.hr_min, sensorConfig.hr_max);
+    // The scenario's cuff reading; one offset for both keeps diastolic below
+    int bpOffset = (int)random(-sensorConfig.bp_variance, sensorConfig.bp_variance + 1);
+    data.bp_sys = constrain((int)lroundf(scenario.bp_sys) + bpOffset,
+                            sensorConfig.bp_sys_min, sensorConfig.bp_sys_max);
+    data.bp_dia = constrain((int)lroundf(scenario.bp_dia) + bpOffset,
+                            sensorConfig.bp_dia_min, sensorConfig.bp_dia_max);
     data.bmi = calculateBMI(data.weight, data.height);
     
     // Get current timestamp
@@ -67,4 +154,45 @@ void simulateSensors(HealthData& data) {
     } else {
         data.timestamp = "N/A";
     }
-}
\ No newline at end of file
+}
+
+/* ==================== REAL SENSORS ==================== */
+extern StreamStore streamStore;
+extern BpCuff bpCuff;
+
+// Every driver's readings land in the stream store as hub samples
+static bool measureReal(uint8_t sensor, HealthData& data) {
+    const StreamChannel& c = streamStore.channel(sensor);
+    if (c.total == 0 || millis() - c.arrivedMs > REAL_READING_MAX_AGE_MS) return false;
+    const SensorDescriptor& s = sensorDescriptor(sensor);
+    if (!sensorPlausible(s, c.latest)) return false;
+    s.store(data, c.latest);
+    data.*s.measured = true;
+    return true;
+}
+
+bool measureRealHeight(HealthData& data) {
+    return measureReal(HUB_SENSOR_HEIGHT, data);
+}
+
+bool measureRealWeight(HealthData& data) {
+    return measureReal(HUB_SENSOR_WEIGHT, data);
+}
+
+bool measureRealTemperature(HealthData& data) {
+    return measureReal(HUB_SENSOR_TEMP, data);
+}
+
+bool measureRealHeartRate(HealthData& data) {
+    return measureReal(HUB_SENSOR_PULSE, data);
+}
+
+bool measureRealBloodPressure(HealthData& data) {
+    if (bpCuff.state() != BPC_DONE) return false;
+    const BpReading& r = bpCuff.latest();
+    if (bpValidate(sensorConfig, r.sys, r.dia)) return false;
+    data.bp_sys = r.sys;
+    data.bp_dia = r.dia;
+    data.bp_measured = true;
+    return true;
+}
@@ -3,39 +3,7 @@
 
 #include <Arduino.h>
 #include "display.h"
-
-// Sensor simulation parameters
-struct SensorConfig {
-    // Temperature range (Celsius)
-    float temp_min = 35.0;
-    float temp_max = 42.0;
-    float temp_variance = 0.5;
-    
-    // Heart rate range (BPM)
-    int hr_min = 50;
-    int hr_max = 120;
-    int hr_variance = 10;
-    
-    // Weight range (kg)
-    float weight_min = 40.0;
-    float weight_max = 120.0;
-    float weight_variance = 0.5;
-    
-    // Height range (cm) - Updated based on sensor
-    float height_min = 140.0;
-    float height_max = 200.0;
-    float height_variance = 0.5;
-    
-    // Blood pressure ranges
-    int bp_sys_min = 90;
-    int bp_sys_max = 180;
-    int bp_dia_min = 60;
-    int bp_dia_max = 120;
-    int bp_variance = 5;
-    
-    // Ultrasonic sensor mounting height (cm from ground)
-    float sensor_mounting_height = 250.0; // Default 2.5m
-};
+#include "sensor_config.h"
 
 // Measurement structure
 struct HealthData {
@@ -59,35 +27,9 @@ struct HealthData {
     bool hr_measured = false;
     bool bp_measured = false;
     
-    String toCSV() {
-        return String(timestamp + "," + 
-                     name + "," + 
-                     age + "," + 
-                     gender + "," + 
-                     address + "," + 
-                     String(weight) + "," + 
-                     String(height) + "," + 
-                     String(temperature) + "," + 
-                     String(bmi) + "," + 
-                     String(heart_rate) + "," + 
-                     String(bp_sys) + "," + 
-                     String(bp_dia));
-    }
-    
-    String toJSON() {
-        return "{\"timestamp\":\"" + timestamp + 
-               "\",\"name\":\"" + name + 
-               "\",\"age\":\"" + age + 
-               "\",\"gender\":\"" + gender + 
-               "\",\"address\":\"" + address + 
-               "\",\"weight\":" + String(weight) + 
-               ",\"height\":" + String(height) + 
-               ",\"temperature\":" + String(temperature) + 
-               ",\"bmi\":" + String(bmi) + 
-               ",\"heart_rate\":" + String(heart_rate) + 
-               ",\"bp_sys\":" + String(bp_sys) + 
-               ",\"bp_dia\":" + String(bp_dia) + "}";
-    }
+    // Defined in record_codec.cpp (field table + fixed-buffer encoders)
+    String toCSV() const;
+    String toJSON() const;
     
     void resetMeasurements() {
         height = 0;
@@ -105,18 +47,34 @@ struct HealthData {
     }
 };
 
-extern SensorConfig sensorConfig;
+// Running configuration; read-only outside the loaders below
+extern const SensorConfig& sensorConfig;
 extern HealthData currentHealthData;
 
+// Configuration loaders. configBegin() takes the NVS copy (or defaults) at
+// boot; configLoadSD() replaces it with CONFIG_FILE once the card is up and
+// stores what it accepted in NVS. Both keep the running configuration when
+// the new one fails to parse or validate, and may be called again at any
+// time to reload without a reboot.
+bool configBegin();
+bool configLoadSD();
+void configReset();   // back to the defaults, NVS copy erased
+const ConfigSnapshot& configSnapshot();
+
 // Simulation functions
 void simulateSensors(HealthData& data);
 float calculateBMI(float weight, float height);
 
-// Real sensor functions (to be implemented)
+// Latest reading of a sensor from whichever driver backs it (hub, local or
+// simulated; see sensor_driver.h). They never wait: false if the sensor is
+// not streaming or nothing plausible arrived in the last
+// REAL_READING_MAX_AGE_MS. measureRealBloodPressure() takes the reading of
+// the cuff run on the BP screen, once the hub has finished it (bp_cuff.h).
+#define REAL_READING_MAX_AGE_MS 1000
 bool measureRealHeight(HealthData& data);
 bool measureRealWeight(HealthData& data);
 bool measureRealTemperature(HealthData& data);
 bool measureRealHeartRate(HealthData& data);
 bool measureRealBloodPressure(HealthData& data);
 
-#endif // SENSORS_H
\ No newline at end of file
+#endif // SENSORS_H
\ No newline at end of file
@@ -0,0 +1,457 @@
+#include "simulator.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+static const char* const CHANNEL_NAMES[SIM_SENSORS] = {"height", "weight", "temp", "pulse"};
+
+/* ==================== SCENARIOS ==================== */
+static void setChannel(SimChannel& c, float start, float target, uint32_t settle_ms,
+                       float noise, float artifact_rate, float artifact_amp,
+                       uint32_t artifact_ms, float dropout, float resolution) {
+    c.enabled = true;
+    c.start = start;
+    c.target = target;
+    c.settle_ms = settle_ms;
+    c.noise = noise;
+    c.artifact_rate = artifact_rate;
+    c.artifact_amp = artifact_amp;
+    c.artifact_ms = artifact_ms;
+    c.dropout = dropout;
+    c.resolution = resolution;
+}
+
+void simDefaultScenario(SimScenario& s) {
+    memset(&s, 0, sizeof(s));
+    strcpy(s.name, "default");
+    s.seed = 1;
+    s.stream_hz = 10;
+    s.measure_ms = 1500;
+    s.ambient_c = 24.0f;
+    s.mount_cm = 250.0f;
+    s.bp_sys = 118.0f;
+    s.bp_dia = 76.0f;
+    //                  start   target  settle noise  art/s  amp    art_ms dropout res
+    setChannel(s.ch[0], 120.0f, 170.0f, 600,   0.40f, 0.10f, 8.0f,  300,   0.010f, 0.10f);  // height
+    setChannel(s.ch[1], 0.0f,   70.0f,  1500,  0.08f, 0.30f, 2.5f,  500,   0.010f, 0.05f);  // weight
+    setChannel(s.ch[2], 33.0f,  36.6f,  6000,  0.03f, 0.02f, 0.8f,  1000,  0.005f, 0.10f);  // temp
+    setChannel(s.ch[3], 90.0f,  72.0f,  4000,  1.50f, 0.15f, 25.0f, 700,   0.020f, 1.00f);  // pulse
+}
+
+struct SimChannelKey {
+    const char* key;
+    float SimChannel::* real;
+    uint32_t SimChannel::* ms;
+};
+
+static const SimChannelKey CHANNEL_KEYS[] = {
+    {"start",         &SimChannel::start,         nullptr},
+    {"target",        &SimChannel::target,        nullptr},
+    {"settle_ms",     nullptr,                    &SimChannel::settle_ms},
+    {"noise",         &SimChannel::noise,         nullptr},
+    {"artifact_rate", &SimChannel::artifact_rate, nullptr},
+    {"artifact_amp",  &SimChannel::artifact_amp,  nullptr},
+    {"artifact_ms",   nullptr,                    &SimChannel::artifact_ms},
+    {"dropout",       &SimChannel::dropout,       nullptr},
+    {"resolution",    &SimChannel::resolution,    nullptr},
+};
+
+static bool parseNumber(const char* text, double& out) {
+    char* end;
+    out = strtod(text, &end);
+    return end != text && *end == '\0';
+}
+
+static bool applyKey(SimScenario& s, int section, const char* key, const char* value) {
+    double v;
+    if (section < 0) {
+        if (strcasecmp(key, "name") == 0) {
+            strncpy(s.name, value, SIM_NAME_MAX - 1);
+            s.name[SIM_NAME_MAX - 1] = '\0';
+            return true;
+        }
+        if (!parseNumber(value, v)) return false;
+        if (strcasecmp(key, "seed") == 0) s.seed = (uint32_t)v;
+        else if (strcasecmp(key, "stream_hz") == 0 && v >= 1 && v <= 1000) s.stream_hz = (uint16_t)v;
+        else if (strcasecmp(key, "measure_ms") == 0) s.measure_ms = (uint32_t)v;
+        else if (strcasecmp(key, "ambient_c") == 0) s.ambient_c = (float)v;
+        else if (strcasecmp(key, "mount_cm") == 0) s.mount_cm = (float)v;
+        else if (strcasecmp(key, "bp_sys") == 0) s.bp_sys = (float)v;
+        else if (strcasecmp(key, "bp_dia") == 0) s.bp_dia = (float)v;
+        else return false;
+        return true;
+    }
+
+    SimChannel& c = s.ch[section];
+    if (!parseNumber(value, v)) return false;
+    if (strcasecmp(key, "enabled") == 0) {
+        c.enabled = v != 0;
+        return true;
+    }
+    for (size_t i = 0; i < sizeof(CHANNEL_KEYS) / sizeof(CHANNEL_KEYS[0]); i++) {
+        if (strcasecmp(key, CHANNEL_KEYS[i].key) != 0) continue;
+        if (CHANNEL_KEYS[i].real) c.*(CHANNEL_KEYS[i].real) = (float)v;
+        else c.*(CHANNEL_KEYS[i].ms) = (uint32_t)v;
+        return true;
+    }
+    return false;
+}
+
+bool simParseScenario(const char* text, SimScenario& s, int* errLine) {
+    simDefaultScenario(s);
+    int section = -1;
+    int lineNo = 0;
+
+    while (*text) {
+        lineNo++;
+        const char* eol = strchr(text, '\n');
+        size_t n = eol ? (size_t)(eol - text) : strlen(text);
+        char line[96];
+        if (n >= sizeof(line)) {
+            if (errLine) *errLine = lineNo;
+            return false;
+        }
+        memcpy(line, text, n);
+        line[n] = '\0';
+        text += eol ? n + 1 : n;
+
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        char* end = p + strlen(p);
+        while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) *--end = '\0';
+        if (*p == '\0') continue;
+
+        bool ok = false;
+        if (*p == '[') {
+            char* close = strchr(p, ']');
+            if (close) {
+                *close = '\0';
+                for (int i = 0; i < SIM_SENSORS; i++) {
+                    if (strcasecmp(p + 1, CHANNEL_NAMES[i]) == 0) { section = i; ok = true; }
+                }
+            }
+        } else {
+            char* value = p;
+            while (*value && *value != ' ' && *value != '\t') value++;
+            if (*value) {
+                *value++ = '\0';
+                while (*value == ' ' || *value == '\t') value++;
+                ok = applyKey(s, section, p, value);
+            }
+        }
+        if (!ok) {
+            if (errLine) *errLine = lineNo;
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ==================== PRNG ==================== */
+float SimRng::gaussian() {
+    // Box-Muller; u1 is kept away from 0 for the log
+    float u1 = ((next() >> 8) + 1) * (1.0f / 16777217.0f);
+    float u2 = uniform();
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+/* ==================== ENGINE ==================== */
+SimEngine::SimEngine() {
+    SimScenario s;
+    simDefaultScenario(s);
+    begin(s);
+}
+
+void SimEngine::begin(const SimScenario& s) {
+    sc = s;
+    rng.seed(sc.seed);
+    clock = 0;
+    for (int i = 0; i < SIM_SENSORS; i++) {
+        channelStart[i] = 0;
+        artifactStart[i] = 0;
+        artifactPeak[i] = 0;
+        streamHz[i] = sc.stream_hz;
+        nextStreamAt[i] = 0;
+    }
+    streamMask = 0;
+    waveOn = false;
+    nextWaveAt = 0;
+    wavePhase = 0;
+    beatHz = 0;
+    waveRng.seed(sc.seed ^ 0x5A5A5A5Au);
+    bpPhase = 0;
+    bpCuff = 0;
+    bpBeat = 0;
+    nextBpAt = 0;
+    bpRng.seed(sc.seed ^ 0xB1009E55u);
+    measurePending = false;
+    measureAt = 0;
+    argCmd = 0;
+    argLen = 0;
+    argNeed = 0;
+    framesSent = 0;
+    framesDropped = 0;
+}
+
+// Channels joining the subscription start streaming now; the subject
+// steps up to them. Channels already streaming keep their history.
+void SimEngine::subscribe(uint8_t mask, const uint8_t* rates) {
+    for (int i = 0; i < SIM_SENSORS; i++) {
+        uint8_t bit = HUB_SENSOR_BIT(i + 1);
+        if (!sc.ch[i].enabled) mask &= ~bit;
+        if (!(mask & bit)) continue;
+        streamHz[i] = rates && rates[i] ? rates[i] : sc.stream_hz;
+        if (!(streamMask & bit)) {
+            channelStart[i] = clock;
+            nextStreamAt[i] = clock;
+        }
+    }
+    streamMask = mask;
+}
+
+void SimEngine::command(const uint8_t* bytes, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = bytes[i];
+        if (argNeed) {
+            args[argLen++] = b;
+            if (argLen < argNeed) continue;
+            argNeed = 0;
+            if (argCmd == CMD_START_STREAM) {
+                // One sensor, replacing whatever was streaming
+                uint8_t type = args[0];
+                streamMask = 0;
+                if (type >= 1 && type <= SIM_SENSORS) subscribe(HUB_SENSOR_BIT(type), NULL);
+            } else {
+                subscribe(args[0], args + 1);
+            }
+            continue;
+        }
+        switch (b) {
+            case CMD_START_STREAM:
+            case CMD_SUBSCRIBE:
+                argCmd = b;
+                argLen = 0;
+                argNeed = b == CMD_START_STREAM ? 1 : SUBSCRIBE_CMD_LEN - 1;
+                break;
+            case CMD_STOP_STREAM:
+                streamMask = 0;
+                waveOn = false;
+                bpPhase = 0;   // vented
+                break;
+            case CMD_START_WAVE:
+                if (!sc.ch[3].enabled || waveOn) break;
+                waveOn = true;
+                nextWaveAt = clock + HUB_WAVE_BATCH * 1000 / SIM_WAVE_HZ;
+                wavePhase = 0;
+                beatHz = 0;
+                break;
+            case CMD_START_BP:
+                if (sc.bp_sys <= sc.bp_dia || sc.bp_dia <= 0 || bpPhase) break;
+                bpPhase = BP_INFLATING;
+                bpCuff = 0;
+                bpBeat = 0;
+                nextBpAt = clock + SIM_BP_FRAME_MS;
+                break;
+            case CMD_MEASURE:
+                measurePending = true;
+                measureAt = clock + sc.measure_ms;
+                break;
+            default: break;   // unknown command bytes are ignored
+        }
+    }
+}
+
+float SimEngine::sample(uint8_t idx) {
+    const SimChannel& c = sc.ch[idx];
+    float t = (float)(clock - channelStart[idx]);
+    float v = c.target;
+    if (c.settle_ms > 0) v += (c.start - c.target) * expf(-t / c.settle_ms);
+    v += c.noise * rng.gaussian();
+
+    // Motion artifacts: half-sine bumps started at random
+    if (artifactPeak[idx] == 0) {
+        if (c.artifact_ms > 0 && rng.uniform() < c.artifact_rate / streamHz[idx]) {
+            artifactStart[idx] = clock;
+            artifactPeak[idx] = c.artifact_amp * (rng.uniform() * 2.0f - 1.0f);
+        }
+    }
+    if (artifactPeak[idx] != 0) {
+        float p = (float)(clock - artifactStart[idx]) / c.artifact_ms;
+        if (p >= 1.0f) artifactPeak[idx] = 0;
+        else v += artifactPeak[idx] * sinf(3.14159265f * p);
+    }
+
+    if (c.resolution > 0) v = roundf(v / c.resolution) * c.resolution;
+    return v < 0 ? 0 : v;
+}
+
+void SimEngine::measure(SensorData& out) {
+    memset(&out, 0, sizeof(out));
+    if (sc.ch[0].enabled) {
+        out.height_cm = sample(0);
+        out.distance_cm = sc.mount_cm - out.height_cm;
+        out.sensor_status |= HUB_STATUS_HEIGHT;
+    }
+    if (sc.ch[1].enabled) {
+        out.weight_kg = sample(1);
+        out.sensor_status |= HUB_STATUS_WEIGHT;
+    }
+    if (sc.ch[2].enabled) {
+        out.temperature_c = sample(2);
+        out.sensor_status |= HUB_STATUS_TEMP;
+    }
+    if (sc.ch[3].enabled) {
+        out.heart_rate = (uint16_t)sample(3);
+        out.sensor_status |= HUB_STATUS_HR;
+    }
+    out.ambient_temp_c = sc.ambient_c + 0.1f * rng.gaussian();
+    if (out.height_cm > 0 && out.weight_kg > 0) {
+        float m = out.height_cm / 100.0f;
+        out.bmi = out.weight_kg / (m * m);
+    }
+    out.timestamp = clock;
+}
+
+// One batch of PPG ending at the current time: a systolic peak and a
+// smaller dicrotic wave per beat, breathing wander and sensor noise. The
+// rate follows the pulse channel's settling curve with some beat-to-beat
+// variation.
+void SimEngine::waveBatch(WaveBatch& out) {
+    const SimChannel& c = sc.ch[3];
+    float bpm = c.target;
+    if (c.settle_ms > 0) bpm += (c.start - c.target) * expf(-(float)(clock - channelStart[3]) / c.settle_ms);
+    if (beatHz == 0) beatHz = bpm / 60.0f;
+
+    const uint32_t stepMs = 1000 / SIM_WAVE_HZ;
+    out.rateHz = SIM_WAVE_HZ;
+    out.timestamp = clock - (HUB_WAVE_BATCH - 1) * stepMs;
+    for (int i = 0; i < HUB_WAVE_BATCH; i++) {
+        float sys = (wavePhase - 0.15f) / 0.07f;
+        float dic = (wavePhase - 0.45f) / 0.09f;
+        float v = expf(-sys * sys) + 0.35f * expf(-dic * dic);
+        v += 0.25f * sinf(6.2831853f * 0.25f * (out.timestamp + i * stepMs) / 1000.0f);
+        v += 0.03f * waveRng.gaussian();
+        out.samples[i] = (int16_t)(2000.0f + 800.0f * v);
+
+        wavePhase += beatHz / SIM_WAVE_HZ;
+        if (wavePhase >= 1.0f) {
+            wavePhase -= 1.0f;
+            beatHz = bpm / 60.0f * (1.0f + 0.04f * waveRng.gaussian());
+        }
+    }
+}
+
+// One cuff frame at the current time. The cuff inflates past systolic and
+// bleeds down linearly; the pulses it picks up follow the usual
+// oscillometric envelope, largest at MAP and falling to 55% of that at
+// systolic and 75% at diastolic (the ratios a hub would use to find them).
+// Below diastolic the run ends with the scenario's reading, give or take a
+// couple of mmHg.
+void SimEngine::bpFrame(BpReading& out) {
+    const float dt = SIM_BP_FRAME_MS / 1000.0f;
+    const float sys = sc.bp_sys, dia = sc.bp_dia;
+    const float map = dia + (sys - dia) / 3.0f;
+
+    memset(&out, 0, sizeof(out));
+    out.timestamp = clock;
+    if (bpPhase == BP_INFLATING) {
+        bpCuff += SIM_BP_INFLATE * dt;
+        if (bpCuff >= sys + SIM_BP_ABOVE_SYS) bpPhase = BP_DEFLATING;
+    } else {
+        bpCuff -= SIM_BP_DEFLATE * dt;
+        if (bpCuff <= dia - SIM_BP_BELOW_DIA) {
+            bpPhase = 0;
+            out.phase = BP_DONE;
+            out.sys = (uint16_t)lroundf(sys + 2.0f * bpRng.gaussian());
+            out.dia = (uint16_t)lroundf(dia + 2.0f * bpRng.gaussian());
+            out.map = (uint16_t)lroundf(out.dia + (out.sys - out.dia) / 3.0f);
+            return;
+        }
+    }
+    out.phase = bpPhase;
+
+    float width = bpCuff > map ? (sys - map) / sqrtf(-logf(0.55f)) : (map - dia) / sqrtf(-logf(0.75f));
+    float z = (bpCuff - map) / width;
+    float osc = SIM_BP_OSC_PEAK * expf(-z * z) * (1.0f + 0.05f * bpRng.gaussian());
+    const SimChannel& pulse = sc.ch[3];
+    bpBeat += (pulse.target > 0 ? pulse.target : 70.0f) / 60.0f * dt;
+    bpBeat -= floorf(bpBeat);
+    out.oscMmHg = osc < 0 ? 0 : osc;
+    out.cuffMmHg = bpCuff + 0.5f * out.oscMmHg * sinf(6.2831853f * bpBeat);
+}
+
+void SimEngine::advance(uint32_t ms, SimByteSink sink, void* ctx) {
+    const uint32_t end = clock + ms;
+    uint8_t frame[DATA_FRAME_LEN];
+
+    for (;;) {
+        // Earliest stream frame due across the subscribed channels
+        int next = -1;
+        for (int i = 0; i < SIM_SENSORS; i++) {
+            if (!(streamMask & HUB_SENSOR_BIT(i + 1))) continue;
+            if ((int32_t)(nextStreamAt[i] - end) > 0) continue;
+            if (next < 0 || (int32_t)(nextStreamAt[i] - nextStreamAt[next]) < 0) next = i;
+        }
+        bool measureDue = measurePending && (int32_t)(measureAt - end) <= 0;
+        bool waveDue = waveOn && (int32_t)(nextWaveAt - end) <= 0;
+        bool bpDue = bpPhase && (int32_t)(nextBpAt - end) <= 0;
+        if (next < 0 && !measureDue && !waveDue && !bpDue) break;
+
+        // Cuff frame when strictly earliest; it loses ties to everything
+        if (bpDue && (next < 0 || (int32_t)(nextBpAt - nextStreamAt[next]) < 0) &&
+            (!measureDue || (int32_t)(nextBpAt - measureAt) < 0) &&
+            (!waveDue || (int32_t)(nextBpAt - nextWaveAt) < 0)) {
+            clock = nextBpAt;
+            nextBpAt += SIM_BP_FRAME_MS;
+            BpReading r;
+            bpFrame(r);
+            sink(frame, encodeBpFrame(r, frame), ctx);
+            framesSent++;
+            continue;
+        }
+
+        // Waveform batch when strictly earliest; it loses ties
+        if (waveDue && (next < 0 || (int32_t)(nextWaveAt - nextStreamAt[next]) < 0) &&
+            (!measureDue || (int32_t)(nextWaveAt - measureAt) < 0)) {
+            clock = nextWaveAt;
+            nextWaveAt += HUB_WAVE_BATCH * 1000 / SIM_WAVE_HZ;
+            WaveBatch w;
+            waveBatch(w);
+            if (waveRng.uniform() < sc.ch[3].dropout) {
+                framesDropped++;
+                continue;
+            }
+            sink(frame, encodeWaveFrame(w, frame), ctx);
+            framesSent++;
+            continue;
+        }
+
+        // Earliest event first; measure wins a tie
+        if (measureDue && (next < 0 || (int32_t)(measureAt - nextStreamAt[next]) <= 0)) {
+            clock = measureAt;
+            measurePending = false;
+            SensorData d;
+            measure(d);
+            sink(frame, encodeDataFrame(d, frame), ctx);
+            framesSent++;
+            continue;
+        }
+
+        clock = nextStreamAt[next];
+        nextStreamAt[next] += 1000 / streamHz[next];
+        StreamSample s;
+        s.sensor = next + 1;
+        s.value = sample(next);
+        s.timestamp = clock;
+        if (rng.uniform() < sc.ch[next].dropout) {
+            framesDropped++;
+            continue;
+        }
+        sink(frame, encodeStreamFrame(s, frame), ctx);
+        framesSent++;
+    }
+    clock = end;
+}
@@ -0,0 +1,142 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hub_protocol.h"
+
+// Sensor hub simulator.
+//
+// Produces a time series per sensor from a scenario – an exponential
+// settling curve from `start` towards `target`, gaussian noise, occasional
+// motion artifacts and dropped frames – and encodes it as the exact UART
+// frames the hub sends. Everything is driven by a seeded PRNG and a virtual
+// clock the caller advances, so a given scenario always produces the same
+// bytes and a host can run hours of hub traffic in milliseconds.
+//
+// Kept free of Arduino dependencies; the firmware feeds it through the SIM
+// console command, host tools link it directly.
+
+#define SIM_SENSORS          4    // HUB_SENSOR_HEIGHT..HUB_SENSOR_PULSE
+#define SIM_WAVE_HZ          100  // pulse waveform after CMD_START_WAVE
+#define SIM_BP_FRAME_MS      200  // cuff frames after CMD_START_BP
+#define SIM_BP_INFLATE       25.0f   // mmHg/s
+#define SIM_BP_DEFLATE       3.0f    // mmHg/s
+#define SIM_BP_ABOVE_SYS     30.0f   // inflate this far past systolic
+#define SIM_BP_BELOW_DIA     15.0f   // deflate this far under diastolic
+#define SIM_BP_OSC_PEAK      2.5f    // oscillation amplitude at MAP, mmHg
+#define SIM_NAME_MAX         24
+#define SIM_SCENARIO_TEXT_MAX 2048
+
+struct SimChannel {
+    bool enabled;
+    float start;            // reading when the subject steps on / in
+    float target;           // settled reading
+    uint32_t settle_ms;     // time constant of the approach to target
+    float noise;            // standard deviation of the sensor noise
+    float artifact_rate;    // motion artifacts per second
+    float artifact_amp;     // peak deviation of an artifact
+    uint32_t artifact_ms;   // artifact duration
+    float dropout;          // probability that a stream frame is lost
+    float resolution;       // reading quantization (0 = none)
+};
+
+struct SimScenario {
+    char name[SIM_NAME_MAX];
+    uint32_t seed;
+    uint16_t stream_hz;     // stream frames per second
+    uint32_t measure_ms;    // hub time to answer CMD_MEASURE
+    float ambient_c;
+    float mount_cm;         // ultrasonic sensor height above the floor
+    float bp_sys;           // cuff result; 0 = hub without a cuff
+    float bp_dia;
+    SimChannel ch[SIM_SENSORS];
+};
+
+// A healthy adult with mild noise on every channel
+void simDefaultScenario(SimScenario& s);
+
+// Scenario text: "key value" lines, '#' comments, and [height] [weight]
+// [temp] [pulse] sections for per-channel keys. Unset keys keep the
+// defaults. Returns false and the offending line number on error.
+bool simParseScenario(const char* text, SimScenario& s, int* errLine);
+
+// xorshift32 – small, fast and identical on every platform
+class SimRng {
+public:
+    void seed(uint32_t s) { state = s ? s : 0x9E3779B9u; }
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }   // [0, 1)
+    float gaussian();   // mean 0, sd 1
+private:
+    uint32_t state;
+};
+
+typedef void (*SimByteSink)(const uint8_t* bytes, size_t len, void* ctx);
+
+class SimEngine {
+public:
+    SimEngine();
+
+    // Resets the clock, PRNG and hub state
+    void begin(const SimScenario& s);
+
+    // Bytes the kiosk sent to the hub
+    void command(const uint8_t* bytes, size_t len);
+
+    // Advances virtual time by `ms`, handing every frame that becomes due
+    // to the sink in order
+    void advance(uint32_t ms, SimByteSink sink, void* ctx);
+
+    // Reading of every enabled channel at the current time, as the hub
+    // would report it for CMD_MEASURE
+    void measure(SensorData& out);
+
+    uint32_t now() const { return clock; }
+    uint8_t streaming() const { return streamMask; }   // HUB_SENSOR_BIT per channel
+    bool waveform() const { return waveOn; }
+    bool cuffRunning() const { return bpPhase != 0; }
+    const SimScenario& scenario() const { return sc; }
+
+    uint32_t framesSent;
+    uint32_t framesDropped;
+
+private:
+    float sample(uint8_t idx);
+    void subscribe(uint8_t mask, const uint8_t* rates);
+    void waveBatch(WaveBatch& out);
+    void bpFrame(BpReading& out);
+
+    SimScenario sc;
+    SimRng rng;
+    uint32_t clock;
+    uint32_t channelStart[SIM_SENSORS];   // when the subject arrived
+    uint32_t artifactStart[SIM_SENSORS];
+    float artifactPeak[SIM_SENSORS];      // 0 = no artifact running
+    uint8_t streamMask;                   // 0 = not streaming
+    uint16_t streamHz[SIM_SENSORS];
+    uint32_t nextStreamAt[SIM_SENSORS];
+    bool waveOn;
+    uint32_t nextWaveAt;
+    float wavePhase;                      // position in the current beat, 0..1
+    float beatHz;                         // rate of the current beat
+    SimRng waveRng;                       // own PRNG: the waveform leaves the channels' series alone
+    uint8_t bpPhase;                      // BpPhase, 0 = cuff idle
+    float bpCuff;                         // cuff pressure, mmHg
+    float bpBeat;                         // position in the current beat, 0..1
+    uint32_t nextBpAt;
+    SimRng bpRng;                         // own PRNG, like the waveform's
+    bool measurePending;
+    uint32_t measureAt;
+    uint8_t argCmd;                       // command still collecting argument bytes
+    uint8_t args[SUBSCRIBE_CMD_LEN];
+    uint8_t argLen;
+    uint8_t argNeed;
+};
+
+#endif // SIMULATOR_H
@@ -0,0 +1,66 @@
+#include "soak.h"
+
+/* ==================== LATENCY ==================== */
+static uint8_t bucketOf(uint32_t us) {
+    if (us < 1) us = 1;
+    uint8_t octave = 31 - __builtin_clz(us);
+    // Two bits below the leading one pick the quarter within the octave
+    uint8_t quarter = octave >= 2 ? (us >> (octave - 2)) & 3 : (us << (2 - octave)) & 3;
+    uint16_t b = octave * 4 + quarter;
+    return b < SOAK_BUCKETS ? b : SOAK_BUCKETS - 1;
+}
+
+static uint32_t bucketUpper(uint8_t b) {
+    uint8_t octave = b / 4, quarter = b % 4;
+    uint64_t base = 1ULL << octave;
+    return (uint32_t)min<uint64_t>(base + (base * (quarter + 1)) / 4, 0xFFFFFFFFULL);
+}
+
+void LatencyHistogram::reset() {
+    memset(buckets, 0, sizeof(buckets));
+    count = 0;
+    maxUs = 0;
+    sumUs = 0;
+}
+
+void LatencyHistogram::add(uint32_t us) {
+    buckets[bucketOf(us)]++;
+    count++;
+    sumUs += us;
+    if (us > maxUs) maxUs = us;
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t pct) const {
+    if (count == 0) return 0;
+    uint32_t rank = (uint32_t)(((uint64_t)count * pct + 99) / 100);
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < SOAK_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= rank) return min(bucketUpper(b), maxUs);
+    }
+    return maxUs;
+}
+
+/* ==================== HEAP ==================== */
+void HeapTrend::reset(uint32_t iterations) {
+    perWindow = max<uint32_t>(1, (iterations + SOAK_HEAP_WINDOWS - 1) / SOAK_HEAP_WINDOWS);
+    windows = 0;
+    for (uint8_t i = 0; i < SOAK_HEAP_WINDOWS; i++) windowMin[i] = UINT32_MAX;
+}
+
+void HeapTrend::add(uint32_t iteration, uint32_t freeBytes) {
+    uint8_t w = min<uint32_t>(iteration / perWindow, SOAK_HEAP_WINDOWS - 1);
+    if (freeBytes < windowMin[w]) windowMin[w] = freeBytes;
+    if (w + 1 > windows) windows = w + 1;
+}
+
+int32_t HeapTrend::growth() const {
+    if (windows < 3) return 0;   // too short to tell warm-up from growth
+    return (int32_t)windowMin[1] - (int32_t)windowMin[windows - 1];
+}
+
+void HeapTrend::print(const char* name) const {
+    Serial.printf("  %-10s min free per window:", name);
+    for (uint8_t i = 0; i < windows; i++) Serial.printf(" %lu", (unsigned long)windowMin[i]);
+    Serial.printf("\n  %-10s growth after warm-up: %ld bytes\n", name, (long)growth());
+}
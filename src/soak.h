@@ -0,0 +1,43 @@
+#ifndef SOAK_H
+#define SOAK_H
+
+#include <Arduino.h>
+
+// Bookkeeping for the soak benchmark (console: SOAK <checkups>). Fixed
+// size, so the benchmark itself doesn't show up in the heap trend it
+// measures.
+
+// Latency histogram, 4 log-spaced buckets per octave from 1 us. Percentiles
+// are accurate to within one bucket (~19%).
+#define SOAK_BUCKETS 96
+
+struct LatencyHistogram {
+    uint32_t buckets[SOAK_BUCKETS];
+    uint32_t count;
+    uint32_t maxUs;
+    uint64_t sumUs;
+
+    void reset();
+    void add(uint32_t us);
+    uint32_t percentile(uint8_t pct) const;   // bucket upper bound, us
+    uint32_t meanUs() const { return count ? (uint32_t)(sumUs / count) : 0; }
+};
+
+// Lowest free-heap reading per window of iterations, windows spread evenly
+// over the run. Comparing an early window with the last one shows growth
+// that doesn't come back, without being fooled by short-lived allocations.
+#define SOAK_HEAP_WINDOWS 16
+
+struct HeapTrend {
+    uint32_t windowMin[SOAK_HEAP_WINDOWS];
+    uint32_t perWindow;
+    uint8_t windows;
+
+    void reset(uint32_t iterations);
+    void add(uint32_t iteration, uint32_t freeBytes);
+    // Bytes lost between window 1 (window 0 is warm-up) and the last window
+    int32_t growth() const;
+    void print(const char* name) const;
+};
+
+#endif // SOAK_H
@@ -1,6 +1,444 @@
 #include "display.h"
 #include "sensors.h"
+#include "storage.h"
+#include "record_codec.h"
+#include "sync_export.h"
+#include "patients.h"
+#include <algorithm>
 
+#define INDEX_MAGIC 0x58494B48   // "HKIX"
+#define INDEX_VERSION 1
+
+struct SegmentInfo {
+    uint32_t seq;
+    uint32_t created;    // epoch seconds, 0 if the clock wasn't set
+    uint16_t records;
+    uint16_t reserved;
+};
+
+struct IndexHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t nextSeq;
+};
+
+// Live segments, oldest first. The last one is the append target.
+static SegmentInfo segments[STORAGE_MAX_SEGMENTS];
+static uint16_t segmentCount = 0;
+static uint32_t nextSeq = 1;
+
+// Directory of the mounted store, DATA_DIR except during a soak run
+static char storeDir[16] = DATA_DIR;
+#define STORE_PATH_MAX 40   // storeDir + "/segNNNNN.csv" with any 32-bit seq
+
+// Line start offsets of the most recently scanned segment, so paging within
+// one segment doesn't rescan it
+static uint32_t offsetCache[STORAGE_SCAN_MAX];
+static uint16_t offsetCount = 0;
+static uint32_t offsetSeq = 0;
+static uint32_t offsetSize = 0;
+
+static uint16_t retainSegments = MAX_RECORDS / SEGMENT_RECORDS;
+static uint16_t retainDays = RETENTION_DAYS;
+
+static void segmentPath(uint32_t seq, char* path, size_t cap) {
+    snprintf(path, cap, "%s/seg%05lu.csv", storeDir, (unsigned long)seq);
+}
+
+static void indexPath(char* path, size_t cap, bool temp) {
+    snprintf(path, cap, "%s/index.%s", storeDir, temp ? "tmp" : "bin");
+}
+
+static bool writeCSVHeader(File& file) {
+    char header[RECORD_CSV_MAX];
+    size_t n = encodeCSVHeader(header, sizeof(header));
+    if (n == 0) return false;
+    file.write((const uint8_t*)header, n);
+    file.write((const uint8_t*)"\r\n", 2);
+    return true;
+}
+
+// Reads one line (without the line break) into buf. Returns false at EOF.
+// Over-long lines are consumed entirely and reported via `truncated`.
+static bool readLine(File& file, char* buf, size_t cap, bool& truncated) {
+    size_t n = 0;
+    truncated = false;
+    int c = -1;
+    while ((c = file.read()) >= 0) {
+        if (c == '\n') break;
+        if (c == '\r') continue;
+        if (n < cap - 1) buf[n++] = (char)c;
+        else truncated = true;
+    }
+    buf[n] = '\0';
+    return c >= 0 || n > 0;
+}
+
+static uint32_t nowEpoch() {
+    time_t now = time(nullptr);
+    return now > 1600000000 ? (uint32_t)now : 0;   // unset RTC reads as 1970
+}
+
+/* ==================== INDEX ==================== */
+// Written to a temp file and renamed so a power cut leaves either the old or
+// the new index; if both are gone the directory is rescanned.
+static bool saveIndex() {
+    char path[STORE_PATH_MAX], tmpPath[STORE_PATH_MAX];
+    indexPath(path, sizeof(path), false);
+    indexPath(tmpPath, sizeof(tmpPath), true);
+    File file = SD.open(tmpPath, FILE_WRITE);
+    if (!file) return false;
+    IndexHeader hdr = {INDEX_MAGIC, INDEX_VERSION, segmentCount, nextSeq};
+    file.write((const uint8_t*)&hdr, sizeof(hdr));
+    file.write((const uint8_t*)segments, segmentCount * sizeof(SegmentInfo));
+    file.close();
+    SD.remove(path);
+    return SD.rename(tmpPath, path);
+}
+
+static bool loadIndex() {
+    char path[STORE_PATH_MAX];
+    indexPath(path, sizeof(path), false);
+    if (!SD.exists(path)) indexPath(path, sizeof(path), true);
+    File file = SD.open(path, FILE_READ);
+    if (!file) return false;
+    IndexHeader hdr;
+    bool ok = file.read((uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+              hdr.magic == INDEX_MAGIC && hdr.version == INDEX_VERSION &&
+              hdr.count <= STORAGE_MAX_SEGMENTS &&
+              file.read((uint8_t*)segments, hdr.count * sizeof(SegmentInfo)) == hdr.count * sizeof(SegmentInfo);
+    file.close();
+    if (!ok) return false;
+    segmentCount = hdr.count;
+    nextSeq = hdr.nextSeq;
+    return true;
+}
+
+static uint16_t countRecords(uint32_t seq) {
+    char path[STORE_PATH_MAX];
+    segmentPath(seq, path, sizeof(path));
+    File file = SD.open(path, FILE_READ);
+    if (!file) return 0;
+    uint32_t lines = 0;
+    uint8_t buf[256];
+    size_t n;
+    while ((n = file.read(buf, sizeof(buf))) > 0) {
+        for (size_t i = 0; i < n; i++) if (buf[i] == '\n') lines++;
+    }
+    file.close();
+    return lines > 0 ? (uint16_t)min<uint32_t>(lines - 1, 0xFFFF) : 0;   // minus header
+}
+
+// Index lost: rebuild it from the segment files present on the card
+static void rebuildIndex() {
+    Serial.println("Rebuilding record index...");
+    segmentCount = 0;
+    nextSeq = 1;
+    File dir = SD.open(storeDir);
+    if (!dir) return;
+    uint32_t found[STORAGE_MAX_SEGMENTS];
+    uint16_t n = 0;
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+        unsigned long seq;
+        const char* name = strrchr(f.name(), '/');
+        name = name ? name + 1 : f.name();
+        if (sscanf(name, "seg%lu.csv", &seq) == 1) {
+            if (n < STORAGE_MAX_SEGMENTS) found[n++] = seq;
+            if (seq >= nextSeq) nextSeq = seq + 1;
+        }
+        f.close();
+    }
+    dir.close();
+    std::sort(found, found + n);
+    for (uint16_t i = 0; i < n; i++) {
+        segments[i].seq = found[i];
+        segments[i].created = 0;
+        segments[i].records = countRecords(found[i]);
+        segments[i].reserved = 0;
+    }
+    segmentCount = n;
+    saveIndex();
+}
+
+/* ==================== SEGMENTS ==================== */
+// Dropping the oldest segment is one file delete plus an index rewrite
+static void dropOldest() {
+    char path[STORE_PATH_MAX];
+    segmentPath(segments[0].seq, path, sizeof(path));
+    SD.remove(path);
+    Serial.printf("Retention: removed %s (%u records)\n", path, segments[0].records);
+    memmove(&segments[0], &segments[1], (segmentCount - 1) * sizeof(SegmentInfo));
+    segmentCount--;
+}
+
+static void applyRetention() {
+    uint32_t now = nowEpoch();
+    while (segmentCount > 1) {
+        bool tooMany = segmentCount > retainSegments;
+        bool tooOld = retainDays > 0 && now > 0 && segments[0].created > 0 &&
+                      now - segments[0].created > (uint32_t)retainDays * 86400UL;
+        if (!tooMany && !tooOld) break;
+        dropOldest();
+    }
+}
+
+static bool rotate() {
+    if (segmentCount >= STORAGE_MAX_SEGMENTS) dropOldest();
+    char path[STORE_PATH_MAX];
+    segmentPath(nextSeq, path, sizeof(path));
+    File file = SD.open(path, FILE_WRITE);
+    if (!file) {
+        Serial.printf("Failed to create segment %s\n", path);
+        return false;
+    }
+    writeCSVHeader(file);
+    file.close();
+
+    SegmentInfo& seg = segments[segmentCount++];
+    seg.seq = nextSeq++;
+    seg.created = nowEpoch();
+    seg.records = 0;
+    seg.reserved = 0;
+    applyRetention();
+    saveIndex();
+    Serial.printf("Started segment %s\n", path);
+    return true;
+}
+
+static bool storageMount() {
+    SD.mkdir(storeDir);
+    offsetSeq = 0;
+    if (!loadIndex()) rebuildIndex();
+
+    // Adopt the pre-segmentation single file as the oldest segment. It has
+    // to sort before every existing segment, or record positions would run
+    // backwards into it, and it must fit within retention, or the
+    // applyRetention() below would delete it straight away. Otherwise it
+    // stays where it is.
+    if (strcmp(storeDir, DATA_DIR) == 0 && SD.exists(DATA_FILENAME)) {
+        uint32_t seq = segmentCount == 0 ? nextSeq : segments[0].seq - 1;
+        if (seq == 0) {
+            Serial.printf("Not migrating %s: no room before the oldest segment\n", DATA_FILENAME);
+        } else if (segmentCount >= retainSegments) {
+            Serial.printf("Not migrating %s: retention would remove it\n", DATA_FILENAME);
+        } else {
+            char path[STORE_PATH_MAX];
+            segmentPath(seq, path, sizeof(path));
+            if (SD.rename(DATA_FILENAME, path)) {
+                Serial.printf("Migrated %s to %s\n", DATA_FILENAME, path);
+                memmove(&segments[1], &segments[0], segmentCount * sizeof(SegmentInfo));
+                segments[0].seq = seq;
+                segments[0].created = 0;
+                segments[0].records = countRecords(seq);
+                segments[0].reserved = 0;
+                segmentCount++;
+                if (seq >= nextSeq) nextSeq = seq + 1;
+                saveIndex();
+            }
+        }
+    }
+
+    // Only the append target can be ahead of the index
+    if (segmentCount > 0) {
+        segments[segmentCount - 1].records = countRecords(segments[segmentCount - 1].seq);
+    }
+    uint16_t mounted = segmentCount;
+    applyRetention();
+    if (segmentCount != mounted) saveIndex();   // the dropped files are gone already
+    Serial.printf("Record store %s: %u segments, %lu records\n",
+                  storeDir, segmentCount, (unsigned long)storageRecordCount());
+    return true;
+}
+
+bool storageSelect(const char* dir) {
+    strlcpy(storeDir, dir, sizeof(storeDir));
+    return storageMount();
+}
+
+bool storageClear() {
+    char path[STORE_PATH_MAX];
+    for (uint16_t i = 0; i < segmentCount; i++) {
+        segmentPath(segments[i].seq, path, sizeof(path));
+        SD.remove(path);
+    }
+    segmentCount = 0;
+    offsetSeq = 0;
+    return saveIndex();
+}
+
+void storageSetRetention(uint16_t maxSegments, uint16_t maxAgeDays) {
+    retainSegments = constrain(maxSegments, 1, STORAGE_MAX_SEGMENTS);
+    retainDays = maxAgeDays;
+}
+
+uint32_t storageRecordCount() {
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < segmentCount; i++) total += segments[i].records;
+    return total;
+}
+
+uint16_t storageSegmentCount() {
+    return segmentCount;
+}
+
+RecordPos storageOldestPos() {
+    return segmentCount > 0 ? RECORD_POS(segments[0].seq, 0) : 0;
+}
+
+bool storageAppend(const char* line, size_t len, RecordPos* at) {
+    if (segmentCount == 0 || segments[segmentCount - 1].records >= SEGMENT_RECORDS) {
+        if (!rotate()) return false;
+    }
+    SegmentInfo& seg = segments[segmentCount - 1];
+    char path[STORE_PATH_MAX];
+    segmentPath(seg.seq, path, sizeof(path));
+    File file = SD.open(path, FILE_APPEND);
+    if (!file) {
+        Serial.println("Failed to open file for writing");
+        return false;
+    }
+    if (at) *at = RECORD_POS(seg.seq, file.size());
+    file.write((const uint8_t*)line, len);
+    file.write((const uint8_t*)"\r\n", 2);
+    file.close();
+    seg.records++;
+    return true;
+}
+
+/* ==================== READING ==================== */
+
+static bool scanOffsets(uint32_t seq, File& file) {
+    if (offsetSeq == seq && offsetSize == file.size()) return true;
+    offsetCount = 0;
+    offsetSeq = seq;
+    offsetSize = file.size();
+
+    char line[RECORD_CSV_MAX];
+    bool truncated;
+    readLine(file, line, sizeof(line), truncated);   // header
+    uint16_t head = 0;
+    uint32_t total = 0;
+    while (true) {
+        uint32_t pos = file.position();
+        if (!readLine(file, line, sizeof(line), truncated)) break;
+        // Keeps the newest STORAGE_SCAN_MAX lines of an oversized segment
+        offsetCache[head] = pos;
+        head = (head + 1) % STORAGE_SCAN_MAX;
+        total++;
+    }
+    offsetCount = min<uint32_t>(total, STORAGE_SCAN_MAX);
+    if (total > STORAGE_SCAN_MAX) {
+        std::rotate(offsetCache, offsetCache + head, offsetCache + STORAGE_SCAN_MAX);
+    }
+    return true;
+}
+
+uint16_t storageReadNewest(uint32_t skip, uint16_t count, RecordLineCallback cb, void* ctx) {
+    uint16_t delivered = 0;
+    uint32_t index = skip;
+    char line[RECORD_CSV_MAX];
+    bool truncated;
+
+    for (int i = segmentCount - 1; i >= 0 && delivered < count; i--) {
+        uint16_t n = segments[i].records;
+        if (skip >= n) { skip -= n; continue; }
+
+        char path[STORE_PATH_MAX];
+        segmentPath(segments[i].seq, path, sizeof(path));
+        File file = SD.open(path, FILE_READ);
+        if (!file) continue;
+        scanOffsets(segments[i].seq, file);
+        n = min<uint16_t>(n, offsetCount);
+        for (uint32_t r = skip; r < n && delivered < count; r++) {
+            file.seek(offsetCache[offsetCount - 1 - r]);
+            readLine(file, line, sizeof(line), truncated);
+            cb(line, index++, ctx);
+            delivered++;
+        }
+        file.close();
+        skip = 0;
+    }
+    return delivered;
+}
+
+RecordReader::RecordReader() : segIdx(0), seq(0), isOpen(false) {}
+
+RecordReader::~RecordReader() {
+    close();
+}
+
+bool RecordReader::openSegment(uint16_t idx, uint32_t offset) {
+    close();
+    if (idx >= segmentCount) return false;
+    char path[STORE_PATH_MAX];
+    segmentPath(segments[idx].seq, path, sizeof(path));
+    file = SD.open(path, FILE_READ);
+    if (!file) return false;
+    segIdx = idx;
+    seq = segments[idx].seq;
+    isOpen = true;
+    if (offset == 0) {
+        char header[RECORD_CSV_MAX];
+        bool truncated;
+        readLine(file, header, sizeof(header), truncated);
+    } else {
+        file.seek(offset);
+    }
+    return true;
+}
+
+// Moves past exhausted segments so position() names the next record
+void RecordReader::skipExhausted() {
+    while (isOpen && file.available() == 0 && segIdx + 1 < segmentCount) {
+        openSegment(segIdx + 1, 0);
+    }
+}
+
+bool RecordReader::open(RecordPos start, bool& resynced) {
+    resynced = false;
+    uint32_t startSeq = RECORD_POS_SEQ(start);
+    for (uint16_t i = 0; i < segmentCount; i++) {
+        if (segments[i].seq < startSeq) continue;
+        if (segments[i].seq > startSeq) {
+            resynced = startSeq != 0;
+            if (!openSegment(i, 0)) return false;
+        } else if (!openSegment(i, RECORD_POS_OFF(start))) {
+            return false;
+        }
+        skipExhausted();
+        return true;
+    }
+    // Start names a segment newer than any on the card (card swapped):
+    // start over from the oldest record
+    resynced = segmentCount > 0;
+    if (!resynced || !openSegment(0, 0)) return false;
+    skipExhausted();
+    return true;
+}
+
+bool RecordReader::next(char* line, size_t cap, RecordPos& at, bool& truncated) {
+    if (!isOpen) return false;
+    at = position();
+    if (!readLine(file, line, cap, truncated)) return false;
+    skipExhausted();
+    return true;
+}
+
+RecordPos RecordReader::position() const {
+    return isOpen ? RECORD_POS(seq, const_cast<File&>(file).position()) : 0;
+}
+
+bool RecordReader::atEnd() {
+    return !isOpen || file.available() == 0;
+}
+
+void RecordReader::close() {
+    if (isOpen) file.close();
+    isOpen = false;
+}
+
+/* ==================== SD CARD ==================== */
 bool initSDCard() {
     Serial.println("=== Initializing SD Card ===");
     Serial.printf("Using pins: CS=%d, MOSI=%d, MISO=%d, SCK=%d\n", 
@@ -37,67 +475,49 @@ bool initSDCard() {
     }
     
     uint64_t cardSize = SD.cardSize() / (1024 * 1024);
-    Serial.printf("Card Size: %lluMB\n", cardSize);
+    Serial.printf("Card Size: %lluMB\n", (unsigned long long)cardSize);
     
-    // Create data file if it doesn't exist
-    if (!SD.exists(DATA_FILENAME)) {
-        Serial.println("Creating health data file...");
-        File file = SD.open(DATA_FILENAME, FILE_WRITE);
-        if (file) {
-            String header = "Timestamp,Name,Age,Gender,Address,Weight(kg),Height(cm),Temperature(C),BMI,HeartRate(BPM),BP_Sys,BP_Dia";
-            file.println(header);
-            file.close();
-            Serial.println("Created data file with headers");
-        } else {
-            Serial.println("Failed to create data file");
-            return false;
-        }
-    } else {
-        Serial.println("Health data file already exists");
-    }
-    
-    return true;
+    return storageMount();
 }
 
 bool saveHealthData(const String& data) {
     Serial.println("Saving health data to SD card...");
     Serial.println(data);
-    
-    File file = SD.open(DATA_FILENAME, FILE_APPEND);
-    if (!file) {
-        Serial.println("Failed to open file for writing");
+    if (!storageAppend(data.c_str(), data.length())) return false;
+    Serial.println("Health data saved successfully!");
+    return true;
+}
+
+bool saveHealthData(const HealthData& data, RecordPos* at) {
+    // Encoded straight into a stack buffer – no String concatenation
+    char line[RECORD_CSV_MAX];
+    size_t n = encodeCSV(data, line, sizeof(line));
+    if (n == 0) {
+        Serial.println("Record too large to encode");
         return false;
     }
-    
-    file.println(data);
-    file.close();
+    Serial.println("Saving health data to SD card...");
+    Serial.println(line);
+    if (!storageAppend(line, n, at)) return false;
     Serial.println("Health data saved successfully!");
-    
     return true;
 }
 
+static void appendLine(const char* line, uint32_t, void* ctx) {
+    String* content = (String*)ctx;
+    *content += line;
+    *content += "\n";
+}
+
+// Header row followed by the newest records, newest first
 String readHealthData() {
     Serial.println("Reading health data from SD card...");
     
-    if (!SD.exists(DATA_FILENAME)) {
-        return "No health data file found";
-    }
-    
-    File file = SD.open(DATA_FILENAME);
-    if (!file) {
-        return "Error: Could not open file";
-    }
-    
-    String content = "";
-    int lineCount = 0;
-    
-    // Read all lines
-    while (file.available() && lineCount < 50) {
-        String line = file.readStringUntil('\n');
-        content += line + "\n";
-        lineCount++;
-    }
-    file.close();
+    char header[RECORD_CSV_MAX];
+    encodeCSVHeader(header, sizeof(header));
+    String content = header;
+    content += "\n";
+    uint16_t lineCount = storageReadNewest(0, 49, appendLine, &content);
     
     Serial.printf("Read %d records\n", lineCount);
     return content;
@@ -106,18 +526,13 @@ String readHealthData() {
 bool deleteHealthData() {
     Serial.println("Deleting all health data...");
     
-    if (SD.remove(DATA_FILENAME)) {
-        // Recreate empty file
-        File file = SD.open(DATA_FILENAME, FILE_WRITE);
-        if (file) {
-            String header = "Timestamp,Name,Age,Gender,Address,Weight(kg),Height(cm),Temperature(C),BMI,HeartRate(BPM),BP_Sys,BP_Dia";
-            file.println(header);
-            file.close();
-            Serial.println("All data cleared successfully");
-            return true;
-        }
+    if (storageClear()) {
+        exportReset();
+        patientsReset();
+        Serial.println("All data cleared successfully");
+        return true;
     }
     
     Serial.println("Failed to delete data");
     return false;
-}
\ No newline at end of file
+}
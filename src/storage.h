@@ -0,0 +1,79 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <Arduino.h>
+#include "display.h"
+
+// Segmented record store. Records are appended to fixed-size CSV segment
+// files under DATA_DIR; a small index (DATA_DIR/index.bin) lists the live
+// segments oldest first. Appends touch only the newest segment, retention
+// removes whole segments from the old end, so both stay O(1) no matter how
+// long the kiosk has been running.
+
+#define STORAGE_MAX_SEGMENTS 64     // upper bound for the retention setting
+#define STORAGE_SCAN_MAX     256    // line offsets cached per segment
+
+// Position of a record: segment sequence number in the high word, byte
+// offset inside that segment in the low word. Increases monotonically.
+typedef uint64_t RecordPos;
+#define RECORD_POS(seq, off) (((uint64_t)(seq) << 32) | (uint32_t)(off))
+#define RECORD_POS_SEQ(pos)  ((uint32_t)((pos) >> 32))
+#define RECORD_POS_OFF(pos)  ((uint32_t)(pos))
+
+// Retention: keep at most maxSegments segments and drop segments whose
+// first record is older than maxAgeDays (0 disables the age limit)
+void storageSetRetention(uint16_t maxSegments, uint16_t maxAgeDays);
+
+// Mounts the store rooted at another directory. The soak benchmark uses
+// this to keep its records away from patient data; DATA_DIR switches back.
+bool storageSelect(const char* dir);
+
+// Removes every record of the mounted store
+bool storageClear();
+
+uint32_t storageRecordCount();
+uint16_t storageSegmentCount();
+
+// Appends one already-encoded CSV line (no line break); `at`, if given,
+// receives the record's position
+bool storageAppend(const char* line, size_t len, RecordPos* at = NULL);
+
+// Position of the oldest record still stored (0 when empty). Anything
+// before it has been removed by retention.
+RecordPos storageOldestPos();
+
+// Delivers up to `count` records newest first, skipping the `skip` newest.
+// Returns the number delivered. The line buffer is only valid in the callback.
+typedef void (*RecordLineCallback)(const char* line, uint32_t index, void* ctx);
+uint16_t storageReadNewest(uint32_t skip, uint16_t count, RecordLineCallback cb, void* ctx);
+
+// Sequential reader across segments, oldest first
+class RecordReader {
+public:
+    RecordReader();
+    ~RecordReader();
+
+    // Positions at the first record at or after `start`. `resynced` is set
+    // when `start` pointed into a segment that retention already removed.
+    bool open(RecordPos start, bool& resynced);
+
+    // Reads the next record line. `at` is where it starts; afterwards
+    // position() is where the following record starts (possibly in the next
+    // segment), so consecutive records are always contiguous.
+    bool next(char* line, size_t cap, RecordPos& at, bool& truncated);
+
+    RecordPos position() const;
+    bool atEnd();
+    void close();
+
+private:
+    bool openSegment(uint16_t idx, uint32_t offset);
+    void skipExhausted();
+
+    File file;
+    uint16_t segIdx;
+    uint32_t seq;
+    bool isOpen;
+};
+
+#endif // STORAGE_H
@@ -0,0 +1,51 @@
+#include "stream_store.h"
+#include <string.h>
+
+StreamStore::StreamStore() {
+    reset();
+}
+
+void StreamStore::reset() {
+    memset(ch, 0, sizeof(ch));
+    dirty = 0;
+}
+
+void StreamStore::push(const StreamSample& s, uint32_t now) {
+    if (s.sensor < 1 || s.sensor > HUB_SENSOR_COUNT) return;
+    StreamChannel& c = ch[s.sensor - 1];
+    c.ring[c.head].value = s.value;
+    c.ring[c.head].timestamp = s.timestamp;
+    c.head = (c.head + 1) % STREAM_RING_LEN;
+    if (c.count < STREAM_RING_LEN) c.count++;
+    c.latest = s.value;
+    c.arrivedMs = now;
+    c.total++;
+    dirty |= HUB_SENSOR_BIT(s.sensor);
+}
+
+const StreamChannel& StreamStore::channel(uint8_t sensor) const {
+    return ch[sensor >= 1 && sensor <= HUB_SENSOR_COUNT ? sensor - 1 : 0];
+}
+
+size_t StreamStore::recent(uint8_t sensor, StreamPoint* out, size_t n) const {
+    const StreamChannel& c = channel(sensor);
+    if (n > c.count) n = c.count;
+    size_t first = (c.head + STREAM_RING_LEN - n) % STREAM_RING_LEN;
+    for (size_t i = 0; i < n; i++) out[i] = c.ring[(first + i) % STREAM_RING_LEN];
+    return n;
+}
+
+float StreamStore::rateHz(uint8_t sensor) const {
+    const StreamChannel& c = channel(sensor);
+    if (c.count < 2) return 0;
+    uint32_t newest = c.ring[(c.head + STREAM_RING_LEN - 1) % STREAM_RING_LEN].timestamp;
+    uint32_t oldest = c.ring[(c.head + STREAM_RING_LEN - c.count) % STREAM_RING_LEN].timestamp;
+    if (newest == oldest) return 0;
+    return (c.count - 1) * 1000.0f / (newest - oldest);
+}
+
+uint8_t StreamStore::takeDirty() {
+    uint8_t d = dirty;
+    dirty = 0;
+    return d;
+}
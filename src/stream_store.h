@@ -0,0 +1,54 @@
+#ifndef STREAM_STORE_H
+#define STREAM_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hub_protocol.h"
+
+// Per-channel storage for hub stream samples. Each sensor keeps its own
+// latest value and a ring of recent samples, so channels streaming at the
+// same time never overwrite each other. Channels touched since the last
+// takeDirty() are flagged, letting the UI redraw every changed readout in
+// one pass instead of once per frame.
+
+#define STREAM_RING_LEN 64
+
+struct StreamPoint {
+    float value;
+    uint32_t timestamp;   // hub clock, ms
+};
+
+struct StreamChannel {
+    StreamPoint ring[STREAM_RING_LEN];
+    uint8_t head;         // next slot to write
+    uint8_t count;        // valid entries, up to STREAM_RING_LEN
+    float latest;
+    uint32_t arrivedMs;   // kiosk clock of the latest sample
+    uint32_t total;
+};
+
+class StreamStore {
+public:
+    StreamStore();
+    void reset();
+
+    void push(const StreamSample& s, uint32_t now);
+
+    // Channels by HUB_SENSOR_* number; other numbers are dropped on push
+    const StreamChannel& channel(uint8_t sensor) const;
+
+    // Up to n most recent samples of a channel, oldest first
+    size_t recent(uint8_t sensor, StreamPoint* out, size_t n) const;
+
+    // Sample rate over the ring, from hub timestamps (0 if too few)
+    float rateHz(uint8_t sensor) const;
+
+    // HUB_SENSOR_BIT mask of channels with new samples; clears it
+    uint8_t takeDirty();
+
+private:
+    StreamChannel ch[HUB_SENSOR_COUNT];
+    uint8_t dirty;
+};
+
+#endif // STREAM_STORE_H
@@ -0,0 +1,118 @@
+#include "sync_export.h"
+#include "display.h"
+#include "sensors.h"
+#include "record_codec.h"
+#include "console.h"
+#include "storage.h"
+#include <Preferences.h>
+
+extern bool sdCardInitialized;
+
+static Preferences exportPrefs;
+static RecordPos watermark = 0;
+static uint32_t generation = 0;
+static RecordPos pendingTo = 0;
+static bool pendingValid = false;
+static char kioskId[13];
+
+static void saveWatermark() {
+    exportPrefs.putULong64("wm", watermark);
+    exportPrefs.putUInt("gen", generation);
+}
+
+static void cmdExport(const char* args) {
+    int maxRecords = atoi(args);
+    if (maxRecords <= 0 || maxRecords > EXPORT_BATCH_MAX) maxRecords = EXPORT_BATCH_MAX;
+
+    if (!sdCardInitialized) {
+        Serial.println("{\"type\":\"error\",\"msg\":\"sd not ready\"}");
+        return;
+    }
+
+    // The reader may open past the watermark without anything being lost:
+    // the end of a full segment and the start of the next name the same
+    // point in the stream. Only a resync moves "from" forward.
+    RecordReader reader;
+    bool resynced = false;
+    bool opened = reader.open(watermark, resynced);
+    RecordPos from = opened && resynced ? reader.position() : watermark;
+    Serial.printf("{\"type\":\"batch\",\"kiosk\":\"%s\",\"gen\":%lu,\"from\":%llu,\"resync\":%s}\n",
+                  kioskId, (unsigned long)generation, (unsigned long long)from,
+                  resynced ? "true" : "false");
+
+    char line[RECORD_CSV_MAX];
+    char json[RECORD_JSON_MAX];
+    bool truncated;
+    int count = 0;
+    RecordPos at, off = from;
+    HealthData rec;
+    while (opened && count < maxRecords && reader.next(line, sizeof(line), at, truncated)) {
+        RecordPos end = reader.position();
+        at = off;   // same as the reader's except across that boundary
+        off = end;
+        count++;
+        if (!truncated && decodeCSV(line, rec) && encodeJSON(rec, json, sizeof(json)) > 0) {
+            Serial.printf("{\"type\":\"rec\",\"off\":%llu,\"end\":%llu,\"rec\":%s}\n",
+                          (unsigned long long)at, (unsigned long long)end, json);
+        } else {
+            Serial.printf("{\"type\":\"skip\",\"off\":%llu,\"end\":%llu}\n",
+                          (unsigned long long)at, (unsigned long long)end);
+        }
+    }
+    RecordPos to = off;
+    bool more = opened && !reader.atEnd();
+    reader.close();
+
+    Serial.printf("{\"type\":\"end\",\"from\":%llu,\"to\":%llu,\"count\":%d,\"more\":%s}\n",
+                  (unsigned long long)from, (unsigned long long)to, count, more ? "true" : "false");
+    pendingTo = to;
+    pendingValid = true;
+}
+
+static void cmdAck(const char* args) {
+    unsigned long gen = 0;
+    unsigned long long to = 0;
+    if (sscanf(args, "%lu %llu", &gen, &to) != 2) {
+        Serial.println("{\"type\":\"error\",\"msg\":\"usage: ACK <gen> <to>\"}");
+        return;
+    }
+    if (!pendingValid || gen != generation || to != pendingTo) {
+        Serial.println("{\"type\":\"error\",\"msg\":\"stale ack\"}");
+        return;
+    }
+    watermark = to;
+    pendingValid = false;
+    saveWatermark();
+    Serial.printf("{\"type\":\"ack\",\"gen\":%lu,\"watermark\":%llu}\n",
+                  (unsigned long)generation, (unsigned long long)watermark);
+}
+
+static void cmdStatus(const char*) {
+    Serial.printf("{\"type\":\"status\",\"kiosk\":\"%s\",\"gen\":%lu,\"watermark\":%llu,\"records\":%lu}\n",
+                  kioskId, (unsigned long)generation, (unsigned long long)watermark,
+                  (unsigned long)storageRecordCount());
+}
+
+void exportBegin() {
+    exportPrefs.begin(EXPORT_NAMESPACE, false);
+    watermark = exportPrefs.getULong64("wm", 0);
+    generation = exportPrefs.getUInt("gen", 0);
+
+    uint64_t mac = ESP.getEfuseMac();
+    snprintf(kioskId, sizeof(kioskId), "%04x%08lx",
+             (unsigned)(mac >> 32) & 0xFFFF, (unsigned long)(mac & 0xFFFFFFFF));
+
+    consoleRegister("EXPORT", cmdExport);
+    consoleRegister("ACK", cmdAck);
+    consoleRegister("EXPORT_STATUS", cmdStatus);
+    Serial.printf("✓ Export watermark gen=%lu segment=%lu off=%lu\n",
+                  (unsigned long)generation, (unsigned long)RECORD_POS_SEQ(watermark),
+                  (unsigned long)RECORD_POS_OFF(watermark));
+}
+
+void exportReset() {
+    generation++;
+    watermark = 0;
+    pendingValid = false;
+    saveWatermark();
+}
@@ -0,0 +1,34 @@
+#ifndef SYNC_EXPORT_H
+#define SYNC_EXPORT_H
+
+#include <Arduino.h>
+
+// Incremental export of stored records to a collector on the USB serial
+// port. The kiosk keeps a persistent watermark (RecordPos of the first
+// record the collector has not acknowledged) and each EXPORT emits only the
+// records after it as NDJSON:
+//
+//   {"type":"batch","kiosk":"<id>","gen":G,"from":F,"resync":false}
+//   {"type":"rec","off":P,"end":E,"rec":{...HealthData JSON...}}
+//   {"type":"skip","off":P,"end":E}          (unreadable line)
+//   {"type":"end","from":F,"to":T,"count":N,"more":true|false}
+//
+// Positions are opaque, increasing numbers; the first record's "off" equals
+// "from" and each later one the previous record's "end", also from one
+// batch to the next. "resync" is set when retention removed records the
+// collector had not yet acknowledged, so "from" jumps forward.
+//
+// The watermark only advances when the collector answers "ACK <gen> <to>",
+// so an interrupted transfer is simply re-sent. `gen` changes whenever the
+// store is cleared.
+
+#define EXPORT_NAMESPACE "export"
+#define EXPORT_BATCH_MAX 50
+
+// Load the watermark and register the EXPORT / ACK / EXPORT_STATUS commands
+void exportBegin();
+
+// Data file was cleared: start a new generation at offset 0
+void exportReset();
+
+#endif // SYNC_EXPORT_H
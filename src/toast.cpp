@@ -0,0 +1,177 @@
+#include "toast.h"
+
+struct ToastMsg {
+    char text[TOAST_TEXT_MAX];
+    uint8_t level;
+    uint32_t ms;
+    uint32_t seq;        // arrival order, FIFO within a level
+};
+
+struct ToastSlot {
+    lv_obj_t *obj;       // NULL = free
+    uint8_t level;
+    char text[TOAST_TEXT_MAX];
+    uint32_t expiresAt;  // lv_tick time
+};
+
+static const uint32_t LEVEL_COLORS[] = {0x3B82F6, 0x10B981, 0xEF4444};
+
+static ToastMsg pending[TOAST_QUEUE_LEN];
+static uint8_t pendingCount = 0;
+static ToastSlot visible[TOAST_VISIBLE_MAX];
+static uint32_t nextSeq = 0;
+static lv_timer_t *toastTimer = NULL;
+
+/* ==================== ON SCREEN ==================== */
+static void restack() {
+    int32_t y = 20;
+    for (uint8_t i = 0; i < TOAST_VISIBLE_MAX; i++) {
+        if (!visible[i].obj) continue;
+        lv_obj_align(visible[i].obj, LV_ALIGN_TOP_MID, 0, y);
+        y += 70;
+    }
+}
+
+static void retire(uint8_t i) {
+    lv_obj_t *obj = visible[i].obj;
+    visible[i].obj = NULL;
+    // Already off the stack; the object only lingers for the fade
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_fade_out(obj, TOAST_FADE_MS, 0);
+    lv_obj_delete_delayed(obj, TOAST_FADE_MS);
+}
+
+static void toast_clicked_cb(lv_event_t *e) {
+    lv_obj_t *obj = (lv_obj_t *)lv_event_get_current_target(e);
+    for (uint8_t i = 0; i < TOAST_VISIBLE_MAX; i++) {
+        if (visible[i].obj == obj) visible[i].expiresAt = lv_tick_get();
+    }
+    if (toastTimer) lv_timer_ready(toastTimer);
+}
+
+static void present(uint8_t slot, const ToastMsg &m) {
+    lv_obj_t *obj = lv_obj_create(lv_layer_top());
+    lv_obj_set_size(obj, 300, 60);
+    lv_obj_set_style_bg_color(obj, lv_color_hex(LEVEL_COLORS[m.level]), 0);
+    lv_obj_set_style_radius(obj, 10, 0);
+    lv_obj_set_style_border_width(obj, 0, 0);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(obj, toast_clicked_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *txt = lv_label_create(obj);
+    lv_label_set_text(txt, m.text);
+    lv_obj_set_style_text_font(txt, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(txt, lv_color_hex(0xFFFFFF), 0);
+    lv_obj_center(txt);
+    lv_obj_fade_in(obj, TOAST_FADE_MS, 0);
+
+    ToastSlot &s = visible[slot];
+    s.obj = obj;
+    s.level = m.level;
+    memcpy(s.text, m.text, sizeof(s.text));
+    s.expiresAt = lv_tick_get() + m.ms;
+}
+
+/* ==================== QUEUE ==================== */
+// Index of the pending toast to show next: highest level, then oldest
+static int8_t nextPending() {
+    int8_t best = -1;
+    for (uint8_t i = 0; i < pendingCount; i++) {
+        if (best < 0 || pending[i].level > pending[best].level ||
+            (pending[i].level == pending[best].level && pending[i].seq < pending[best].seq)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void service() {
+    uint32_t now = lv_tick_get();
+    bool moved = false;
+    for (uint8_t i = 0; i < TOAST_VISIBLE_MAX; i++) {
+        if (visible[i].obj && (int32_t)(now - visible[i].expiresAt) >= 0) {
+            retire(i);
+            moved = true;
+        }
+    }
+
+    int8_t next;
+    while ((next = nextPending()) >= 0) {
+        int8_t slot = -1, lesser = -1;
+        for (uint8_t i = 0; i < TOAST_VISIBLE_MAX; i++) {
+            if (!visible[i].obj) {
+                if (slot < 0) slot = i;
+            } else if (visible[i].level < pending[next].level &&
+                       (lesser < 0 || visible[i].expiresAt < visible[lesser].expiresAt)) {
+                lesser = i;
+            }
+        }
+        if (slot < 0 && pending[next].level == TOAST_ERROR && lesser >= 0) {
+            retire(lesser);
+            slot = lesser;
+        }
+        if (slot < 0) break;
+        present(slot, pending[next]);
+        pending[next] = pending[--pendingCount];
+        moved = true;
+    }
+    if (moved) restack();
+
+    if (toastTimer && toastCount() == 0) lv_timer_pause(toastTimer);
+}
+
+static void toast_timer_cb(lv_timer_t *) {
+    service();
+}
+
+void toastShow(const char *text, ToastLevel level, uint32_t ms) {
+    for (uint8_t i = 0; i < TOAST_VISIBLE_MAX; i++) {
+        if (visible[i].obj && visible[i].level == level && strncmp(visible[i].text, text, TOAST_TEXT_MAX - 1) == 0) {
+            visible[i].expiresAt = lv_tick_get() + ms;
+            return;
+        }
+    }
+
+    if (pendingCount == TOAST_QUEUE_LEN) {
+        // Full: the newcomer replaces the least important, oldest entry, if
+        // there is one at or below its level
+        int8_t victim = -1;
+        for (uint8_t i = 0; i < pendingCount; i++) {
+            if (pending[i].level > level) continue;
+            if (victim < 0 || pending[i].level < pending[victim].level ||
+                (pending[i].level == pending[victim].level && pending[i].seq < pending[victim].seq)) {
+                victim = i;
+            }
+        }
+        if (victim < 0) return;
+        pending[victim] = pending[--pendingCount];
+    }
+    ToastMsg &m = pending[pendingCount++];
+    strncpy(m.text, text, TOAST_TEXT_MAX - 1);
+    m.text[TOAST_TEXT_MAX - 1] = '\0';
+    m.level = level;
+    m.ms = ms;
+    m.seq = nextSeq++;
+
+    if (!toastTimer) toastTimer = lv_timer_create(toast_timer_cb, TOAST_TICK_MS, NULL);
+    lv_timer_resume(toastTimer);
+    service();   // on screen in this very LVGL cycle if there is room
+}
+
+void toastClear() {
+    pendingCount = 0;
+    for (uint8_t i = 0; i < TOAST_VISIBLE_MAX; i++) {
+        if (visible[i].obj) {
+            lv_obj_delete(visible[i].obj);
+            visible[i].obj = NULL;
+        }
+    }
+    if (toastTimer) lv_timer_pause(toastTimer);
+}
+
+uint8_t toastCount() {
+    uint8_t n = pendingCount;
+    for (uint8_t i = 0; i < TOAST_VISIBLE_MAX; i++) {
+        if (visible[i].obj) n++;
+    }
+    return n;
+}
@@ -0,0 +1,35 @@
+#ifndef TOAST_H
+#define TOAST_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+// Transient notifications on lv_layer_top().
+//
+// toastShow() only queues the message and returns; an lv_timer puts it on
+// screen, stacks up to TOAST_VISIBLE_MAX from the top edge, fades each out
+// when its time is up (or when tapped) and moves the next one in. Nothing
+// waits, so UI callbacks stay within their latency budget and the message
+// actually gets rendered. Higher levels jump the queue, and an error that
+// finds the stack full retires the oldest lesser toast early. Showing the
+// same text again while it is up restarts its timer instead of stacking a
+// duplicate.
+
+#define TOAST_VISIBLE_MAX  3
+#define TOAST_QUEUE_LEN    8
+#define TOAST_TEXT_MAX     48
+#define TOAST_MS           2000
+#define TOAST_FADE_MS      200
+#define TOAST_TICK_MS      50
+
+enum ToastLevel { TOAST_INFO, TOAST_SUCCESS, TOAST_ERROR };   // ascending priority
+
+void toastShow(const char *text, ToastLevel level, uint32_t ms = TOAST_MS);
+
+// Drop everything queued and on screen
+void toastClear();
+
+// Toasts on screen plus queued
+uint8_t toastCount();
+
+#endif // TOAST_H
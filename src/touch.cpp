@@ -0,0 +1,181 @@
+#include "touch.h"
+#include "display.h"
+#include "console.h"
+#include "gesture.h"
+#include "scheduler.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+extern TAMC_GT911 ts;
+
+// Raw controller point -> LVGL point:
+//   x = xx * raw.x + xy * raw.y + x0
+//   y = yx * raw.x + yy * raw.y + y0
+struct TouchTransform {
+    int8_t xx, xy, yx, yy;
+    int16_t x0, y0;
+};
+
+// Indexed by DISPLAY_ROTATION. ts.setRotation() already handles the
+// controller side; this is what is left to match the portrait LVGL display.
+static const TouchTransform ROTATIONS[4] = {
+    {1, 0, 0, 1, 0, 0},
+    {0, 1, -1, 0, 0, (int16_t)max(TOUCH_MAP_X1, TOUCH_MAP_X2)},
+    {1, 0, 0, 1, 0, 0},
+    {1, 0, 0, 1, 0, 0},
+};
+
+static TouchTransform xform;
+static QueueHandle_t touchQueue = NULL;
+static TaskHandle_t touchTaskHandle = NULL;
+static bool useIrq = false;
+static uint32_t overruns = 0;
+
+static portMUX_TYPE irqMux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t irqStamp = 0;
+
+// LVGL side state (UI thread only)
+static TouchEvent last = {0, {{0, 0}}, 0};
+
+// Latency probe (UI thread only)
+static bool probeOn = false;
+static int64_t probeStamp = 0;     // IRQ time of the press awaiting a flush
+static int64_t probeReadAt = 0;
+static uint32_t probeCount = 0;
+static int64_t probeMin = 0, probeMax = 0, probeSum = 0;
+
+#if TOUCH_GT911_INT >= 0
+static void IRAM_ATTR touchIsr() {
+    portENTER_CRITICAL_ISR(&irqMux);
+    irqStamp = esp_timer_get_time();
+    portEXIT_CRITICAL_ISR(&irqMux);
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(touchTaskHandle, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+#endif
+
+static void pushEvent(const TouchEvent& ev) {
+    if (xQueueSend(touchQueue, &ev, 0) == pdTRUE) {
+        schedWake(SCHED_WAKE_TOUCH);
+        return;
+    }
+    // Full: LVGL is behind. Drop the oldest report rather than the newest so
+    // a release is never lost.
+    TouchEvent stale;
+    xQueueReceive(touchQueue, &stale, 0);
+    xQueueSend(touchQueue, &ev, 0);
+    overruns++;
+    schedWake(SCHED_WAKE_TOUCH);
+}
+
+static void touchTask(void *param) {
+    TouchEvent prev = {0, {{-1, -1}}, 0};
+
+    for (;;) {
+        TickType_t wait;
+        if (!useIrq) wait = pdMS_TO_TICKS(TOUCH_POLL_MS);
+        else wait = prev.count ? pdMS_TO_TICKS(TOUCH_RELEASE_MS) : portMAX_DELAY;
+
+        bool fromIrq = ulTaskNotifyTake(pdTRUE, wait) > 0;
+        TouchEvent ev;
+        if (fromIrq) {
+            portENTER_CRITICAL(&irqMux);
+            ev.stamp_us = irqStamp;
+            portEXIT_CRITICAL(&irqMux);
+        } else {
+            ev.stamp_us = esp_timer_get_time();
+        }
+
+        ts.read();
+
+        ev.count = ts.isTouched ? min<uint8_t>(ts.touches, TOUCH_MAX_POINTS) : 0;
+        if (ts.isTouched && ev.count == 0) ev.count = 1;
+        for (uint8_t i = 0; i < ev.count; i++) {
+            int32_t rx = ts.points[i].x, ry = ts.points[i].y;
+            ev.pts[i].x = xform.xx * rx + xform.xy * ry + xform.x0;
+            ev.pts[i].y = xform.yx * rx + xform.yy * ry + xform.y0;
+        }
+        if (ev.count == 0) {
+            if (prev.count == 0) continue;
+            ev.pts[0] = prev.pts[0];
+        } else if (ev.count == prev.count &&
+                   memcmp(ev.pts, prev.pts, ev.count * sizeof(TouchPoint)) == 0) {
+            continue;   // nothing moved
+        }
+        prev = ev;
+        pushEvent(ev);
+    }
+}
+
+void touchRead(lv_indev_t *indev, lv_indev_data_t *data) {
+    TouchEvent ev;
+    if (touchQueue && xQueueReceive(touchQueue, &ev, 0) == pdTRUE) {
+        if (probeOn && ev.count && !last.count) {
+            probeStamp = ev.stamp_us;
+            probeReadAt = esp_timer_get_time();
+        }
+        last = ev;
+        gestureFeed(ev);
+        // Let LVGL see every queued report in this read cycle
+        data->continue_reading = uxQueueMessagesWaiting(touchQueue) > 0;
+    }
+    data->point.x = last.pts[0].x;
+    data->point.y = last.pts[0].y;
+    data->state = last.count ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+void touchNoteFlush() {
+    if (!probeOn || probeStamp == 0) return;
+    int64_t now = esp_timer_get_time();
+    int64_t total = now - probeStamp;
+    Serial.printf("Touch latency: irq->read %lld us, irq->pixel %lld us\n",
+                  (long long)(probeReadAt - probeStamp), (long long)total);
+    if (probeCount == 0 || total < probeMin) probeMin = total;
+    if (total > probeMax) probeMax = total;
+    probeSum += total;
+    probeCount++;
+    probeStamp = 0;
+}
+
+static void cmdTouchLatency(const char* args) {
+    if (strcasecmp(args, "ON") == 0) {
+        probeOn = true;
+        probeStamp = 0;
+        probeCount = 0;
+        probeMin = probeMax = probeSum = 0;
+        Serial.println("Touch latency probe on – tap the screen");
+        return;
+    }
+    if (strcasecmp(args, "OFF") == 0) probeOn = false;
+
+    Serial.printf("Touch: %s, %lu queue overruns\n",
+                  useIrq ? "interrupt" : "polling", (unsigned long)overruns);
+    if (probeCount > 0) {
+        Serial.printf("Touch-to-pixel over %lu taps: min %lld us, avg %lld us, max %lld us\n",
+                      (unsigned long)probeCount, (long long)probeMin,
+                      (long long)(probeSum / probeCount), (long long)probeMax);
+    }
+}
+
+void touchBegin() {
+    xform = ROTATIONS[DISPLAY_ROTATION & 3];
+    touchQueue = xQueueCreate(TOUCH_QUEUE_LEN, sizeof(TouchEvent));
+#if TOUCH_GT911_INT >= 0
+    useIrq = true;
+#endif
+    xTaskCreatePinnedToCore(touchTask, "touch", 3072, NULL, 3, &touchTaskHandle, 0);
+
+#if TOUCH_GT911_INT >= 0
+    // Attach only once the task exists – the ISR notifies it
+    pinMode(TOUCH_GT911_INT, INPUT);
+    attachInterrupt(digitalPinToInterrupt(TOUCH_GT911_INT), touchIsr, FALLING);
+    Serial.println("✓ Touch: GT911 interrupt mode");
+#else
+    Serial.println("✓ Touch: GT911 polling mode (INT not wired)");
+#endif
+
+    consoleRegister("TOUCHLAT", cmdTouchLatency);
+}
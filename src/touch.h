@@ -0,0 +1,41 @@
+#ifndef TOUCH_H
+#define TOUCH_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+// GT911 touch input.
+//
+// A reader task owns all I2C traffic to the controller. With TOUCH_GT911_INT
+// wired it sleeps until the controller pulls its interrupt line; otherwise it
+// falls back to polling every TOUCH_POLL_MS. Each report is rotated into
+// LVGL coordinates once, stamped with the interrupt (or poll) time and queued,
+// so the LVGL read callback only drains the queue and never waits on the bus.
+
+#define TOUCH_QUEUE_LEN   16
+#define TOUCH_POLL_MS     10
+#define TOUCH_RELEASE_MS  40   // no report for this long while pressed = lifted
+#define TOUCH_MAX_POINTS  2    // contacts forwarded to the gesture layer
+
+struct TouchPoint {
+    int16_t x;
+    int16_t y;
+};
+
+struct TouchEvent {
+    int64_t stamp_us;   // esp_timer time of the IRQ (or poll) that produced it
+    TouchPoint pts[TOUCH_MAX_POINTS];   // LVGL coordinates; pts[0] drives LVGL
+    uint8_t count;      // contacts down, 0 = released (pts[0] = last position)
+};
+
+// Call once after ts.begin()/ts.setRotation(); starts the reader task
+void touchBegin();
+
+// LVGL pointer read callback. Also feeds every report to the gesture layer.
+void touchRead(lv_indev_t *indev, lv_indev_data_t *data);
+
+// Call from the display flush callback. Used by the latency probe
+// (console: TOUCHLAT ON|OFF) to time touch-to-first-pixel.
+void touchNoteFlush();
+
+#endif // TOUCH_H
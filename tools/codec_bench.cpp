@@ -0,0 +1,205 @@
+// Host benchmark for the record serializers (src/record_codec.h).
+//
+// Encodes a set of synthetic records – names and addresses with the commas,
+// quotes and line breaks the CSV writer has to quote – with encodeCSV,
+// encodeJSON and encodeBinary, and with the String concatenation that
+// HealthData::toCSV()/toJSON() used before the field table, then reports
+// records per second for each. Every record is also round-tripped through
+// decodeCSV and decodeBinary; any field that comes back different (beyond
+// the two decimals CSV keeps, and the line breaks it turns into spaces) is
+// a failure and makes the exit status non-zero.
+//
+// The host's allocator is far cheaper than the ESP32 heap, so the gap to
+// the String baseline is smaller here than on the kiosk.
+//
+//   g++ -O2 -std=gnu++11 -Itools/host -Isrc tools/codec_bench.cpp src/record_codec.cpp -o codec_bench
+//   ./codec_bench --records 200000
+//
+// Options:
+//   --records N     records encoded per serializer (default 100000)
+
+#include "record_codec.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define SAMPLES 64   // distinct records, cycled
+
+static const char* const NAMES[] = {
+    "Maria Santos", "Dela Cruz, Juan", "Ana \"Annie\" Reyes", "Pedro Bautista", "Rosa Mendoza-Garcia",
+    "Carmen Villanueva", "Luis Fernandez", "Elena \"Lena\" Torres",
+};
+static const char* const ADDRESSES[] = {
+    "12 Rizal St, Poblacion", "Purok 3\nBarangay San Isidro", "Lot 7 Block 2, Phase \"B\"", "",
+};
+#define COUNT(a) (sizeof(a) / sizeof(a[0]))
+
+static HealthData sample(int i) {
+    HealthData d;
+    d.timestamp = "2026-10-18 09:" + String(10 + i % 50) + ":00";
+    d.name = NAMES[i % COUNT(NAMES)];
+    d.age = String(18 + i % 70);
+    d.gender = (i & 1) ? "Female" : "Male";
+    d.address = ADDRESSES[i % COUNT(ADDRESSES)];
+    d.weight = 45.0f + (i % 60) * 0.75f;
+    d.height = 140.0f + (i % 50) * 0.9f;
+    d.temperature = 36.0f + (i % 20) * 0.05f;
+    d.bmi = d.weight / ((d.height / 100) * (d.height / 100));
+    d.heart_rate = 55 + i % 60;
+    d.bp_sys = 100 + i % 50;
+    d.bp_dia = 60 + i % 30;
+    d.weight_measured = d.height_measured = true;
+    d.temp_measured = (i % 3) != 0;
+    d.hr_measured = (i % 4) != 0;
+    d.bp_measured = (i % 5) != 0;
+    return d;
+}
+
+// The pre-field-table serializers, kept here as the baseline
+static String concatCSV(const HealthData& d) {
+    return String(d.timestamp + "," + d.name + "," + d.age + "," + d.gender + "," + d.address + "," +
+                  String(d.weight) + "," + String(d.height) + "," + String(d.temperature) + "," +
+                  String(d.bmi) + "," + String(d.heart_rate) + "," + String(d.bp_sys) + "," + String(d.bp_dia));
+}
+
+static String concatJSON(const HealthData& d) {
+    return "{\"timestamp\":\"" + d.timestamp + "\",\"name\":\"" + d.name + "\",\"age\":\"" + d.age +
+           "\",\"gender\":\"" + d.gender + "\",\"address\":\"" + d.address + "\",\"weight\":" + String(d.weight) +
+           ",\"height\":" + String(d.height) + ",\"temperature\":" + String(d.temperature) +
+           ",\"bmi\":" + String(d.bmi) + ",\"heart_rate\":" + String(d.heart_rate) +
+           ",\"bp_sys\":" + String(d.bp_sys) + ",\"bp_dia\":" + String(d.bp_dia) + "}";
+}
+
+// Fields equal, floats to the `tolerance` the format keeps
+static bool same(const HealthData& a, const HealthData& b, float tolerance) {
+    return a.timestamp == b.timestamp && a.name == b.name && a.age == b.age && a.gender == b.gender &&
+           a.address == b.address && fabsf(a.weight - b.weight) <= tolerance &&
+           fabsf(a.height - b.height) <= tolerance && fabsf(a.temperature - b.temperature) <= tolerance &&
+           fabsf(a.bmi - b.bmi) <= tolerance && a.heart_rate == b.heart_rate && a.bp_sys == b.bp_sys &&
+           a.bp_dia == b.bp_dia;
+}
+
+// What CSV keeps of a record: the store is line-oriented, so line breaks
+// inside text fields are written as spaces
+static HealthData csvForm(HealthData d) {
+    String* text[] = {&d.timestamp, &d.name, &d.age, &d.gender, &d.address};
+    for (size_t i = 0; i < COUNT(text); i++) {
+        for (size_t c = 0; c < text[i]->s.size(); c++) {
+            if (text[i]->s[c] == '\r' || text[i]->s[c] == '\n') text[i]->s[c] = ' ';
+        }
+    }
+    return d;
+}
+
+static bool sameFlags(const HealthData& a, const HealthData& b) {
+    return a.height_measured == b.height_measured && a.weight_measured == b.weight_measured &&
+           a.temp_measured == b.temp_measured && a.hr_measured == b.hr_measured && a.bp_measured == b.bp_measured;
+}
+
+static double since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void report(const char* name, long records, double seconds, size_t bytes) {
+    printf("%-14s %10.0f rec/s  %6.1f MB/s\n", name, records / seconds, bytes / seconds / 1e6);
+}
+
+int main(int argc, char** argv) {
+    long records = 100000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--records") && i + 1 < argc) records = atol(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--records N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<HealthData> set;
+    for (int i = 0; i < SAMPLES; i++) set.push_back(sample(i));
+
+    // Round trips first: a fast encoder that loses data is no use
+    long wrong = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        char line[RECORD_CSV_MAX];
+        HealthData back;
+        if (encodeCSV(set[i], line, sizeof(line)) == 0 || !decodeCSV(line, back) ||
+            !same(csvForm(set[i]), back, 0.005f)) {
+            printf("csv round trip failed for record %d\n", i);
+            wrong++;
+        }
+        uint8_t bin[RECORD_BIN_MAX];
+        size_t n = encodeBinary(set[i], bin, sizeof(bin));
+        HealthData binBack;
+        if (n == 0 || !decodeBinary(bin, n, binBack) || !same(set[i], binBack, 0) || !sameFlags(set[i], binBack)) {
+            printf("binary round trip failed for record %d\n", i);
+            wrong++;
+        }
+    }
+
+    // A record that cannot fit must be refused, not cut short
+    char small[16];
+    if (encodeCSV(set[0], small, sizeof(small)) != 0 || encodeJSON(set[0], small, sizeof(small)) != 0) {
+        printf("overflow not reported\n");
+        wrong++;
+    }
+    HealthData huge = set[0];
+    huge.address = String(std::string(600, 'x'));
+    uint8_t hugeBin[RECORD_BIN_MAX * 4];
+    if (huge.toCSV().length() != 0 || huge.toJSON().length() != 0 ||
+        encodeBinary(huge, hugeBin, sizeof(hugeBin)) != 0) {
+        printf("oversized record not refused\n");
+        wrong++;
+    }
+
+    // The longest text the info screen accepts, every character escaped,
+    // must fit every format
+    HealthData worst = sample(1);
+    worst.timestamp = "2026-10-18 09:00:00";
+    worst.name = String(std::string(RECORD_NAME_MAX, '"'));
+    worst.age = String(std::string(RECORD_AGE_MAX, '9'));
+    worst.gender = "Prefer not to say";
+    worst.address = String(std::string(RECORD_ADDRESS_MAX, '"'));
+    worst.weight = worst.height = worst.temperature = worst.bmi = -4294967040.0f;
+    worst.heart_rate = worst.bp_sys = worst.bp_dia = -2147483647 - 1;
+    char worstText[RECORD_JSON_MAX];
+    uint8_t worstBin[RECORD_BIN_MAX];
+    if (encodeCSV(worst, worstText, RECORD_CSV_MAX) == 0 || encodeJSON(worst, worstText, sizeof(worstText)) == 0 ||
+        encodeBinary(worst, worstBin, sizeof(worstBin)) == 0) {
+        printf("record at the info screen's limits does not fit\n");
+        wrong++;
+    }
+
+    size_t bytes = 0;
+    char text[RECORD_JSON_MAX];
+    uint8_t bin[RECORD_BIN_MAX];
+    std::chrono::steady_clock::time_point t0;
+
+    t0 = std::chrono::steady_clock::now();
+    for (long r = 0; r < records; r++) bytes += concatCSV(set[r % SAMPLES]).length();
+    report("String CSV", records, since(t0), bytes);
+
+    bytes = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (long r = 0; r < records; r++) bytes += encodeCSV(set[r % SAMPLES], text, RECORD_CSV_MAX);
+    report("encodeCSV", records, since(t0), bytes);
+
+    bytes = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (long r = 0; r < records; r++) bytes += concatJSON(set[r % SAMPLES]).length();
+    report("String JSON", records, since(t0), bytes);
+
+    bytes = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (long r = 0; r < records; r++) bytes += encodeJSON(set[r % SAMPLES], text, sizeof(text));
+    report("encodeJSON", records, since(t0), bytes);
+
+    bytes = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (long r = 0; r < records; r++) bytes += encodeBinary(set[r % SAMPLES], bin, sizeof(bin));
+    report("encodeBinary", records, since(t0), bytes);
+
+    printf("round trips    %d records, %ld failures\n", SAMPLES, wrong);
+    return wrong ? 1 : 0;
+}
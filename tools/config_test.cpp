@@ -0,0 +1,232 @@
+// Host checks for the sensor configuration parser (src/sensor_config.h).
+//
+// Covers configParse (version line, comments and CRLF, over-long lines,
+// bad numbers, whole-number keys, per-key ranges, the line number reported
+// for each error), configValidate's range and cross-checks, bpValidate,
+// and a configFormat -> configParse round trip. The shipped
+// tools/config/sensors.cfg (or the file given) must parse and validate.
+// Each failed check is printed; any failure makes the exit status non-zero.
+//
+//   g++ -O2 -std=gnu++11 -Isrc tools/config_test.cpp src/sensor_config.cpp -o config_test
+//   ./config_test [tools/config/sensors.cfg]
+
+#include "sensor_config.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);    \
+            failures++;                                                        \
+        }                                                                      \
+    } while (0)
+
+// configParse result: the error line, or -1 if the text was accepted
+static int parseLine(const char* text, SensorConfig* out = NULL) {
+    SensorConfig c;
+    int line = -1;
+    if (configParse(text, out ? *out : c, &line)) return -1;
+    return line;
+}
+
+// An error string, and the expected one
+static bool says(const char* got, const char* want) {
+    return got && !strcmp(got, want);
+}
+
+static bool sameConfig(const SensorConfig& a, const SensorConfig& b) {
+    return a.temp_min == b.temp_min && a.temp_max == b.temp_max && a.temp_variance == b.temp_variance &&
+           a.hr_min == b.hr_min && a.hr_max == b.hr_max && a.hr_variance == b.hr_variance &&
+           a.weight_min == b.weight_min && a.weight_max == b.weight_max &&
+           a.weight_variance == b.weight_variance && a.height_min == b.height_min &&
+           a.height_max == b.height_max && a.height_variance == b.height_variance &&
+           a.bp_sys_min == b.bp_sys_min && a.bp_sys_max == b.bp_sys_max && a.bp_dia_min == b.bp_dia_min &&
+           a.bp_dia_max == b.bp_dia_max && a.bp_variance == b.bp_variance &&
+           a.sensor_mounting_height == b.sensor_mounting_height;
+}
+
+/* ==================== PARSE ==================== */
+static void version() {
+    SensorConfig c;
+    CHECK(parseLine("version 1\n") == -1);
+    CHECK(parseLine("version 1") == -1);   // no final newline
+    CHECK(parseLine("") == 0);
+    CHECK(parseLine("# only a comment\n\n") == 0);
+    // Keys before the version are refused where they appear
+    CHECK(parseLine("temp_min 36\nversion 1\n") == 1);
+    CHECK(parseLine("# header\n\ntemp_min 36\nversion 1\n") == 3);
+    CHECK(parseLine("version 2\n") == 1);
+    CHECK(parseLine("version 1\nversion 1\n") == 2);
+    CHECK(parseLine("version one\n") == 1);
+    CHECK(parseLine("  version 1  # first\r\n", &c) == -1);
+}
+
+static void lines() {
+    SensorConfig c;
+    CHECK(parseLine("version 1\r\n# comment\r\n\r\n\tTEMP_MIN\t36.5 # keys ignore case\r\n", &c) == -1);
+    CHECK(c.temp_min == 36.5f);
+
+    // Lines are read into 96 bytes; anything longer is an error, even a comment
+    std::string fits = "version 1\n#" + std::string(94, 'x') + "\n";
+    std::string tooLong = "version 1\n\n#" + std::string(95, 'x') + "\ntemp_min 36\n";
+    CHECK(parseLine(fits.c_str()) == -1);
+    CHECK(parseLine(tooLong.c_str()) == 3);
+
+    CHECK(parseLine("version 1\nno_such_key 1\n") == 2);
+    CHECK(parseLine("version 1\ntemp_min\n") == 2);   // key without a value
+}
+
+static void numbers() {
+    SensorConfig c;
+    CHECK(parseLine("version 1\ntemp_min abc\n") == 2);
+    CHECK(parseLine("version 1\ntemp_min 36x\n") == 2);
+    CHECK(parseLine("version 1\ntemp_min 36 37\n") == 2);
+    CHECK(parseLine("version 1\ntemp_min 3.6e1\n", &c) == -1 && c.temp_min == 36.0f);
+
+    // Whole-number keys take integers only
+    CHECK(parseLine("version 1\nhr_min 50.5\n") == 2);
+    CHECK(parseLine("version 1\nhr_min 55.0\n", &c) == -1 && c.hr_min == 55);
+
+    // Each value against its own key's range, bounds inclusive
+    CHECK(parseLine("version 1\ntemp_min 45\n") == -1);
+    CHECK(parseLine("version 1\ntemp_min 45.1\n") == 2);
+    CHECK(parseLine("version 1\nhr_max 251\n") == 2);
+    CHECK(parseLine("version 1\nsensor_mounting_height 99\n") == 2);
+    CHECK(parseLine("version 1\nweight_min -1\n") == 2);
+}
+
+static void keepsOutput() {
+    // `out` is only written on success, and unset keys keep the defaults
+    SensorConfig c;
+    c.temp_min = 30.0f;
+    int line = -1;
+    CHECK(!configParse("version 1\ntemp_min 36\nhr_min x\n", c, &line) && line == 3);
+    CHECK(c.temp_min == 30.0f);
+    CHECK(configParse("version 1\nhr_min 60\n", c, &line));
+    CHECK(c.hr_min == 60 && c.temp_min == SensorConfig().temp_min);
+    CHECK(!configParse("", c, NULL));   // errLine is optional
+}
+
+/* ==================== VALIDATE ==================== */
+static void validate() {
+    SensorConfig d;
+    CHECK(configValidate(d) == NULL);
+
+    SensorConfig c = d;
+    c.temp_min = 20.0f;
+    CHECK(says(configValidate(c), "temp_min"));
+    c = d;
+    c.weight_variance = NAN;
+    CHECK(says(configValidate(c), "weight_variance"));
+    c = d;
+    c.bp_variance = 31;
+    CHECK(says(configValidate(c), "bp_variance"));
+
+    struct {
+        void (*apply)(SensorConfig& c);
+        const char* error;
+    } const cross[] = {
+        {[](SensorConfig& c) { c.temp_min = c.temp_max; }, "temp_min not below temp_max"},
+        {[](SensorConfig& c) { c.hr_min = 130; }, "hr_min not below hr_max"},
+        {[](SensorConfig& c) { c.weight_max = 30; }, "weight_min not below weight_max"},
+        {[](SensorConfig& c) { c.height_min = 210; }, "height_min not below height_max"},
+        {[](SensorConfig& c) { c.bp_sys_min = 200; }, "bp_sys_min not below bp_sys_max"},
+        {[](SensorConfig& c) { c.bp_dia_min = 130; }, "bp_dia_min not below bp_dia_max"},
+        {[](SensorConfig& c) { c.bp_dia_max = 150; c.bp_sys_max = 150; }, "bp_dia_max not below bp_sys_max"},
+        {[](SensorConfig& c) { c.sensor_mounting_height = 200; }, "sensor_mounting_height not above height_max"},
+    };
+    for (size_t i = 0; i < sizeof(cross) / sizeof(cross[0]); i++) {
+        c = d;
+        cross[i].apply(c);
+        const char* e = configValidate(c);
+        if (!says(e, cross[i].error)) {
+            printf("cross-check %zu: expected \"%s\", got \"%s\"\n", i, cross[i].error, e ? e : "NULL");
+            failures++;
+        }
+    }
+
+    // Parsing checks each value, validation the combination
+    CHECK(parseLine("version 1\nheight_max 250\n", &c) == -1);
+    CHECK(says(configValidate(c), "sensor_mounting_height not above height_max"));
+}
+
+static void bloodPressure() {
+    SensorConfig c;
+    CHECK(bpValidate(c, 120, 80) == NULL);
+    CHECK(bpValidate(c, c.bp_sys_min, c.bp_dia_min) == NULL);   // bounds inclusive
+    CHECK(bpValidate(c, c.bp_sys_max, c.bp_dia_max) == NULL);
+    CHECK(says(bpValidate(c, c.bp_sys_min - 1, 70), "Systolic out of range"));
+    CHECK(says(bpValidate(c, c.bp_sys_max + 1, 70), "Systolic out of range"));
+    CHECK(says(bpValidate(c, 120, c.bp_dia_min - 1), "Diastolic out of range"));
+    CHECK(says(bpValidate(c, 100, 100), "Diastolic must be below systolic"));
+    CHECK(says(bpValidate(c, 100, 110), "Diastolic must be below systolic"));
+}
+
+/* ==================== FILES ==================== */
+static void appendLine(const char* line, void* ctx) {
+    std::string& s = *(std::string*)ctx;
+    s += line;
+    s += '\n';
+}
+
+static void formatRoundTrip() {
+    SensorConfig c;
+    c.temp_min = 35.5f;
+    c.hr_max = 140;
+    c.sensor_mounting_height = 230.25f;
+    std::string text;
+    configFormat(c, appendLine, &text);
+    SensorConfig back;
+    back.temp_min = 0;
+    CHECK(parseLine(text.c_str(), &back) == -1);
+    CHECK(sameConfig(c, back));
+}
+
+static void shippedFile(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        printf("cannot read %s\n", path);
+        failures++;
+        return;
+    }
+    // The kiosk reads at most CONFIG_TEXT_MAX - 1 bytes
+    static char text[CONFIG_TEXT_MAX + 2];
+    size_t n = fread(text, 1, sizeof(text) - 1, f);
+    fclose(f);
+    text[n] = '\0';
+    CHECK(n < CONFIG_TEXT_MAX);
+
+    SensorConfig c;
+    int line = -1;
+    if (!configParse(text, c, &line)) {
+        printf("%s: error on line %d\n", path, line);
+        failures++;
+        return;
+    }
+    const char* e = configValidate(c);
+    if (e) {
+        printf("%s: %s\n", path, e);
+        failures++;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "tools/config/sensors.cfg";
+
+    version();
+    lines();
+    numbers();
+    keepsOutput();
+    validate();
+    bloodPressure();
+    formatRoundTrip();
+    shippedFile(path);
+
+    printf("config_test: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
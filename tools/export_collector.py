@@ -0,0 +1,246 @@
+#!/usr/bin/env python3
+"""Collect health records from a kiosk over USB serial.
+
+Drives the kiosk's EXPORT/ACK console commands (see src/sync_export.h),
+appends every new record to <out>/<kiosk>.ndjson and acknowledges the batch
+only after it has been written to disk. Positions are checked so that each
+record starts where the previous one ended: a gap aborts the run without
+acknowledging, and the next run re-requests the same batch. The only
+accepted gap is one the kiosk announces with "resync" (records removed by
+its retention policy before they were collected); it is written to the file
+as a {"mark":"resync"} line, and a record the kiosk could not read as a
+{"mark":"skip"} line, so --verify can tell them from lost records.
+
+Where the file ends is taken from the file itself, and state.json records
+the kiosk's watermark only once the kiosk has confirmed the ACK. A batch
+that was written but never acknowledged (lost ACK, crash before it) is sent
+again by the kiosk from its old watermark; the records already on disk are
+skipped.
+
+    export_collector.py --port /dev/ttyACM0 --out collected/
+    export_collector.py --verify collected/
+
+Requires pyserial for collection (pip install pyserial).
+"""
+import argparse
+import json
+import os
+import sys
+import time
+
+
+class ExportError(Exception):
+    pass
+
+
+def load_state(out_dir):
+    path = os.path.join(out_dir, "state.json")
+    if os.path.exists(path):
+        with open(path) as f:
+            return json.load(f)
+    return {}
+
+
+def save_state(out_dir, state):
+    path = os.path.join(out_dir, "state.json")
+    tmp = path + ".tmp"
+    with open(tmp, "w") as f:
+        json.dump(state, f, indent=1)
+        f.flush()
+        os.fsync(f.fileno())
+    os.replace(tmp, path)
+
+
+def disk_tail(path):
+    """(gen, end) of the last line of a collected file, or None.
+
+    A line torn by a crash mid-append was never acknowledged; it is cut off
+    so the batch can be written again.
+    """
+    if not os.path.exists(path):
+        return None
+    with open(path, "rb+") as f:
+        size = f.seek(0, os.SEEK_END)
+        block = min(size, 65536)
+        f.seek(size - block)
+        tail = f.read(block)
+        if tail and not tail.endswith(b"\n"):
+            keep = tail.rfind(b"\n") + 1
+            print("warning: %s: dropping a torn last line" % path, file=sys.stderr)
+            f.truncate(size - block + keep)
+            tail = tail[:keep]
+    lines = tail.splitlines()
+    if not lines:
+        return None
+    last = json.loads(lines[-1])
+    return last["gen"], last["end"]
+
+
+def read_message(port, timeout):
+    """Next JSON line from the kiosk; ordinary log output is skipped."""
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        raw = port.readline()
+        if not raw:
+            continue
+        line = raw.decode("utf-8", "replace").strip()
+        if not line.startswith("{"):
+            continue
+        try:
+            msg = json.loads(line)
+        except ValueError:
+            continue
+        if "type" in msg:
+            return msg
+    raise ExportError("timed out waiting for kiosk")
+
+
+def collect_batch(port, out_dir, state, batch, timeout):
+    port.write(("EXPORT %d\n" % batch).encode())
+    msg = read_message(port, timeout)
+    if msg["type"] == "error":
+        raise ExportError(msg.get("msg", "kiosk error"))
+    if msg["type"] != "batch":
+        raise ExportError("expected batch header, got %r" % msg)
+
+    kiosk, gen, start = msg["kiosk"], msg["gen"], msg["from"]
+    path = os.path.join(out_dir, kiosk + ".ndjson")
+    tail = disk_tail(path)
+    held = tail[1] if tail and tail[0] == gen else None   # end of what is on disk
+
+    lines = []
+    if held is not None and start > held:
+        if not msg.get("resync"):
+            raise ExportError("%s gen %d: batch starts at %d, expected %d"
+                              % (kiosk, gen, start, held))
+        # Kiosk retention removed records before we fetched them
+        print("warning: %s dropped records %d..%d before export"
+              % (kiosk, held, start), file=sys.stderr)
+        lines.append({"kiosk": kiosk, "gen": gen, "off": held, "end": start, "mark": "resync"})
+
+    added = 0
+    pos = start
+    while True:
+        msg = read_message(port, timeout)
+        if msg["type"] in ("rec", "skip"):
+            if msg["off"] != pos:
+                raise ExportError("gap/duplicate at offset %d (expected %d)" % (msg["off"], pos))
+            pos = msg["end"]
+            if held is not None and msg["off"] < held:
+                # Sent again because our last ACK never landed; already on disk
+                if msg["end"] > held:
+                    raise ExportError("record %d..%d overlaps the end of %s at %d"
+                                      % (msg["off"], msg["end"], path, held))
+                continue
+            line = {"kiosk": kiosk, "gen": gen, "off": msg["off"], "end": msg["end"]}
+            if msg["type"] == "rec":
+                line["rec"] = msg["rec"]
+                added += 1
+            else:
+                line["mark"] = "skip"
+                print("warning: kiosk skipped unreadable record at %d" % msg["off"],
+                      file=sys.stderr)
+            lines.append(line)
+        elif msg["type"] == "end":
+            break
+        else:
+            raise ExportError("unexpected message %r" % msg)
+
+    if msg["to"] != pos:
+        raise ExportError("batch ends at %d but last record ended at %d" % (msg["to"], pos))
+
+    if lines:
+        with open(path, "a") as f:
+            for line in lines:
+                f.write(json.dumps(line, separators=(",", ":")) + "\n")
+            f.flush()
+            os.fsync(f.fileno())
+
+    port.write(("ACK %d %d\n" % (gen, msg["to"])).encode())
+    ack = read_message(port, timeout)
+    if ack["type"] != "ack":
+        raise ExportError("kiosk rejected ACK: %r" % ack)
+    state[kiosk] = {"gen": gen, "to": msg["to"]}
+    save_state(out_dir, state)
+    return added, msg["more"]
+
+
+def collect(args):
+    import serial  # pyserial
+
+    os.makedirs(args.out, exist_ok=True)
+    state = load_state(args.out)
+    total = 0
+    with serial.Serial(args.port, args.baud, timeout=0.5) as port:
+        time.sleep(0.5)
+        port.reset_input_buffer()
+        while True:
+            n, more = collect_batch(port, args.out, state, args.batch, args.timeout)
+            total += n
+            if not more:
+                break
+    print("collected %d new records" % total)
+
+
+def verify(out_dir):
+    """Check every collected file for duplicate offsets and gaps.
+
+    Within a generation each line must start where the previous one ended;
+    the only holes allowed are the ones covered by a resync or skip mark.
+    """
+    ok = True
+    for name in sorted(os.listdir(out_dir)):
+        if not name.endswith(".ndjson"):
+            continue
+        last_end = {}
+        seen = set()
+        count = 0
+        marks = {"resync": 0, "skip": 0}
+        with open(os.path.join(out_dir, name)) as f:
+            for lineno, line in enumerate(f, 1):
+                r = json.loads(line)
+                key = (r["gen"], r["off"])
+                if key in seen:
+                    print("%s:%d duplicate record gen %d off %d" % (name, lineno, *key))
+                    ok = False
+                seen.add(key)
+                prev = last_end.get(r["gen"])
+                if prev is not None and r["off"] < prev:
+                    print("%s:%d out of order at gen %d off %d" % (name, lineno, *key))
+                    ok = False
+                elif prev is not None and r["off"] > prev:
+                    print("%s:%d gap in gen %d: %d..%d missing" % (name, lineno, r["gen"], prev, r["off"]))
+                    ok = False
+                last_end[r["gen"]] = r["end"]
+                if "mark" in r:
+                    marks[r["mark"]] = marks.get(r["mark"], 0) + 1
+                else:
+                    count += 1
+        print("%s: %d records, %d generation(s), %d resync(s), %d skipped"
+              % (name, count, len(last_end), marks["resync"], marks["skip"]))
+    return ok
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--port", help="serial device of the kiosk")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--out", default="collected")
+    ap.add_argument("--batch", type=int, default=50)
+    ap.add_argument("--timeout", type=float, default=5.0)
+    ap.add_argument("--verify", metavar="DIR", help="check collected data and exit")
+    args = ap.parse_args()
+
+    if args.verify:
+        sys.exit(0 if verify(args.verify) else 1)
+    if not args.port:
+        ap.error("--port is required")
+    try:
+        collect(args)
+    except ExportError as e:
+        print("export aborted: %s" % e, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,541 @@
+// Host checks for the checkup measurement state machine (src/measure_flow.h)
+// and the dashboard's parallel capture (src/parallel_capture.h).
+//
+// Drives MeasureFlow on virtual time with a recording hub link and UI
+// handler and checks the commands it sends and the updates it reports:
+// start, samples and capture, STOP for samples nobody asked for, retries
+// and giving up when the stream goes quiet, switching sensors, the
+// streaming time limit, cancel and capture without a reading.
+//
+// ParallelCapture runs against the hub simulator (default scenario), once
+// with a hub that streams the subscription and once with one that ignores
+// CMD_SUBSCRIBE and has to be polled; every channel must settle and stop()
+// must leave nothing streaming. Dropouts are checked with hand-fed samples.
+//
+// BpCuff (src/bp_cuff.h) takes one run on the simulated cuff to its
+// reading, then hand-fed frames: every way a run fails – over-pressure,
+// BP_MAX_RUN_MS, frames that never start or stop coming, cancel – must
+// send STOP and report the failure, cuff frames with no run going must be
+// answered with STOP, and a BP_DONE whose diastolic is not below systolic
+// is no reading.
+//
+// Each failed check is printed; any failure makes the exit status non-zero.
+//
+//   g++ -O2 -std=gnu++11 -Isrc tools/flow_check.cpp src/measure_flow.cpp src/parallel_capture.cpp
+//       src/bp_cuff.cpp src/simulator.cpp src/hub_protocol.cpp -o flow_check
+//   ./flow_check
+
+#include "measure_flow.h"
+#include "parallel_capture.h"
+#include "bp_cuff.h"
+#include "simulator.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);    \
+            failures++;                                                        \
+        }                                                                      \
+    } while (0)
+
+// Hub link and UI as the flow sees them
+struct Recorder {
+    std::vector<uint8_t> sent;           // every command byte
+    std::vector<MeasureUpdate> updates;
+
+    void clear() {
+        sent.clear();
+        updates.clear();
+    }
+    uint8_t lastCommand() const { return sent.empty() ? 0 : sent.back(); }
+    int lastUpdate() const { return updates.empty() ? -1 : updates.back().kind; }
+    size_t count(uint8_t command) const {
+        size_t n = 0;
+        for (size_t i = 0; i < sent.size(); i++) n += sent[i] == command;
+        return n;
+    }
+};
+
+static void record(const uint8_t* bytes, size_t len, void* ctx) {
+    Recorder* r = (Recorder*)ctx;
+    r->sent.insert(r->sent.end(), bytes, bytes + len);
+}
+
+static void recordUpdate(const MeasureUpdate& u, void* ctx) {
+    ((Recorder*)ctx)->updates.push_back(u);
+}
+
+static void attach(MeasureFlow& f, Recorder& r) {
+    f.setLink(record, &r);
+    f.setHandler(recordUpdate, &r);
+}
+
+/* ==================== CHECKS ==================== */
+static void startSampleCapture() {
+    MeasureFlow f;
+    Recorder r;
+    attach(f, r);
+
+    f.start(HUB_SENSOR_HEIGHT, 0);
+    CHECK(f.state() == MS_WAITING);
+    CHECK(r.sent.size() == 2 && r.sent[0] == CMD_START_STREAM && r.sent[1] == HUB_SENSOR_HEIGHT);
+
+    f.sample(HUB_SENSOR_HEIGHT, 170.5f, 100);
+    CHECK(f.state() == MS_STREAMING);
+    CHECK(r.lastUpdate() == MU_LIVE && f.latest() == 170.5f);
+
+    // A late frame from another sensor's stream is not this reading
+    f.sample(HUB_SENSOR_WEIGHT, 1.0f, 150);
+    CHECK(f.state() == MS_STREAMING && f.latest() == 170.5f);
+
+    f.capture(200);
+    CHECK(f.state() == MS_IDLE);
+    CHECK(f.isDone(HUB_SENSOR_HEIGHT));
+    CHECK(r.lastCommand() == CMD_STOP_STREAM);
+    CHECK(r.lastUpdate() == MU_CAPTURED && r.updates.back().value == 170.5f);
+}
+
+static void strayStop() {
+    MeasureFlow f;
+    Recorder r;
+    attach(f, r);
+    f.start(HUB_SENSOR_HEIGHT, 0);
+    f.sample(HUB_SENSOR_HEIGHT, 170, 100);
+    f.capture(200);
+
+    // Frames in flight right after the STOP are expected
+    size_t stops = r.count(CMD_STOP_STREAM);
+    f.sample(HUB_SENSOR_HEIGHT, 170, 300);
+    CHECK(r.count(CMD_STOP_STREAM) == stops);
+    // Later ones mean the STOP was lost: send it again, rate-limited
+    f.sample(HUB_SENSOR_HEIGHT, 170, 200 + MEASURE_STRAY_STOP_MS);
+    CHECK(r.count(CMD_STOP_STREAM) == stops + 1);
+    f.sample(HUB_SENSOR_HEIGHT, 170, 300 + MEASURE_STRAY_STOP_MS);
+    CHECK(r.count(CMD_STOP_STREAM) == stops + 1);
+    CHECK(f.state() == MS_IDLE);
+}
+
+static void retriesThenNoData() {
+    MeasureFlow f;
+    Recorder r;
+    attach(f, r);
+    uint32_t t = 1000;
+    f.start(HUB_SENSOR_WEIGHT, t);
+    f.tick(t + MEASURE_FIRST_SAMPLE_MS - 1);
+    CHECK(f.retriesSent == 0);
+
+    for (uint32_t i = 1; i <= MEASURE_RETRIES; i++) {
+        t += MEASURE_FIRST_SAMPLE_MS;
+        f.tick(t);
+        CHECK(f.retriesSent == i && f.state() == MS_WAITING);
+        CHECK(r.lastUpdate() == MU_RETRY);
+    }
+    CHECK(r.count(CMD_START_STREAM) == 1 + MEASURE_RETRIES);
+
+    t += MEASURE_FIRST_SAMPLE_MS;
+    f.tick(t);
+    CHECK(f.state() == MS_IDLE);
+    CHECK(r.lastUpdate() == MU_NO_DATA && r.lastCommand() == CMD_STOP_STREAM);
+    CHECK(!f.isDone(HUB_SENSOR_WEIGHT));
+}
+
+static void quietStreamRetries() {
+    MeasureFlow f;
+    Recorder r;
+    attach(f, r);
+    f.start(HUB_SENSOR_TEMP, 0);
+    f.sample(HUB_SENSOR_TEMP, 36.6f, 500);
+    f.tick(500 + MEASURE_SAMPLE_GAP_MS);
+    CHECK(f.state() == MS_WAITING && f.retriesSent == 1);
+    // A sample resets the retry count and the reading is still there
+    f.sample(HUB_SENSOR_TEMP, 36.7f, 3000);
+    CHECK(f.state() == MS_STREAMING);
+    f.capture(3100);
+    CHECK(f.isDone(HUB_SENSOR_TEMP) && r.updates.back().value == 36.7f);
+}
+
+static void switchSensor() {
+    MeasureFlow f;
+    Recorder r;
+    attach(f, r);
+    f.start(HUB_SENSOR_TEMP, 0);
+    r.clear();
+    // One stream at a time: the old one is stopped before the new START
+    f.start(HUB_SENSOR_PULSE, 100);
+    CHECK(r.sent.size() == 3 && r.sent[0] == CMD_STOP_STREAM && r.sent[1] == CMD_START_STREAM &&
+          r.sent[2] == HUB_SENSOR_PULSE);
+    CHECK(f.sensor() == HUB_SENSOR_PULSE && f.state() == MS_WAITING);
+    CHECK(r.updates.size() == 1 && r.updates[0].kind == MU_STOPPED && r.updates[0].sensor == HUB_SENSOR_TEMP);
+}
+
+static void expires() {
+    MeasureFlow f;
+    Recorder r;
+    attach(f, r);
+    f.start(HUB_SENSOR_PULSE, 0);
+    uint32_t t = 0;
+    for (; t < MEASURE_MAX_STREAM_MS + 1000 && f.streaming(); t += 500) {
+        f.sample(HUB_SENSOR_PULSE, 72, t);
+        f.tick(t);
+    }
+    CHECK(!f.streaming());
+    CHECK(t > MEASURE_MAX_STREAM_MS && t <= MEASURE_MAX_STREAM_MS + 500);
+    CHECK(r.lastUpdate() == MU_EXPIRED && r.lastCommand() == CMD_STOP_STREAM);
+    CHECK(!f.isDone(HUB_SENSOR_PULSE));
+}
+
+static void cancelAndNoReading() {
+    MeasureFlow f;
+    Recorder r;
+    attach(f, r);
+    f.start(HUB_SENSOR_TEMP, 0);
+    f.cancel(10);
+    CHECK(f.state() == MS_IDLE && r.lastCommand() == CMD_STOP_STREAM && r.lastUpdate() == MU_STOPPED);
+
+    // Cancel while idle sends nothing
+    size_t sent = r.sent.size();
+    f.cancel(20);
+    CHECK(r.sent.size() == sent);
+
+    f.start(HUB_SENSOR_TEMP, 100);
+    f.capture(110);
+    CHECK(f.state() == MS_IDLE && r.lastUpdate() == MU_NO_READING);
+    CHECK(r.lastCommand() == CMD_STOP_STREAM && !f.isDone(HUB_SENSOR_TEMP));
+
+    // Sensors outside the hub's range are refused
+    sent = r.sent.size();
+    f.start(0, 200);
+    f.start(HUB_SENSOR_PULSE + 1, 200);
+    CHECK(f.state() == MS_IDLE && r.sent.size() == sent);
+}
+
+static void steps() {
+    MeasureFlow f;
+    f.markDone(MEASURE_STEP_BP);
+    f.markDone(MEASURE_STEPS);   // out of range, ignored
+    CHECK(f.isDone(MEASURE_STEP_BP) && !f.isDone(MEASURE_STEPS));
+    bool flags[MEASURE_STEPS] = {false, true, false, true, false};
+    f.restore(flags);
+    CHECK(!f.isDone(MEASURE_STEP_BP) && f.isDone(HUB_SENSOR_HEIGHT) && f.isDone(HUB_SENSOR_TEMP));
+    f.reset(0);
+    for (uint8_t s = 0; s < MEASURE_STEPS; s++) CHECK(!f.isDone(s));
+}
+
+/* ==================== PARALLEL CAPTURE ==================== */
+#define PARALLEL_SETTLE_MS 30000   // generous; the default scenario settles in well under this
+
+struct HubRun {
+    SimEngine engine;
+    FrameDecoder decoder;
+    ParallelCapture capture;
+    bool legacy;   // hub without CMD_SUBSCRIBE
+};
+
+static void hubSend(const uint8_t* bytes, size_t len, void* ctx) {
+    HubRun& h = *(HubRun*)ctx;
+    if (h.legacy && bytes[0] == CMD_SUBSCRIBE) return;
+    h.engine.command(bytes, len);
+}
+
+static void hubFrame(const HubFrame& frame, void* ctx) {
+    HubRun& h = *(HubRun*)ctx;
+    if (frame.type == FRAME_DATA) h.capture.feed(frame.data, h.engine.now());
+    else if (frame.type == FRAME_STREAM) h.capture.feedSample(frame.sample.sensor, frame.sample.value, h.engine.now());
+}
+
+static void hubSink(const uint8_t* bytes, size_t len, void* ctx) {
+    HubRun& h = *(HubRun*)ctx;
+    for (size_t i = 0; i < len; i++) h.decoder.push(bytes[i], hubFrame, &h);
+}
+
+static void settles(bool legacy) {
+    static HubRun h;
+    h = HubRun();
+    h.legacy = legacy;
+    SimScenario scenario;
+    simDefaultScenario(scenario);
+    h.engine.begin(scenario);
+    h.capture.setLink(hubSend, &h);
+    h.capture.begin(h.engine.now());
+    CHECK(h.capture.active() && h.capture.takeChanged());
+
+    while (h.engine.now() < PARALLEL_SETTLE_MS && !h.capture.allStable()) {
+        h.engine.advance(10, hubSink, &h);
+        h.capture.tick(h.engine.now());
+    }
+    CHECK(h.capture.allStable());
+    CHECK(h.capture.mode() == (legacy ? PM_POLL : PM_STREAM));
+    if (legacy) CHECK(h.capture.polls > 0 && h.capture.samples == 0);
+    else CHECK(h.capture.polls == 0 && h.capture.samples > 0);
+    for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+        const ParallelChannel& c = h.capture.channel(s);
+        CHECK(c.spread <= c.tolerance && c.value > 0);
+    }
+
+    h.capture.stop();
+    CHECK(!h.capture.active() && h.engine.streaming() == 0);
+    // Frames still in flight are left to the caller once stopped
+    SensorData data = SensorData();
+    CHECK(!h.capture.feed(data, h.engine.now()) && !h.capture.feedSample(HUB_SENSOR_HEIGHT, 170, h.engine.now()));
+}
+
+static void dropouts() {
+    ParallelCapture p;
+    Recorder r;
+    p.setLink(record, &r);
+    p.begin(0);
+    CHECK(r.sent.size() == SUBSCRIBE_CMD_LEN && r.sent[0] == CMD_SUBSCRIBE);
+
+    uint32_t t = 0;
+    for (int i = 0; i < PARALLEL_WINDOW_MAX; i++, t += 100) p.feedSample(HUB_SENSOR_WEIGHT, 70.0f, t);
+    CHECK(p.channel(HUB_SENSOR_WEIGHT).state == PC_STABLE && p.channel(HUB_SENSOR_WEIGHT).value == 70.0f);
+
+    // Stepping off the scale: the hub reports zero and the window starts over
+    p.feedSample(HUB_SENSOR_WEIGHT, 0, t);
+    CHECK(p.channel(HUB_SENSOR_WEIGHT).state == PC_ABSENT && p.channel(HUB_SENSOR_WEIGHT).count == 0);
+    p.feedSample(HUB_SENSOR_WEIGHT, 71.0f, t += 100);
+    CHECK(p.channel(HUB_SENSOR_WEIGHT).state == PC_SETTLING);
+
+    // A reading outside the tolerance keeps the channel settling
+    for (int i = 0; i < PARALLEL_WINDOW_MAX; i++, t += 100) p.feedSample(HUB_SENSOR_WEIGHT, i & 1 ? 71.0f : 72.0f, t);
+    CHECK(p.channel(HUB_SENSOR_WEIGHT).state == PC_SETTLING);
+
+    // A channel that goes quiet is no longer ready
+    p.tick(t + PARALLEL_QUIET_MS);
+    CHECK(p.channel(HUB_SENSOR_WEIGHT).state == PC_ABSENT);
+    CHECK(p.mode() == PM_STREAM);   // samples arrived, so no fallback to polling
+}
+
+/* ==================== BP CUFF ==================== */
+// The result handler's calls
+struct BpResults {
+    std::vector<BpReading> readings;
+    std::vector<const char*> failures;   // NULL for a reading
+
+    size_t count() const { return failures.size(); }
+    bool lastFailed(const char* why) const {
+        return !failures.empty() && failures.back() && !strcmp(failures.back(), why);
+    }
+};
+
+static void bpResult(const BpReading& result, const char* failure, void* ctx) {
+    BpResults* r = (BpResults*)ctx;
+    r->readings.push_back(result);
+    r->failures.push_back(failure);
+}
+
+static BpReading bpFrame(uint8_t phase, float cuff, float osc = 0) {
+    BpReading f = BpReading();
+    f.phase = phase;
+    f.cuffMmHg = cuff;
+    f.oscMmHg = osc;
+    return f;
+}
+
+static void attachCuff(BpCuff& c, Recorder& r, BpResults& results) {
+    c.setLink(record, &r);
+    c.setHandler(bpResult, &results);
+}
+
+struct CuffRun {
+    SimEngine engine;
+    FrameDecoder decoder;
+    BpCuff cuff;
+};
+
+static void cuffSend(const uint8_t* bytes, size_t len, void* ctx) {
+    ((CuffRun*)ctx)->engine.command(bytes, len);
+}
+
+static void cuffFrame(const HubFrame& frame, void* ctx) {
+    CuffRun& h = *(CuffRun*)ctx;
+    if (frame.type == FRAME_BP) h.cuff.frame(frame.bp, h.engine.now());
+}
+
+static void cuffSink(const uint8_t* bytes, size_t len, void* ctx) {
+    CuffRun& h = *(CuffRun*)ctx;
+    for (size_t i = 0; i < len; i++) h.decoder.push(bytes[i], cuffFrame, &h);
+}
+
+static void cuffReading() {
+    static CuffRun h;
+    h = CuffRun();
+    BpResults results;
+    SimScenario scenario;
+    simDefaultScenario(scenario);
+    h.engine.begin(scenario);
+    h.cuff.setLink(cuffSend, &h);
+    h.cuff.setHandler(bpResult, &results);
+
+    h.cuff.start(h.engine.now());
+    CHECK(h.cuff.state() == BPC_WAITING && h.engine.cuffRunning());
+    bool mapShown = false;
+    while (h.cuff.running() && h.engine.now() < BP_MAX_RUN_MS) {
+        h.engine.advance(50, cuffSink, &h);
+        h.cuff.tick(h.engine.now());
+        if (h.cuff.mapEstimate() > 0) mapShown = true;
+    }
+    CHECK(h.cuff.state() == BPC_DONE && !h.engine.cuffRunning());
+    CHECK(results.count() == 1 && results.failures[0] == NULL);
+    const BpReading& r = results.readings[0];
+    CHECK(std::fabs(r.sys - scenario.bp_sys) <= 5 && std::fabs(r.dia - scenario.bp_dia) <= 5 && r.dia < r.sys);
+    CHECK(mapShown);
+}
+
+static void cuffOverPressure() {
+    BpCuff c;
+    Recorder r;
+    BpResults results;
+    attachCuff(c, r, results);
+    c.start(0);
+    CHECK(r.sent.size() == 1 && r.sent[0] == CMD_START_BP);
+
+    c.frame(bpFrame(BP_INFLATING, 150), 100);
+    CHECK(c.state() == BPC_INFLATING && r.count(CMD_STOP_STREAM) == 0);
+    c.frame(bpFrame(BP_INFLATING, BP_MAX_CUFF_MMHG + 1), 200);
+    CHECK(r.lastCommand() == CMD_STOP_STREAM);
+    CHECK(c.state() == BPC_FAILED && results.lastFailed("Cuff over-pressure"));
+    CHECK(!strcmp(c.failure(), "Cuff over-pressure"));
+}
+
+static void cuffMaxRun() {
+    BpCuff c;
+    Recorder r;
+    BpResults results;
+    attachCuff(c, r, results);
+    c.start(0);
+    // A hub that keeps reporting and never finishes
+    uint32_t t = 0;
+    for (; t < BP_MAX_RUN_MS - 500; t += 500) {
+        c.frame(bpFrame(BP_DEFLATING, 100, 1), t);
+        c.tick(t);
+    }
+    CHECK(c.running() && r.count(CMD_STOP_STREAM) == 0);
+    c.frame(bpFrame(BP_DEFLATING, 100, 1), BP_MAX_RUN_MS);
+    c.tick(BP_MAX_RUN_MS);
+    CHECK(r.lastCommand() == CMD_STOP_STREAM);
+    CHECK(c.state() == BPC_FAILED && results.lastFailed("Timed out"));
+}
+
+static void cuffFramesStop() {
+    BpCuff c;
+    Recorder r;
+    BpResults results;
+    attachCuff(c, r, results);
+
+    // Never answered
+    c.start(0);
+    c.tick(BP_FIRST_FRAME_MS - 1);
+    CHECK(c.running() && r.count(CMD_STOP_STREAM) == 0);
+    c.tick(BP_FIRST_FRAME_MS);
+    CHECK(r.lastCommand() == CMD_STOP_STREAM);
+    CHECK(c.state() == BPC_FAILED && results.lastFailed("Cuff not responding"));
+
+    // Stopped mid-run
+    r.clear();
+    c.start(10000);
+    c.frame(bpFrame(BP_INFLATING, 80), 10500);
+    c.frame(bpFrame(BP_DEFLATING, 160, 0.5f), 11000);
+    c.tick(11000 + BP_FRAME_GAP_MS - 1);
+    CHECK(c.running() && r.count(CMD_STOP_STREAM) == 0);
+    c.tick(11000 + BP_FRAME_GAP_MS);
+    CHECK(r.lastCommand() == CMD_STOP_STREAM);
+    CHECK(c.state() == BPC_FAILED && results.lastFailed("Cuff stopped reporting"));
+    CHECK(results.count() == 2);
+}
+
+static void cuffCancel() {
+    BpCuff c;
+    Recorder r;
+    BpResults results;
+    attachCuff(c, r, results);
+    c.cancel(0);   // nothing running: nothing to vent
+    CHECK(r.sent.empty());
+
+    c.start(0);
+    c.frame(bpFrame(BP_INFLATING, 120), 500);
+    c.cancel(600);
+    CHECK(r.lastCommand() == CMD_STOP_STREAM && r.count(CMD_STOP_STREAM) == 1);
+    CHECK(c.state() == BPC_IDLE && !c.running() && c.failure() == NULL);
+    c.tick(600 + BP_MAX_RUN_MS);
+    CHECK(results.count() == 0);   // cancelled, not failed
+}
+
+static void cuffStrayRun() {
+    BpCuff c;
+    Recorder r;
+    BpResults results;
+    attachCuff(c, r, results);
+
+    // A run the kiosk didn't start (it restarted mid-run)
+    c.frame(bpFrame(BP_INFLATING, 90), 0);
+    CHECK(r.sent.size() == 1 && r.lastCommand() == CMD_STOP_STREAM);
+    c.frame(bpFrame(BP_DEFLATING, 140), BP_STRAY_STOP_MS - 1);
+    CHECK(r.count(CMD_STOP_STREAM) == 1);   // not every frame
+    c.frame(bpFrame(BP_DEFLATING, 130), BP_STRAY_STOP_MS);
+    CHECK(r.count(CMD_STOP_STREAM) == 2);   // still going: again
+    c.frame(bpFrame(BP_DONE, 0), 5 * BP_STRAY_STOP_MS);
+    CHECK(r.count(CMD_STOP_STREAM) == 2);   // finished runs are left alone
+    CHECK(c.state() == BPC_IDLE && results.count() == 0);
+
+    // Frames after a failed run are stray too
+    c.start(10000);
+    c.frame(bpFrame(BP_INFLATING, BP_MAX_CUFF_MMHG + 5), 10100);
+    size_t stops = r.count(CMD_STOP_STREAM);
+    c.frame(bpFrame(BP_INFLATING, BP_MAX_CUFF_MMHG + 6), 10100 + BP_STRAY_STOP_MS);
+    CHECK(r.count(CMD_STOP_STREAM) == stops + 1);
+}
+
+static void cuffInvalidDone() {
+    BpCuff c;
+    Recorder r;
+    BpResults results;
+    attachCuff(c, r, results);
+
+    const uint16_t readings[][2] = {{120, 120}, {110, 125}, {0, 80}, {120, 0}};
+    for (size_t i = 0; i < sizeof(readings) / sizeof(readings[0]); i++) {
+        c.start(i * 1000);
+        BpReading done = bpFrame(BP_DONE, 0);
+        done.sys = readings[i][0];
+        done.dia = readings[i][1];
+        c.frame(done, i * 1000 + 500);
+        CHECK(c.state() == BPC_FAILED && results.lastFailed("No valid reading"));
+    }
+    c.start(9000);
+    BpReading done = bpFrame(BP_DONE, 0);
+    done.sys = 121;
+    done.dia = 79;
+    c.frame(done, 9500);
+    CHECK(c.state() == BPC_DONE && results.failures.back() == NULL && results.readings.back().sys == 121);
+    CHECK(r.count(CMD_STOP_STREAM) == 0);   // the hub vents after BP_DONE itself
+}
+
+int main() {
+    startSampleCapture();
+    strayStop();
+    retriesThenNoData();
+    quietStreamRetries();
+    switchSensor();
+    expires();
+    cancelAndNoReading();
+    steps();
+    settles(false);
+    settles(true);
+    dropouts();
+    cuffReading();
+    cuffOverPressure();
+    cuffMaxRun();
+    cuffFramesStop();
+    cuffCancel();
+    cuffStrayRun();
+    cuffInvalidDone();
+
+    printf("flow_check: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
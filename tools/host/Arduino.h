@@ -0,0 +1,124 @@
+// Host stand-in for the parts of the Arduino core that the portable
+// firmware modules use, so tools/ programs can build them with g++.
+// Not a port: String keeps Arduino's interface for what the modules call,
+// Serial prints to hostSerialOut() (stdout unless a program captures it),
+// the clocks run from program start and the pins do nothing.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+using std::min;   // the ESP32 core does the same
+using std::max;
+
+class String {
+public:
+    String(const char* c = "") : s(c ? c : "") {}
+    String(const std::string& x) : s(x) {}
+    explicit String(char c) : s(1, c) {}
+    String(int v) : s(std::to_string(v)) {}
+    String(unsigned v) : s(std::to_string(v)) {}
+    String(long v) : s(std::to_string(v)) {}
+    String(unsigned long v) : s(std::to_string(v)) {}
+    String(float v, unsigned decimals = 2) { fixed(v, decimals); }
+    String(double v, unsigned decimals = 2) { fixed(v, decimals); }
+
+    String& operator+=(const String& o) { s += o.s; return *this; }
+    String& operator+=(const char* o) { s += o; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    bool operator==(const String& o) const { return s == o.s; }
+    bool operator==(const char* o) const { return s == o; }
+    bool operator!=(const String& o) const { return s != o.s; }
+    bool operator!=(const char* o) const { return s != o; }
+    char operator[](unsigned i) const { return s[i]; }
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned length() const { return s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    bool reserve(unsigned n) { s.reserve(n); return true; }
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return atof(s.c_str()); }
+
+    std::string s;
+
+private:
+    void fixed(double v, unsigned decimals) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        s = buf;
+    }
+};
+inline String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+inline String operator+(const String& a, const char* b) { return String(a.s + b); }
+inline String operator+(const char* a, const String& b) { return String(a + b.s); }
+
+inline FILE*& hostSerialOut() {
+    static FILE* out = stdout;
+    return out;
+}
+
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    size_t print(const char* t) { return fputs(t, hostSerialOut()); }
+    size_t print(const String& t) { return print(t.c_str()); }
+    size_t println(const char* t = "") { return printf("%s\n", t); }
+    size_t println(const String& t) { return println(t.c_str()); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vfprintf(hostSerialOut(), fmt, ap);
+        va_end(ap);
+        return n < 0 ? 0 : n;
+    }
+};
+static HostSerial Serial __attribute__((unused));
+
+inline uint64_t hostMicros() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+inline unsigned long micros() { return (unsigned long)hostMicros(); }
+inline unsigned long millis() { return (unsigned long)(hostMicros() / 1000); }
+
+// The ESP32's newlib has it; glibc only from 2.38
+#if defined(__GLIBC__) && (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+inline size_t strlcpy(char* dst, const char* src, size_t cap) {
+    size_t len = strlen(src);
+    if (cap) {
+        size_t n = len < cap - 1 ? len : cap - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+inline void delay(uint32_t) {}   // nothing to wait for on the host
+
+#define OUTPUT 0x03
+#define HIGH   0x1
+#define LOW    0x0
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+class EspClass {
+public:
+    uint64_t getEfuseMac() { return 0x0000A1B2C3D4E5F6ULL; }
+};
+static EspClass ESP __attribute__((unused));
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#endif // HOST_ARDUINO_H
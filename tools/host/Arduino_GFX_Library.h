@@ -0,0 +1,3 @@
+// Host stand-in: display.h only names these types
+class Arduino_ESP32RGBPanel;
+class Arduino_RGB_Display;
@@ -0,0 +1,95 @@
+// Host stand-in for the Arduino FS File, backed by a directory on the host
+// (hostSdRoot(), see SD.h): files are stdio streams, directories a sorted
+// listing that openNextFile() walks. Only what src/storage.cpp calls.
+
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <Arduino.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+// Host directory that stands for the card's root
+inline std::string& hostSdRoot() {
+    static std::string root = ".";
+    return root;
+}
+
+class File;
+inline File hostFsOpen(const char* path, const char* mode);
+
+class File {
+public:
+    File() : isDir(false), nextEntry(0) {}
+
+    explicit operator bool() const { return f || isDir; }
+    void close() {
+        f.reset();
+        isDir = false;
+    }
+    const char* name() const { return path.c_str(); }
+    bool isDirectory() const { return isDir; }
+
+    size_t size() {
+        if (!f) return 0;
+        long at = ftell(f.get());
+        fseek(f.get(), 0, SEEK_END);
+        long end = ftell(f.get());
+        fseek(f.get(), at, SEEK_SET);
+        return end;
+    }
+    size_t position() { return f ? ftell(f.get()) : 0; }
+    bool seek(uint32_t pos) { return f && fseek(f.get(), pos, SEEK_SET) == 0; }
+    int available() { return (int)(size() - position()); }
+
+    int read() {
+        int c = f ? fgetc(f.get()) : EOF;
+        return c == EOF ? -1 : c;
+    }
+    size_t read(uint8_t* buf, size_t n) { return f ? fread(buf, 1, n, f.get()) : 0; }
+    size_t write(const uint8_t* buf, size_t n) { return f ? fwrite(buf, 1, n, f.get()) : 0; }
+
+    File openNextFile() {
+        if (!isDir || nextEntry >= entries.size()) return File();
+        return hostFsOpen(entries[nextEntry++].c_str(), FILE_READ);
+    }
+
+private:
+    friend File hostFsOpen(const char* path, const char* mode);
+
+    std::shared_ptr<FILE> f;
+    std::string path;
+    bool isDir;
+    std::vector<std::string> entries;   // card paths, sorted
+    size_t nextEntry;
+};
+
+inline File hostFsOpen(const char* path, const char* mode) {
+    File file;
+    file.path = path;
+    std::string host = hostSdRoot() + path;
+    struct stat st;
+    if (stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(host.c_str());
+        if (!dir) return File();
+        while (struct dirent* e = readdir(dir)) {
+            if (e->d_name[0] != '.') file.entries.push_back(std::string(path) + "/" + e->d_name);
+        }
+        closedir(dir);
+        std::sort(file.entries.begin(), file.entries.end());
+        file.isDir = true;
+        return file;
+    }
+    FILE* f = fopen(host.c_str(), mode[0] == 'r' ? "rb" : mode[0] == 'w' ? "wb" : "ab");
+    if (f) file.f = std::shared_ptr<FILE>(f, fclose);
+    return file;
+}
+
+#endif // HOST_FS_H
@@ -0,0 +1,34 @@
+// Host stand-in for the ESP32 Preferences (NVS) library: one in-memory map
+// shared by every namespace, empty at program start.
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+class Preferences {
+public:
+    bool begin(const char*, bool = false) { return true; }
+    size_t putUInt(const char* key, uint32_t v) { return put(key, v, 4); }
+    uint32_t getUInt(const char* key, uint32_t def = 0) { return (uint32_t)get(key, def); }
+    size_t putULong64(const char* key, uint64_t v) { return put(key, v, 8); }
+    uint64_t getULong64(const char* key, uint64_t def = 0) { return get(key, def); }
+
+private:
+    static std::map<std::string, uint64_t>& store() {
+        static std::map<std::string, uint64_t> kv;
+        return kv;
+    }
+    size_t put(const char* key, uint64_t v, size_t n) {
+        store()[key] = v;
+        return n;
+    }
+    uint64_t get(const char* key, uint64_t def) {
+        std::map<std::string, uint64_t>::const_iterator it = store().find(key);
+        return it == store().end() ? def : it->second;
+    }
+};
+
+#endif // HOST_PREFERENCES_H
@@ -0,0 +1,32 @@
+// Host stand-in for the SD library: the card is the directory named by
+// hostSdRoot() (FS.h), which a program sets before mounting the store.
+
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+#include "FS.h"
+#include <stdio.h>
+
+enum { CARD_NONE, CARD_MMC, CARD_SD, CARD_SDHC };
+
+class SDFS {
+public:
+    bool begin(uint8_t) { return true; }
+    uint8_t cardType() { return CARD_SDHC; }
+    uint64_t cardSize() { return 1ULL << 30; }
+
+    File open(const char* path, const char* mode = FILE_READ) { return hostFsOpen(path, mode); }
+    bool exists(const char* path) {
+        struct stat st;
+        return stat(host(path).c_str(), &st) == 0;
+    }
+    bool remove(const char* path) { return ::remove(host(path).c_str()) == 0; }
+    bool rename(const char* from, const char* to) { return ::rename(host(from).c_str(), host(to).c_str()) == 0; }
+    bool mkdir(const char* path) { return ::mkdir(host(path).c_str(), 0755) == 0; }
+
+private:
+    static std::string host(const char* path) { return hostSdRoot() + path; }
+};
+static SDFS SD __attribute__((unused));
+
+#endif // HOST_SD_H
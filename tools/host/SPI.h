@@ -0,0 +1,14 @@
+// Host stand-in: the SD card's SPI bus has nothing to set up
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <stdint.h>
+
+class SPIClass {
+public:
+    void begin(int8_t, int8_t, int8_t, int8_t = -1) {}
+};
+static SPIClass SPI __attribute__((unused));
+
+#endif // HOST_SPI_H
@@ -0,0 +1,2 @@
+// Host stand-in: display.h only names this type
+class TAMC_GT911;
@@ -0,0 +1,195 @@
+// Host stand-in for the few LVGL calls the portable UI modules make
+// (toast.cpp), so tools/ programs can drive them with g++. Nothing is
+// drawn: objects are records of what was asked for – parent, flags,
+// position, label text, pending fade and delete – and lv_timer_handler()
+// runs due timers and delayed deletes against a tick the program sets
+// with hostLvTick().
+
+#ifndef HOST_LVGL_H
+#define HOST_LVGL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+struct lv_obj_t;
+struct lv_timer_t;
+struct lv_event_t;
+
+typedef void (*lv_event_cb_t)(lv_event_t* e);
+typedef void (*lv_timer_cb_t)(lv_timer_t* t);
+
+enum lv_obj_flag_t { LV_OBJ_FLAG_HIDDEN = 1, LV_OBJ_FLAG_CLICKABLE = 2, LV_OBJ_FLAG_SCROLLABLE = 4 };
+enum lv_event_code_t { LV_EVENT_ALL, LV_EVENT_CLICKED };
+enum lv_align_t { LV_ALIGN_DEFAULT, LV_ALIGN_TOP_MID, LV_ALIGN_CENTER };
+
+struct lv_color_t {
+    uint32_t hex;
+};
+struct lv_font_t {
+    int size;
+};
+static const lv_font_t lv_font_montserrat_14 = {14};
+
+struct lv_obj_t {
+    lv_obj_t* parent;
+    uint32_t flags;
+    int32_t y;            // from lv_obj_align
+    uint32_t bgColor;
+    std::string text;     // labels
+    lv_event_cb_t eventCb;
+    lv_event_code_t eventCode;
+    bool fadingOut;
+    bool deletePending;
+    uint32_t deleteAt;    // tick
+};
+
+struct lv_timer_t {
+    lv_timer_cb_t cb;
+    uint32_t period;
+    uint32_t lastRun;
+    bool paused;
+    void* user_data;
+};
+
+struct lv_event_t {
+    lv_obj_t* target;
+    lv_event_code_t code;
+};
+
+/* ==================== HOST STATE ==================== */
+struct HostLvgl {
+    uint32_t tick;
+    lv_obj_t top;
+    std::vector<lv_obj_t*> objects;   // live, in creation order
+    std::vector<lv_timer_t*> timers;
+};
+
+inline HostLvgl& hostLv() {
+    static HostLvgl lv = HostLvgl();
+    return lv;
+}
+
+inline void hostLvTick(uint32_t ms) { hostLv().tick = ms; }
+
+// Live children of `parent`, oldest first
+inline std::vector<lv_obj_t*> hostLvChildren(const lv_obj_t* parent) {
+    std::vector<lv_obj_t*> out;
+    for (size_t i = 0; i < hostLv().objects.size(); i++) {
+        if (hostLv().objects[i]->parent == parent) out.push_back(hostLv().objects[i]);
+    }
+    return out;
+}
+
+// Sends LV_EVENT_CLICKED the way a tap would; false if the object ignores taps
+inline bool hostLvClick(lv_obj_t* obj) {
+    if (!(obj->flags & LV_OBJ_FLAG_CLICKABLE) || !obj->eventCb) return false;
+    if (obj->eventCode != LV_EVENT_CLICKED && obj->eventCode != LV_EVENT_ALL) return false;
+    lv_event_t e = {obj, LV_EVENT_CLICKED};
+    obj->eventCb(&e);
+    return true;
+}
+
+/* ==================== OBJECTS ==================== */
+inline lv_obj_t* lv_layer_top() { return &hostLv().top; }
+
+inline lv_obj_t* lv_obj_create(lv_obj_t* parent) {
+    lv_obj_t* obj = new lv_obj_t();
+    obj->parent = parent;
+    obj->flags = LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE;
+    hostLv().objects.push_back(obj);
+    return obj;
+}
+
+inline lv_obj_t* lv_label_create(lv_obj_t* parent) {
+    lv_obj_t* obj = lv_obj_create(parent);
+    obj->flags = 0;
+    return obj;
+}
+
+inline void lv_obj_delete(lv_obj_t* obj) {
+    std::vector<lv_obj_t*> children = hostLvChildren(obj);
+    for (size_t i = 0; i < children.size(); i++) lv_obj_delete(children[i]);
+    std::vector<lv_obj_t*>& all = hostLv().objects;
+    for (size_t i = 0; i < all.size(); i++) {
+        if (all[i] == obj) {
+            all.erase(all.begin() + i);
+            break;
+        }
+    }
+    delete obj;
+}
+
+inline void lv_obj_delete_delayed(lv_obj_t* obj, uint32_t ms) {
+    obj->deletePending = true;
+    obj->deleteAt = hostLv().tick + ms;
+}
+
+inline void lv_obj_add_flag(lv_obj_t* obj, lv_obj_flag_t f) { obj->flags |= f; }
+inline void lv_obj_clear_flag(lv_obj_t* obj, lv_obj_flag_t f) { obj->flags &= ~(uint32_t)f; }
+inline void lv_obj_align(lv_obj_t* obj, lv_align_t, int32_t, int32_t y) { obj->y = y; }
+inline void lv_obj_center(lv_obj_t*) {}
+inline void lv_obj_set_size(lv_obj_t*, int32_t, int32_t) {}
+inline void lv_obj_fade_in(lv_obj_t* obj, uint32_t, uint32_t) { obj->fadingOut = false; }
+inline void lv_obj_fade_out(lv_obj_t* obj, uint32_t, uint32_t) { obj->fadingOut = true; }
+
+inline lv_color_t lv_color_hex(uint32_t c) {
+    lv_color_t color = {c};
+    return color;
+}
+inline void lv_obj_set_style_bg_color(lv_obj_t* obj, lv_color_t c, uint32_t) { obj->bgColor = c.hex; }
+inline void lv_obj_set_style_text_color(lv_obj_t*, lv_color_t, uint32_t) {}
+inline void lv_obj_set_style_text_font(lv_obj_t*, const lv_font_t*, uint32_t) {}
+inline void lv_obj_set_style_radius(lv_obj_t*, int32_t, uint32_t) {}
+inline void lv_obj_set_style_border_width(lv_obj_t*, int32_t, uint32_t) {}
+
+inline void lv_label_set_text(lv_obj_t* obj, const char* text) { obj->text = text; }
+
+/* ==================== EVENTS ==================== */
+inline void lv_obj_add_event_cb(lv_obj_t* obj, lv_event_cb_t cb, lv_event_code_t code, void*) {
+    obj->eventCb = cb;
+    obj->eventCode = code;
+}
+
+inline void* lv_event_get_current_target(lv_event_t* e) { return e->target; }
+
+/* ==================== TIMERS ==================== */
+inline uint32_t lv_tick_get() { return hostLv().tick; }
+
+inline lv_timer_t* lv_timer_create(lv_timer_cb_t cb, uint32_t period, void* user_data) {
+    lv_timer_t* t = new lv_timer_t();
+    t->cb = cb;
+    t->period = period;
+    t->lastRun = hostLv().tick;
+    t->user_data = user_data;
+    hostLv().timers.push_back(t);
+    return t;
+}
+
+inline void lv_timer_pause(lv_timer_t* t) { t->paused = true; }
+inline void lv_timer_resume(lv_timer_t* t) { t->paused = false; }
+inline void lv_timer_ready(lv_timer_t* t) { t->lastRun = hostLv().tick - t->period; }
+
+// Due timers, then delayed deletes whose time has come
+inline uint32_t lv_timer_handler() {
+    HostLvgl& lv = hostLv();
+    for (size_t i = 0; i < lv.timers.size(); i++) {
+        lv_timer_t* t = lv.timers[i];
+        if (t->paused || lv.tick - t->lastRun < t->period) continue;
+        t->lastRun = lv.tick;
+        t->cb(t);
+    }
+    for (size_t i = 0; i < lv.objects.size();) {
+        lv_obj_t* obj = lv.objects[i];
+        if (obj->deletePending && (int32_t)(lv.tick - obj->deleteAt) >= 0) {
+            lv_obj_delete(obj);
+            i = 0;   // children went with it
+        } else {
+            i++;
+        }
+    }
+    return 1;
+}
+
+#endif // HOST_LVGL_H
@@ -0,0 +1,286 @@
+// Sensor hub stand-in for host integration and soak tests.
+//
+// Speaks the kiosk's hub protocol (src/hub_protocol.h) on a pseudo-terminal
+// or a real serial device, with readings generated by the sensor simulator
+// (src/simulator.h) on the wall clock. The link can be made deliberately
+// bad: command latency and jitter, output paced to a baud rate, and
+// corrupted, dropped or stray bytes.
+//
+//   g++ -O2 -std=gnu++11 -Isrc tools/hub_emulator.cpp src/simulator.cpp src/hub_protocol.cpp -o hub_emulator
+//   ./hub_emulator --scenario tools/scenarios/restless_child.sim --latency-ms 40 --corrupt 0.0005
+//       -> prints the pty path; open it as the hub UART (115200 8N1, raw)
+//   ./hub_emulator --device /dev/ttyUSB0 --baud 115200
+//       -> drive a kiosk's UART pins through a USB serial adapter
+//
+// Options:
+//   --scenario FILE   scenario to simulate (built-in default otherwise)
+//   --device PATH     use a serial device instead of a new pty
+//   --baud N          pace output to N baud, 10 bits per byte (default 115200, 0 = unpaced)
+//   --latency-ms N    delay before a command takes effect (default 5)
+//   --jitter-ms N     extra random delay, 0..N ms (default 0)
+//   --corrupt P       flip one bit of an output byte with probability P
+//   --drop P          drop an output byte with probability P
+//   --garbage P       insert a random byte before an output byte with probability P
+//   --stats S         print counters every S seconds (default 10)
+
+#include "simulator.h"
+#include "hub_protocol.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define OUT_QUEUE_MAX 65536
+
+struct Options {
+    const char* scenario = NULL;
+    const char* device = NULL;
+    long baud = 115200;
+    uint32_t latencyMs = 5;
+    uint32_t jitterMs = 0;
+    double corrupt = 0;
+    double drop = 0;
+    double garbage = 0;
+    uint32_t statsSec = 10;
+};
+
+struct PendingCommand {
+    uint64_t dueMs;
+    uint8_t byte;
+};
+
+struct Stats {
+    uint64_t commands = 0;
+    uint64_t bytesOut = 0;
+    uint64_t corrupted = 0;
+    uint64_t dropped = 0;
+    uint64_t garbage = 0;
+    uint64_t overflow = 0;
+};
+
+static Options opt;
+static Stats stats;
+static SimRng faults;
+static std::deque<uint8_t> outQueue;
+static volatile sig_atomic_t running = 1;
+
+static void onSignal(int) { running = 0; }
+
+static uint64_t nowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void enqueue(uint8_t b) {
+    if (outQueue.size() >= OUT_QUEUE_MAX) {
+        outQueue.pop_front();   // nobody is reading; keep the newest bytes
+        stats.overflow++;
+    }
+    outQueue.push_back(b);
+}
+
+// Error injection happens on the way out, per byte
+static void sink(const uint8_t* bytes, size_t len, void*) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = bytes[i];
+        if (opt.garbage > 0 && faults.uniform() < opt.garbage) {
+            enqueue((uint8_t)faults.next());
+            stats.garbage++;
+        }
+        if (opt.drop > 0 && faults.uniform() < opt.drop) {
+            stats.dropped++;
+            continue;
+        }
+        if (opt.corrupt > 0 && faults.uniform() < opt.corrupt) {
+            b ^= 1 << (faults.next() & 7);
+            stats.corrupted++;
+        }
+        enqueue(b);
+    }
+}
+
+static bool makeRaw(int fd, long baud) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) return false;
+    cfmakeraw(&tio);
+    speed_t speed = B115200;
+    switch (baud) {
+        case 9600: speed = B9600; break;
+        case 19200: speed = B19200; break;
+        case 38400: speed = B38400; break;
+        case 57600: speed = B57600; break;
+        case 230400: speed = B230400; break;
+        case 460800: speed = B460800; break;
+        case 921600: speed = B921600; break;
+        default: break;
+    }
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+// Returns the master side. The slave stays open here so the pty survives
+// the kiosk side closing and reopening it.
+static int openPty(int& slaveFd) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return -1;
+    const char* name = ptsname(master);
+    slaveFd = open(name, O_RDWR | O_NOCTTY);
+    if (slaveFd < 0 || !makeRaw(slaveFd, opt.baud)) return -1;
+    makeRaw(master, opt.baud);
+    printf("hub on %s\n", name);
+    fflush(stdout);
+    return master;
+}
+
+static bool loadScenario(SimScenario& s) {
+    if (!opt.scenario) {
+        simDefaultScenario(s);
+        return true;
+    }
+    FILE* f = fopen(opt.scenario, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot read %s\n", opt.scenario);
+        return false;
+    }
+    std::vector<char> text(SIM_SCENARIO_TEXT_MAX);
+    size_t n = fread(text.data(), 1, text.size() - 1, f);
+    fclose(f);
+    text[n] = '\0';
+    int errLine = 0;
+    if (!simParseScenario(text.data(), s, &errLine)) {
+        fprintf(stderr, "%s:%d: not understood\n", opt.scenario, errLine);
+        return false;
+    }
+    return true;
+}
+
+static bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        bool more = i + 1 < argc;
+        const char* a = argv[i];
+        if (!strcmp(a, "--scenario") && more) opt.scenario = argv[++i];
+        else if (!strcmp(a, "--device") && more) opt.device = argv[++i];
+        else if (!strcmp(a, "--baud") && more) opt.baud = atol(argv[++i]);
+        else if (!strcmp(a, "--latency-ms") && more) opt.latencyMs = atoi(argv[++i]);
+        else if (!strcmp(a, "--jitter-ms") && more) opt.jitterMs = atoi(argv[++i]);
+        else if (!strcmp(a, "--corrupt") && more) opt.corrupt = atof(argv[++i]);
+        else if (!strcmp(a, "--drop") && more) opt.drop = atof(argv[++i]);
+        else if (!strcmp(a, "--garbage") && more) opt.garbage = atof(argv[++i]);
+        else if (!strcmp(a, "--stats") && more) opt.statsSec = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "unknown option %s (see the header of tools/hub_emulator.cpp)\n", a);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) return 2;
+
+    SimScenario scenario;
+    if (!loadScenario(scenario)) return 2;
+    faults.seed(scenario.seed ^ 0x5EEDu);
+
+    int slaveFd = -1;
+    int fd;
+    if (opt.device) {
+        fd = open(opt.device, O_RDWR | O_NOCTTY);
+        if (fd < 0 || !makeRaw(fd, opt.baud)) {
+            fprintf(stderr, "cannot open %s: %s\n", opt.device, strerror(errno));
+            return 1;
+        }
+    } else {
+        fd = openPty(slaveFd);
+        if (fd < 0) {
+            fprintf(stderr, "cannot create pty: %s\n", strerror(errno));
+            return 1;
+        }
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    SimEngine engine;
+    engine.begin(scenario);
+    std::deque<PendingCommand> pending;
+
+    const uint64_t startMs = nowMs();
+    uint64_t lastStats = startMs;
+    uint64_t lastPace = startMs;
+    double budget = 0;   // bytes the line may carry right now
+
+    fprintf(stderr, "scenario '%s' seed %u, %ld baud, latency %u+%u ms\n", scenario.name,
+            scenario.seed, opt.baud, opt.latencyMs, opt.jitterMs);
+
+    while (running) {
+        struct pollfd p = {fd, POLLIN, 0};
+        poll(&p, 1, 1);
+        uint64_t now = nowMs();
+
+        uint8_t in[64];
+        ssize_t n = read(fd, in, sizeof(in));
+        for (ssize_t i = 0; i < n; i++) {
+            uint32_t jitter = opt.jitterMs ? faults.next() % (opt.jitterMs + 1) : 0;
+            PendingCommand c = {now + opt.latencyMs + jitter, in[i]};
+            // Keep the byte order even when jitter would reorder them
+            if (!pending.empty() && pending.back().dueMs > c.dueMs) c.dueMs = pending.back().dueMs;
+            pending.push_back(c);
+            stats.commands++;
+        }
+
+        // Run the simulated hub up to each command, then apply it
+        while (!pending.empty() && pending.front().dueMs <= now) {
+            uint32_t at = (uint32_t)(pending.front().dueMs - startMs);
+            if (at > engine.now()) engine.advance(at - engine.now(), sink, NULL);
+            engine.command(&pending.front().byte, 1);
+            pending.pop_front();
+        }
+        uint32_t elapsed = (uint32_t)(now - startMs);
+        if (elapsed > engine.now()) engine.advance(elapsed - engine.now(), sink, NULL);
+
+        // Pace output to the configured line rate
+        size_t allowed = outQueue.size();
+        if (opt.baud > 0) {
+            budget += (now - lastPace) * (opt.baud / 10.0) / 1000.0;
+            if (budget > 64) budget = 64;   // no bursts after idle time
+            allowed = std::min(allowed, (size_t)budget);
+        }
+        lastPace = now;
+        if (allowed > 0) {
+            uint8_t out[256];
+            size_t count = std::min(allowed, sizeof(out));
+            for (size_t i = 0; i < count; i++) out[i] = outQueue[i];
+            ssize_t w = write(fd, out, count);
+            if (w > 0) {
+                outQueue.erase(outQueue.begin(), outQueue.begin() + w);
+                stats.bytesOut += w;
+                budget -= w;
+            }
+        }
+
+        if (opt.statsSec && now - lastStats >= opt.statsSec * 1000ULL) {
+            fprintf(stderr, "[%6.0fs] cmds %llu, frames %u (+%u dropped by scenario), out %llu B,"
+                            " queued %zu, corrupt %llu, drop %llu, garbage %llu, overflow %llu\n",
+                    (now - startMs) / 1000.0, (unsigned long long)stats.commands,
+                    engine.framesSent, engine.framesDropped, (unsigned long long)stats.bytesOut,
+                    outQueue.size(), (unsigned long long)stats.corrupted,
+                    (unsigned long long)stats.dropped, (unsigned long long)stats.garbage,
+                    (unsigned long long)stats.overflow);
+            lastStats = now;
+        }
+    }
+
+    close(fd);
+    if (slaveFd >= 0) close(slaveFd);
+    return 0;
+}
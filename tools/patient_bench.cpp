@@ -0,0 +1,180 @@
+// Host benchmark for the returning-patient index (src/patient_index.h).
+//
+// Fills the index from a synthetic record stream – names drawn from first
+// and last name lists, with a share of returning patients – then times
+// typeahead suggestions for prefixes of one to six characters and checks
+// each answer against a sorted list of every name. The kiosk's budget for
+// a suggestion is well under one 16 ms frame.
+//
+// With --retain, only the newest N records are kept, RETAIN_STEP at a time
+// as retention drops segments, and a full index is rebuilt from the kept
+// records whenever it holds patients that are gone – what patients.cpp
+// does with its catch-up scan. Every live patient must then be indexed as
+// long as there are no more than PATIENT_INDEX_MAX of them.
+//
+//   g++ -O2 -std=gnu++11 -Isrc tools/patient_bench.cpp src/patient_index.cpp
+//       src/simulator.cpp src/hub_protocol.cpp -o patient_bench
+//   ./patient_bench --records 50000
+//
+// Options:
+//   --records N     records saved (default 20000)
+//   --returning P   share of records from a patient seen before (default 0.4)
+//   --queries N     suggestions timed (default 20000)
+//   --retain N      keep only the newest N records (default all)
+//   --seed N
+
+#include "patient_index.h"
+#include "simulator.h"   // SimRng
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char* const FIRST[] = {
+    "Maria", "Jose", "Juan", "Ana", "Pedro", "Rosa", "Antonio", "Carmen", "Luis", "Elena",
+    "Mark", "Grace", "John", "Joy", "Paul", "Faith", "James", "Angel", "Michael", "Kristine",
+    "Ramon", "Teresa", "Carlos", "Liza", "Daniel", "Joan", "Miguel", "Cristina", "Rafael", "Lourdes",
+};
+static const char* const LAST[] = {
+    "Santos", "Reyes", "Cruz", "Bautista", "Garcia", "Mendoza", "Torres", "Flores", "Gonzales",
+    "Ramos", "Aquino", "Castillo", "Villanueva", "Dela Cruz", "Fernandez", "Navarro", "Rivera",
+    "Lopez", "Morales", "Santiago", "Domingo", "Manalo", "Pascual", "Salazar", "Tolentino",
+};
+#define COUNT(a) (sizeof(a) / sizeof(a[0]))
+#define RETAIN_STEP 100   // records dropped at once, as a segment
+
+static double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[(size_t)(p / 100.0 * (v.size() - 1))];
+}
+
+int main(int argc, char** argv) {
+    long records = 20000;
+    double returning = 0.4;
+    long queries = 20000;
+    uint32_t seed = 1;
+    long retain = 0;
+    for (int i = 1; i < argc; i++) {
+        bool more = i + 1 < argc;
+        if (!strcmp(argv[i], "--records") && more) records = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--returning") && more) returning = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--queries") && more) queries = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && more) seed = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--retain") && more) retain = atol(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--records N] [--returning P] [--queries N] [--retain N] [--seed N]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    SimRng rng;
+    rng.seed(seed);
+    PatientIndex index;
+    if (!index.begin()) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    // Records as the kiosk would save them; a position is just the record number
+    std::vector<std::string> seen;
+    std::vector<uint32_t> recordName;   // index into seen, per record
+    std::vector<double> addUs, rebuildMs;
+    uint64_t oldest = 1, builtOldest = 1;   // first live position
+    for (long r = 0; r < records; r++) {
+        std::string name;
+        if (!seen.empty() && rng.uniform() < returning) {
+            recordName.push_back(rng.next() % seen.size());
+            name = seen[recordName.back()];
+        } else {
+            char buf[64];
+            snprintf(buf, sizeof(buf), "%s %s %s", FIRST[rng.next() % COUNT(FIRST)],
+                     FIRST[rng.next() % COUNT(FIRST)], LAST[rng.next() % COUNT(LAST)]);
+            name = buf;
+            if (rng.uniform() < 0.5f) name += " " + std::to_string(rng.next() % 100);   // namesakes
+            recordName.push_back(seen.size());
+            seen.push_back(name);
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        index.add(name.c_str(), (uint64_t)r + 1);
+        addUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+
+        if (retain > 0 && r + 1 - (long)(oldest - 1) > retain + RETAIN_STEP) oldest += RETAIN_STEP;
+        if (index.dropped && oldest != builtOldest) {
+            builtOldest = oldest;
+            if (index.countBefore(oldest)) {
+                t0 = std::chrono::steady_clock::now();
+                index.clear();
+                for (uint64_t p = oldest; p <= (uint64_t)r + 1; p++) index.add(seen[recordName[p - 1]].c_str(), p);
+                rebuildMs.push_back(
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+            }
+        }
+    }
+
+    // Reference: every indexed key, sorted – the order suggestions come in
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < seen.size(); i++) {
+        char key[PATIENT_NAME_MAX + 1];
+        PatientIndex::normalize(seen[i].c_str(), key);
+        uint64_t pos;
+        if (index.find(seen[i].c_str(), pos)) keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<double> suggestUs;
+    long wrong = 0;
+    for (long q = 0; q < queries; q++) {
+        const std::string& from = seen[rng.next() % seen.size()];
+        size_t plen = 1 + rng.next() % 6;
+        std::string prefix = from.substr(0, std::min(plen, from.size()));
+
+        PatientMatch out[4];
+        auto t0 = std::chrono::steady_clock::now();
+        size_t n = index.suggest(prefix.c_str(), 0, out, 4);
+        suggestUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+
+        char key[PATIENT_NAME_MAX + 1];
+        size_t klen = PatientIndex::normalize(prefix.c_str(), key, true);
+        std::vector<std::string>::iterator it = std::lower_bound(keys.begin(), keys.end(), std::string(key));
+        for (size_t i = 0; i < 4; i++, ++it) {
+            bool expect = it != keys.end() && it->compare(0, klen, key) == 0;
+            if (expect != (i < n)) { wrong++; break; }
+            if (!expect) break;
+            char got[PATIENT_NAME_MAX + 1];
+            PatientIndex::normalize(out[i].name, got);
+            if (*it != got) { wrong++; break; }
+        }
+    }
+
+    printf("records       %ld, %u patients (%u not indexed)\n", records, index.count(), index.dropped);
+    printf("memory        %zu bytes reserved, %u trie nodes, %u pool bytes used\n", index.bytes(),
+           index.nodeCount(), index.poolUsed());
+    printf("add           p50 %.2f us, p99 %.2f us, max %.2f us\n", percentile(addUs, 50),
+           percentile(addUs, 99), percentile(addUs, 100));
+    printf("suggest       p50 %.2f us, p99 %.2f us, max %.2f us over %ld queries\n", percentile(suggestUs, 50),
+           percentile(suggestUs, 99), percentile(suggestUs, 100), queries);
+
+    // Every patient with a kept record is indexed, if they fit
+    std::vector<uint32_t> live;
+    for (uint64_t p = oldest; p <= (uint64_t)records; p++) live.push_back(recordName[p - 1]);
+    std::sort(live.begin(), live.end());
+    live.erase(std::unique(live.begin(), live.end()), live.end());
+    long missing = 0;
+    for (size_t i = 0; i < live.size(); i++) {
+        uint64_t pos;
+        if (!index.find(seen[live[i]].c_str(), pos) || pos < oldest) missing++;
+    }
+    if (live.size() > PATIENT_INDEX_MAX) missing = 0;   // cannot all fit; `dropped` says how many didn't
+    if (retain > 0) {
+        printf("retention     %zu live patients, %zu rebuilds (max %.1f ms), %ld live not indexed\n",
+               live.size(), rebuildMs.size(), percentile(rebuildMs, 100), missing);
+    }
+    printf("mismatches    %ld\n", wrong);
+    return wrong || missing ? 1 : 0;
+}
@@ -0,0 +1,351 @@
+// Host runner for the sensor hub simulator (src/simulator.h).
+//
+// Plays a scenario through simulated checkups – START_STREAM / STOP_STREAM
+// on each enabled sensor (or one CMD_SUBSCRIBE of all of them with
+// --multiplex), then CMD_MEASURE – on virtual time, feeds every
+// frame through the firmware's FrameDecoder and prints a summary with an
+// FNV-1a hash of the emitted bytes. The same scenario and seed always give
+// the same hash, so it doubles as a regression check for the simulator and
+// the decoder.
+//
+//   g++ -O2 -std=gnu++11 -Isrc tools/simrun.cpp src/simulator.cpp src/hub_protocol.cpp src/ppg.cpp -o simrun
+//   ./simrun tools/scenarios/adult_normal.sim --checkups 1000
+//   ./simrun tools/scenarios/restless_child.sim --trace --corrupt 0.001
+//
+// Options:
+//   --checkups N    checkups to run (default 1)
+//   --seconds S     streaming time per sensor (default 10)
+//   --multiplex     stream all sensors at once; R Hz each with --rates R,R,R,R
+//   --seed N        override the scenario seed
+//   --corrupt P     flip a random bit in each byte with probability P
+//   --frames FILE   write the raw byte stream to FILE
+//   --trace         print every decoded frame as CSV
+//   --wave          also stream the pulse waveform and run the firmware's
+//                   PPG processing on it (src/ppg.h), then check it: once
+//                   the pulse has settled the heart rate must be within
+//                   PPG_CHECK_BPM of the scenario's, and quality must drop
+//                   to 0 after lost frames and with no finger on the sensor
+//   --bp            take a cuff reading (CMD_START_BP) after the sensors
+
+#include "simulator.h"
+#include "hub_protocol.h"
+#include "ppg.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct RunState {
+    FrameDecoder decoder;
+    SimRng noise;
+    double corrupt;
+    FILE* frames;
+    bool trace;
+    uint64_t bytes;
+    uint32_t hash;
+    uint32_t perSensor[SIM_SENSORS + 1];
+    float last[SIM_SENSORS + 1];
+    uint32_t measurements;
+    uint32_t waveSamples;
+    PpgProcessor ppg;
+    uint32_t bpFrames;
+    uint32_t bpRuns;
+    BpReading bpResult;
+    float bpPeakOsc;        // largest oscillation of the last run
+    float bpPeakCuff;       // cuff pressure there (MAP)
+};
+
+static void onFrame(const HubFrame& f, void* ctx) {
+    RunState* st = (RunState*)ctx;
+    if (f.type == FRAME_STREAM) {
+        uint8_t s = f.sample.sensor <= SIM_SENSORS ? f.sample.sensor : 0;
+        st->perSensor[s]++;
+        st->last[s] = f.sample.value;
+        if (st->trace) printf("%u,stream,%u,%.2f\n", f.sample.timestamp, f.sample.sensor, f.sample.value);
+    } else if (f.type == FRAME_WAVE) {
+        st->waveSamples += HUB_WAVE_BATCH;
+        st->ppg.push(f.wave);
+        if (st->trace) {
+            PpgStats p = st->ppg.stats();
+            printf("%u,wave,%d..%d,HR=%u RMSSD=%u Q=%u\n", f.wave.timestamp, f.wave.samples[0],
+                   f.wave.samples[HUB_WAVE_BATCH - 1], p.bpm, p.rmssdMs, p.quality);
+        }
+    } else if (f.type == FRAME_BP) {
+        st->bpFrames++;
+        if (f.bp.phase == BP_DONE || f.bp.phase == BP_FAILED) {
+            st->bpRuns++;
+            st->bpResult = f.bp;
+        } else if (f.bp.phase == BP_DEFLATING && f.bp.oscMmHg > st->bpPeakOsc) {
+            st->bpPeakOsc = f.bp.oscMmHg;
+            st->bpPeakCuff = f.bp.cuffMmHg;
+        }
+        if (st->trace) {
+            printf("%u,bp,%u,%.1f,%.2f,%u/%u/%u\n", f.bp.timestamp, f.bp.phase, f.bp.cuffMmHg,
+                   f.bp.oscMmHg, f.bp.sys, f.bp.dia, f.bp.map);
+        }
+    } else {
+        st->measurements++;
+        if (st->trace) {
+            printf("%u,measure,H=%.1f W=%.2f T=%.1f HR=%u BMI=%.1f ST=0x%02X\n", f.data.timestamp,
+                   f.data.height_cm, f.data.weight_kg, f.data.temperature_c, f.data.heart_rate,
+                   f.data.bmi, f.data.sensor_status);
+        }
+    }
+}
+
+static void sink(const uint8_t* bytes, size_t len, void* ctx) {
+    RunState* st = (RunState*)ctx;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = bytes[i];
+        st->hash = (st->hash ^ b) * 16777619u;
+        if (st->corrupt > 0 && st->noise.uniform() < st->corrupt) b ^= 1 << (st->noise.next() & 7);
+        if (st->frames) fputc(b, st->frames);
+        st->decoder.push(b, onFrame, st);
+    }
+    st->bytes += len;
+}
+
+/* ==================== PPG CHECKS ==================== */
+#define PPG_CHECK_BPM     5       // heart rate tolerance once settled
+#define PPG_CHECK_SETTLE  30000   // ms of waveform before the rate is compared
+
+struct PpgRun {
+    FrameDecoder decoder;
+    PpgProcessor ppg;
+    bool losing;   // frames lost on the way: nothing reaches the processor
+};
+
+static void ppgFrame(const HubFrame& f, void* ctx) {
+    PpgRun* run = (PpgRun*)ctx;
+    if (f.type == FRAME_WAVE && !run->losing) run->ppg.push(f.wave);
+}
+
+static void ppgSink(const uint8_t* bytes, size_t len, void* ctx) {
+    PpgRun* run = (PpgRun*)ctx;
+    for (size_t i = 0; i < len; i++) run->decoder.push(bytes[i], ppgFrame, run);
+}
+
+// A flat trace, as the sensor reads with no finger on it
+static void noFinger(PpgProcessor& ppg, uint32_t fromMs, uint32_t ms) {
+    for (uint32_t t = 0; t < ms; t += 1000 / PPG_RATE_HZ) ppg.pushSample(2000, fromMs + t);
+}
+
+// The scenario's pulse without its frame dropouts, which the checks make
+// themselves; returns the number of failed checks
+static int ppgChecks(const SimScenario& base) {
+    SimScenario scenario = base;
+    scenario.ch[HUB_SENSOR_PULSE - 1].dropout = 0;
+    SimEngine engine;
+    engine.begin(scenario);
+    static PpgRun run;
+    run.losing = false;
+    int failures = 0;
+
+    uint8_t start[2] = {CMD_START_STREAM, HUB_SENSOR_PULSE};
+    uint8_t startWave = CMD_START_WAVE;
+    engine.command(start, 2);
+    engine.command(&startWave, 1);
+    engine.advance(PPG_CHECK_SETTLE, ppgSink, &run);
+
+    float target = scenario.ch[HUB_SENSOR_PULSE - 1].target;
+    PpgStats p = run.ppg.stats();
+    if (p.quality == 0 || std::fabs(p.bpm - target) > PPG_CHECK_BPM) {
+        printf("ppg check: HR %u BPM (quality %u%%), scenario %.0f BPM\n", p.bpm, p.quality, target);
+        failures++;
+    }
+
+    // Frames lost for longer than PPG_LOST_MS: no estimate on the next one
+    run.losing = true;
+    engine.advance(PPG_LOST_MS + 500, ppgSink, &run);
+    run.losing = false;
+    engine.advance(200, ppgSink, &run);
+    p = run.ppg.stats();
+    if (p.quality != 0 || p.bpm != 0) {
+        printf("ppg check: quality %u%% and HR %u BPM after lost frames\n", p.quality, p.bpm);
+        failures++;
+    }
+    // ...and one again once beats come through
+    engine.advance(10000, ppgSink, &run);
+    p = run.ppg.stats();
+    if (p.quality == 0) {
+        printf("ppg check: no recovery after lost frames\n");
+        failures++;
+    }
+
+    noFinger(run.ppg, engine.now(), PPG_LOST_MS + 500);
+    p = run.ppg.stats();
+    if (p.quality != 0 || p.bpm != 0) {
+        printf("ppg check: quality %u%% and HR %u BPM with no finger\n", p.quality, p.bpm);
+        failures++;
+    }
+    return failures;
+}
+
+static bool readFile(const char* path, std::vector<char>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[512];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.insert(out.end(), buf, buf + n);
+    fclose(f);
+    out.push_back('\0');
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s scenario.sim [--checkups N] [--seconds S] [--seed N]"
+                        " [--corrupt P] [--frames FILE] [--trace] [--wave] [--bp]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<char> text;
+    if (!readFile(argv[1], text)) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 2;
+    }
+    SimScenario scenario;
+    int errLine = 0;
+    if (!simParseScenario(text.data(), scenario, &errLine)) {
+        fprintf(stderr, "%s:%d: not understood\n", argv[1], errLine);
+        return 2;
+    }
+
+    long checkups = 1;
+    uint32_t seconds = 10;
+    bool multiplex = false;
+    bool wave = false;
+    bool bp = false;
+    uint8_t rates[HUB_SENSOR_COUNT] = {0, 0, 0, 0};
+    RunState st;
+    memset(st.perSensor, 0, sizeof(st.perSensor));
+    memset(st.last, 0, sizeof(st.last));
+    st.corrupt = 0;
+    st.frames = NULL;
+    st.trace = false;
+    st.bytes = 0;
+    st.hash = 2166136261u;
+    st.measurements = 0;
+    st.waveSamples = 0;
+    st.bpFrames = 0;
+    st.bpRuns = 0;
+    memset(&st.bpResult, 0, sizeof(st.bpResult));
+
+    for (int i = 2; i < argc; i++) {
+        bool more = i + 1 < argc;
+        if (!strcmp(argv[i], "--checkups") && more) checkups = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--seconds") && more) seconds = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && more) scenario.seed = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--corrupt") && more) st.corrupt = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--frames") && more) st.frames = fopen(argv[++i], "wb");
+        else if (!strcmp(argv[i], "--trace")) st.trace = true;
+        else if (!strcmp(argv[i], "--multiplex")) multiplex = true;
+        else if (!strcmp(argv[i], "--wave")) wave = true;
+        else if (!strcmp(argv[i], "--bp")) bp = true;
+        else if (!strcmp(argv[i], "--rates") && more) {
+            char* p = argv[++i];
+            for (int r = 0; r < HUB_SENSOR_COUNT && *p; r++) {
+                rates[r] = (uint8_t)strtoul(p, &p, 10);
+                if (*p == ',') p++;
+            }
+        }
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    st.noise.seed(scenario.seed ^ 0xC0FFEEu);
+
+    SimEngine engine;
+    engine.begin(scenario);
+    uint64_t virtualMs = 0;
+
+    auto wallStart = std::chrono::steady_clock::now();
+    for (long c = 0; c < checkups; c++) {
+        if (multiplex) {
+            uint8_t mask = 0;
+            for (uint8_t s = 1; s <= SIM_SENSORS; s++) {
+                if (scenario.ch[s - 1].enabled) mask |= HUB_SENSOR_BIT(s);
+            }
+            uint8_t cmd[SUBSCRIBE_CMD_LEN];
+            engine.command(cmd, encodeSubscribe(mask, rates, cmd));
+            if (wave) {
+                uint8_t startWave = CMD_START_WAVE;
+                engine.command(&startWave, 1);
+            }
+            engine.advance(seconds * 1000, sink, &st);
+            uint8_t stop = CMD_STOP_STREAM;
+            engine.command(&stop, 1);
+            virtualMs += seconds * 1000;
+        }
+        for (uint8_t s = 1; s <= SIM_SENSORS && !multiplex; s++) {
+            if (!scenario.ch[s - 1].enabled) continue;
+            uint8_t start[2] = {CMD_START_STREAM, s};
+            engine.command(start, 2);
+            if (wave && s == HUB_SENSOR_PULSE) {
+                uint8_t startWave = CMD_START_WAVE;
+                engine.command(&startWave, 1);
+            }
+            engine.advance(seconds * 1000, sink, &st);
+            uint8_t stop = CMD_STOP_STREAM;
+            engine.command(&stop, 1);
+            virtualMs += seconds * 1000;
+        }
+        if (bp) {
+            // Runs take about 40 s; give up on one after two minutes
+            uint8_t startBp = CMD_START_BP;
+            engine.command(&startBp, 1);
+            st.bpPeakOsc = 0;
+            st.bpPeakCuff = 0;
+            for (int s = 0; s < 120 && engine.cuffRunning(); s++) {
+                engine.advance(1000, sink, &st);
+                virtualMs += 1000;
+            }
+            uint8_t stop = CMD_STOP_STREAM;
+            engine.command(&stop, 1);
+        }
+        uint8_t measure = CMD_MEASURE;
+        engine.command(&measure, 1);
+        engine.advance(scenario.measure_ms + 500, sink, &st);
+        virtualMs += scenario.measure_ms + 500;
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - wallStart).count();
+    if (st.frames) fclose(st.frames);
+
+    printf("scenario      %s (seed %u)\n", scenario.name, scenario.seed);
+    printf("checkups      %ld, %.1f h of hub time in %.1f ms (%.0fx real time)\n", checkups,
+           virtualMs / 3600000.0, wallMs, wallMs > 0 ? virtualMs / wallMs : 0.0);
+    printf("frames        %u sent, %u dropped by scenario, %u decoded, %u bad\n",
+           engine.framesSent, engine.framesDropped, st.decoder.goodFrames, st.decoder.badFrames);
+    printf("bytes         %llu, fnv1a %08x\n", (unsigned long long)st.bytes, st.hash);
+    for (uint8_t s = 1; s <= SIM_SENSORS; s++) {
+        printf("sensor %u      %u samples, last %.2f\n", s, st.perSensor[s], st.last[s]);
+    }
+    printf("measurements  %u\n", st.measurements);
+    if (wave) {
+        PpgStats p = st.ppg.stats();
+        printf("waveform      %u samples, %u beats, HR %u BPM, RMSSD %u ms, quality %u%%\n",
+               st.waveSamples, p.beats, p.bpm, p.rmssdMs, p.quality);
+    }
+
+    if (bp) {
+        printf("cuff          %u frames, %u runs, last %u/%u mmHg (MAP %u), peak pulse %.2f mmHg at %.0f mmHg\n",
+               st.bpFrames, st.bpRuns, st.bpResult.sys, st.bpResult.dia, st.bpResult.map,
+               st.bpPeakOsc, st.bpPeakCuff);
+    }
+
+    // Without injected corruption every sent frame must decode
+    if (st.corrupt == 0 && (st.decoder.goodFrames != engine.framesSent || st.decoder.badFrames)) {
+        fprintf(stderr, "decoder lost frames\n");
+        return 1;
+    }
+    if (wave) {
+        int failures = ppgChecks(scenario);
+        printf("ppg checks    %d failures\n", failures);
+        if (failures) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,227 @@
+// Host build of the soak benchmark's checkup lifecycle (console: SOAK).
+//
+// Runs the parts of a soak checkup that don't need the kiosk hardware:
+// hub traffic from the simulator (default scenario) through the firmware's
+// FrameDecoder and MeasureFlow, captures stored through the sensor table as
+// apply_capture() does, and the record written with encodeCSV to a file the
+// way saveHealthData() appends to the SD store. Latencies per stage and the
+// heap trend use the firmware's LatencyHistogram and HeapTrend.
+//
+// Not covered here, only by SOAK on the kiosk: the results screen, the
+// printer's dry run, toasts, the LVGL pool and the SD card's own timing.
+//
+// Every saved record is decoded again and compared with the checkup it came
+// from, and every sensor must have been captured with a plausible value.
+// Any failure, or heap growth over the firmware's tolerance, makes the exit
+// status non-zero.
+//
+//   g++ -O2 -std=gnu++11 -Itools/host -Isrc tools/soak_host.cpp src/simulator.cpp src/hub_protocol.cpp
+//       src/measure_flow.cpp src/record_codec.cpp src/soak.cpp -o soak_host
+//   ./soak_host --checkups 1000
+//
+// Options:
+//   --checkups N    checkups to run (default 100)
+//   --out FILE      record file (default soak_records.csv, removed afterwards)
+//   --keep          keep the record file
+
+#include "simulator.h"
+#include "hub_protocol.h"
+#include "measure_flow.h"
+#include "record_codec.h"
+#include "sensor_table.h"
+#include "soak.h"
+#include <malloc.h>
+
+#define SOAK_HEAP_TOLERANCE 4096   // as in main.cpp
+
+enum SoakStage { SOAK_CAPTURE, SOAK_SAVE, SOAK_TOTAL, SOAK_STAGES };
+static const char* const SOAK_STAGE_NAMES[SOAK_STAGES] = {"capture", "save", "total"};
+
+struct Checkup {
+    SimEngine engine;
+    FrameDecoder decoder;
+    MeasureFlow flow;
+    HealthData data;
+    uint32_t badCaptures;
+};
+
+// sensors.cpp needs the hardware; same formula
+float calculateBMI(float weight, float height) {
+    float heightM = height / 100.0;
+    return weight / (heightM * heightM);
+}
+
+/* ==================== HUB LINK ==================== */
+// What onHubFrame() does with the frames a soak checkup produces
+static void onFrame(const HubFrame& frame, void* ctx) {
+    Checkup& c = *(Checkup*)ctx;
+    if (frame.type == FRAME_DATA) {
+        const SensorData& d = frame.data;
+        c.data.height = d.height_cm;
+        c.data.temperature = d.temperature_c;
+        c.data.heart_rate = d.heart_rate;
+        c.data.weight = d.weight_kg;
+        c.data.bmi = d.bmi;
+        c.data.height_measured = (d.sensor_status & HUB_STATUS_HEIGHT) != 0;
+        c.data.temp_measured = (d.sensor_status & HUB_STATUS_TEMP) != 0;
+        c.data.hr_measured = (d.sensor_status & HUB_STATUS_HR) != 0;
+        c.data.weight_measured = (d.sensor_status & HUB_STATUS_WEIGHT) != 0;
+    } else if (frame.type == FRAME_STREAM) {
+        c.flow.sample(frame.sample.sensor, frame.sample.value, c.engine.now());
+    }
+}
+
+static void sink(const uint8_t* bytes, size_t len, void* ctx) {
+    Checkup& c = *(Checkup*)ctx;
+    for (size_t i = 0; i < len; i++) c.decoder.push(bytes[i], onFrame, &c);
+}
+
+static void send(const uint8_t* bytes, size_t len, void* ctx) {
+    ((Checkup*)ctx)->engine.command(bytes, len);
+}
+
+// apply_capture() without the journal and the results screen
+static void onUpdate(const MeasureUpdate& u, void* ctx) {
+    Checkup& c = *(Checkup*)ctx;
+    if (u.kind != MU_CAPTURED) return;
+    const SensorDescriptor& s = sensorDescriptor(u.sensor);
+    float captured = u.value;
+    if (!sensorPlausible(s, captured)) {
+        captured = 0;
+        c.badCaptures++;
+    }
+    s.store(c.data, captured);
+    c.data.*s.measured = true;
+    if (s.cls == SC_BODY && c.data.height > 0 && c.data.weight > 0)
+        c.data.bmi = calculateBMI(c.data.weight, c.data.height);
+}
+
+/* ==================== LIFECYCLE ==================== */
+// soak_capture() in main.cpp
+static void capture(Checkup& c, uint32_t i) {
+    c.flow.reset(c.engine.now());
+    c.data = HealthData();
+    c.data.name = "Soak " + String(i);
+    c.data.age = String(20 + i % 60);
+    c.data.gender = (i & 1) ? "Female" : "Male";
+    c.data.address = "Benchmark Street " + String(i % 100);
+    c.data.timestamp = "2024-01-01 00:00:00";
+    c.data.bp_sys = 110 + i % 30;
+    c.data.bp_dia = 70 + i % 20;
+    c.data.bp_measured = true;
+    c.flow.markDone(MEASURE_STEP_BP);
+
+    for (uint8_t sensor = HUB_SENSOR_HEIGHT; sensor <= HUB_SENSOR_PULSE; sensor++) {
+        c.flow.start(sensor, c.engine.now());
+        c.engine.advance(2000, sink, &c);
+        c.flow.capture(c.engine.now());
+    }
+    uint8_t measure = CMD_MEASURE;
+    c.engine.command(&measure, 1);
+    c.engine.advance(c.engine.scenario().measure_ms, sink, &c);
+}
+
+// Fields equal to the two decimals CSV keeps
+static bool sameRecord(const HealthData& a, const HealthData& b) {
+    return a.timestamp == b.timestamp && a.name == b.name && a.age == b.age && a.gender == b.gender &&
+           a.address == b.address && fabsf(a.weight - b.weight) <= 0.005f &&
+           fabsf(a.height - b.height) <= 0.005f && fabsf(a.temperature - b.temperature) <= 0.005f &&
+           fabsf(a.bmi - b.bmi) <= 0.005f && a.heart_rate == b.heart_rate && a.bp_sys == b.bp_sys &&
+           a.bp_dia == b.bp_dia;
+}
+
+// Heap in use, turned into the "free bytes" HeapTrend expects
+static uint32_t heapFree() {
+    return UINT32_MAX - (uint32_t)mallinfo2().uordblks;
+}
+
+int main(int argc, char** argv) {
+    long n = 100;
+    const char* path = "soak_records.csv";
+    bool keep = false;
+    for (int i = 1; i < argc; i++) {
+        bool more = i + 1 < argc;
+        if (!strcmp(argv[i], "--checkups") && more) n = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--out") && more) path = argv[++i];
+        else if (!strcmp(argv[i], "--keep")) keep = true;
+        else {
+            fprintf(stderr, "usage: %s [--checkups N] [--out FILE] [--keep]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (n <= 0) n = 100;
+
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return 2;
+    }
+
+    static Checkup c;
+    SimScenario scenario;
+    simDefaultScenario(scenario);
+    c.engine.begin(scenario);
+    c.flow.setLink(send, &c);
+    c.flow.setHandler(onUpdate, &c);
+    c.badCaptures = 0;
+
+    static LatencyHistogram latency[SOAK_STAGES];
+    for (int s = 0; s < SOAK_STAGES; s++) latency[s].reset();
+    HeapTrend heap;
+    heap.reset(n);
+    uint32_t saveFailures = 0, missing = 0, roundTrips = 0;
+
+    for (long i = 0; i < n; i++) {
+        uint32_t t0 = micros();
+        capture(c, i);
+        uint32_t t1 = micros();
+        char line[RECORD_CSV_MAX];
+        size_t len = encodeCSV(c.data, line, sizeof(line));
+        if (len == 0 || fwrite(line, 1, len, out) != len || fwrite("\r\n", 1, 2, out) != 2 || fflush(out) != 0)
+            saveFailures++;
+        uint32_t t2 = micros();
+
+        latency[SOAK_CAPTURE].add(t1 - t0);
+        latency[SOAK_SAVE].add(t2 - t1);
+        latency[SOAK_TOTAL].add(t2 - t0);
+        heap.add(i, heapFree());
+
+        for (uint8_t s = HUB_SENSOR_HEIGHT; s <= HUB_SENSOR_PULSE; s++) {
+            if (!c.flow.isDone(s)) missing++;
+        }
+        HealthData back;
+        if (len && decodeCSV(line, back) && sameRecord(c.data, back)) roundTrips++;
+    }
+    fclose(out);
+
+    // The file must hold every record, in order, decodable
+    uint32_t readBack = 0;
+    FILE* in = fopen(path, "rb");
+    if (in) {
+        char line[RECORD_CSV_MAX + 2];
+        while (fgets(line, sizeof(line), in)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            HealthData d;
+            if (decodeCSV(line, d) && d.name == ("Soak " + String((unsigned long)readBack))) readBack++;
+        }
+        fclose(in);
+    }
+    if (!keep) remove(path);
+
+    printf("SOAK host results (us)  p50       p99       max      mean\n");
+    for (int s = 0; s < SOAK_STAGES; s++) {
+        const LatencyHistogram& h = latency[s];
+        printf("  %-10s %14lu %9lu %9lu %9lu\n", SOAK_STAGE_NAMES[s], (unsigned long)h.percentile(50),
+               (unsigned long)h.percentile(99), (unsigned long)h.maxUs, (unsigned long)h.meanUs());
+    }
+    printf("  %ld checkups, %lu save failures, %lu steps not captured, %lu implausible captures\n", n,
+           (unsigned long)saveFailures, (unsigned long)missing, (unsigned long)c.badCaptures);
+    printf("  %lu/%ld records round-tripped, %lu/%ld read back from %s\n", (unsigned long)roundTrips, n,
+           (unsigned long)readBack, n, path);
+    heap.print("heap");
+
+    bool ok = saveFailures == 0 && missing == 0 && c.badCaptures == 0 && roundTrips == (uint32_t)n &&
+              readBack == (uint32_t)n && heap.growth() <= SOAK_HEAP_TOLERANCE;
+    printf(ok ? "SOAK: PASS\n" : "SOAK: FAIL\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,353 @@
+// Host checks for the segmented record store (src/storage.h) and the
+// EXPORT / ACK protocol over it (src/sync_export.h).
+//
+// Builds the firmware's storage.cpp and sync_export.cpp against the host
+// stand-ins in tools/host, with the card a scratch directory (SD.h). Covers
+// segment rotation and retention, RecordReader reading every record in
+// order with contiguous positions, and batches taken the way
+// tools/export_collector.py takes them: each batch must start where the
+// last acknowledged one ended – also when that was the end of a full
+// segment and the next segment was only started afterwards – unless the
+// kiosk reports a resync. Each failed check is printed; any failure makes
+// the exit status non-zero.
+//
+//   g++ -O2 -std=gnu++11 -Itools/host -Isrc tools/storage_test.cpp src/storage.cpp
+//       src/sync_export.cpp src/record_codec.cpp -o storage_test
+//   ./storage_test
+//
+// Options:
+//   --keep    leave the scratch card directory in place
+
+#include "storage.h"
+#include "sync_export.h"
+#include "record_codec.h"
+#include "console.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);    \
+            failures++;                                                        \
+        }                                                                      \
+    } while (0)
+
+/* ==================== KIOSK SIDE ==================== */
+// What main.cpp and the other modules provide to storage.cpp and
+// sync_export.cpp
+bool sdCardInitialized = true;
+void patientsReset() {}
+
+struct Command {
+    std::string name;
+    ConsoleHandler handler;
+};
+static std::vector<Command> commands;
+
+bool consoleRegister(const char* name, ConsoleHandler handler) {
+    Command c = {name, handler};
+    commands.push_back(c);
+    return true;
+}
+
+// Runs a console command; its NDJSON replies, one per element (log lines
+// that aren't JSON are left out, as the collector skips them)
+static std::vector<std::string> console(const char* name, const char* args) {
+    std::vector<std::string> out;
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (commands[i].name != name) continue;
+        FILE* capture = tmpfile();
+        FILE* was = hostSerialOut();
+        hostSerialOut() = capture;
+        commands[i].handler(args);
+        hostSerialOut() = was;
+        rewind(capture);
+        char line[RECORD_JSON_MAX + 128];
+        while (fgets(line, sizeof(line), capture)) {
+            if (line[0] == '{') out.push_back(line);
+        }
+        fclose(capture);
+    }
+    return out;
+}
+
+static HealthData record(uint32_t i) {
+    HealthData d = HealthData();
+    d.timestamp = "2026-10-18 09:00:00";
+    d.name = "Patient " + String((unsigned long)i);
+    d.age = "40";
+    d.gender = "Female";
+    d.address = "Storage Street";
+    d.weight = 60;
+    d.height = 160;
+    d.heart_rate = 70;
+    return d;
+}
+
+static bool append(uint32_t i, RecordPos* at = NULL) {
+    char line[RECORD_CSV_MAX];
+    size_t n = encodeCSV(record(i), line, sizeof(line));
+    return n > 0 && storageAppend(line, n, at);
+}
+
+// The number after `"key":` in a reply
+static unsigned long long field(const std::string& msg, const char* key) {
+    std::string k = std::string("\"") + key + "\":";
+    size_t at = msg.find(k);
+    return at == std::string::npos ? ~0ULL : strtoull(msg.c_str() + at + k.size(), NULL, 10);
+}
+
+static bool isType(const std::string& msg, const char* type) {
+    return msg.find(std::string("{\"type\":\"") + type + "\"") == 0;
+}
+
+/* ==================== COLLECTOR SIDE ==================== */
+// export_collector.py's bookkeeping: where the records on disk end, the
+// names received, and every batch checked the way collect_batch checks it
+struct Collector {
+    unsigned long gen;
+    RecordPos held;
+    bool hasHeld;
+    std::vector<std::string> names;
+    int resyncs;
+};
+
+// One EXPORT and its ACK; false once nothing more is waiting
+static bool collect(Collector& c, int batch) {
+    char args[16];
+    snprintf(args, sizeof(args), "%d", batch);
+    std::vector<std::string> msgs = console("EXPORT", args);
+    if (msgs.size() < 2 || !isType(msgs[0], "batch") || !isType(msgs.back(), "end")) {
+        printf("EXPORT: malformed reply (%zu lines)\n", msgs.size());
+        failures++;
+        return false;
+    }
+    const std::string& head = msgs[0];
+    const std::string& end = msgs.back();
+    RecordPos from = field(head, "from");
+    bool resync = head.find("\"resync\":true") != std::string::npos;
+    if (c.hasHeld && field(head, "gen") != c.gen) c.hasHeld = false;   // store cleared
+    if (c.hasHeld && from != c.held) {
+        if (!resync || from < c.held) {
+            printf("batch starts at %llu, expected %llu\n", (unsigned long long)from,
+                   (unsigned long long)c.held);
+            failures++;
+            return false;
+        }
+        c.resyncs++;
+    }
+
+    RecordPos pos = from;
+    for (size_t i = 1; i + 1 < msgs.size(); i++) {
+        CHECK(isType(msgs[i], "rec"));
+        if (field(msgs[i], "off") != pos) {
+            printf("gap/duplicate at offset %llu (expected %llu)\n", field(msgs[i], "off"),
+                   (unsigned long long)pos);
+            failures++;
+            return false;
+        }
+        pos = field(msgs[i], "end");
+        size_t name = msgs[i].find("\"name\":\"");
+        if (name != std::string::npos) {
+            name += 8;
+            c.names.push_back(msgs[i].substr(name, msgs[i].find('"', name) - name));
+        }
+    }
+    CHECK(field(end, "from") == from);
+    CHECK(field(end, "to") == pos);
+    CHECK(field(end, "count") == msgs.size() - 2);
+
+    char ack[48];
+    snprintf(ack, sizeof(ack), "%llu %llu", field(head, "gen"), (unsigned long long)pos);
+    std::vector<std::string> reply = console("ACK", ack);
+    CHECK(reply.size() == 1 && isType(reply[0], "ack") && field(reply[0], "watermark") == pos);
+    c.gen = field(head, "gen");
+    c.held = pos;
+    c.hasHeld = true;
+    return end.find("\"more\":true") != std::string::npos;
+}
+
+static void drain(Collector& c, int batch) {
+    for (int i = 0; i < 1000 && collect(c, batch); i++) {}
+}
+
+static std::string nameOf(uint32_t i) {
+    return ("Patient " + String((unsigned long)i)).s;
+}
+
+/* ==================== CHECKS ==================== */
+static void fresh() {
+    storageSetRetention(STORAGE_MAX_SEGMENTS, 0);
+    storageSelect(DATA_DIR);
+    CHECK(storageClear());
+    exportReset();
+}
+
+static void rotation() {
+    fresh();
+    RecordPos prev = 0, at = 0;
+    bool increasing = true;
+    for (uint32_t i = 0; i < 2 * SEGMENT_RECORDS + 50; i++) {
+        CHECK(append(i, &at));
+        if (at <= prev) increasing = false;
+        prev = at;
+    }
+    CHECK(increasing);
+    CHECK(storageSegmentCount() == 3);
+    CHECK(storageRecordCount() == 2 * SEGMENT_RECORDS + 50);
+    CHECK(RECORD_POS_SEQ(at) == RECORD_POS_SEQ(storageOldestPos()) + 2);
+
+    // Remounting reads the same store back from the index...
+    storageSelect(DATA_DIR);
+    CHECK(storageSegmentCount() == 3 && storageRecordCount() == 2 * SEGMENT_RECORDS + 50);
+    // ...and retention drops whole segments from the old end
+    RecordPos oldest = storageOldestPos();
+    storageSetRetention(2, 0);
+    storageSelect(DATA_DIR);
+    CHECK(storageSegmentCount() == 2);
+    CHECK(storageRecordCount() == SEGMENT_RECORDS + 50);
+    CHECK(RECORD_POS_SEQ(storageOldestPos()) == RECORD_POS_SEQ(oldest) + 1);
+}
+
+static void reader() {
+    fresh();
+    for (uint32_t i = 0; i < 2 * SEGMENT_RECORDS + 7; i++) append(i);
+
+    RecordReader r;
+    bool resynced = true;
+    CHECK(r.open(0, resynced) && !resynced);
+    char line[RECORD_CSV_MAX];
+    RecordPos at, expect = r.position();
+    bool truncated, contiguous = true, inOrder = true;
+    uint32_t n = 0;
+    while (r.next(line, sizeof(line), at, truncated)) {
+        HealthData d;
+        if (at != expect) contiguous = false;
+        if (truncated || !decodeCSV(line, d) || d.name.s != nameOf(n)) inOrder = false;
+        expect = r.position();
+        n++;
+    }
+    CHECK(n == 2 * SEGMENT_RECORDS + 7);
+    CHECK(contiguous && inOrder);
+    CHECK(r.atEnd());
+
+    // Starting from a record's position gives that record first
+    RecordPos start = 0;
+    r.open(0, resynced);
+    for (uint32_t i = 0; i <= SEGMENT_RECORDS; i++) r.next(line, sizeof(line), start, truncated);
+    CHECK(r.open(start, resynced) && !resynced && r.position() == start);
+    HealthData d;
+    CHECK(r.next(line, sizeof(line), at, truncated) && decodeCSV(line, d) && d.name.s == nameOf(SEGMENT_RECORDS));
+}
+
+// A batch that ended at the end of the newest segment, before the next
+// one existed, must be followed by one that starts right there
+static void exportAcrossSegments() {
+    fresh();
+    Collector c = Collector();
+    for (uint32_t i = 0; i < SEGMENT_RECORDS; i++) append(i);
+    drain(c, EXPORT_BATCH_MAX);
+    CHECK(c.names.size() == SEGMENT_RECORDS);
+    CHECK(RECORD_POS_OFF(c.held) > 0);   // the end of that segment
+
+    // Nothing new: an empty batch that starts and ends there
+    CHECK(!collect(c, EXPORT_BATCH_MAX));
+    CHECK(c.names.size() == SEGMENT_RECORDS);
+
+    for (uint32_t i = SEGMENT_RECORDS; i < SEGMENT_RECORDS + 3; i++) append(i);
+    CHECK(storageSegmentCount() == 2);
+    drain(c, 2);
+    for (uint32_t i = SEGMENT_RECORDS + 3; i < 3 * SEGMENT_RECORDS + 20; i++) {
+        append(i);
+        if (i % 37 == 0) collect(c, 1 + i % EXPORT_BATCH_MAX);
+    }
+    drain(c, EXPORT_BATCH_MAX);
+
+    bool all = c.names.size() == 3 * SEGMENT_RECORDS + 20;
+    for (size_t i = 0; all && i < c.names.size(); i++) all = c.names[i] == nameOf(i);
+    CHECK(all);
+    CHECK(c.resyncs == 0);
+}
+
+static void acks() {
+    fresh();
+    Collector c = Collector();
+    for (uint32_t i = 0; i < 10; i++) append(i);
+    std::vector<std::string> msgs = console("EXPORT", "4");
+    RecordPos to = field(msgs.back(), "to");
+    char ack[48];
+
+    // Only the batch just sent, in this generation, is acknowledged
+    snprintf(ack, sizeof(ack), "%llu %llu", field(msgs[0], "gen") + 1, (unsigned long long)to);
+    CHECK(isType(console("ACK", ack)[0], "error"));
+    snprintf(ack, sizeof(ack), "%llu %llu", field(msgs[0], "gen"), (unsigned long long)to + 1);
+    CHECK(isType(console("ACK", ack)[0], "error"));
+    CHECK(isType(console("ACK", "")[0], "error"));
+
+    // An unacknowledged batch is sent again
+    std::vector<std::string> again = console("EXPORT", "4");
+    CHECK(field(again[0], "from") == field(msgs[0], "from") && field(again.back(), "to") == to);
+    snprintf(ack, sizeof(ack), "%llu %llu", field(again[0], "gen"), (unsigned long long)to);
+    CHECK(isType(console("ACK", ack)[0], "ack"));
+    CHECK(isType(console("ACK", ack)[0], "error"));   // only once
+    std::vector<std::string> next = console("EXPORT", "4");
+    CHECK(field(next[0], "from") == to);
+}
+
+// Retention removing records before they were fetched is reported, and the
+// batch starts at the oldest record left
+static void resync() {
+    fresh();
+    Collector c = Collector();
+    storageSetRetention(2, 0);
+    for (uint32_t i = 0; i < 10; i++) append(i);
+    drain(c, EXPORT_BATCH_MAX);
+    for (uint32_t i = 10; i < 3 * SEGMENT_RECORDS; i++) append(i);
+    CHECK(storageSegmentCount() == 2);
+    drain(c, EXPORT_BATCH_MAX);
+    CHECK(c.resyncs == 1);
+    CHECK(c.names.size() == 10 + 2 * SEGMENT_RECORDS);
+    CHECK(c.names[10] == nameOf(SEGMENT_RECORDS));
+}
+
+int main(int argc, char** argv) {
+    bool keep = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--keep")) keep = true;
+        else {
+            fprintf(stderr, "usage: %s [--keep]\n", argv[0]);
+            return 2;
+        }
+    }
+    char root[] = "/tmp/storage_test.XXXXXX";
+    if (!mkdtemp(root)) {
+        fprintf(stderr, "cannot create a scratch directory\n");
+        return 2;
+    }
+    hostSdRoot() = root;
+    FILE* quiet = fopen("/dev/null", "w");
+    hostSerialOut() = quiet;   // the store's own log lines
+    exportBegin();
+    rotation();
+    reader();
+    exportAcrossSegments();
+    acks();
+    resync();
+    hostSerialOut() = stdout;
+    fclose(quiet);
+
+    if (keep) {
+        printf("card left in %s\n", root);
+    } else {
+        std::string rm = std::string("rm -rf ") + root;
+        if (system(rm.c_str()) != 0) printf("could not remove %s\n", root);
+    }
+    printf("storage_test: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
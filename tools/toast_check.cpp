@@ -0,0 +1,286 @@
+// Host checks for the toast queue (src/toast.h) and its UI callback budget.
+//
+// Builds the firmware's toast.cpp against the recording LVGL stand-in in
+// tools/host/lvgl.h and drives it the way the kiosk does: toastShow() from
+// event handlers, lv_timer_handler() every few milliseconds of LVGL tick.
+// Checks that a toast is on screen in the same cycle, the stack limit and
+// queue order, duplicates, errors retiring a lesser toast, the full queue,
+// expiry, tapping, fades and the timer pausing when idle.
+//
+// Every toastShow() and lv_timer_handler() call is timed on the wall clock,
+// through the checks and a randomised flood afterwards; any call over
+// UI_CALLBACK_BUDGET_MS is a failure, as is any failed check, and makes
+// the exit status non-zero. The host is far faster than the ESP32, so this
+// catches blocking (a delay(), a wait on I/O) rather than tight margins;
+// SOAK on the kiosk times the real thing.
+//
+//   g++ -O2 -std=gnu++11 -Itools/host -Isrc tools/toast_check.cpp src/toast.cpp -o toast_check
+//   ./toast_check --flood 100000
+//
+// Options:
+//   --flood N    randomised toastShow/timer calls after the checks (default 20000)
+
+#include "toast.h"
+#include "loop_health.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);    \
+            failures++;                                                        \
+        }                                                                      \
+    } while (0)
+
+/* ==================== TIMED CALLS ==================== */
+static uint32_t worstUs = 0;
+static uint32_t overBudget = 0;
+static uint32_t calls = 0;
+
+static void timed(uint32_t t0) {
+    uint32_t us = micros() - t0;
+    calls++;
+    if (us > worstUs) worstUs = us;
+    if (us > UI_CALLBACK_BUDGET_MS * 1000UL) overBudget++;
+}
+
+static void show(const char* text, ToastLevel level, uint32_t ms = TOAST_MS) {
+    uint32_t t0 = micros();
+    toastShow(text, level, ms);
+    timed(t0);
+}
+
+// LVGL's tick moves on and the handler runs, as loop() does
+static void run(uint32_t ms) {
+    hostLvTick(lv_tick_get() + ms);
+    uint32_t t0 = micros();
+    lv_timer_handler();
+    timed(t0);
+}
+
+// Advance in handler-sized steps
+static void runFor(uint32_t ms) {
+    for (uint32_t t = 0; t < ms; t += 5) run(5);
+}
+
+// Past a toast time of `ms`: the toast timer only looks every TOAST_TICK_MS
+static void runPast(uint32_t ms) {
+    runFor(ms + TOAST_TICK_MS);
+}
+
+/* ==================== SCREEN ==================== */
+// Toasts on the stack (a retired toast loses CLICKABLE while it fades)
+static std::vector<lv_obj_t*> stacked() {
+    std::vector<lv_obj_t*> all = hostLvChildren(lv_layer_top()), out;
+    for (size_t i = 0; i < all.size(); i++) {
+        if (all[i]->flags & LV_OBJ_FLAG_CLICKABLE) out.push_back(all[i]);
+    }
+    return out;
+}
+
+static std::string textOf(lv_obj_t* toast) {
+    std::vector<lv_obj_t*> label = hostLvChildren(toast);
+    return label.empty() ? "" : label[0]->text;
+}
+
+static bool onScreen(const char* text) {
+    std::vector<lv_obj_t*> s = stacked();
+    for (size_t i = 0; i < s.size(); i++) {
+        if (textOf(s[i]) == text) return true;
+    }
+    return false;
+}
+
+static void reset() {
+    toastClear();
+    runFor(TOAST_FADE_MS + 10);
+}
+
+/* ==================== CHECKS ==================== */
+static void sameCycle() {
+    reset();
+    show("Data saved", TOAST_SUCCESS);
+    CHECK(onScreen("Data saved"));
+    CHECK(toastCount() == 1);
+    CHECK(stacked()[0]->bgColor == 0x10B981);
+}
+
+static void stackAndQueue() {
+    reset();
+    char text[16];
+    for (int i = 0; i < 5; i++) {
+        snprintf(text, sizeof(text), "info %d", i);
+        show(text, TOAST_INFO);
+    }
+    CHECK(stacked().size() == TOAST_VISIBLE_MAX);
+    CHECK(toastCount() == 5);
+    CHECK(onScreen("info 0") && onScreen("info 2") && !onScreen("info 3"));
+
+    // Stacked from the top edge without overlap
+    std::vector<lv_obj_t*> s = stacked();
+    CHECK(s[0]->y < s[1]->y && s[1]->y < s[2]->y);
+
+    // Higher levels jump the queue
+    show("saved", TOAST_SUCCESS);
+    CHECK(!onScreen("saved"));
+    runPast(TOAST_MS);
+    CHECK(onScreen("saved") && onScreen("info 3") && onScreen("info 4"));
+    CHECK(toastCount() == 3);
+}
+
+static void duplicates() {
+    reset();
+    show("Printer offline", TOAST_ERROR, 1000);
+    runFor(800);
+    show("Printer offline", TOAST_ERROR, 1000);   // restarts its timer
+    CHECK(toastCount() == 1);
+    runFor(1000 - TOAST_TICK_MS);
+    CHECK(onScreen("Printer offline"));
+    runPast(TOAST_TICK_MS);
+    CHECK(!onScreen("Printer offline"));
+
+    // Same text at another level is its own toast
+    show("Check", TOAST_INFO);
+    show("Check", TOAST_ERROR);
+    CHECK(stacked().size() == 2);
+}
+
+static void errorRetiresLesser() {
+    reset();
+    show("a", TOAST_INFO);
+    runFor(100);
+    show("b", TOAST_SUCCESS);
+    show("c", TOAST_INFO);
+    show("Save failed", TOAST_ERROR);
+    // The oldest of the lesser toasts makes room at once
+    CHECK(onScreen("Save failed") && !onScreen("a") && onScreen("b") && onScreen("c"));
+
+    // Errors don't push out errors
+    show("e1", TOAST_ERROR);
+    show("e2", TOAST_ERROR);
+    show("e3", TOAST_ERROR);
+    CHECK(onScreen("Save failed") && onScreen("e1") && onScreen("e2") && !onScreen("e3"));
+}
+
+static void fullQueue() {
+    reset();
+    char text[16];
+    for (int i = 0; i < TOAST_VISIBLE_MAX; i++) {
+        snprintf(text, sizeof(text), "up %d", i);
+        show(text, TOAST_ERROR, 60000);
+    }
+    for (int i = 0; i < TOAST_QUEUE_LEN; i++) {
+        snprintf(text, sizeof(text), "q %d", i);
+        show(text, TOAST_INFO);
+    }
+    CHECK(toastCount() == TOAST_VISIBLE_MAX + TOAST_QUEUE_LEN);
+
+    // A full queue drops its oldest lesser entry for a newcomer...
+    show("newer", TOAST_SUCCESS);
+    CHECK(toastCount() == TOAST_VISIBLE_MAX + TOAST_QUEUE_LEN);
+    // ...but never a more important one
+    for (int i = 0; i < TOAST_QUEUE_LEN; i++) {
+        snprintf(text, sizeof(text), "err %d", i);
+        show(text, TOAST_ERROR);
+    }
+    show("dropped", TOAST_INFO);
+    CHECK(toastCount() == TOAST_VISIBLE_MAX + TOAST_QUEUE_LEN);
+    runPast(60000);
+    CHECK(onScreen("err 0") && onScreen("err 1") && onScreen("err 2"));
+    // The rest drain in arrival order within each level
+    runPast(TOAST_MS);
+    CHECK(onScreen("err 3") && onScreen("err 4") && onScreen("err 5"));
+    runPast(TOAST_MS);
+    CHECK(onScreen("err 6") && onScreen("err 7") && !onScreen("dropped"));
+    runPast(TOAST_MS);
+    CHECK(toastCount() == 0);
+}
+
+static void expiry() {
+    reset();
+    show("short", TOAST_INFO, 500);
+    runFor(500 - TOAST_TICK_MS);
+    CHECK(onScreen("short"));
+    runPast(TOAST_TICK_MS);
+    CHECK(!onScreen("short"));
+    // It fades, then is deleted
+    CHECK(hostLvChildren(lv_layer_top()).size() == 1 && hostLvChildren(lv_layer_top())[0]->fadingOut);
+    runPast(TOAST_FADE_MS);
+    CHECK(hostLvChildren(lv_layer_top()).empty());
+    CHECK(hostLv().timers.size() == 1 && hostLv().timers[0]->paused);
+}
+
+static void tap() {
+    reset();
+    show("tap me", TOAST_INFO, 60000);
+    std::vector<lv_obj_t*> s = stacked();
+    CHECK(s.size() == 1 && hostLvClick(s[0]));
+    run(1);   // the tap readies the timer
+    CHECK(!onScreen("tap me"));
+    CHECK(!hostLvClick(hostLvChildren(lv_layer_top())[0]));   // fading toasts ignore taps
+}
+
+static void longText() {
+    reset();
+    std::string text(80, 'x');
+    show(text.c_str(), TOAST_INFO);
+    CHECK(textOf(stacked()[0]) == std::string(TOAST_TEXT_MAX - 1, 'x'));
+}
+
+static void clear() {
+    show("one", TOAST_INFO);
+    show("two", TOAST_INFO);
+    toastClear();
+    CHECK(toastCount() == 0 && hostLvChildren(lv_layer_top()).empty());
+    CHECK(hostLv().timers[0]->paused);
+}
+
+// Random toasts and ticks; only the budget is checked
+static void flood(long n) {
+    reset();
+    static const char* const TEXTS[] = {"Data saved", "Printing...", "Printer offline", "Save failed",
+                                        "Sensor not responding", "All data cleared"};
+    uint32_t rng = 12345;
+    for (long i = 0; i < n; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        uint32_t r = rng >> 8;
+        if (r % 3 == 0) show(TEXTS[r % 6], (ToastLevel)(r % 3 == 0 ? (r >> 4) % 3 : r % 3), 200 + r % 3000);
+        else run(1 + r % 40);
+        if (r % 97 == 0) {
+            std::vector<lv_obj_t*> s = stacked();
+            if (!s.empty()) hostLvClick(s[0]);
+        }
+    }
+    CHECK(toastCount() <= TOAST_VISIBLE_MAX + TOAST_QUEUE_LEN);
+    CHECK(stacked().size() <= TOAST_VISIBLE_MAX);
+}
+
+int main(int argc, char** argv) {
+    long floodCalls = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--flood") && i + 1 < argc) floodCalls = atol(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--flood N]\n", argv[0]);
+            return 2;
+        }
+    }
+    hostLvTick(1000);
+
+    sameCycle();
+    stackAndQueue();
+    duplicates();
+    errorRetiresLesser();
+    fullQueue();
+    expiry();
+    tap();
+    longText();
+    clear();
+    flood(floodCalls);
+
+    printf("toast_check: %lu calls, worst %lu us, %lu over the %d ms budget\n", (unsigned long)calls,
+           (unsigned long)worstUs, (unsigned long)overBudget, UI_CALLBACK_BUDGET_MS);
+    if (overBudget) failures++;
+    printf("toast_check: %d failures\n", failures);
+    return failures ? 1 : 0;
+}